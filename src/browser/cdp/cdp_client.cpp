@@ -3,6 +3,7 @@
 #include <iostream>
 #include "../../core/logger/logger.hpp"
 #include "../../core/types/constants.hpp"
+#include "../../network/dns/dns_cache.hpp"
 #include "../../network/http/beast_client.hpp"
 
 namespace Mojo {
@@ -27,9 +28,8 @@ CDPClient::~CDPClient() {
 
 net::awaitable<std::string> CDPClient::get_web_socket_url() {
     try {
-        tcp::resolver resolver(co_await net::this_coro::executor);
-        auto          results =
-            co_await  resolver.async_resolve(host_, std::to_string(port_), net::use_awaitable);
+        auto results =
+            co_await Mojo::Network::Dns::DnsCache::instance().resolve(host_, std::to_string(port_));
 
         beast::tcp_stream stream(co_await net::this_coro::executor);
         co_await          stream.async_connect(results, net::use_awaitable);
@@ -68,9 +68,8 @@ net::awaitable<bool> CDPClient::connect() {
                 path = ws_url.substr(slash);
         }
 
-        tcp::resolver resolver(co_await net::this_coro::executor);
-        auto          results =
-            co_await  resolver.async_resolve(host_, std::to_string(port_), net::use_awaitable);
+        auto results =
+            co_await Mojo::Network::Dns::DnsCache::instance().resolve(host_, std::to_string(port_));
 
         beast::get_lowest_layer(ws_).expires_after(std::chrono::seconds(30));
         co_await beast::get_lowest_layer(ws_).async_connect(results, net::use_awaitable);
@@ -225,9 +224,8 @@ net::awaitable<void> CDPClient::close() {
         co_return;
 
     try {
-        tcp::resolver resolver(co_await net::this_coro::executor);
-        auto          results =
-            co_await  resolver.async_resolve(host_, std::to_string(port_), net::use_awaitable);
+        auto results =
+            co_await Mojo::Network::Dns::DnsCache::instance().resolve(host_, std::to_string(port_));
 
         beast::tcp_stream stream(co_await net::this_coro::executor);
         co_await          stream.async_connect(results, net::use_awaitable);
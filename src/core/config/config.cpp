@@ -44,6 +44,61 @@ void load_yaml(Config& config, const std::string& path) {
             config.cdp_port = yaml["cdp_port"].as<int>();
         if (yaml["proxy_threads"])
             config.proxy_threads = yaml["proxy_threads"].as<int>();
+        if (yaml["dns_cache_size"])
+            config.dns_cache_size = yaml["dns_cache_size"].as<size_t>();
+        if (yaml["dns_ttl"])
+            config.dns_ttl = yaml["dns_ttl"].as<int>();
+        if (yaml["max_body_size"])
+            config.max_body_size = yaml["max_body_size"].as<size_t>();
+        if (yaml["http2"])
+            config.http2 = yaml["http2"].as<bool>();
+        if (yaml["max_connections_per_host"])
+            config.max_connections_per_host = yaml["max_connections_per_host"].as<size_t>();
+        if (yaml["max_idle_per_host"])
+            config.max_idle_per_host = yaml["max_idle_per_host"].as<size_t>();
+        if (yaml["url_scorer"])
+            config.url_scorer = yaml["url_scorer"].as<std::string>();
+        if (yaml["frontier_memory"])
+            config.frontier_memory = yaml["frontier_memory"].as<size_t>();
+        if (yaml["visited_mode"])
+            config.visited_mode = yaml["visited_mode"].as<std::string>();
+        if (yaml["visited_fp_rate"])
+            config.visited_fp_rate = yaml["visited_fp_rate"].as<double>();
+        if (yaml["canonicalize"])
+            config.canonicalize = yaml["canonicalize"].as<bool>();
+        if (yaml["html_parser"])
+            config.html_parser = yaml["html_parser"].as<std::string>();
+        if (yaml["main_content"])
+            config.main_content = yaml["main_content"].as<bool>();
+        if (yaml["boilerplate"])
+            config.boilerplate = yaml["boilerplate"].as<double>();
+        if (yaml["near_duplicates"])
+            config.near_duplicates = yaml["near_duplicates"].as<std::string>();
+        if (yaml["near_duplicate_distance"])
+            config.near_duplicate_distance = yaml["near_duplicate_distance"].as<int>();
+        if (yaml["follow_duplicate_links"])
+            config.follow_duplicate_links = yaml["follow_duplicate_links"].as<bool>();
+        if (yaml["dedup_content"])
+            config.dedup_content = yaml["dedup_content"].as<bool>();
+        if (yaml["storage"])
+            config.storage = yaml["storage"].as<std::string>();
+        if (yaml["roll_size"])
+            config.roll_size = yaml["roll_size"].as<uint64_t>();
+        if (yaml["jsonl_shards"])
+            config.jsonl_shards = yaml["jsonl_shards"].as<size_t>();
+        if (yaml["jsonl_zstd"])
+            config.jsonl_zstd = yaml["jsonl_zstd"].as<bool>();
+        if (yaml["write_behind"])
+            config.write_behind = yaml["write_behind"].as<bool>();
+        if (yaml["hash_dirs"])
+            config.hash_dirs = yaml["hash_dirs"].as<int>();
+        if (yaml["fsync"])
+            config.fsync = yaml["fsync"].as<std::string>();
+
+        if (yaml["strip_params"] && yaml["strip_params"].IsSequence()) {
+            for (const auto& node : yaml["strip_params"])
+                config.strip_params.push_back(node.as<std::string>());
+        }
 
         if (yaml["proxies"] && yaml["proxies"].IsSequence()) {
             for (const auto& node : yaml["proxies"])
@@ -97,6 +152,57 @@ Config Config::parse(int argc, char* argv[]) {
     app.add_option("--cdp-port", config.cdp_port, "Chrome DevTools Protocol port");
     app.add_option("--browser", config.browser_path, "Path to Chromium/Chrome executable");
     app.add_option("--config", config.config_path, "Path to YAML configuration file");
+    app.add_option("--dns-cache-size", config.dns_cache_size, "Max cached DNS lookups (0 = off)");
+    app.add_option("--dns-ttl", config.dns_ttl, "Seconds a resolved address is reused");
+    app.add_option("--max-connections-per-host",
+                   config.max_connections_per_host,
+                   "Open connections per origin; further requests wait for one (0 = no limit)");
+    app.add_option("--max-idle-per-host",
+                   config.max_idle_per_host,
+                   "Keep-alive connections kept open per origin between requests");
+    app.add_option("--max-body-size", config.max_body_size, "Max response body bytes to download");
+    app.add_option("--scorer",
+                   config.url_scorer,
+                   "Frontier URL priority: fifo, depth, opic or heuristic");
+    app.add_option("--frontier-memory",
+                   config.frontier_memory,
+                   "Queued URLs kept in memory; the rest spill to disk (0 = no limit)");
+    app.add_option("--visited-mode",
+                   config.visited_mode,
+                   "Visited URL set: bloom (scalable filter) or exact (64-bit fingerprints)");
+    app.add_option("--visited-fp-rate",
+                   config.visited_fp_rate,
+                   "False positive budget for the bloom visited set");
+    app.add_option("--strip-param",
+                   config.strip_params,
+                   "Extra query parameter to drop when canonicalizing (repeatable, prefix* ok)");
+    app.add_option("--html-parser",
+                   config.html_parser,
+                   "Link extraction: html2md (single pass), gumbo or lexbor (full HTML5 DOM)");
+    app.add_option("--boilerplate",
+                   config.boilerplate,
+                   "Drop Markdown blocks found on more than this % of a host's pages (0 = off)");
+    app.add_option("--near-duplicates",
+                   config.near_duplicates,
+                   "Pages nearly identical to an earlier one: off, skip (not saved) or tag");
+    app.add_option("--near-duplicate-distance",
+                   config.near_duplicate_distance,
+                   "SimHash bits two pages may differ in and still be near-duplicates (0-7)");
+    app.add_option("--storage",
+                   config.storage,
+                   "Output backend: disk (a file per URL), uring (the same tree, written "
+                   "asynchronously through io_uring), warc (.warc.gz + CDX) or jsonl");
+    app.add_option("--roll-size", config.roll_size, "Bytes per output file before a new one");
+    app.add_option("--jsonl-shards",
+                   config.jsonl_shards,
+                   "JSONL files written in parallel (0 = one per worker thread)");
+    app.add_option("--hash-dirs",
+                   config.hash_dirs,
+                   "With --flat, spread files over this many levels of 256 hash-named directories");
+    app.add_option("--fsync",
+                   config.fsync,
+                   "Disk storage durability: none, batch (group commit per write-behind batch) "
+                   "or file");
 
     app.add_flag(
         "--flat",
@@ -105,7 +211,33 @@ Config Config::parse(int argc, char* argv[]) {
                 config.tree_structure = false;
         },
         "Use flat output structure");
+    app.add_flag(
+        "--no-canonicalize",
+        [&](size_t count) {
+            if (count > 0)
+                config.canonicalize = false;
+        },
+        "Dedupe URLs exactly as found instead of canonicalizing them");
+    app.add_flag(
+        "--no-duplicate-links",
+        [&](size_t count) {
+            if (count > 0)
+                config.follow_duplicate_links = false;
+        },
+        "Do not follow links found on near-duplicate pages");
     app.add_flag("--render", config.render_js, "Enable JavaScript rendering");
+    app.add_flag("--http2", config.http2, "Use HTTP/2 for https origins that support it");
+    app.add_flag("--main-content",
+                 config.main_content,
+                 "Save only each page's main content block, without headers, sidebars or footers");
+    app.add_flag("--jsonl-zstd", config.jsonl_zstd, "Compress JSONL output as zstd frames");
+    app.add_flag("--write-behind",
+                 config.write_behind,
+                 "Queue disk writes for writer threads so workers return at once; with "
+                 "--fsync batch, saves more files per second than syncing each one");
+    app.add_flag("--dedup-content",
+                 config.dedup_content,
+                 "Store identical page bodies once; later URLs become hard links to the first");
     app.add_flag(
         "--no-headless",
         [&](size_t count) {
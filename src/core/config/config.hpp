@@ -30,6 +30,40 @@ struct Config {
 
     int proxy_threads = 32;
 
+    size_t dns_cache_size = Constants::DEFAULT_DNS_CACHE_SIZE;
+    int    dns_ttl        = Constants::DEFAULT_DNS_TTL_SECONDS;  // seconds
+    size_t max_body_size  = Constants::DEFAULT_MAX_BODY_SIZE;    // bytes
+    bool   http2          = false;
+
+    size_t max_connections_per_host = Constants::DEFAULT_POOL_MAX_PER_HOST;  // 0 = no limit
+    size_t max_idle_per_host        = Constants::DEFAULT_POOL_MAX_IDLE_PER_HOST;
+
+    std::string url_scorer      = "fifo";  // fifo, depth, opic or heuristic
+    size_t      frontier_memory = 0;       // URLs kept in memory before spilling (0 = all)
+    std::string visited_mode    = Constants::DEFAULT_VISITED_MODE;  // bloom or exact
+    double      visited_fp_rate = Constants::DEFAULT_VISITED_FP_RATE;
+
+    bool                     canonicalize = true;  // Normalize URLs before dedupe
+    std::vector<std::string> strip_params;         // Extra query keys to drop ("prefix*" ok)
+
+    std::string html_parser  = "html2md";  // Link source: html2md, gumbo or lexbor
+    bool        main_content = false;      // Convert only the readability-picked block
+    double      boilerplate  = 0.0;        // % of a host's pages a block may be on (0 = off)
+
+    std::string near_duplicates         = "off";  // off, skip or tag near-duplicate pages
+    int         near_duplicate_distance = Constants::NEAR_DUPLICATE_DISTANCE;  // SimHash bits
+    bool        follow_duplicate_links  = true;   // Enqueue links found on near-duplicates
+    bool        dedup_content           = false;  // Store byte-identical bodies once
+
+    std::string storage      = Constants::DEFAULT_STORAGE;  // disk, warc or jsonl
+    uint64_t    roll_size    = Constants::WARC_ROLL_SIZE;   // Bytes per archive file
+    size_t      jsonl_shards = 0;                           // 0 = one per worker thread
+    bool        jsonl_zstd   = false;                       // zstd frames instead of plain text
+
+    bool        write_behind = false;                     // Disk: save from writer threads
+    int         hash_dirs    = 0;                         // Disk, flat: hash directory levels
+    std::string fsync        = Constants::DEFAULT_FSYNC;  // Disk: none, batch or file
+
     static Config parse(int argc, char* argv[]);
 };
 
@@ -1,5 +1,7 @@
 #pragma once
+#include <cctype>
 #include <chrono>
+#include <cstdint>
 #include <map>
 #include <string>
 #include <vector>
@@ -22,6 +24,55 @@ struct Constants {
     static constexpr size_t DEFAULT_BLOOM_FILTER_SIZE   = 1000000;
     static constexpr int    DEFAULT_BLOOM_FILTER_HASHES = 7;
     static constexpr int    DEFAULT_PROXY_RETRIES       = 3;
+
+    static constexpr size_t      DEFAULT_VISITED_CAPACITY = 100000;  // Keys in the first stage
+    static constexpr double      DEFAULT_VISITED_FP_RATE  = 0.001;   // Whole-crawl budget
+    static constexpr size_t      VISITED_STATS_INTERVAL   = 100000;  // New URLs between logs
+    static constexpr const char* DEFAULT_VISITED_MODE     = "bloom";
+
+    static constexpr size_t DEFAULT_POOL_MAX_PER_HOST      = 16;  // Open connections per origin
+    static constexpr size_t DEFAULT_POOL_MAX_IDLE_PER_HOST = 16;
+    static constexpr int    DEFAULT_POOL_IDLE_TIMEOUT_MS   = 30000;
+    static constexpr int    POOL_LEASE_RECHECK_MS          = 100;  // Parked lease re-check
+    static constexpr size_t DEFAULT_TLS_SESSION_CACHE_SIZE = 4096;
+
+    static constexpr size_t DEFAULT_DNS_CACHE_SIZE           = 10000;
+    static constexpr int    DEFAULT_DNS_TTL_SECONDS          = 300;
+    static constexpr int    DEFAULT_DNS_NEGATIVE_TTL_SECONDS = 30;
+
+    static constexpr size_t MAX_DECODED_BODY_SIZE = 64 * 1024 * 1024;  // Decompression bomb cap
+    static constexpr size_t DEFAULT_MAX_BODY_SIZE = 8 * 1024 * 1024;   // Wire bytes per response
+
+    static constexpr size_t      FRONTIER_SPILL_SEGMENT_SIZE = 65536;  // URLs per spill file
+    static constexpr const char* FRONTIER_SPILL_DIR          = ".frontier";
+
+    static constexpr size_t BOILERPLATE_MIN_PAGES  = 10;      // Pages seen before blocks drop
+    static constexpr size_t BOILERPLATE_MAX_BLOCKS = 100000;  // Fingerprints tracked per host
+    static constexpr size_t BOILERPLATE_MAX_HOSTS  = 10000;   // Hosts tracked at once
+
+    static constexpr int    NEAR_DUPLICATE_DISTANCE  = 3;        // Differing SimHash bits
+    static constexpr int    NEAR_DUPLICATE_SHINGLE   = 4;        // Words per shingle
+    static constexpr size_t NEAR_DUPLICATE_MAX_PAGES = 1000000;  // Pages the index keeps
+
+    static constexpr size_t      DEDUP_MAX_ENTRIES = 4000000;  // Content hashes remembered
+    static constexpr const char* DEDUP_MANIFEST    = ".duplicates.tsv";
+
+    static constexpr const char* DEFAULT_STORAGE = "disk";
+    static constexpr uint64_t    WARC_ROLL_SIZE  = 1ULL << 30;  // Bytes before a new WARC file
+    static constexpr const char* WARC_PREFIX     = "mojo";
+    static constexpr const char* WARC_CDX        = "index.cdx";
+
+    static constexpr size_t      JSONL_FLUSH_SIZE = 1 << 20;  // Buffered bytes per shard
+    static constexpr const char* JSONL_PREFIX     = "pages";
+
+    static constexpr size_t      DISK_BATCH_FILES = 256;       // Files per write-behind batch
+    static constexpr size_t      DISK_MAX_PENDING = 64 << 20;  // Queued bytes before save() waits
+    static constexpr size_t      DISK_DIR_FDS     = 256;       // Directory descriptors per writer
+    static constexpr size_t      DISK_WRITERS     = 4;         // Write-behind writer threads
+    static constexpr const char* DEFAULT_FSYNC    = "none";
+
+    static constexpr unsigned URING_QUEUE_DEPTH = 256;        // Submission queue entries
+    static constexpr size_t   URING_MAX_PENDING = 64 << 20;  // Queued bytes before save() blocks
 };
 
 inline const std::map<std::string, std::string>& get_mime_map() {
@@ -79,7 +130,7 @@ inline std::string get_matching_extension(const std::string&              url,
 
     std::string url_lower = url;
     for (char& c : url_lower)
-        c = std::tolower(c);
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
 
     for (const auto& ext : extensions) {
         if (url_lower.size() >= ext.size()
@@ -122,6 +173,24 @@ inline bool is_downloadable_mime(const std::string& content_type) {
     return false;
 }
 
+/**
+ * @brief Whether a response of this type is worth downloading: markup and text we convert,
+ * or a document type we store. Media streams and opaque binaries are rejected on headers.
+ */
+inline bool is_fetchable_content_type(const std::string& content_type) {
+    if (content_type.empty())
+        return true;
+
+    std::string type = content_type.substr(0, content_type.find(';'));
+    for (char& c : type)
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+
+    if (type.rfind("text/", 0) == 0 || type.find("html") != std::string::npos
+        || type.find("xml") != std::string::npos || type.find("json") != std::string::npos)
+        return true;
+    return is_downloadable_mime(type);
+}
+
 inline std::chrono::milliseconds get_backoff_time(int attempt) {
     if (attempt <= 0)
         return std::chrono::milliseconds(0);
@@ -2,15 +2,18 @@
 #include "../../browser/browser_client.hpp"
 #include "../../core/logger/logger.hpp"
 #include "../../core/types/constants.hpp"
+#include "../../network/dns/dns_cache.hpp"
 #include "../../network/http/beast_client.hpp"
 #include "../../network/http/http_client.hpp"
 #include "../../utils/text/converter.hpp"
 #include "../../utils/url/url.hpp"
 
+#include <algorithm>
 #include <boost/asio/co_spawn.hpp>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <stdexcept>
 
 namespace Mojo {
 namespace Engine {
@@ -40,7 +43,78 @@ Crawler::Crawler(const CrawlerConfig& config)
       headless_(config.headless),
       proxy_connect_timeout_(config.proxy_connect_timeout),
       proxy_threads_(config.proxy_threads),
-      user_agent_(config.user_agent) {
+      user_agent_(config.user_agent),
+      max_body_size_(config.max_body_size),
+      http2_(config.http2),
+      dedup_content_(config.dedup_content),
+      storage_options_{config.output_dir,
+                       config.roll_size,
+                       config.jsonl_shards > 0 ? config.jsonl_shards
+                                               : static_cast<size_t>(num_worker_threads_),
+                       config.jsonl_zstd,
+                       config.write_behind,
+                       config.tree_structure ? 0 : config.hash_dirs,
+                       config.fsync},
+      storage_name_(config.storage) {
+#ifndef MOJO_HAVE_NGHTTP2
+    if (http2_)
+        Logger::warn("Built without nghttp2; --http2 is ignored and HTTP/1.1 is used");
+#endif
+    try {
+        scorer_ = UrlScorer::create(config.url_scorer);
+    } catch (const std::invalid_argument& e) {
+        Logger::warn(std::string(e.what()) + "; falling back to fifo");
+    }
+    try {
+        html_parser_ = Text::HtmlParser::create(config.html_parser);
+    } catch (const std::invalid_argument& e) {
+        Logger::warn(std::string(e.what()) + "; falling back to html2md");
+    }
+    if (config.main_content)
+        readability_ = std::make_unique<Text::Readability>();
+    if (config.boilerplate > 0.0)
+        boilerplate_ = std::make_unique<Text::BoilerplateFilter>(config.boilerplate / 100.0);
+    if (config.near_duplicates == "skip" || config.near_duplicates == "tag") {
+        near_duplicates_ =
+            std::make_unique<Text::NearDuplicateIndex>(config.near_duplicate_distance);
+        skip_near_duplicates_ = config.near_duplicates == "skip";
+    }
+    else if (config.near_duplicates != "off") {
+        Logger::warn("Unknown near-duplicate mode: " + config.near_duplicates
+                     + "; near-duplicates are not detected");
+    }
+    follow_duplicate_links_ = config.follow_duplicate_links;
+    try {
+        visited_ = VisitedSet::create(
+            config.visited_mode, Constants::DEFAULT_VISITED_CAPACITY, config.visited_fp_rate);
+    } catch (const std::invalid_argument& e) {
+        Logger::warn(std::string(e.what()) + "; falling back to bloom");
+        visited_ = VisitedSet::create(
+            "bloom", Constants::DEFAULT_VISITED_CAPACITY, config.visited_fp_rate);
+    }
+    if (config.canonicalize) {
+        CanonicalizerOptions options;
+        options.tracking_params.insert(options.tracking_params.end(),
+                                       config.strip_params.begin(),
+                                       config.strip_params.end());
+        canonicalizer_ = std::make_unique<UrlCanonicalizer>(std::move(options));
+    }
+    if (config.frontier_memory > 0) {
+        // Several segments fit in the budget, so refilling never overshoots it by much.
+        size_t segment = std::clamp<size_t>(
+            config.frontier_memory / 4, 1, Constants::FRONTIER_SPILL_SEGMENT_SIZE);
+        frontier_.enable_spill(std::filesystem::path(output_dir_) / Constants::FRONTIER_SPILL_DIR,
+                               config.frontier_memory,
+                               segment);
+    }
+    Mojo::Network::Dns::DnsCache::instance().configure(
+        config.dns_cache_size,
+        std::chrono::seconds(config.dns_ttl),
+        std::chrono::seconds(Constants::DEFAULT_DNS_NEGATIVE_TTL_SECONDS));
+    ConnectionPool::get(ioc_).configure(
+        config.max_connections_per_host,
+        config.max_idle_per_host,
+        std::chrono::milliseconds(Constants::DEFAULT_POOL_IDLE_TIMEOUT_MS));
 }
 
 }  // namespace Engine
@@ -5,7 +5,6 @@
 #include <map>
 #include <mutex>
 #include <optional>
-#include <queue>
 #include <string>
 #include <thread>
 #include <unordered_set>
@@ -16,11 +15,19 @@
 #include "../../network/http/http_client.hpp"
 #include "../../proxy/pool/proxy_pool.hpp"
 #include "../../proxy/server/proxy_server.hpp"
+#include "../../storage/dedup_storage.hpp"
 #include "../../storage/disk_storage.hpp"
 #include "../../storage/storage.hpp"
-#include "../../utils/crypto/bloom_filter.hpp"
+#include "../../utils/crypto/visited_set.hpp"
 #include "../../utils/robotstxt/robotstxt.hpp"
+#include "../../utils/text/boilerplate.hpp"
+#include "../../utils/text/html_parser.hpp"
+#include "../../utils/text/near_duplicate.hpp"
+#include "../../utils/text/readability.hpp"
+#include "../../utils/url/canonicalizer.hpp"
 #include "../../utils/url/url.hpp"
+#include "../frontier/frontier.hpp"
+#include "../frontier/url_scorer.hpp"
 
 namespace Mojo {
 namespace Engine {
@@ -52,6 +59,34 @@ struct CrawlerConfig {
     int                        proxy_connect_timeout = 5000;
     int                        proxy_threads         = 32;
     std::string                user_agent            = Mojo::Core::Constants::USER_AGENT;
+    size_t                     dns_cache_size        = Constants::DEFAULT_DNS_CACHE_SIZE;
+    int                        dns_ttl               = Constants::DEFAULT_DNS_TTL_SECONDS;
+    size_t                     max_body_size         = Constants::DEFAULT_MAX_BODY_SIZE;
+    bool                       http2                 = false;
+    std::string                url_scorer            = "fifo";
+    size_t                     frontier_memory       = 0;
+    std::string                visited_mode          = Constants::DEFAULT_VISITED_MODE;
+    double                     visited_fp_rate       = Constants::DEFAULT_VISITED_FP_RATE;
+    bool                       canonicalize          = true;
+    std::vector<std::string>   strip_params;
+    std::string                html_parser  = "html2md";
+    bool                       main_content = false;
+    double                     boilerplate  = 0.0;  // Percent of a host's pages; 0 = off
+
+    std::string near_duplicates         = "off";  // off, skip or tag
+    int         near_duplicate_distance = Constants::NEAR_DUPLICATE_DISTANCE;
+    bool        follow_duplicate_links  = true;
+    bool        dedup_content           = false;
+    std::string storage                 = Constants::DEFAULT_STORAGE;
+    uint64_t    roll_size               = Constants::WARC_ROLL_SIZE;
+    size_t      jsonl_shards            = 0;
+    bool        jsonl_zstd              = false;
+    bool        write_behind            = false;
+    int         hash_dirs               = 0;
+    std::string fsync                   = Constants::DEFAULT_FSYNC;
+
+    size_t max_connections_per_host = Constants::DEFAULT_POOL_MAX_PER_HOST;
+    size_t max_idle_per_host        = Constants::DEFAULT_POOL_MAX_IDLE_PER_HOST;
 };
 
 class Crawler {
@@ -88,24 +123,32 @@ private:
     ProxyPool                    proxy_pool_;
     std::unique_ptr<ProxyServer> proxy_server_;
 
-    std::queue<std::pair<std::string, int>> frontier_;
-    BloomFilter                             visited_filter_;
+    std::unique_ptr<VisitedSet>              visited_;
+    std::unique_ptr<UrlCanonicalizer>        canonicalizer_;  // nullptr: URLs deduped as found
+    std::unique_ptr<Text::HtmlParser>        html_parser_;    // nullptr: links from html2md
+    std::unique_ptr<Text::Readability>       readability_;    // nullptr: whole pages converted
+    std::unique_ptr<Text::BoilerplateFilter> boilerplate_;    // nullptr: pages stored as is
+
+    std::unique_ptr<Text::NearDuplicateIndex> near_duplicates_;  // nullptr: pages not compared
+    bool skip_near_duplicates_   = false;  // Drop near-duplicates instead of tagging them
+    bool follow_duplicate_links_ = true;
 
     boost::asio::io_context ioc_;
     std::unique_ptr<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>>
-                             work_guard_;
-    std::vector<std::thread> io_threads_;
-    boost::asio::thread_pool worker_pool_;
-    boost::asio::signal_set  signals_{ioc_};
-
-    std::mutex queue_mutex_;
+                               work_guard_;
+    std::vector<std::thread>   io_threads_;
+    boost::asio::thread_pool   worker_pool_;
+    boost::asio::signal_set    signals_{ioc_};
+    Frontier                   frontier_{ioc_};
+    std::unique_ptr<UrlScorer> scorer_;  // nullptr: plain discovery order
 
-    std::atomic<int>        active_workers_{0};
-    std::atomic<int>        pending_content_tasks_{0};
     std::atomic<bool>       done_{false};
     std::condition_variable done_cv_;
     std::mutex              done_mutex_;
     std::atomic<bool>       is_shutdown_{false};
+    std::atomic<uint64_t>   wire_bytes_{0};
+    std::atomic<uint64_t>   decoded_bytes_{0};
+    std::atomic<uint64_t>   visited_count_{0};
     std::string             start_domain_;
     bool                    render_js_;
     std::string             browser_path_;
@@ -113,13 +156,12 @@ private:
     int                     proxy_connect_timeout_;
     int                     proxy_threads_;
     std::string             user_agent_;
+    size_t                  max_body_size_;
+    bool                    http2_;
 
     std::map<std::string, std::shared_ptr<RobotsTxt>> robots_cache_;
     std::mutex                                        robots_mutex_;
 
-    std::map<std::string, std::chrono::steady_clock::time_point> domain_last_access_;
-    std::mutex                                                   domain_mutex_;
-
     void init_io_services();
     void init_signals();
     void init_proxies();
@@ -129,23 +171,31 @@ private:
     void await_completion();
 
     std::unique_ptr<Mojo::Storage::Storage> storage_;
+    Mojo::Storage::DedupStorage*            dedup_ = nullptr;  // Inside storage_ when enabled
+    bool                                    dedup_content_;
+    Mojo::Storage::StorageOptions           storage_options_;
+    std::string                             storage_name_;
 
-    std::unique_ptr<HttpClient>                create_client();
-    std::optional<std::pair<std::string, int>> fetch_next_task();
-    bool                                       should_stop_worker();
+    std::unique_ptr<HttpClient> create_client();
 
-    boost::asio::awaitable<void> process_url_task(HttpClient& client, std::string url, int depth);
-    boost::asio::awaitable<bool> check_politeness_and_wait(const std::string& host);
+    boost::asio::awaitable<void>
+    process_url_task(HttpClient& client, std::string url, int depth, double priority);
 
     void process_successful_response(const std::string& url,
                                      int                depth,
                                      Response           res,
                                      const std::string& proxy_url);
     void handle_binary_content(const std::string& url,
-                               const std::string& content,
-                               const std::string& ext);
-    void handle_text_content(const std::string& url, int depth, Response res);
-    void parse_and_extract_links(const std::string& base_url, const std::string& html, int depth);
+                               const std::string& ext,
+                               Response           res);
+    void handle_text_content(const std::string& url,
+                             const std::string& base_url,
+                             int                depth,
+                             Response           res);
+    void enqueue_links(const std::string&                   url,
+                       const std::string&                   base_url,
+                       std::vector<Mojo::Utils::Text::Link> links,
+                       int                                  depth);
 
     std::shared_ptr<RobotsTxt> get_cached_robots(const std::string& domain);
     void        cache_robots(const std::string& domain, std::shared_ptr<RobotsTxt> robots);
@@ -155,17 +205,20 @@ private:
     boost::asio::awaitable<bool> ensure_robots_txt(const Mojo::Utils::UrlParsed& parsed,
                                                    HttpClient&                   client);
     boost::asio::awaitable<bool> is_url_allowed(const std::string& url, HttpClient& client);
-    boost::asio::awaitable<bool> wait_for_politeness(const std::string& domain);
 
     boost::asio::awaitable<void> worker_loop();
     boost::asio::awaitable<bool> fetch_page(HttpClient& client, const std::string& url, int depth);
 
-    void        save_to_storage(const std::string& filename,
-                                const std::string& content,
-                                bool               is_binary = false);
+    void        save_to_storage(const std::string&                filename,
+                                const std::string&                content,
+                                bool                              is_binary = false,
+                                const Mojo::Storage::FetchRecord* fetch     = nullptr);
     std::string get_save_filename(const std::string& url, const std::string& extension = "");
 
-    void add_url(std::string url, int depth);
+    void add_url(std::string url, int depth, double priority = 0.0);
+    /// Depth, domain and visited-set checks; marks `url` visited when it passes.
+    bool admit(const std::string& url, int depth);
+    void log_visited_stats();
 };
 
 }  // namespace Engine
@@ -1,5 +1,11 @@
 #include <iostream>
 #include "../../../core/logger/logger.hpp"
+#include "../../../network/dns/dns_cache.hpp"
+#include "../../../network/http/connection_pool.hpp"
+#ifdef MOJO_HAVE_NGHTTP2
+#include "../../../network/http/h2_connection.hpp"
+#endif
+#include "../../../network/http/tls_context.hpp"
 #include "../crawler.hpp"
 
 namespace Mojo {
@@ -11,14 +17,18 @@ Crawler::~Crawler() {
 
 void Crawler::start(const std::string& start_url) {
     done_ = false;
+    frontier_.reopen();
 
     Logger::info("Crawler: Starting for " + start_url);
-    auto parsed   = Mojo::Utils::Url::parse(start_url);
-    start_domain_ = parsed.host;
+    std::string seed   = canonicalizer_ ? canonicalizer_->canonicalize(start_url) : start_url;
+    auto        parsed = Mojo::Utils::Url::parse(seed);
+    start_domain_      = parsed.host;
     Logger::info("Crawler: Domain set to " + start_domain_);
 
-    add_url(start_url, 0);
+    add_url(seed, 0, scorer_ ? scorer_->seed(seed) : 0.0);
     Logger::info("Crawler: Start URL added");
+    if (scorer_)
+        Logger::info("Crawler: Frontier ordered by " + std::string(scorer_->name()) + " scorer");
 
     init_io_services();
     init_signals();
@@ -32,7 +42,17 @@ void Crawler::start(const std::string& start_url) {
 }
 
 void Crawler::init_storage() {
-    storage_ = std::make_unique<Mojo::Storage::DiskStorage>(output_dir_);
+    try {
+        storage_ = Mojo::Storage::Storage::create(storage_name_, storage_options_);
+    } catch (const std::exception& e) {
+        Logger::warn(std::string(e.what()) + "; falling back to disk");
+        storage_ = std::make_unique<Mojo::Storage::DiskStorage>(output_dir_);
+    }
+    if (dedup_content_) {
+        auto dedup = std::make_unique<Mojo::Storage::DedupStorage>(std::move(storage_));
+        dedup_     = dedup.get();
+        storage_   = std::move(dedup);
+    }
 }
 
 void Crawler::init_io_services() {
@@ -67,6 +87,8 @@ void Crawler::trigger_done() {
         std::lock_guard<std::mutex> lock(done_mutex_);
         done_ = true;
     }
+    // Wakes any worker still parked on an empty frontier.
+    frontier_.close();
     done_cv_.notify_all();
 }
 
@@ -131,8 +153,59 @@ void Crawler::shutdown() {
         return;
 
     done_ = true;
+    frontier_.close();
     Logger::info("Shutting down resources...");
 
+    auto pool_stats = ConnectionPool::get(ioc_).stats();
+    Logger::info("Connection pool: " + std::to_string(pool_stats.hits) + " reused, "
+                 + std::to_string(pool_stats.misses) + " opened, "
+                 + std::to_string(pool_stats.evictions) + " evicted");
+#ifdef MOJO_HAVE_NGHTTP2
+    if (http2_) {
+        auto h2_stats = H2ConnectionPool::get(ioc_).stats();
+        Logger::info("HTTP/2: " + std::to_string(h2_stats.streams) + " streams over "
+                     + std::to_string(h2_stats.connections) + " connections, "
+                     + std::to_string(h2_stats.fallbacks) + " HTTP/1.1 fallbacks");
+    }
+#endif
+    auto tls_stats = TlsContext::instance().stats();
+    Logger::info("TLS handshakes: " + std::to_string(tls_stats.resumed_handshakes) + " resumed, "
+                 + std::to_string(tls_stats.full_handshakes) + " full");
+    auto dns_stats = Mojo::Network::Dns::DnsCache::instance().stats();
+    Logger::info("DNS cache: " + std::to_string(dns_stats.hits) + " hits, "
+                 + std::to_string(dns_stats.misses) + " lookups, "
+                 + std::to_string(dns_stats.coalesced) + " coalesced, "
+                 + std::to_string(dns_stats.negative_hits) + " negative hits");
+    Logger::info("Transfer: " + std::to_string(wire_bytes_.load()) + " bytes on the wire, "
+                 + std::to_string(decoded_bytes_.load()) + " bytes decoded");
+    log_visited_stats();
+    auto frontier_stats = frontier_.stats();
+    if (frontier_stats.dispatched > 0) {
+        Logger::info("Frontier: " + std::to_string(frontier_stats.dispatched) + " dispatched ("
+                     + std::to_string(frontier_stats.handoffs) + " direct to idle workers), "
+                     + std::to_string(frontier_stats.total_dispatch_us / frontier_stats.dispatched)
+                     + "us avg / " + std::to_string(frontier_stats.max_dispatch_us)
+                     + "us max time-to-dispatch");
+    }
+    if (frontier_stats.spill_segments > 0) {
+        Logger::info("Frontier spill: " + std::to_string(frontier_stats.spill_segments)
+                     + " segments, " + std::to_string(frontier_stats.spill_bytes)
+                     + " bytes written to disk");
+    }
+    if (boilerplate_) {
+        auto boilerplate_stats = boilerplate_->stats();
+        Logger::info("Boilerplate: " + std::to_string(boilerplate_stats.blocks_removed)
+                     + " blocks (" + std::to_string(boilerplate_stats.bytes_removed)
+                     + " bytes) removed from " + std::to_string(boilerplate_stats.pages)
+                     + " pages");
+    }
+    if (near_duplicates_) {
+        auto near_duplicate_stats = near_duplicates_->stats();
+        Logger::info("Near-duplicates: " + std::to_string(near_duplicate_stats.duplicates)
+                     + " of " + std::to_string(near_duplicate_stats.pages) + " pages ("
+                     + std::to_string(near_duplicate_stats.indexed) + " fingerprints indexed)");
+    }
+
     work_guard_.reset();
     ioc_.stop();
 
@@ -149,6 +222,16 @@ void Crawler::shutdown() {
 
     worker_pool_.stop();
     worker_pool_.join();
+    if (storage_)
+        storage_->flush();
+    // Only now are the last saves, and any links a write-behind queue made for them, counted.
+    if (dedup_) {
+        auto dedup_stats = dedup_->stats();
+        Logger::info("Content dedup: " + std::to_string(dedup_stats.duplicates) + " of "
+                     + std::to_string(dedup_stats.saved + dedup_stats.duplicates)
+                     + " bodies stored as links, " + std::to_string(dedup_stats.bytes_saved)
+                     + " bytes not written");
+    }
 
     if (render_js_)
         BrowserLauncher::cleanup();
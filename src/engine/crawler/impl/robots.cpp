@@ -1,4 +1,3 @@
-#include <boost/asio/steady_timer.hpp>
 #include "../../../core/logger/logger.hpp"
 #include "../crawler.hpp"
 
@@ -6,8 +5,7 @@ namespace Mojo {
 namespace Engine {
 
 namespace {
-constexpr int    POLITENESS_BUFFER_MS = 100;
-constexpr double MIN_DELAY            = 0.0;
+constexpr double MIN_DELAY = 0.0;
 }  // namespace
 
 std::shared_ptr<RobotsTxt> Crawler::get_cached_robots(const std::string& domain) {
@@ -47,6 +45,14 @@ boost::asio::awaitable<bool> Crawler::ensure_robots_txt(const Mojo::Utils::UrlPa
         co_return true;
     auto robots = co_await fetch_robots_txt(get_robots_url(parsed), client);
     cache_robots(parsed.host, robots);
+
+    // Crawl-delay goes straight into the frontier's per-host schedule.
+    double delay = robots->get_crawl_delay(user_agent_);
+    if (delay > MIN_DELAY) {
+        Logger::info("Politeness: " + parsed.host + " crawl-delay " + std::to_string(delay) + "s");
+        frontier_.set_host_delay(parsed.host,
+                                 std::chrono::milliseconds(static_cast<long long>(delay * 1000)));
+    }
     co_return true;
 }
 
@@ -65,46 +71,5 @@ boost::asio::awaitable<bool> Crawler::is_url_allowed(const std::string& url, Htt
     co_return true;
 }
 
-boost::asio::awaitable<bool> Crawler::check_politeness_and_wait(const std::string& host) {
-    return wait_for_politeness(host);
-}
-
-boost::asio::awaitable<bool> Crawler::wait_for_politeness(const std::string& domain) {
-    auto   robots = get_cached_robots(domain);
-    double delay  = robots ? robots->get_crawl_delay(user_agent_) : MIN_DELAY;
-    if (delay <= MIN_DELAY)
-        co_return true;
-
-    std::chrono::milliseconds delay_ms(static_cast<long long>(delay * 1000));
-    std::chrono::milliseconds wait_time(0);
-
-    {
-        std::lock_guard<std::mutex> lock(domain_mutex_);
-        auto                        it  = domain_last_access_.find(domain);
-        auto                        now = std::chrono::steady_clock::now();
-
-        if (it != domain_last_access_.end()) {
-            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - it->second);
-            if (elapsed < delay_ms)
-                wait_time = delay_ms - elapsed;
-        }
-
-        if (wait_time > std::chrono::milliseconds(POLITENESS_BUFFER_MS))
-            co_return false;
-
-        domain_last_access_[domain] = now + wait_time;
-    }
-
-    if (wait_time.count() > 0) {
-        Logger::info("Politeness: Waiting " + std::to_string(wait_time.count()) + "ms for "
-                     + domain);
-        boost::asio::steady_timer timer(ioc_);
-        timer.expires_after(wait_time);
-        co_await timer.async_wait(boost::asio::use_awaitable);
-    }
-
-    co_return true;
-}
-
 }  // namespace Engine
 }  // namespace Mojo
@@ -18,19 +18,24 @@ std::string Crawler::get_save_filename(const std::string& url, const std::string
     return filename;
 }
 
-void Crawler::save_to_storage(const std::string& filename,
-                              const std::string& content,
-                              bool               is_binary) {
-    if (storage_) {
+void Crawler::save_to_storage(const std::string&                filename,
+                              const std::string&                content,
+                              bool                              is_binary,
+                              const Mojo::Storage::FetchRecord* fetch) {
+    if (!storage_)
+        return;
+    if (fetch)
+        storage_->save_page(filename, content, is_binary, *fetch);
+    else
         storage_->save(filename, content, is_binary);
-    }
 }
 
-void Crawler::handle_binary_content(const std::string& url,
-                                    const std::string& content,
-                                    const std::string& ext) {
-    boost::asio::post(worker_pool_, [this, url, content, ext]() {
-        save_to_storage(get_save_filename(url, ext), content, true);
+void Crawler::handle_binary_content(const std::string& url, const std::string& ext, Response res) {
+    auto fetched = std::chrono::system_clock::now();
+    boost::asio::post(worker_pool_, [this, url, ext, fetched, res = std::move(res)]() {
+        Mojo::Storage::FetchRecord fetch{
+            url, res.status_code, res.content_type, fetched, res.body, {}};
+        save_to_storage(get_save_filename(url, ext), res.body, true, &fetch);
     });
 }
 
@@ -6,6 +6,9 @@
 #include "../../../core/logger/logger.hpp"
 #include "../../../core/types/constants.hpp"
 #include "../../../network/http/beast_client.hpp"
+#ifdef MOJO_HAVE_NGHTTP2
+#include "../../../network/http/h2_client.hpp"
+#endif
 #include "../../../utils/text/converter.hpp"
 #include "../../../utils/url/url.hpp"
 #include "../crawler.hpp"
@@ -18,93 +21,84 @@ using namespace Mojo::Network::Http;
 using namespace Mojo::Browser;
 using namespace Mojo::Utils::Text;
 
-namespace {
-constexpr int WORKER_POLL_INTERVAL_MS = 50;
-constexpr int REQUEUE_DELAY_MS        = 1000;
-}  // namespace
+void Crawler::add_url(std::string url, int depth, double priority) {
+    if (admit(url, depth))
+        frontier_.push(std::move(url), depth, priority);
+}
 
-void Crawler::add_url(std::string url, int depth) {
+bool Crawler::admit(const std::string& url, int depth) {
     if (depth > max_depth_)
-        return;
+        return false;
 
     if (!start_domain_.empty()) {
         auto parsed = Mojo::Utils::Url::parse(url);
         if (parsed.host != start_domain_) {
-            return;
+            return false;
         }
     }
 
-    {
-        std::lock_guard<std::mutex> lock(queue_mutex_);
-        if (visited_filter_.contains(url))
-            return;
-        visited_filter_.add(url);
-        frontier_.push({std::move(url), depth});
-    }
+    if (!visited_->test_and_add(url))
+        return false;
+    if (visited_count_.fetch_add(1, std::memory_order_relaxed) % Constants::VISITED_STATS_INTERVAL
+        == Constants::VISITED_STATS_INTERVAL - 1)
+        log_visited_stats();
+    return true;
+}
+
+void Crawler::log_visited_stats() {
+    auto stats = visited_->stats();
+    Logger::info("Visited set: " + std::to_string(stats.items) + " URLs, "
+                 + std::to_string(stats.memory_bytes / 1024) + " KiB in "
+                 + std::to_string(stats.stages) + " stage(s), "
+                 + std::to_string(static_cast<int>(stats.fill_ratio * 100)) + "% full, est. "
+                 + std::to_string(stats.false_positive_rate * 100) + "% false positives");
 }
 
 std::unique_ptr<HttpClient> Crawler::create_client() {
     if (render_js_) {
         return std::make_unique<BrowserClient>(ioc_);
     }
+#ifdef MOJO_HAVE_NGHTTP2
+    if (http2_) {
+        auto client = std::make_unique<H2Client>(ioc_);
+        client->set_connect_timeout(std::chrono::milliseconds(proxy_connect_timeout_));
+        client->set_max_body_size(max_body_size_);
+        return client;
+    }
+#endif
     auto client = std::make_unique<BeastClient>(ioc_);
     client->set_connect_timeout(std::chrono::milliseconds(proxy_connect_timeout_));
+    client->set_max_body_size(max_body_size_);
     return client;
 }
 
-std::optional<std::pair<std::string, int>> Crawler::fetch_next_task() {
-    std::lock_guard<std::mutex> lock(queue_mutex_);
-    if (frontier_.empty())
-        return std::nullopt;
-
-    auto task = std::move(frontier_.front());
-    frontier_.pop();
-    active_workers_++;
-    return task;
-}
-
-bool Crawler::should_stop_worker() {
-    std::lock_guard<std::mutex> lock(queue_mutex_);
-    return done_ || (active_workers_ == 0 && pending_content_tasks_ == 0 && frontier_.empty());
-}
-
-struct WorkerGuard {
-    std::atomic<int>& count;
-    explicit WorkerGuard(std::atomic<int>& c) : count(c) {
+struct TaskGuard {
+    Frontier& frontier;
+    explicit TaskGuard(Frontier& f) : frontier(f) {
     }
-    ~WorkerGuard() {
-        count--;
+    ~TaskGuard() {
+        frontier.task_done();
     }
 };
 
 boost::asio::awaitable<void> Crawler::worker_loop() {
     try {
-        auto                      client = create_client();
-        boost::asio::steady_timer timer(ioc_);
+        auto client = create_client();
 
         while (!done_) {
-            auto task_opt = fetch_next_task();
-
-            if (!task_opt) {
-                if (should_stop_worker()) {
-                    if (!done_.exchange(true)) {
-                        trigger_done();
-                    }
-                    co_return;
-                }
-                timer.expires_after(std::chrono::milliseconds(WORKER_POLL_INTERVAL_MS));
-                boost::system::error_code ec;
-                co_await                  timer.async_wait(
-                    boost::asio::redirect_error(boost::asio::use_awaitable, ec));
-                if (done_) {
-                    co_return;
+            // Parks until a URL is pushed; nullopt means the crawl is quiescent or stopping.
+            auto task = co_await frontier_.pop();
+            if (!task) {
+                if (!done_.exchange(true)) {
+                    trigger_done();
                 }
-                continue;
+                co_return;
             }
 
             {
-                WorkerGuard guard(active_workers_);
-                co_await    process_url_task(*client, task_opt->first, task_opt->second);
+                TaskGuard guard(frontier_);
+                co_await  process_url_task(
+                    *client, std::move(task->url), task->depth, task->priority);
             }
         }
     } catch (const std::exception& e) {
@@ -115,30 +109,17 @@ boost::asio::awaitable<void> Crawler::worker_loop() {
 }
 
 boost::asio::awaitable<void>
-Crawler::process_url_task(HttpClient& client, std::string url, int depth) {
+Crawler::process_url_task(HttpClient& client, std::string url, int depth, double priority) {
+    // Politeness is enforced by the frontier, which only hands out URLs of ready hosts.
     if (!co_await is_url_allowed(url, client))
         co_return;
 
-    auto parsed = Mojo::Utils::Url::parse(url);
-    if (!parsed.host.empty()) {
-        if (!co_await check_politeness_and_wait(parsed.host)) {
-            boost::asio::steady_timer timer(ioc_);
-            timer.expires_after(std::chrono::milliseconds(REQUEUE_DELAY_MS));
-            co_await timer.async_wait(boost::asio::use_awaitable);
-
-            std::lock_guard<std::mutex> lock(queue_mutex_);
-            frontier_.push({url, depth});
-            co_return;
-        }
-    }
-
     if (co_await fetch_page(client, url, depth))
         co_return;
 
     if (use_proxies_ && !proxy_pool_.empty()) {
         Logger::warn("Re-queueing (Rotation): " + url);
-        std::lock_guard<std::mutex> lock(queue_mutex_);
-        frontier_.push({std::move(url), depth});
+        frontier_.push(std::move(url), depth, priority);
     } else {
         Logger::error("Giving up: " + url);
     }
@@ -164,9 +145,11 @@ Crawler::fetch_page(HttpClient& client, const std::string& url, int depth) {
         Logger::info(log_msg);
 
         Response res = co_await client.get(url);
+        wire_bytes_ += res.wire_bytes;
+        decoded_bytes_ += res.decoded_bytes;
 
         if (res.skipped || res.error_type == ErrorType::Skipped) {
-            Logger::info("Skipped (Type): " + url);
+            Logger::info("Skipped (Type): " + url + (res.error.empty() ? "" : " - " + res.error));
             co_return true;
         }
 
@@ -211,43 +194,102 @@ void Crawler::process_successful_response(const std::string& url,
     std::string base_url = !res.effective_url.empty() ? res.effective_url : url;
     std::string ext      = Mojo::Core::get_file_extension(res.content_type, base_url);
 
+    if (res.truncated) {
+        // A cut-off document is useless, but the head of a huge page still has text and links.
+        if (!ext.empty()) {
+            Logger::warn("Truncated at " + std::to_string(res.wire_bytes) + " bytes, not saved: "
+                         + url);
+            return;
+        }
+        Logger::warn("Truncated at " + std::to_string(res.wire_bytes) + " bytes: " + url);
+    }
+
     if (!ext.empty()) {
-        handle_binary_content(base_url, res.body, ext);
+        handle_binary_content(base_url, ext, std::move(res));
     }
     else {
-        handle_text_content(base_url, depth, std::move(res));
+        handle_text_content(url, base_url, depth, std::move(res));
     }
 }
 
-void Crawler::handle_text_content(const std::string& url, int depth, Response res) {
-    pending_content_tasks_++;
-    boost::asio::post(worker_pool_, [this, url, content = std::move(res.body), depth]() {
+void Crawler::handle_text_content(const std::string& url,
+                                  const std::string& base_url,
+                                  int                depth,
+                                  Response           res) {
+    // Links found while converting still feed the frontier, so the crawl is not idle yet.
+    frontier_.hold();
+    auto fetched = std::chrono::system_clock::now();
+    boost::asio::post(worker_pool_, [this, url, base_url, depth, fetched, res = std::move(res)]() {
         try {
-            std::string markdown = Converter::to_markdown(content);
-            save_to_storage(get_save_filename(url), markdown);
+            // One pass yields both; links are skipped when the page is at the depth limit.
+            ProcessedPage page = Converter::process(
+                res.body, depth < max_depth_, html_parser_.get(), readability_.get());
+            if (boilerplate_) {
+                page.markdown =
+                    boilerplate_->filter(Mojo::Utils::Url::parse(url).host, page.markdown);
+            }
+            // Checked after boilerplate removal, so shared site chrome does not make
+            // unrelated pages of one host look alike.
+            std::optional<NearDuplicate> original;
+            if (near_duplicates_)
+                original = near_duplicates_->find_or_add(page.markdown, url);
+            std::string title;
+            if (storage_ && storage_->wants_title())
+                title = Converter::extract_title(res.body);
+            Mojo::Storage::FetchRecord fetch{
+                base_url, res.status_code, res.content_type, fetched, res.body, title};
+            if (!original) {
+                save_to_storage(get_save_filename(base_url), page.markdown, false, &fetch);
+            }
+            else if (!skip_near_duplicates_) {
+                save_to_storage(get_save_filename(base_url),
+                                "<!-- near-duplicate-of: " + original->url + " -->\n\n"
+                                    + page.markdown,
+                                false,
+                                &fetch);
+            }
+            else {
+                Logger::info("Near-duplicate of " + original->url + ", not saved: " + url);
+            }
 
-            if (depth < max_depth_) {
-                parse_and_extract_links(url, content, depth);
+            if (depth < max_depth_ && (!original || follow_duplicate_links_)) {
+                enqueue_links(url, base_url, std::move(page.links), depth);
             }
         } catch (const std::exception& e) {
-            Logger::error("Content processing failed for " + url + ": " + std::string(e.what()));
+            Logger::error("Content processing failed for " + base_url + ": "
+                          + std::string(e.what()));
         } catch (...) {
-            Logger::error("Content processing unknown error for " + url
+            Logger::error("Content processing unknown error for " + base_url
                           + " - possible memory corruption");
         }
-        pending_content_tasks_--;
+        frontier_.release();
     });
 }
 
-void Crawler::parse_and_extract_links(const std::string& base_url,
-                                      const std::string& html,
-                                      int                depth) {
-    std::vector<std::string> links = Converter::extract_links(html);
-    for (const auto& link : links) {
-        std::string absolute_link = Mojo::Utils::Url::resolve(base_url, link);
-        if (absolute_link.empty())
-            continue;
-        add_url(std::move(absolute_link), depth + 1);
+void Crawler::enqueue_links(const std::string& url,
+                            const std::string& base_url,
+                            std::vector<Link>  links,
+                            int                depth) {
+    // Canonicalized once, here, so the scorer, the visited set and the frontier all key on
+    // the same spelling of each URL.
+    for (auto& link : links) {
+        link.href = Mojo::Utils::Url::resolve(base_url, link.href);
+        if (canonicalizer_ && !link.href.empty())
+            link.href = canonicalizer_->canonicalize(link.href);
+    }
+    std::erase_if(links, [](const Link& link) { return link.href.empty(); });
+
+    std::vector<bool> queued(links.size());
+    for (size_t i = 0; i < links.size(); ++i)
+        queued[i] = admit(links[i].href, depth + 1);
+
+    // Every link is scored, so the scorer sees the page's full out-degree. The page is
+    // identified by the URL it was queued under, which is what its score was keyed on.
+    std::vector<double> priorities = scorer_ ? scorer_->score(url, depth, links, queued)
+                                             : std::vector<double>(links.size(), 0.0);
+    for (size_t i = 0; i < links.size(); ++i) {
+        if (queued[i])
+            frontier_.push(std::move(links[i].href), depth + 1, priorities[i]);
     }
 }
 
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+namespace Mojo {
+namespace Engine {
+
+struct CrawlTask {
+    std::string                           url;
+    std::string                           host;
+    int                                   depth    = 0;
+    double                                priority = 0.0;  // Higher is dispatched sooner
+    std::chrono::steady_clock::time_point enqueued{};
+};
+
+}  // namespace Engine
+}  // namespace Mojo
@@ -0,0 +1,373 @@
+#include "frontier.hpp"
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "../../utils/url/url.hpp"
+
+namespace Mojo {
+namespace Engine {
+
+namespace net = boost::asio;
+
+Frontier::Frontier(net::io_context& ioc) : timer_(ioc) {
+}
+
+bool Frontier::TaskOrder::operator()(const QueuedTask& a, const QueuedTask& b) const {
+    if (a.task.priority != b.task.priority)
+        return a.task.priority < b.task.priority;
+    return a.seq > b.seq;
+}
+
+bool Frontier::HostOrder::operator()(const EligibleHost& a, const EligibleHost& b) const {
+    if (a.priority != b.priority)
+        return a.priority < b.priority;
+    return a.since > b.since;
+}
+
+void Frontier::push(std::string url, int depth, double priority) {
+    std::string host = Mojo::Utils::Url::parse(url).host;
+    CrawlTask   task{std::move(url), std::move(host), depth, priority, Clock::now()};
+
+    std::vector<Handoff> handoffs;
+    bool                 spill = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_)
+            return;
+        stats_.pushed++;
+        queued_++;
+        // Over budget, or behind earlier overflow: spill so URLs come back in order.
+        spill = spill_ && (spilling_ > 0 || !spill_->empty() || queued_ - 1 >= max_in_memory_);
+        if (spill) {
+            spilling_++;
+        }
+        else {
+            enqueue_locked(std::move(task));
+            handoffs = dispatch_locked();
+        }
+    }
+    if (spill) {
+        // Compressing and writing a full segment happens here, without the frontier lock.
+        // Then dispatch again: the head may have drained while the task was in transit.
+        spill_->push(std::move(task));
+        std::lock_guard<std::mutex> lock(mutex_);
+        spilling_--;
+        handoffs = dispatch_locked();
+    }
+    deliver(handoffs);
+}
+
+void Frontier::enable_spill(std::filesystem::path dir,
+                            size_t                max_in_memory,
+                            size_t                segment_size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (spill_)
+        return;
+    spill_         = std::make_unique<SpillQueue>(std::move(dir), segment_size);
+    max_in_memory_ = max_in_memory;
+}
+
+void Frontier::set_host_delay(const std::string& host, std::chrono::milliseconds delay) {
+    std::vector<Handoff> handoffs;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& queue = hosts_[host];
+        if (queue.delay == delay)
+            return;
+        queue.delay = delay;
+        // Re-key a waiting host; the stale heap entry is skipped when it surfaces.
+        if (!queue.tasks.empty())
+            schedule_locked(host, queue);
+        handoffs = dispatch_locked();
+    }
+    deliver(handoffs);
+}
+
+net::awaitable<std::optional<CrawlTask>> Frontier::pop() {
+    std::vector<Waiter> woken;
+    bool                finished = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto                        now = Clock::now();
+        if (ready_locked(now))
+            co_return take_locked(now);
+        if (closed_)
+            co_return std::nullopt;
+        woken    = close_if_quiescent_locked();
+        finished = closed_;
+    }
+    if (finished) {
+        for (auto& waiter : woken)
+            waiter(std::nullopt);
+        co_return std::nullopt;
+    }
+
+    auto executor = co_await net::this_coro::executor;
+
+    // Same pattern as DnsCache: arguments go through async_initiate, not lambda captures,
+    // to stay clear of the GCC coroutine capture bug.
+    co_return co_await net::async_initiate<decltype(net::use_awaitable),
+                                           void(std::optional<CrawlTask>)>(
+        [this](auto handler, auto executor) { start_pop(std::move(handler), executor); },
+        net::use_awaitable,
+        executor);
+}
+
+template <typename Handler, typename Executor>
+void Frontier::start_pop(Handler handler, const Executor& executor) {
+    auto   shared = std::make_shared<Handler>(std::move(handler));
+    Waiter waiter = [shared, executor](std::optional<CrawlTask> task) {
+        auto ex = net::get_associated_executor(*shared, executor);
+        net::post(ex, [shared, task = std::move(task)]() mutable { (*shared)(std::move(task)); });
+    };
+
+    std::optional<CrawlTask> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto                        now = Clock::now();
+        // Re-check under the lock: a push or close may have landed since pop() looked.
+        if (ready_locked(now)) {
+            ready = take_locked(now);
+        }
+        else if (!closed_) {
+            waiters_.push_back(std::move(waiter));
+            arm_timer_locked();
+            return;
+        }
+    }
+    waiter(std::move(ready));
+}
+
+void Frontier::task_done() {
+    release();
+}
+
+void Frontier::hold() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    outstanding_++;
+}
+
+void Frontier::release() {
+    std::vector<Waiter> woken;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (outstanding_ > 0)
+            outstanding_--;
+        woken = close_if_quiescent_locked();
+    }
+    for (auto& waiter : woken)
+        waiter(std::nullopt);
+}
+
+void Frontier::close() {
+    std::deque<Waiter> woken;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        woken.swap(waiters_);
+        timer_.cancel();
+        timer_deadline_ = Clock::time_point::max();
+    }
+    for (auto& waiter : woken)
+        waiter(std::nullopt);
+}
+
+void Frontier::reopen() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = false;
+}
+
+bool Frontier::closed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return closed_;
+}
+
+size_t Frontier::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queued_;
+}
+
+FrontierStats Frontier::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    FrontierStats s = stats_;
+    s.queued        = queued_;
+    s.waiting       = waiters_.size();
+    s.hosts         = std::count_if(
+        hosts_.begin(), hosts_.end(), [](const auto& h) { return !h.second.tasks.empty(); });
+    if (spill_) {
+        auto spill       = spill_->stats();
+        s.spilled        = spill_->size();
+        s.spill_segments = spill.segments_written;
+        s.spill_bytes    = spill.bytes_written;
+    }
+    return s;
+}
+
+void Frontier::enqueue_locked(CrawlTask task) {
+    std::string name     = task.host;
+    double      priority = task.priority;
+    auto&       queue    = hosts_[name];
+    bool        first    = queue.tasks.empty();
+    double      best     = first ? 0.0 : queue.tasks.front().task.priority;
+    queue.tasks.push_back({std::move(task), next_seq_++});
+    std::push_heap(queue.tasks.begin(), queue.tasks.end(), TaskOrder{});
+    if (first) {
+        schedule_locked(name, queue);
+    }
+    else if (queue.eligible && priority > best) {
+        // A better URL for a host that is already fetchable: re-key it in place.
+        eligible_.push({priority, queue.scheduled, queue.epoch, name});
+    }
+}
+
+void Frontier::refill_locked() {
+    // Read spilled segments back once the head has drained to half its budget.
+    while (spill_ && !spill_->empty() && queued_ - spill_->size() <= max_in_memory_ / 2) {
+        // A segment that could not be read is gone; stop counting its URLs as queued.
+        // Pushes spill without the frontier lock, so only the queue itself can say how many.
+        size_t dropped = 0;
+        auto   tasks   = spill_->pop_segment(&dropped);
+        queued_ -= dropped;
+        for (auto& task : tasks)
+            enqueue_locked(std::move(task));
+    }
+}
+
+void Frontier::schedule_locked(const std::string& host, HostQueue& queue) {
+    queue.eligible  = false;
+    queue.scheduled = queue.last_fetch + queue.delay;
+    ready_.emplace(queue.scheduled, host);
+}
+
+void Frontier::make_eligible_locked(const std::string& host, HostQueue& queue) {
+    queue.eligible = true;
+    queue.epoch++;
+    eligible_.push({queue.tasks.front().task.priority, queue.scheduled, queue.epoch, host});
+}
+
+void Frontier::prune_waiting_locked() {
+    // Drop entries superseded by a re-key or left behind by a drained or promoted host.
+    while (!ready_.empty()) {
+        const auto& [when, host] = ready_.top();
+        auto it                  = hosts_.find(host);
+        if (it != hosts_.end() && !it->second.tasks.empty() && !it->second.eligible
+            && it->second.scheduled == when)
+            break;
+        ready_.pop();
+    }
+}
+
+bool Frontier::ready_locked(Clock::time_point now) {
+    refill_locked();
+    // Promote every host whose next allowed fetch time has passed.
+    prune_waiting_locked();
+    while (!ready_.empty() && ready_.top().first <= now) {
+        std::string host = ready_.top().second;
+        ready_.pop();
+        make_eligible_locked(host, hosts_[host]);
+        prune_waiting_locked();
+    }
+
+    while (!eligible_.empty()) {
+        const auto& top = eligible_.top();
+        auto        it  = hosts_.find(top.host);
+        if (it != hosts_.end() && it->second.eligible && it->second.epoch == top.epoch
+            && it->second.tasks.front().task.priority == top.priority)
+            break;
+        eligible_.pop();
+    }
+    return !eligible_.empty();
+}
+
+CrawlTask Frontier::take_locked(Clock::time_point now) {
+    std::string host = eligible_.top().host;
+    eligible_.pop();
+
+    auto& queue = hosts_[host];
+    std::pop_heap(queue.tasks.begin(), queue.tasks.end(), TaskOrder{});
+    CrawlTask task = std::move(queue.tasks.back().task);
+    queue.tasks.pop_back();
+    queued_--;
+    queue.last_fetch = now;
+    if (!queue.tasks.empty())
+        schedule_locked(host, queue);
+    else if (queue.delay.count() == 0)
+        hosts_.erase(host);
+    else
+        queue.eligible = false;
+
+    outstanding_++;
+    record_dispatch_locked(task, now);
+    return task;
+}
+
+std::vector<Frontier::Handoff> Frontier::dispatch_locked() {
+    std::vector<Handoff> handoffs;
+    auto                 now = Clock::now();
+    while (!waiters_.empty() && ready_locked(now)) {
+        Waiter waiter = std::move(waiters_.front());
+        waiters_.pop_front();
+        handoffs.emplace_back(std::move(waiter), take_locked(now));
+        stats_.handoffs++;
+    }
+    if (!waiters_.empty())
+        arm_timer_locked();
+    return handoffs;
+}
+
+void Frontier::arm_timer_locked() {
+    // Only hosts still serving out a delay need a wake-up; eligible ones are dispatched now.
+    if (ready_locked(Clock::now()) || ready_.empty() || closed_)
+        return;
+    auto deadline = ready_.top().first;
+    if (deadline >= timer_deadline_)
+        return;
+    timer_deadline_ = deadline;
+    timer_.expires_at(deadline);
+    timer_.async_wait([this](const boost::system::error_code& ec) { on_timer(ec); });
+}
+
+void Frontier::on_timer(const boost::system::error_code& ec) {
+    if (ec == net::error::operation_aborted)
+        return;
+    std::vector<Handoff> handoffs;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        timer_deadline_ = Clock::time_point::max();
+        if (closed_)
+            return;
+        handoffs = dispatch_locked();
+    }
+    deliver(handoffs);
+}
+
+void Frontier::deliver(std::vector<Handoff>& handoffs) {
+    for (auto& [waiter, task] : handoffs)
+        waiter(std::move(task));
+}
+
+void Frontier::record_dispatch_locked(const CrawlTask& task, Clock::time_point now) {
+    auto waited = std::chrono::duration_cast<std::chrono::microseconds>(now - task.enqueued);
+    auto us     = static_cast<uint64_t>(std::max<int64_t>(waited.count(), 0));
+    stats_.dispatched++;
+    stats_.total_dispatch_us += us;
+    stats_.max_dispatch_us = std::max(stats_.max_dispatch_us, us);
+}
+
+std::vector<Frontier::Waiter> Frontier::close_if_quiescent_locked() {
+    std::vector<Waiter> woken;
+    if (closed_ || queued_ > 0 || outstanding_ > 0)
+        return woken;
+    // Nothing queued and nothing in flight that could still discover links: done.
+    closed_ = true;
+    for (auto& waiter : waiters_)
+        woken.push_back(std::move(waiter));
+    waiters_.clear();
+    timer_.cancel();
+    timer_deadline_ = Clock::time_point::max();
+    return woken;
+}
+
+}  // namespace Engine
+}  // namespace Mojo
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <boost/asio.hpp>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "crawl_task.hpp"
+#include "spill_queue.hpp"
+
+namespace Mojo {
+namespace Engine {
+
+struct FrontierStats {
+    uint64_t pushed            = 0;
+    uint64_t dispatched        = 0;
+    uint64_t handoffs          = 0;  // Pushes handed straight to a parked worker
+    uint64_t total_dispatch_us = 0;  // Sum of push-to-pop latencies
+    uint64_t max_dispatch_us   = 0;
+    size_t   queued            = 0;
+    size_t   waiting           = 0;  // Workers currently parked in pop()
+    size_t   hosts             = 0;  // Hosts with queued URLs
+    size_t   spilled           = 0;  // Queued URLs held in the spill queue, not the head
+    uint64_t spill_segments    = 0;  // Segments written to disk
+    uint64_t spill_bytes       = 0;  // Compressed bytes written to disk
+};
+
+/**
+ * @brief Awaitable URL frontier shared by all crawler workers.
+ *
+ * URLs are kept in per-host back-queues (Mercator style), each a max-heap on the task's
+ * priority with FIFO order among equal priorities. A min-heap orders the hosts that have
+ * work by the earliest time they may be fetched again; hosts whose time has come move to a
+ * second heap keyed by their best queued priority, so `pop()` hands out the most valuable
+ * URL among the hosts that are ready right now. Dispatching a URL pushes its host back by
+ * that host's crawl delay, so a slow or crawl-delayed host never holds a worker hostage
+ * while other hosts have work, and politeness always wins over priority.
+ *
+ * Workers `co_await pop()`; when nothing is ready they park instead of polling. Each
+ * `push()` of a ready host wakes exactly one parked worker, and a timer wakes one when
+ * the next delayed host becomes ready. The frontier also tracks outstanding
+ * work: a popped task counts until `task_done()`, and anything else that may still push
+ * URLs (content processing on the worker pool) brackets itself with `hold()`/`release()`.
+ * Once the queue is empty and nothing is outstanding the crawl is quiescent: the frontier
+ * closes and every pending and future `pop()` returns nullopt.
+ *
+ * With `enable_spill()` the host queues become a bounded in-memory head. Pushes beyond the
+ * budget, and every push after them, go to a SpillQueue that writes compressed segments to
+ * disk; segments are read back in order whenever the head drains to half its budget. URLs
+ * therefore reach the head in discovery order, and priorities only compete within it. The
+ * spill write runs outside the frontier lock, so pops are not held up by zlib or the disk.
+ */
+class Frontier {
+public:
+    explicit Frontier(boost::asio::io_context& ioc);
+
+    void push(std::string url, int depth, double priority = 0.0);
+
+    /// Minimum spacing between two dispatches to `host` (e.g. robots.txt Crawl-delay).
+    void set_host_delay(const std::string& host, std::chrono::milliseconds delay);
+
+    /// Keep at most `max_in_memory` URLs in the host queues, spilling the rest under `dir`.
+    void enable_spill(std::filesystem::path dir, size_t max_in_memory, size_t segment_size);
+
+    /**
+     * @brief Next task, waiting for one if necessary.
+     * @return nullopt once the frontier is closed, by `close()` or by quiescence.
+     */
+    boost::asio::awaitable<std::optional<CrawlTask>> pop();
+
+    void task_done();
+    void hold();
+    void release();
+    void close();
+    /// Accepts pushes again after a close, e.g. for the next start URL.
+    void reopen();
+
+    bool          closed() const;
+    size_t        size() const;
+    FrontierStats stats() const;
+
+private:
+    using Clock     = std::chrono::steady_clock;
+    using Waiter    = std::function<void(std::optional<CrawlTask>)>;
+    using Handoff   = std::pair<Waiter, CrawlTask>;
+    using ReadyTime = std::pair<Clock::time_point, std::string>;
+
+    struct QueuedTask {
+        CrawlTask task;
+        uint64_t  seq = 0;  // Push order, breaks priority ties FIFO
+    };
+
+    struct HostQueue {
+        std::vector<QueuedTask>   tasks;  // Heap, best task at front()
+        std::chrono::milliseconds delay{0};
+        Clock::time_point         last_fetch{};
+        Clock::time_point         scheduled{};  // Key of the host's live ready-time entry
+        bool                      eligible = false;  // Moved to eligible_, fetchable now
+        uint64_t                  epoch    = 0;      // Bumped on each move to eligible_
+    };
+
+    struct EligibleHost {
+        double            priority = 0.0;
+        Clock::time_point since{};
+        uint64_t          epoch = 0;
+        std::string       host;
+    };
+
+    struct TaskOrder {
+        bool operator()(const QueuedTask& a, const QueuedTask& b) const;
+    };
+    struct HostOrder {
+        bool operator()(const EligibleHost& a, const EligibleHost& b) const;
+    };
+
+    template <typename Handler, typename Executor>
+    void start_pop(Handler handler, const Executor& executor);
+
+    void                 enqueue_locked(CrawlTask task);
+    void                 refill_locked();
+    void                 schedule_locked(const std::string& host, HostQueue& queue);
+    void                 make_eligible_locked(const std::string& host, HostQueue& queue);
+    void                 prune_waiting_locked();
+    bool                 ready_locked(Clock::time_point now);
+    CrawlTask            take_locked(Clock::time_point now);
+    std::vector<Handoff> dispatch_locked();
+    void                 arm_timer_locked();
+    void                 on_timer(const boost::system::error_code& ec);
+    void                 record_dispatch_locked(const CrawlTask& task, Clock::time_point now);
+    std::vector<Waiter>  close_if_quiescent_locked();
+
+    static void deliver(std::vector<Handoff>& handoffs);
+
+    mutable std::mutex                         mutex_;
+    std::unordered_map<std::string, HostQueue> hosts_;
+    std::priority_queue<ReadyTime, std::vector<ReadyTime>, std::greater<>>  ready_;
+    std::priority_queue<EligibleHost, std::vector<EligibleHost>, HostOrder> eligible_;
+    std::deque<Waiter>                                                      waiters_;
+    boost::asio::steady_timer                                               timer_;
+    std::unique_ptr<SpillQueue>                                             spill_;
+    size_t            max_in_memory_  = 0;
+    Clock::time_point timer_deadline_ = Clock::time_point::max();
+    uint64_t          next_seq_       = 0;
+    size_t            queued_         = 0;
+    size_t            outstanding_    = 0;
+    size_t            spilling_       = 0;  // Pushes on their way into spill_, unlocked
+    bool              closed_         = false;
+    FrontierStats     stats_;
+};
+
+}  // namespace Engine
+}  // namespace Mojo
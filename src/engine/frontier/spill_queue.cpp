@@ -0,0 +1,229 @@
+#include "spill_queue.hpp"
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+#include <zlib.h>
+#include "../../binary/reader.hpp"
+#include "../../binary/writer.hpp"
+#include "../../core/logger/logger.hpp"
+
+namespace Mojo {
+namespace Engine {
+
+using Mojo::Core::Logger;
+
+namespace {
+
+constexpr uint32_t SEGMENT_MAGIC      = 0x5053'4A4D;  // "MJSP"
+constexpr size_t   SEGMENT_HEADER_LEN = 16;           // magic, count, raw size
+
+void write_task(Mojo::Binary::Writer& out, const CrawlTask& task) {
+    out.write_uint32_le(static_cast<uint32_t>(task.url.size()));
+    out.write_string(task.url);
+    out.write_uint32_le(static_cast<uint32_t>(task.host.size()));
+    out.write_string(task.host);
+    out.write_uint32_le(static_cast<uint32_t>(task.depth));
+    out.write(task.priority);
+    out.write_uint64_le(static_cast<uint64_t>(task.enqueued.time_since_epoch().count()));
+}
+
+CrawlTask read_task(Mojo::Binary::Reader& in) {
+    CrawlTask task;
+    task.url      = in.read_string(in.read_uint32_le());
+    task.host     = in.read_string(in.read_uint32_le());
+    task.depth    = static_cast<int>(in.read_uint32_le());
+    task.priority = in.read<double>();
+    task.enqueued = std::chrono::steady_clock::time_point(
+        std::chrono::steady_clock::duration(static_cast<int64_t>(in.read_uint64_le())));
+    return task;
+}
+
+}  // namespace
+
+SpillQueue::SpillQueue(std::filesystem::path dir, size_t segment_size)
+    : dir_(std::move(dir)),
+      segment_size_(segment_size > 0 ? segment_size : 1) {
+}
+
+SpillQueue::~SpillQueue() {
+    std::error_code ec;
+    for (const auto& segment : segments_)
+        std::filesystem::remove(segment.path, ec);
+    // Only removes the directory if nothing else lives there.
+    std::filesystem::remove(dir_, ec);
+}
+
+void SpillQueue::push(CrawlTask task) {
+    uint64_t                     id;
+    size_t                       count;
+    std::filesystem::path        path;
+    std::shared_ptr<const Bytes> raw;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tail_.push_back(std::move(task));
+        if (tail_.size() < segment_size_)
+            return;
+
+        // Serializing is a copy; zlib and the file write happen after the lock is released.
+        auto                 data = std::make_shared<Bytes>();
+        Mojo::Binary::Writer out(*data);
+        for (const auto& queued : tail_)
+            write_task(out, queued);
+
+        id    = next_id_++;
+        count = tail_.size();
+        path  = dir_ / ("segment-" + std::to_string(id) + ".bin.z");
+        segments_.push_back({id, path, count, data});
+        segmented_ += count;
+        tail_.clear();
+        raw = std::move(data);
+    }
+    write_segment(id, path, count, *raw);
+}
+
+std::vector<CrawlTask> SpillQueue::pop_segment(size_t* dropped) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<CrawlTask>      tasks;
+    size_t                      lost = 0;
+    while (!segments_.empty()) {
+        Segment segment = std::move(segments_.front());
+        segments_.pop_front();
+        segmented_ -= segment.count;
+
+        // Not written (yet): decode the bytes at hand. A writer still busy with it finds
+        // the segment gone and removes its file.
+        if (segment.raw) {
+            Mojo::Binary::Reader in(*segment.raw);
+            tasks.reserve(segment.count);
+            for (size_t i = 0; i < segment.count; ++i)
+                tasks.push_back(read_task(in));
+            stats_.segments_read++;
+            if (dropped)
+                *dropped = lost;
+            return tasks;
+        }
+
+        std::error_code ec;
+        try {
+            std::ifstream file(segment.path, std::ios::binary);
+            if (!file.is_open())
+                throw std::runtime_error("cannot open");
+            std::vector<uint8_t> raw((std::istreambuf_iterator<char>(file)),
+                                     std::istreambuf_iterator<char>());
+
+            Mojo::Binary::Reader header(raw);
+            if (raw.size() < SEGMENT_HEADER_LEN || header.read_uint32_le() != SEGMENT_MAGIC)
+                throw std::runtime_error("bad segment header");
+            uint32_t count    = header.read_uint32_le();
+            uLongf   raw_size = static_cast<uLongf>(header.read_uint64_le());
+
+            std::vector<uint8_t> data(raw_size);
+            if (uncompress(data.data(),
+                           &raw_size,
+                           raw.data() + SEGMENT_HEADER_LEN,
+                           static_cast<uLong>(raw.size() - SEGMENT_HEADER_LEN))
+                    != Z_OK
+                || raw_size != data.size())
+                throw std::runtime_error("corrupt segment");
+
+            Mojo::Binary::Reader in(data);
+            tasks.reserve(count);
+            for (uint32_t i = 0; i < count; ++i)
+                tasks.push_back(read_task(in));
+            std::filesystem::remove(segment.path, ec);
+            stats_.segments_read++;
+            if (segment.count > tasks.size())
+                lost += segment.count - tasks.size();
+            if (dropped)
+                *dropped = lost;
+            return tasks;
+        } catch (const std::exception& e) {
+            Logger::error("Frontier spill: dropping " + std::to_string(segment.count)
+                          + " URLs from " + segment.path.string() + ": " + e.what());
+            lost += segment.count;
+            tasks.clear();
+            std::filesystem::remove(segment.path, ec);
+        }
+    }
+
+    if (dropped)
+        *dropped = lost;
+    tasks.swap(tail_);
+    return tasks;
+}
+
+size_t SpillQueue::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return segmented_ + tail_.size();
+}
+
+bool SpillQueue::empty() const {
+    return size() == 0;
+}
+
+SpillStats SpillQueue::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void SpillQueue::write_segment(uint64_t                     id,
+                               const std::filesystem::path& path,
+                               size_t                       count,
+                               const Bytes&                 raw) {
+    size_t written = compress_to(path, count, raw);
+
+    std::error_code ec;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto                        it = segments_.begin();
+        while (it != segments_.end() && it->id != id)
+            ++it;
+        if (it == segments_.end()) {
+            // Popped from memory while it was being written.
+            std::filesystem::remove(path, ec);
+            return;
+        }
+        if (written > 0) {
+            it->raw.reset();
+            stats_.segments_written++;
+            stats_.bytes_written += written;
+            return;
+        }
+        stats_.write_errors++;
+    }
+    std::filesystem::remove(path, ec);
+    Logger::warn("Frontier spill: could not write " + path.string() + ", keeping URLs in memory");
+}
+
+size_t SpillQueue::compress_to(const std::filesystem::path& path, size_t count, const Bytes& raw) {
+    uLongf               compressed_size = compressBound(static_cast<uLong>(raw.size()));
+    std::vector<uint8_t> file_data;
+    Mojo::Binary::Writer header(file_data);
+    header.write_uint32_le(SEGMENT_MAGIC);
+    header.write_uint32_le(static_cast<uint32_t>(count));
+    header.write_uint64_le(raw.size());
+    file_data.resize(SEGMENT_HEADER_LEN + compressed_size);
+
+    // Spilling is about throughput, not ratio: URL lists still shrink several times at level 1.
+    if (compress2(file_data.data() + SEGMENT_HEADER_LEN,
+                  &compressed_size,
+                  raw.data(),
+                  static_cast<uLong>(raw.size()),
+                  Z_BEST_SPEED)
+        != Z_OK)
+        return 0;
+    file_data.resize(SEGMENT_HEADER_LEN + compressed_size);
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir_, ec);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(file_data.data()),
+               static_cast<std::streamsize>(file_data.size()));
+    file.close();
+    return file.good() ? file_data.size() : 0;
+}
+
+}  // namespace Engine
+}  // namespace Mojo
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "crawl_task.hpp"
+
+namespace Mojo {
+namespace Engine {
+
+struct SpillStats {
+    uint64_t segments_written = 0;
+    uint64_t segments_read    = 0;
+    uint64_t bytes_written    = 0;  // Compressed bytes on disk
+    uint64_t write_errors     = 0;
+};
+
+/**
+ * @brief FIFO overflow for the frontier, spilled to disk in compressed segments.
+ *
+ * Tasks are appended to an in-memory tail; once the tail holds `segment_size` tasks it is
+ * serialized, zlib-compressed and written as one immutable segment file under `dir`.
+ * `pop_segment()` hands segments back oldest first, then whatever is still in the tail, so
+ * tasks come out in the order they went in and memory stays bounded by about two segments.
+ *
+ * Thread-safe. The push that fills the tail serializes it under the lock, then compresses
+ * and writes the segment without holding it, so other pushes and the Frontier's own lock
+ * never wait on zlib or the disk. A segment popped before its write finishes is read back
+ * from memory. A segment that cannot be written stays in memory; one that cannot be read
+ * back is logged and dropped.
+ */
+class SpillQueue {
+public:
+    SpillQueue(std::filesystem::path dir, size_t segment_size);
+    ~SpillQueue();
+
+    SpillQueue(const SpillQueue&)            = delete;
+    SpillQueue& operator=(const SpillQueue&) = delete;
+
+    void push(CrawlTask task);
+
+    /**
+     * @brief The oldest segment, or the tail once no segment is left. `dropped`, when given,
+     * is set to the URLs lost on the way to it: segments that could not be read back are
+     * skipped, and their count is taken under the same lock that removed them.
+     */
+    std::vector<CrawlTask> pop_segment(size_t* dropped = nullptr);
+
+    size_t     size() const;
+    bool       empty() const;
+    SpillStats stats() const;
+
+private:
+    using Bytes = std::vector<uint8_t>;
+
+    struct Segment {
+        uint64_t                     id = 0;
+        std::filesystem::path        path;
+        size_t                       count = 0;
+        std::shared_ptr<const Bytes> raw;  // Serialized tasks, until the file is written
+    };
+
+    void   write_segment(uint64_t                     id,
+                         const std::filesystem::path& path,
+                         size_t                       count,
+                         const Bytes&                 raw);
+    size_t compress_to(const std::filesystem::path& path, size_t count, const Bytes& raw);
+
+    mutable std::mutex     mutex_;
+    std::filesystem::path  dir_;
+    size_t                 segment_size_;
+    std::deque<Segment>    segments_;
+    std::vector<CrawlTask> tail_;
+    size_t                 segmented_ = 0;  // Tasks held in segments_, on disk or not
+    uint64_t               next_id_   = 0;
+    SpillStats             stats_;
+};
+
+}  // namespace Engine
+}  // namespace Mojo
@@ -0,0 +1,255 @@
+#include "url_scorer.hpp"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <stdexcept>
+#include "../../utils/url/url.hpp"
+
+namespace Mojo {
+namespace Engine {
+
+using Mojo::Utils::Text::Link;
+
+namespace {
+
+constexpr double OPIC_SEED_CASH = 1.0;
+
+constexpr double DEPTH_PENALTY      = 0.5;
+constexpr double PAGINATION_PENALTY = 3.0;
+constexpr double LISTING_PENALTY    = 2.0;
+constexpr double UTILITY_PENALTY    = 4.0;
+constexpr double QUERY_PARAM_COST   = 0.5;
+constexpr double ARTICLE_BONUS      = 1.0;
+constexpr double NAV_ANCHOR_PENALTY = 2.0;
+constexpr double BARE_ANCHOR_COST   = 0.5;
+
+constexpr std::array<std::string_view, 8> LISTING_SEGMENTS = {
+    "/tag/", "/tags/", "/category/", "/categories/", "/archive", "/author/", "/label/", "/topic/"};
+
+constexpr std::array<std::string_view, 16> UTILITY_MARKERS = {"/search",
+                                                              "?s=",
+                                                              "&s=",
+                                                              "/login",
+                                                              "/signin",
+                                                              "/sign-in",
+                                                              "/register",
+                                                              "/signup",
+                                                              "/cart",
+                                                              "/account",
+                                                              "/feed",
+                                                              "/rss",
+                                                              "replytocom=",
+                                                              "/print",
+                                                              "share=",
+                                                              "/wp-admin"};
+
+constexpr std::array<std::string_view, 7> ARTICLE_SEGMENTS = {
+    "/article", "/post", "/blog/", "/docs/", "/doc/", "/guide", "/news/"};
+
+constexpr std::array<std::string_view, 12> NAV_ANCHORS = {"next",
+                                                          "prev",
+                                                          "previous",
+                                                          "older",
+                                                          "newer",
+                                                          "older posts",
+                                                          "newer posts",
+                                                          "next page",
+                                                          "previous page",
+                                                          "more",
+                                                          "load more",
+                                                          "top"};
+
+std::string lower(std::string_view s) {
+    std::string out(s);
+    for (char& c : out)
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return out;
+}
+
+bool contains_any(const std::string& haystack, const auto& needles) {
+    return std::any_of(needles.begin(), needles.end(), [&](std::string_view n) {
+        return haystack.find(n) != std::string::npos;
+    });
+}
+
+bool all_digits(std::string_view s) {
+    return !s.empty() && std::all_of(s.begin(), s.end(), [](unsigned char c) {
+        return std::isdigit(c);
+    });
+}
+
+/// "/page/3", "?page=3", "&p=3", "?offset=40" and friends.
+bool is_pagination(const std::string& path, const std::string& query) {
+    auto page = path.find("/page/");
+    if (page != std::string::npos) {
+        auto rest = std::string_view(path).substr(page + 6);
+        if (all_digits(rest.substr(0, rest.find('/'))))
+            return true;
+    }
+
+    size_t start = 0;
+    while (start < query.size()) {
+        size_t end = query.find('&', start);
+        if (end == std::string::npos)
+            end = query.size();
+        auto param = std::string_view(query).substr(start, end - start);
+        auto eq    = param.find('=');
+        if (eq != std::string_view::npos) {
+            auto key = param.substr(0, eq);
+            if ((key == "page" || key == "p" || key == "offset" || key == "start" || key == "pg")
+                && all_digits(param.substr(eq + 1)))
+                return true;
+        }
+        start = end + 1;
+    }
+    return false;
+}
+
+bool is_article_like(const std::string& path) {
+    if (contains_any(path, ARTICLE_SEGMENTS))
+        return true;
+
+    // Dated permalinks ("/2024/05/...") or a multi-word slug as the last segment.
+    std::string_view view(path);
+    for (size_t i = 0; i + 6 <= view.size(); ++i) {
+        if (view[i] == '/' && view[i + 5] == '/' && all_digits(view.substr(i + 1, 4)))
+            return true;
+    }
+    auto   slug    = view.substr(path.find_last_of('/', path.size() - 2) + 1);
+    size_t hyphens = std::count(slug.begin(), slug.end(), '-');
+    return hyphens >= 2;
+}
+
+double anchor_adjustment(const std::string& anchor_text) {
+    if (anchor_text.empty())
+        return -BARE_ANCHOR_COST;
+
+    std::string text = lower(anchor_text);
+    if (all_digits(text) || text.size() <= 2
+        || std::find(NAV_ANCHORS.begin(), NAV_ANCHORS.end(), text) != NAV_ANCHORS.end())
+        return -NAV_ANCHOR_PENALTY;
+
+    size_t words = 1 + std::count(text.begin(), text.end(), ' ');
+    if (words >= 6)
+        return 2.0;
+    if (words >= 3)
+        return 1.0;
+    return 0.0;
+}
+
+}  // namespace
+
+std::unique_ptr<UrlScorer> UrlScorer::create(const std::string& name) {
+    if (name.empty() || name == "fifo")
+        return nullptr;
+    if (name == "depth" || name == "bfs")
+        return std::make_unique<DepthScorer>();
+    if (name == "opic")
+        return std::make_unique<OpicScorer>();
+    if (name == "heuristic")
+        return std::make_unique<HeuristicScorer>();
+    throw std::invalid_argument("Unknown URL scorer: " + name);
+}
+
+std::string_view DepthScorer::name() const {
+    return "depth";
+}
+
+double DepthScorer::seed(const std::string&) {
+    return 0.0;
+}
+
+std::vector<double> DepthScorer::score(const std::string&,
+                                       int                      depth,
+                                       const std::vector<Link>& links,
+                                       const std::vector<bool>&) {
+    return std::vector<double>(links.size(), -static_cast<double>(depth + 1));
+}
+
+std::string_view OpicScorer::name() const {
+    return "opic";
+}
+
+double OpicScorer::seed(const std::string& url) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cash_[url] += OPIC_SEED_CASH;
+}
+
+std::vector<double> OpicScorer::score(const std::string&       page,
+                                      int                      /*depth*/,
+                                      const std::vector<Link>& links,
+                                      const std::vector<bool>& queued) {
+    std::vector<double>         priorities;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // The page spends its whole balance; fetched pages are not looked up again.
+    double balance = 0.0;
+    if (auto it = cash_.find(page); it != cash_.end()) {
+        balance = it->second;
+        cash_.erase(it);
+    }
+    if (links.empty())
+        return priorities;
+
+    // Newly queued links open a balance; links already waiting in the frontier add to theirs.
+    // Anything else will not be fetched (again), and its share is dropped.
+    double share = balance / static_cast<double>(links.size());
+    priorities.assign(links.size(), 0.0);
+    for (size_t i = 0; i < links.size(); ++i) {
+        auto it = queued[i] ? cash_.try_emplace(links[i].href, 0.0).first
+                            : cash_.find(links[i].href);
+        if (it != cash_.end())
+            priorities[i] = it->second += share;
+    }
+    return priorities;
+}
+
+double OpicScorer::cash(const std::string& url) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto                        it = cash_.find(url);
+    return it == cash_.end() ? 0.0 : it->second;
+}
+
+std::string_view HeuristicScorer::name() const {
+    return "heuristic";
+}
+
+double HeuristicScorer::seed(const std::string&) {
+    return 0.0;
+}
+
+std::vector<double> HeuristicScorer::score(const std::string&,
+                                           int                      depth,
+                                           const std::vector<Link>& links,
+                                           const std::vector<bool>&) {
+    std::vector<double> priorities;
+    priorities.reserve(links.size());
+    for (const auto& link : links)
+        priorities.push_back(score_link(link.href, link.text, depth + 1));
+    return priorities;
+}
+
+double HeuristicScorer::score_link(const std::string& url,
+                                   const std::string& anchor_text,
+                                   int                depth) {
+    auto        parsed = Mojo::Utils::Url::parse(url);
+    std::string path   = lower(parsed.path.empty() ? "/" : parsed.path);
+    std::string query  = lower(parsed.query);
+    std::string target = path + (query.empty() ? "" : "?" + query);
+
+    double score = -DEPTH_PENALTY * depth;
+    if (is_pagination(path, query))
+        score -= PAGINATION_PENALTY;
+    if (contains_any(target, LISTING_SEGMENTS))
+        score -= LISTING_PENALTY;
+    if (contains_any(target, UTILITY_MARKERS))
+        score -= UTILITY_PENALTY;
+    if (!query.empty())
+        score -= QUERY_PARAM_COST * (1 + std::count(query.begin(), query.end(), '&'));
+    if (is_article_like(path))
+        score += ARTICLE_BONUS;
+    return score + anchor_adjustment(anchor_text);
+}
+
+}  // namespace Engine
+}  // namespace Mojo
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "../../utils/text/converter.hpp"
+
+namespace Mojo {
+namespace Engine {
+
+/**
+ * @brief Assigns frontier priorities to discovered URLs; higher is fetched sooner.
+ *
+ * Scorers are called from the content worker pool, so implementations must be thread-safe.
+ * A page's links are scored as one batch, including the ones depth, domain or duplicate
+ * filtering keep out of the frontier, so a scorer sees the page's full out-degree.
+ */
+class UrlScorer {
+public:
+    virtual ~UrlScorer() = default;
+
+    virtual std::string_view name() const = 0;
+
+    /// Priority of a start URL.
+    virtual double seed(const std::string& url) = 0;
+
+    /**
+     * @brief Priorities of the links found on `page`, fetched at `depth`.
+     * @param links Anchors with `href` already resolved to an absolute URL.
+     * @param queued Per link, whether it is new and in scope and so enters the frontier.
+     * @return One priority per link, in the same order; only queued links' are used.
+     */
+    virtual std::vector<double> score(const std::string&                          page,
+                                      int                                         depth,
+                                      const std::vector<Mojo::Utils::Text::Link>& links,
+                                      const std::vector<bool>&                    queued) = 0;
+
+    /**
+     * @brief Scorer by name: "depth", "opic" or "heuristic".
+     * @return nullptr for "fifo" (plain discovery order), throws on an unknown name.
+     */
+    static std::unique_ptr<UrlScorer> create(const std::string& name);
+};
+
+/// Breadth-first: shallower pages first, discovery order within a level.
+class DepthScorer : public UrlScorer {
+public:
+    std::string_view    name() const override;
+    double              seed(const std::string& url) override;
+    std::vector<double> score(const std::string&                          page,
+                              int                                         depth,
+                              const std::vector<Mojo::Utils::Text::Link>& links,
+                              const std::vector<bool>&                    queued) override;
+};
+
+/**
+ * @brief On-line Page Importance Computation (Abiteboul et al.).
+ *
+ * Every seed starts with one unit of cash. When a page is processed its cash is split evenly
+ * over its out-links and credited to their targets, and its own balance is cleared. A URL's
+ * priority is the cash it holds when it is discovered, so pages linked from many important
+ * pages rise to the front. Cash credited after a URL was queued is not re-keyed in the
+ * frontier, but it is still passed on when that page is processed.
+ *
+ * Shares for links that are filtered out, or whose page was already processed, are dropped
+ * rather than credited, so balances are kept for queued URLs only (plus the few whose fetch
+ * failed) instead of for every href the crawl has ever seen.
+ */
+class OpicScorer : public UrlScorer {
+public:
+    std::string_view    name() const override;
+    double              seed(const std::string& url) override;
+    std::vector<double> score(const std::string&                          page,
+                              int                                         depth,
+                              const std::vector<Mojo::Utils::Text::Link>& links,
+                              const std::vector<bool>&                    queued) override;
+
+    double cash(const std::string& url) const;
+
+private:
+    mutable std::mutex                      mutex_;
+    std::unordered_map<std::string, double> cash_;
+};
+
+/**
+ * @brief Cheap content-likelihood guess from the URL and its anchor text.
+ *
+ * Penalises pagination, tag/category/archive listings, search, login and feed URLs and
+ * navigation anchors ("next", "2", "»"); rewards descriptive anchor text and article-like
+ * paths. Depth is a mild tie-breaker.
+ */
+class HeuristicScorer : public UrlScorer {
+public:
+    std::string_view    name() const override;
+    double              seed(const std::string& url) override;
+    std::vector<double> score(const std::string&                          page,
+                              int                                         depth,
+                              const std::vector<Mojo::Utils::Text::Link>& links,
+                              const std::vector<bool>&                    queued) override;
+
+    static double score_link(const std::string& url, const std::string& anchor_text, int depth);
+};
+
+}  // namespace Engine
+}  // namespace Mojo
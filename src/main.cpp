@@ -22,6 +22,34 @@ void run_crawler(const Mojo::Core::Config& config) {
         crawler_config.browser_path     = config.browser_path;
         crawler_config.headless         = config.headless;
         crawler_config.proxy_threads    = config.proxy_threads;
+        crawler_config.dns_cache_size   = config.dns_cache_size;
+        crawler_config.dns_ttl          = config.dns_ttl;
+        crawler_config.max_body_size    = config.max_body_size;
+        crawler_config.http2            = config.http2;
+        crawler_config.url_scorer       = config.url_scorer;
+        crawler_config.frontier_memory  = config.frontier_memory;
+        crawler_config.visited_mode     = config.visited_mode;
+        crawler_config.visited_fp_rate  = config.visited_fp_rate;
+        crawler_config.canonicalize     = config.canonicalize;
+        crawler_config.strip_params     = config.strip_params;
+        crawler_config.html_parser      = config.html_parser;
+        crawler_config.main_content     = config.main_content;
+        crawler_config.boilerplate      = config.boilerplate;
+
+        crawler_config.near_duplicates         = config.near_duplicates;
+        crawler_config.near_duplicate_distance = config.near_duplicate_distance;
+        crawler_config.follow_duplicate_links  = config.follow_duplicate_links;
+        crawler_config.dedup_content           = config.dedup_content;
+        crawler_config.storage                 = config.storage;
+        crawler_config.roll_size               = config.roll_size;
+        crawler_config.jsonl_shards            = config.jsonl_shards;
+        crawler_config.jsonl_zstd              = config.jsonl_zstd;
+        crawler_config.write_behind            = config.write_behind;
+        crawler_config.hash_dirs               = config.hash_dirs;
+        crawler_config.fsync                   = config.fsync;
+
+        crawler_config.max_connections_per_host = config.max_connections_per_host;
+        crawler_config.max_idle_per_host        = config.max_idle_per_host;
 
         crawler_config.proxy_bind_ip   = config.proxy_bind_ip;
         crawler_config.proxy_bind_port = config.proxy_bind_port;
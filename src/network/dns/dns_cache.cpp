@@ -0,0 +1,228 @@
+#include "dns_cache.hpp"
+#include <memory>
+
+namespace Mojo {
+namespace Network {
+namespace Dns {
+
+namespace net = boost::asio;
+using tcp     = net::ip::tcp;
+
+DnsCache& DnsCache::instance() {
+    static DnsCache instance;
+    return instance;
+}
+
+void DnsCache::configure(size_t               max_entries,
+                         std::chrono::seconds ttl,
+                         std::chrono::seconds negative_ttl) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_entries_  = max_entries;
+    ttl_          = ttl;
+    negative_ttl_ = negative_ttl;
+    while (entries_.size() > max_entries_) {
+        entries_.erase(lru_.back());
+        lru_.pop_back();
+        evictions_++;
+    }
+}
+
+net::awaitable<Endpoints> DnsCache::resolve(const std::string& host, const std::string& port) {
+    std::string key = host + ":" + port;
+
+    Endpoints                 cached;
+    boost::system::error_code cached_ec;
+    if (lookup(key, cached, cached_ec)) {
+        if (cached_ec)
+            throw boost::system::system_error(cached_ec);
+        co_return cached;
+    }
+
+    auto executor = co_await net::this_coro::executor;
+
+    // Arguments go through async_initiate rather than lambda captures: GCC <= 13 destroys
+    // captures of lambdas passed into coroutines twice (see MOJO_DISABLE_COROUTINES).
+    co_return co_await net::async_initiate<decltype(net::use_awaitable),
+                                           void(boost::system::error_code, Endpoints)>(
+        [this](auto handler, std::string key, std::string host, std::string port, auto executor) {
+            start_lookup(std::move(handler), key, host, port, executor);
+        },
+        net::use_awaitable,
+        std::move(key),
+        host,
+        port,
+        executor);
+}
+
+template <typename Handler, typename Executor>
+void DnsCache::start_lookup(Handler            handler,
+                            const std::string& key,
+                            const std::string& host,
+                            const std::string& port,
+                            const Executor&    executor) {
+    // Handlers are move-only; share them so they fit in a std::function and always
+    // complete on the waiter's own executor.
+    auto shared   = std::make_shared<Handler>(std::move(handler));
+    auto complete = [shared, executor](boost::system::error_code ec, Endpoints results) {
+        auto ex = net::get_associated_executor(*shared, executor);
+        net::post(ex, [shared, ec, results = std::move(results)]() mutable {
+            (*shared)(ec, std::move(results));
+        });
+    };
+    Waiter waiter{executor, std::move(complete)};
+
+    bool leader = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto&                       waiters = in_flight_[key];
+        leader                              = waiters.empty();
+        waiters.push_back(std::move(waiter));
+    }
+    if (!leader) {
+        coalesced_++;
+        return;
+    }
+
+    misses_++;
+    resolve_on(key, host, port, executor);
+}
+
+void DnsCache::resolve_on(const std::string&          key,
+                          const std::string&          host,
+                          const std::string&          port,
+                          const net::any_io_executor& executor) {
+    auto resolver = std::make_shared<tcp::resolver>(executor);
+    auto resolve  = std::make_shared<Resolve>(this, key, host, port, executor);
+    resolver->async_resolve(
+        host, port, [resolver, resolve](boost::system::error_code ec, Endpoints results) {
+            resolve->done = true;
+            resolve->cache->complete(resolve->key, ec, results);
+        });
+}
+
+void DnsCache::abandon(const std::string&          key,
+                       const std::string&          host,
+                       const std::string&          port,
+                       const net::any_io_executor& executor) {
+    // The resolve's io_context is shutting down, and with it every waiter that lives there.
+    auto& dead = net::query(executor, net::execution::context);
+
+    std::vector<Waiter>  dropped;
+    net::any_io_executor next;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto                        it = in_flight_.find(key);
+        if (it == in_flight_.end())
+            return;
+
+        std::vector<Waiter> alive;
+        for (auto& waiter : it->second) {
+            if (&net::query(waiter.executor, net::execution::context) == &dead)
+                dropped.push_back(std::move(waiter));
+            else
+                alive.push_back(std::move(waiter));
+        }
+        if (alive.empty()) {
+            in_flight_.erase(it);
+        }
+        else {
+            next       = alive.front().executor;
+            it->second = std::move(alive);
+        }
+    }
+    // Handlers of the dropped waiters are destroyed here, outside the lock.
+    dropped.clear();
+    if (next)
+        resolve_on(key, host, port, next);
+}
+
+bool DnsCache::lookup(const std::string&         key,
+                      Endpoints&                 endpoints,
+                      boost::system::error_code& ec) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto                        it = entries_.find(key);
+    if (it == entries_.end())
+        return false;
+
+    if (Clock::now() >= it->second.expires) {
+        lru_.erase(it->second.lru);
+        entries_.erase(it);
+        return false;
+    }
+
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+    endpoints = it->second.endpoints;
+    ec        = it->second.error;
+    if (ec)
+        negative_hits_++;
+    else
+        hits_++;
+    return true;
+}
+
+void DnsCache::complete(const std::string&        key,
+                        boost::system::error_code ec,
+                        const Endpoints&          endpoints) {
+    std::vector<Waiter> waiters;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // A cancelled lookup says nothing about the name, so it is not cached.
+        if (ec != net::error::operation_aborted)
+            store(key, ec, endpoints);
+        auto it = in_flight_.find(key);
+        if (it != in_flight_.end()) {
+            waiters = std::move(it->second);
+            in_flight_.erase(it);
+        }
+    }
+    for (auto& waiter : waiters)
+        waiter.complete(ec, endpoints);
+}
+
+void DnsCache::store(const std::string&        key,
+                     boost::system::error_code ec,
+                     const Endpoints&          endpoints) {
+    if (max_entries_ == 0)
+        return;
+
+    auto expires = Clock::now() + (ec ? negative_ttl_ : ttl_);
+    auto it      = entries_.find(key);
+    if (it != entries_.end()) {
+        it->second.endpoints = endpoints;
+        it->second.error     = ec;
+        it->second.expires   = expires;
+        lru_.splice(lru_.begin(), lru_, it->second.lru);
+        return;
+    }
+
+    if (entries_.size() >= max_entries_) {
+        entries_.erase(lru_.back());
+        lru_.pop_back();
+        evictions_++;
+    }
+    lru_.push_front(key);
+    entries_.emplace(key, Entry{endpoints, ec, expires, lru_.begin()});
+}
+
+DnsStats DnsCache::stats() const {
+    DnsStats s;
+    s.hits          = hits_.load();
+    s.misses        = misses_.load();
+    s.coalesced     = coalesced_.load();
+    s.negative_hits = negative_hits_.load();
+    s.evictions     = evictions_.load();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    s.entries = entries_.size();
+    return s;
+}
+
+void DnsCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    lru_.clear();
+}
+
+}  // namespace Dns
+}  // namespace Network
+}  // namespace Mojo
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <boost/asio.hpp>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../../core/types/constants.hpp"
+
+namespace Mojo {
+namespace Network {
+namespace Dns {
+
+using Endpoints = boost::asio::ip::tcp::resolver::results_type;
+
+struct DnsStats {
+    uint64_t hits          = 0;
+    uint64_t misses        = 0;
+    uint64_t coalesced     = 0;
+    uint64_t negative_hits = 0;
+    uint64_t evictions     = 0;
+    size_t   entries       = 0;
+};
+
+/**
+ * @brief Process-wide resolver cache shared by the HTTP client, CDP client and proxy gateway.
+ *
+ * Lookups are keyed by host and service. Concurrent misses for the same key are coalesced
+ * into a single `async_resolve` (single-flight) and every waiter is completed on its own
+ * executor. The resolve runs on the first waiter's executor; if that io_context is torn
+ * down before the answer arrives, its waiters are dropped with it and the lookup is
+ * restarted on the executor of the next waiter still alive. Failed lookups are cached for a
+ * shorter negative TTL so a dead host does not trigger a resolve per link. getaddrinfo does
+ * not expose record TTLs, so positive entries live for a fixed, configurable TTL. The cache
+ * is bounded; the least recently used entry is evicted once `max_entries` is reached.
+ */
+class DnsCache {
+public:
+    static DnsCache& instance();
+
+    void configure(size_t               max_entries,
+                   std::chrono::seconds ttl,
+                   std::chrono::seconds negative_ttl);
+
+    /**
+     * @brief Resolves `host`:`port`, serving from cache when possible.
+     * @throws boost::system::system_error on resolution failure (including cached failures).
+     */
+    boost::asio::awaitable<Endpoints> resolve(const std::string& host, const std::string& port);
+
+    DnsStats stats() const;
+    void     clear();
+
+    DnsCache(const DnsCache&)            = delete;
+    DnsCache& operator=(const DnsCache&) = delete;
+
+private:
+    DnsCache() = default;
+
+    using Clock   = std::chrono::steady_clock;
+    using LruList = std::list<std::string>;
+
+    struct Waiter {
+        boost::asio::any_io_executor                               executor;
+        std::function<void(boost::system::error_code, Endpoints)> complete;
+    };
+
+    /// One async_resolve; abandons the lookup if its handler dies without being run.
+    struct Resolve {
+        DnsCache*                    cache;
+        std::string                  key;
+        std::string                  host;
+        std::string                  port;
+        boost::asio::any_io_executor executor;
+        bool                         done = false;
+
+        ~Resolve() {
+            if (!done)
+                cache->abandon(key, host, port, executor);
+        }
+    };
+
+    struct Entry {
+        Endpoints                 endpoints;
+        boost::system::error_code error;
+        Clock::time_point         expires;
+        LruList::iterator         lru;
+    };
+
+    template <typename Handler, typename Executor>
+    void start_lookup(Handler            handler,
+                      const std::string& key,
+                      const std::string& host,
+                      const std::string& port,
+                      const Executor&    executor);
+    void resolve_on(const std::string&                  key,
+                    const std::string&                  host,
+                    const std::string&                  port,
+                    const boost::asio::any_io_executor& executor);
+    void abandon(const std::string&                  key,
+                 const std::string&                  host,
+                 const std::string&                  port,
+                 const boost::asio::any_io_executor& executor);
+    bool lookup(const std::string& key, Endpoints& endpoints, boost::system::error_code& ec);
+    void complete(const std::string&        key,
+                  boost::system::error_code ec,
+                  const Endpoints&          endpoints);
+    void store(const std::string& key, boost::system::error_code ec, const Endpoints& endpoints);
+
+    mutable std::mutex                                   mutex_;
+    std::unordered_map<std::string, Entry>               entries_;
+    LruList                                              lru_;
+    std::unordered_map<std::string, std::vector<Waiter>> in_flight_;
+
+    size_t               max_entries_ = Mojo::Core::Constants::DEFAULT_DNS_CACHE_SIZE;
+    std::chrono::seconds ttl_{Mojo::Core::Constants::DEFAULT_DNS_TTL_SECONDS};
+    std::chrono::seconds negative_ttl_{Mojo::Core::Constants::DEFAULT_DNS_NEGATIVE_TTL_SECONDS};
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> coalesced_{0};
+    std::atomic<uint64_t> negative_hits_{0};
+    std::atomic<uint64_t> evictions_{0};
+};
+
+}  // namespace Dns
+}  // namespace Network
+}  // namespace Mojo
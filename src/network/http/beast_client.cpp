@@ -1,12 +1,18 @@
 #include "beast_client.hpp"
+#include <algorithm>
 #include <boost/lexical_cast.hpp>
 #include <iostream>
+#include <limits>
+#include <vector>
 #include "../../binary/reader.hpp"
 #include "../../binary/writer.hpp"
 #include "../../core/logger/logger.hpp"
 #include "../../core/types/constants.hpp"
 #include "../../utils/url/url.hpp"
+#include "../dns/dns_cache.hpp"
 #include "../proxy/socks_handshake.hpp"
+#include "decompressor.hpp"
+#include "tls_context.hpp"
 
 namespace Mojo {
 namespace Network {
@@ -18,9 +24,11 @@ namespace net   = boost::asio;
 namespace ssl   = net::ssl;
 using tcp       = net::ip::tcp;
 
-BeastClient::BeastClient(net::io_context& /*ioc*/) {
-    ssl_ctx_.set_default_verify_paths();
-    ssl_ctx_.set_verify_mode(ssl::verify_peer);
+namespace {
+constexpr size_t BODY_CHUNK_SIZE = 16384;
+}  // namespace
+
+BeastClient::BeastClient(net::io_context& ioc) : pool_(ConnectionPool::get(ioc)) {
 }
 
 void BeastClient::set_proxy(const std::string& proxy) {
@@ -31,6 +39,14 @@ void BeastClient::set_connect_timeout(std::chrono::milliseconds timeout) {
     connect_timeout_ = timeout;
 }
 
+void BeastClient::set_max_body_size(size_t bytes) {
+    max_body_size_ = bytes;
+}
+
+void BeastClient::set_max_decoded_size(size_t bytes) {
+    max_decoded_size_ = bytes;
+}
+
 net::awaitable<Response> BeastClient::get(const std::string& url) {
     co_return co_await do_request(http::verb::get, url);
 }
@@ -58,8 +74,7 @@ net::awaitable<Response> BeastClient::do_request(http::verb method, const std::s
     std::string target = parsed.path.empty() ? "/" : parsed.path;
     if (!parsed.query.empty())
         target += "?" + parsed.query;
-    if (!parsed.fragment.empty())
-        target += "#" + parsed.fragment;
+    // The fragment is client-side only (RFC 9110 §7.1); it never goes on the wire.
 
     bool is_ssl = (parsed.scheme == "https");
 
@@ -110,54 +125,43 @@ net::awaitable<Response> BeastClient::perform_http_request(const std::string& ho
     Response response;
     response.effective_url = effective_url;
 
-    std::string connect_host = host;
-    std::string connect_port = port;
-
-    if (use_proxy) {
-        auto proxy_parsed = Mojo::Utils::Url::parse(proxy_);
-        if (!proxy_parsed.host.empty()) {
-            connect_host = proxy_parsed.host;
-            connect_port = proxy_parsed.port.empty() ? "8080" : proxy_parsed.port;
-        }
-    }
-
-    tcp::resolver resolver(co_await net::this_coro::executor);
-    auto results = co_await resolver.async_resolve(connect_host, connect_port, net::use_awaitable);
-
-    beast::tcp_stream stream(co_await net::this_coro::executor);
-    stream.expires_after(connect_timeout_);
-    co_await stream.async_connect(results, net::use_awaitable);
-
-    if (use_proxy) {
-        co_await handle_http_proxy_handshake(stream.socket(), host, port);
-    }
-
-    stream.expires_after(std::chrono::seconds(Mojo::Core::Constants::REQUEST_TIMEOUT_SECONDS));
-
     std::string req_target = target;
     if (use_proxy && (proxy_scheme.empty() || proxy_scheme == "http")) {
         req_target = response.effective_url;
     }
 
-    http::request<http::string_body> req{method, req_target, 11};
+    Request req{method, req_target, 11};
     req.set(http::field::host, host);
     req.set(http::field::user_agent, Mojo::Core::Constants::USER_AGENT);
+    req.set(http::field::accept_encoding, Decompressor::accept_encoding());
+
+    PoolKey           key{"http", host, port, proxy_};
+    bool              reusable = false;
+    beast::error_code ec       = net::error::not_connected;
+
+    // Held until the response is read, so the origin never sees more than its limit.
+    auto lease = co_await pool_.lease(key);
+
+    // A pooled socket may have been closed by the server since it was checked in; in that
+    // case fall through and retry once on a fresh connection.
+    auto stream = pool_.acquire_plain(key);
+    if (stream)
+        ec = co_await exchange(*stream, req, response, reusable);
+    if (ec) {
+        stream = co_await connect_plain(host, port, use_proxy);
+        ec     = co_await exchange(*stream, req, response, reusable);
+        if (ec)
+            throw beast::system_error(ec);
+    }
 
-    co_await http::async_write(stream, req, net::use_awaitable);
-
-    beast::flat_buffer                b;
-    http::response<http::string_body> res;
-    co_await                          http::async_read(stream, b, res, net::use_awaitable);
-
-    response.status_code = res.result_int();
-    response.body        = std::move(res.body());
-    response.success     = (response.status_code >= 200 && response.status_code < 400);
-    auto ct              = res.find(http::field::content_type);
-    if (ct != res.end())
-        response.content_type = std::string(ct->value());
-
-    beast::error_code ec;
-    stream.socket().shutdown(tcp::socket::shutdown_both, ec);
+    if (reusable) {
+        pool_.release(key, std::move(stream));
+    }
+    else {
+        beast::error_code ignored;
+        stream->socket().shutdown(tcp::socket::shutdown_both, ignored);
+        stream->socket().close(ignored);
+    }
     co_return response;
 }
 
@@ -170,6 +174,77 @@ net::awaitable<Response> BeastClient::perform_https_request(const std::string& h
     Response response;
     response.effective_url = "https://" + host + ":" + port + target;
 
+    Request req{method, target, 11};
+    req.set(http::field::host, host);
+    req.set(http::field::user_agent, Mojo::Core::Constants::USER_AGENT);
+    req.set(http::field::accept_encoding, Decompressor::accept_encoding());
+
+    PoolKey           key{"https", host, port, proxy_};
+    bool              reusable = false;
+    beast::error_code ec       = net::error::not_connected;
+
+    auto lease  = co_await pool_.lease(key);
+    auto stream = pool_.acquire_tls(key);
+    if (stream)
+        ec = co_await exchange(*stream, req, response, reusable);
+    if (ec) {
+        stream = co_await connect_tls(host, port, use_proxy, proxy_scheme, response);
+        if (!stream)
+            co_return response;
+        ec = co_await exchange(*stream, req, response, reusable);
+        if (ec)
+            throw beast::system_error(ec);
+    }
+
+    if (reusable) {
+        pool_.release(key, std::move(stream));
+    }
+    else if (response.truncated || response.skipped) {
+        // The body was abandoned mid-stream; a TLS close_notify exchange would have to
+        // wade through the rest of it, so just drop the socket.
+        beast::error_code ignored;
+        beast::get_lowest_layer(*stream).socket().close(ignored);
+    }
+    else {
+        // Many servers drop the socket without a close_notify; the response is already
+        // complete at this point, so shutdown errors are not worth failing the request.
+        beast::error_code ignored;
+        beast::get_lowest_layer(*stream).expires_after(connect_timeout_);
+        co_await stream->async_shutdown(net::redirect_error(net::use_awaitable, ignored));
+    }
+    co_return response;
+}
+
+net::awaitable<std::unique_ptr<TcpStream>>
+BeastClient::connect_plain(const std::string& host, const std::string& port, bool use_proxy) {
+    std::string connect_host = host;
+    std::string connect_port = port;
+
+    if (use_proxy) {
+        auto proxy_parsed = Mojo::Utils::Url::parse(proxy_);
+        if (!proxy_parsed.host.empty()) {
+            connect_host = proxy_parsed.host;
+            connect_port = proxy_parsed.port.empty() ? "8080" : proxy_parsed.port;
+        }
+    }
+
+    auto results = co_await Dns::DnsCache::instance().resolve(connect_host, connect_port);
+
+    auto stream = std::make_unique<TcpStream>(co_await net::this_coro::executor);
+    stream->expires_after(connect_timeout_);
+    co_await stream->async_connect(results, net::use_awaitable);
+
+    if (use_proxy) {
+        co_await handle_http_proxy_handshake(stream->socket(), host, port);
+    }
+    co_return stream;
+}
+
+net::awaitable<std::unique_ptr<SslStream>> BeastClient::connect_tls(const std::string& host,
+                                                                    const std::string& port,
+                                                                    bool               use_proxy,
+                                                                    const std::string& proxy_scheme,
+                                                                    Response&          response) {
     std::string connect_host = host;
     std::string connect_port = port;
 
@@ -181,73 +256,163 @@ net::awaitable<Response> BeastClient::perform_https_request(const std::string& h
         }
     }
 
-    tcp::resolver resolver(co_await net::this_coro::executor);
-    auto results = co_await resolver.async_resolve(connect_host, connect_port, net::use_awaitable);
+    auto results = co_await Dns::DnsCache::instance().resolve(connect_host, connect_port);
 
-    beast::ssl_stream<beast::tcp_stream> ssl_stream(co_await net::this_coro::executor, ssl_ctx_);
-    if (!SSL_set_tlsext_host_name(ssl_stream.native_handle(), host.c_str())) {
+    auto& tls        = pool_.tls_context();
+    auto  ssl_stream = tls.make_stream<SslStream>(co_await net::this_coro::executor);
+    if (!tls.prepare(ssl_stream->native_handle(), host)) {
         throw beast::system_error(
             beast::error_code(static_cast<int>(::ERR_get_error()), net::error::get_ssl_category()));
     }
 
-    beast::get_lowest_layer(ssl_stream).expires_after(connect_timeout_);
-    co_await beast::get_lowest_layer(ssl_stream).async_connect(results, net::use_awaitable);
+    auto& lowest = beast::get_lowest_layer(*ssl_stream);
+    lowest.expires_after(connect_timeout_);
+    co_await lowest.async_connect(results, net::use_awaitable);
 
     if (use_proxy) {
         if (proxy_scheme == "socks5") {
             co_await Mojo::Network::Proxy::SocksHandshake::perform_socks5(
-                beast::get_lowest_layer(ssl_stream).socket(), host, port);
+                lowest.socket(), host, port);
         }
         else if (proxy_scheme == "socks4") {
             co_await Mojo::Network::Proxy::SocksHandshake::perform_socks4(
-                beast::get_lowest_layer(ssl_stream).socket(), host, port);
+                lowest.socket(), host, port);
         }
         else {
             // HTTP CONNECT
             http::request<http::empty_body> req{http::verb::connect, host + ":" + port, 11};
             req.set(http::field::host, host + ":" + port);
             req.set(http::field::user_agent, Mojo::Core::Constants::USER_AGENT);
-            co_await http::async_write(
-                beast::get_lowest_layer(ssl_stream), req, net::use_awaitable);
+            co_await http::async_write(lowest, req, net::use_awaitable);
 
             beast::flat_buffer               b;
             http::response<http::empty_body> res;
-            co_await                         http::async_read(
-                beast::get_lowest_layer(ssl_stream), b, res, net::use_awaitable);
+            co_await http::async_read(lowest, b, res, net::use_awaitable);
 
             if (res.result() != http::status::ok) {
                 response.status_code = res.result_int();
                 response.error       = "Proxy CONNECT failed";
-                co_return response;
+                co_return nullptr;
             }
         }
     }
 
-    beast::get_lowest_layer(ssl_stream).expires_after(connect_timeout_);
-    co_await ssl_stream.async_handshake(ssl::stream_base::client, net::use_awaitable);
-
-    beast::get_lowest_layer(ssl_stream)
-        .expires_after(std::chrono::seconds(Mojo::Core::Constants::REQUEST_TIMEOUT_SECONDS));
-
-    http::request<http::string_body> req{method, target, 11};
-    req.set(http::field::host, host);
-    req.set(http::field::user_agent, Mojo::Core::Constants::USER_AGENT);
-
-    co_await http::async_write(ssl_stream, req, net::use_awaitable);
+    lowest.expires_after(connect_timeout_);
+    co_await ssl_stream->async_handshake(ssl::stream_base::client, net::use_awaitable);
+    tls.record_handshake(ssl_stream->native_handle());
+    co_return ssl_stream;
+}
 
-    beast::flat_buffer                b;
-    http::response<http::string_body> res;
-    co_await                          http::async_read(ssl_stream, b, res, net::use_awaitable);
+template <typename Stream>
+net::awaitable<beast::error_code>
+BeastClient::exchange(Stream& stream, const Request& req, Response& response, bool& reusable) {
+    beast::get_lowest_layer(stream).expires_after(
+        std::chrono::seconds(Mojo::Core::Constants::REQUEST_TIMEOUT_SECONDS));
 
-    response.status_code = res.result_int();
-    response.body        = std::move(res.body());
-    response.success     = (response.status_code >= 200 && response.status_code < 400);
-    auto ct              = res.find(http::field::content_type);
-    if (ct != res.end())
+    beast::error_code ec;
+    co_await http::async_write(stream, req, net::redirect_error(net::use_awaitable, ec));
+    if (ec)
+        co_return ec;
+
+    beast::flat_buffer                        b;
+    http::response_parser<http::buffer_body> parser;
+    // Responses to HEAD carry a Content-Length but no body; without skip() the parser
+    // would wait for bytes that never arrive on a kept-alive connection.
+    parser.skip(req.method() == http::verb::head);
+    // Size limits are enforced below so that an oversized response yields a skipped or
+    // truncated result instead of a parser error. (boost::none would disable the limit, but
+    // older Beast compares Content-Length against it and rejects every body.)
+    parser.body_limit(std::numeric_limits<std::uint64_t>::max());
+
+    co_await http::async_read_header(
+        stream, b, parser, net::redirect_error(net::use_awaitable, ec));
+    if (ec)
+        co_return ec;
+
+    auto& head           = parser.get();
+    response.status_code = head.result_int();
+    auto ct              = head.find(http::field::content_type);
+    if (ct != head.end())
         response.content_type = std::string(ct->value());
 
-    co_await  ssl_stream.async_shutdown(net::use_awaitable);
-    co_return response;
+    // Decide on the headers alone whether the body is worth reading. Bailing out here
+    // leaves unread bytes on the socket, so the connection is dropped rather than pooled.
+    if (!Mojo::Core::is_fetchable_content_type(response.content_type)) {
+        reusable            = false;
+        response.skipped    = true;
+        response.error_type = ErrorType::Skipped;
+        response.error      = "Unwanted content type: " + response.content_type;
+        co_return ec;
+    }
+    // A HEAD response advertises the size of a body that is never sent.
+    if (req.method() != http::verb::head && parser.content_length()
+        && *parser.content_length() > max_body_size_) {
+        reusable            = false;
+        response.skipped    = true;
+        response.error_type = ErrorType::Skipped;
+        response.error      = "Content-Length exceeds limit of " + std::to_string(max_body_size_);
+        co_return ec;
+    }
+    // The body is decoded chunk by chunk as it arrives, so a compressed response is never
+    // held in memory in both forms and a bomb is cut off as soon as it crosses the limit.
+    auto         encoding = head[http::field::content_encoding];
+    Decompressor decoder(Decompressor::parse(std::string_view(encoding.data(), encoding.size())),
+                         max_decoded_size_);
+    std::string       body;
+    size_t            wire_bytes = 0;
+    std::vector<char> chunk(BODY_CHUNK_SIZE);
+    bool              decoded   = true;
+    bool              truncated = false;
+
+    while (!parser.is_done()) {
+        if (wire_bytes >= max_body_size_) {
+            truncated = true;
+            break;
+        }
+        size_t want              = std::min(chunk.size(), max_body_size_ - wire_bytes);
+        parser.get().body().data = chunk.data();
+        parser.get().body().size = want;
+        co_await http::async_read(stream, b, parser, net::redirect_error(net::use_awaitable, ec));
+        if (ec == http::error::need_buffer)
+            ec = {};
+        if (ec)
+            co_return ec;
+
+        size_t n = want - parser.get().body().size;
+        wire_bytes += n;
+        if (!decoder.feed(std::string_view(chunk.data(), n), body)) {
+            decoded = false;
+            break;
+        }
+    }
+    // A truncated stream cannot end cleanly, so only complete bodies are checked. HEAD, 204
+    // and 304 responses carry no body at all, so there is no stream to end.
+    if (decoded && !truncated && wire_bytes > 0 && !decoder.finish())
+        decoded = false;
+
+    response.wire_bytes    = wire_bytes;
+    response.decoded_bytes = body.size();
+
+    if (!decoded) {
+        // The rest of the body was not read, so the connection cannot be reused.
+        reusable         = false;
+        response.success = false;
+        response.error   = decoder.error();
+        if (decoder.skipped()) {
+            response.skipped    = true;
+            response.error_type = ErrorType::Skipped;
+        }
+        else {
+            response.error_type = ErrorType::Other;
+        }
+        co_return ec;
+    }
+
+    response.body      = std::move(body);
+    response.truncated = truncated;
+    response.success   = (response.status_code >= 200 && response.status_code < 400);
+    reusable           = !truncated && parser.keep_alive();
+    co_return ec;
 }
 
 net::awaitable<void> BeastClient::handle_http_proxy_handshake(net::ip::tcp::socket& socket,
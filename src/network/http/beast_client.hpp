@@ -4,8 +4,11 @@
 #include <boost/asio/ssl.hpp>
 #include <boost/beast.hpp>
 #include <boost/beast/ssl.hpp>
+#include <memory>
 #include <string>
 #include <utility>
+#include "../../core/types/constants.hpp"
+#include "connection_pool.hpp"
 #include "http_client.hpp"
 
 namespace Mojo {
@@ -19,13 +22,19 @@ public:
 
     void set_proxy(const std::string& proxy) override;
     void set_connect_timeout(std::chrono::milliseconds timeout) override;
+    void set_max_body_size(size_t bytes) override;
+    void set_max_decoded_size(size_t bytes);
     boost::asio::awaitable<Response> get(const std::string& url) override;
     boost::asio::awaitable<Response> head(const std::string& url) override;
 
 private:
+    using Request = boost::beast::http::request<boost::beast::http::empty_body>;
+
+    ConnectionPool&           pool_;
     std::string               proxy_;
     std::chrono::milliseconds connect_timeout_{5000};
-    boost::asio::ssl::context ssl_ctx_{boost::asio::ssl::context::tlsv12_client};
+    size_t                    max_body_size_    = Mojo::Core::Constants::DEFAULT_MAX_BODY_SIZE;
+    size_t                    max_decoded_size_ = Mojo::Core::Constants::MAX_DECODED_BODY_SIZE;
 
     boost::asio::awaitable<Response> do_request(boost::beast::http::verb method,
                                                 const std::string&       url);
@@ -49,6 +58,18 @@ private:
                                                            bool                     use_proxy,
                                                            const std::string&       proxy_scheme);
 
+    boost::asio::awaitable<std::unique_ptr<TcpStream>>
+    connect_plain(const std::string& host, const std::string& port, bool use_proxy);
+    boost::asio::awaitable<std::unique_ptr<SslStream>> connect_tls(const std::string& host,
+                                                                   const std::string& port,
+                                                                   bool               use_proxy,
+                                                                   const std::string& proxy_scheme,
+                                                                   Response&          response);
+
+    template <typename Stream>
+    boost::asio::awaitable<boost::beast::error_code>
+    exchange(Stream& stream, const Request& req, Response& response, bool& reusable);
+
     boost::asio::awaitable<void> handle_http_proxy_handshake(boost::asio::ip::tcp::socket& socket,
                                                              const std::string&            host,
                                                              const std::string&            port);
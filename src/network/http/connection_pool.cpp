@@ -0,0 +1,246 @@
+#include "connection_pool.hpp"
+#include <algorithm>
+
+namespace Mojo {
+namespace Network {
+namespace Http {
+
+namespace beast = boost::beast;
+namespace net   = boost::asio;
+using tcp       = net::ip::tcp;
+
+net::execution_context::id ConnectionPool::id;
+
+ConnectionPool::ConnectionPool(net::execution_context& ctx)
+    : net::execution_context::service(ctx) {
+}
+
+ConnectionPool& ConnectionPool::get(net::io_context& ioc) {
+    return net::use_service<ConnectionPool>(ioc);
+}
+
+ConnectionLease& ConnectionLease::operator=(ConnectionLease&& other) noexcept {
+    if (this != &other) {
+        reset();
+        pool_ = std::exchange(other.pool_, nullptr);
+        key_  = std::move(other.key_);
+    }
+    return *this;
+}
+
+void ConnectionLease::reset() {
+    if (pool_)
+        std::exchange(pool_, nullptr)->give_back(key_);
+}
+
+void ConnectionPool::configure(size_t                    max_per_host,
+                               size_t                    max_idle_per_host,
+                               std::chrono::milliseconds idle_timeout) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_per_host_      = max_per_host;
+    max_idle_per_host_ = max_idle_per_host;
+    idle_timeout_      = idle_timeout;
+}
+
+void ConnectionPool::set_tls_context(TlsContext& tls) {
+    tls_ = &tls;
+}
+
+TlsContext& ConnectionPool::tls_context() {
+    TlsContext* tls = tls_.load();
+    return tls ? *tls : TlsContext::instance();
+}
+
+net::awaitable<ConnectionLease> ConnectionPool::lease(const PoolKey& key) {
+    std::string             id       = key.str();
+    auto                    executor = co_await net::this_coro::executor;
+    std::shared_ptr<Waiter> waiter;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slots&                      slots = slots_[id];
+        if (max_per_host_ == 0 || slots.active < max_per_host_) {
+            slots.active++;
+            // This lease goes on to check out the newest idle socket, so that one is not
+            // extra. Only idle sockets beyond it, with every other lease holding one, would
+            // take the key past its limit; the oldest of those is closed.
+            auto it = idle_.find(id);
+            if (max_per_host_ > 0 && it != idle_.end() && !it->second.empty()
+                && slots.active - 1 + it->second.size() > max_per_host_) {
+                it->second.pop_front();
+                evictions_++;
+            }
+            co_return ConnectionLease(this, id);
+        }
+        waiter = std::make_shared<Waiter>(executor);
+        slots.waiters.push_back(waiter);
+        waits_++;
+    }
+
+    // If the coroutine is destroyed while parked, the slot (or the place in line) goes back.
+    struct Parked {
+        ConnectionPool*          pool;
+        const std::string&       id;
+        std::shared_ptr<Waiter>& waiter;
+        ~Parked() {
+            if (waiter)
+                pool->abandon(id, waiter);
+        }
+    } parked{this, id, waiter};
+
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (waiter->granted)
+                break;
+        }
+        // give_back() cancels the timer; the recheck covers a cancel that lands before
+        // the wait starts.
+        boost::system::error_code ignored;
+        waiter->timer.expires_after(
+            std::chrono::milliseconds(Mojo::Core::Constants::POOL_LEASE_RECHECK_MS));
+        co_await waiter->timer.async_wait(net::redirect_error(net::use_awaitable, ignored));
+    }
+    waiter.reset();
+    co_return ConnectionLease(this, id);
+}
+
+void ConnectionPool::give_back(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto                        it = slots_.find(key);
+    if (it == slots_.end())
+        return;
+    Slots& slots = it->second;
+    if (!slots.waiters.empty()) {
+        // The slot passes straight to the next caller in line, so the count is unchanged.
+        auto next = std::move(slots.waiters.front());
+        slots.waiters.pop_front();
+        next->granted = true;
+        net::post(next->timer.get_executor(), [next]() { next->timer.cancel(); });
+        return;
+    }
+    if (slots.active > 0)
+        slots.active--;
+    if (slots.active == 0)
+        slots_.erase(it);
+}
+
+void ConnectionPool::abandon(const std::string& key, const std::shared_ptr<Waiter>& waiter) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!waiter->granted) {
+            auto it = slots_.find(key);
+            if (it != slots_.end()) {
+                auto& waiters = it->second.waiters;
+                waiters.erase(std::remove(waiters.begin(), waiters.end(), waiter), waiters.end());
+            }
+            return;
+        }
+    }
+    give_back(key);
+}
+
+std::unique_ptr<TcpStream> ConnectionPool::acquire_plain(const PoolKey& key) {
+    return std::move(checkout(key).plain);
+}
+
+std::unique_ptr<SslStream> ConnectionPool::acquire_tls(const PoolKey& key) {
+    return std::move(checkout(key).tls);
+}
+
+void ConnectionPool::release(const PoolKey& key, std::unique_ptr<TcpStream> stream) {
+    if (!stream)
+        return;
+    stream->expires_never();
+    checkin(key, IdleConnection{std::move(stream), nullptr, std::chrono::steady_clock::now()});
+}
+
+void ConnectionPool::release(const PoolKey& key, std::unique_ptr<SslStream> stream) {
+    if (!stream)
+        return;
+    beast::get_lowest_layer(*stream).expires_never();
+    checkin(key, IdleConnection{nullptr, std::move(stream), std::chrono::steady_clock::now()});
+}
+
+ConnectionPool::IdleConnection ConnectionPool::checkout(const PoolKey& key) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto                         it = idle_.find(key.str());
+    if (it != idle_.end()) {
+        auto& queue = it->second;
+        // Most recently used first: it is the least likely to have been closed by the peer.
+        while (!queue.empty()) {
+            IdleConnection conn = std::move(queue.back());
+            queue.pop_back();
+            if (is_healthy(conn)) {
+                hits_++;
+                return conn;
+            }
+            evictions_++;
+        }
+        idle_.erase(it);
+    }
+    misses_++;
+    return {};
+}
+
+void ConnectionPool::checkin(const PoolKey& key, IdleConnection conn) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (max_idle_per_host_ == 0)
+        return;
+
+    auto& queue = idle_[key.str()];
+    if (queue.size() >= max_idle_per_host_) {
+        queue.pop_front();
+        evictions_++;
+    }
+    queue.push_back(std::move(conn));
+}
+
+bool ConnectionPool::is_healthy(IdleConnection& conn) const {
+    if (std::chrono::steady_clock::now() - conn.idle_since > idle_timeout_)
+        return false;
+
+    tcp::socket& socket =
+        conn.plain ? conn.plain->socket() : beast::get_lowest_layer(*conn.tls).socket();
+    if (!socket.is_open())
+        return false;
+
+    // An idle keep-alive socket must have nothing to read. EOF means the peer closed it,
+    // stray bytes mean the stream is out of sync; only would_block is a usable socket.
+    boost::system::error_code ec;
+    char                      byte = 0;
+    socket.non_blocking(true, ec);
+    if (ec)
+        return false;
+    socket.receive(net::buffer(&byte, 1), tcp::socket::message_peek, ec);
+    boost::system::error_code restore_ec;
+    socket.non_blocking(false, restore_ec);
+    return ec == net::error::would_block && !restore_ec;
+}
+
+PoolStats ConnectionPool::stats() const {
+    PoolStats s;
+    s.hits      = hits_.load();
+    s.misses    = misses_.load();
+    s.evictions = evictions_.load();
+    s.waits     = waits_.load();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [key, queue] : idle_)
+        s.idle += queue.size();
+    for (const auto& [key, slots] : slots_)
+        s.active += slots.active;
+    return s;
+}
+
+void ConnectionPool::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    idle_.clear();
+}
+
+void ConnectionPool::shutdown() {
+    clear();
+}
+
+}  // namespace Http
+}  // namespace Network
+}  // namespace Mojo
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/ssl.hpp>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include "../../core/types/constants.hpp"
+#include "tls_context.hpp"
+
+namespace Mojo {
+namespace Network {
+namespace Http {
+
+using TcpStream = boost::beast::tcp_stream;
+using SslStream = boost::beast::ssl_stream<boost::beast::tcp_stream>;
+
+/**
+ * @brief Identifies a reusable connection: same scheme, origin and upstream proxy.
+ */
+struct PoolKey {
+    std::string scheme;
+    std::string host;
+    std::string port;
+    std::string proxy;
+
+    std::string str() const {
+        return scheme + "://" + host + ":" + port + "|" + proxy;
+    }
+};
+
+struct PoolStats {
+    uint64_t hits      = 0;
+    uint64_t misses    = 0;
+    uint64_t evictions = 0;
+    uint64_t waits     = 0;  // Leases that queued behind a host's connection limit
+    size_t   idle      = 0;
+    size_t   active    = 0;  // Connections leased out right now
+};
+
+class ConnectionPool;
+
+/**
+ * @brief One of a key's connection slots, held for the length of a request. Returning it
+ * (on destruction or reset()) hands the slot to the next waiter, if any.
+ */
+class ConnectionLease {
+public:
+    ConnectionLease() = default;
+    ConnectionLease(ConnectionPool* pool, std::string key) : pool_(pool), key_(std::move(key)) {
+    }
+    ~ConnectionLease() {
+        reset();
+    }
+
+    ConnectionLease(ConnectionLease&& other) noexcept
+        : pool_(std::exchange(other.pool_, nullptr)), key_(std::move(other.key_)) {
+    }
+    ConnectionLease& operator=(ConnectionLease&& other) noexcept;
+    ConnectionLease(const ConnectionLease&)            = delete;
+    ConnectionLease& operator=(const ConnectionLease&) = delete;
+
+    void reset();
+
+private:
+    ConnectionPool* pool_ = nullptr;
+    std::string     key_;
+};
+
+/**
+ * @brief Keep-alive connection pool shared by every client on an io_context.
+ *
+ * Registered as an asio service, so all BeastClient instances created on the same
+ * io_context see the same idle sockets. Idle connections are dropped once they exceed
+ * the idle timeout, and at most `max_idle_per_host` sockets are retained per key.
+ * Each checkout probes the socket so a peer-closed connection is never handed out.
+ *
+ * A request first takes a lease(): at most `max_per_host` are out per key at once, and
+ * further callers wait, in order, for one to be returned. Idle sockets count against the
+ * same limit, so a key never holds more than `max_per_host` open connections.
+ */
+class ConnectionPool : public boost::asio::execution_context::service {
+public:
+    static boost::asio::execution_context::id id;
+
+    explicit ConnectionPool(boost::asio::execution_context& ctx);
+    ~ConnectionPool() override = default;
+
+    static ConnectionPool& get(boost::asio::io_context& ioc);
+
+    /// `max_per_host` of 0 lifts the limit on concurrent connections.
+    void configure(size_t                    max_per_host,
+                   size_t                    max_idle_per_host,
+                   std::chrono::milliseconds idle_timeout);
+
+    /// Waits until `key` is below its connection limit and takes a slot.
+    boost::asio::awaitable<ConnectionLease> lease(const PoolKey& key);
+
+    std::unique_ptr<TcpStream> acquire_plain(const PoolKey& key);
+    std::unique_ptr<SslStream> acquire_tls(const PoolKey& key);
+
+    void release(const PoolKey& key, std::unique_ptr<TcpStream> stream);
+    void release(const PoolKey& key, std::unique_ptr<SslStream> stream);
+
+    /// TLS connections of this pool are made with `tls` instead of TlsContext::instance().
+    /// Set it before the first request; idle connections keep the context they were made with.
+    void        set_tls_context(TlsContext& tls);
+    TlsContext& tls_context();
+
+    PoolStats stats() const;
+    void      clear();
+
+private:
+    friend class ConnectionLease;
+
+    /// A parked lease() call; granted once a slot is handed to it.
+    struct Waiter {
+        explicit Waiter(const boost::asio::any_io_executor& executor) : timer(executor) {
+        }
+        boost::asio::steady_timer timer;
+        bool                      granted = false;
+    };
+
+    struct Slots {
+        size_t                              active = 0;
+        std::deque<std::shared_ptr<Waiter>> waiters;
+    };
+
+    struct IdleConnection {
+        std::unique_ptr<TcpStream>            plain;
+        std::unique_ptr<SslStream>            tls;
+        std::chrono::steady_clock::time_point idle_since;
+    };
+
+    void shutdown() override;
+
+    IdleConnection checkout(const PoolKey& key);
+    void           checkin(const PoolKey& key, IdleConnection conn);
+    bool           is_healthy(IdleConnection& conn) const;
+    void           give_back(const std::string& key);
+    void           abandon(const std::string& key, const std::shared_ptr<Waiter>& waiter);
+
+    mutable std::mutex                                          mutex_;
+    std::unordered_map<std::string, std::deque<IdleConnection>> idle_;
+    std::unordered_map<std::string, Slots>                      slots_;
+    size_t max_per_host_      = Mojo::Core::Constants::DEFAULT_POOL_MAX_PER_HOST;
+    size_t max_idle_per_host_ = Mojo::Core::Constants::DEFAULT_POOL_MAX_IDLE_PER_HOST;
+    std::chrono::milliseconds idle_timeout_{Mojo::Core::Constants::DEFAULT_POOL_IDLE_TIMEOUT_MS};
+    std::atomic<TlsContext*>  tls_{nullptr};  // TlsContext::instance() until set
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> waits_{0};
+};
+
+}  // namespace Http
+}  // namespace Network
+}  // namespace Mojo
@@ -0,0 +1,271 @@
+#include "decompressor.hpp"
+#include <algorithm>
+#include <cctype>
+#include <zlib.h>
+#ifdef MOJO_HAVE_BROTLI
+#include <brotli/decode.h>
+#endif
+#ifdef MOJO_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace Mojo {
+namespace Network {
+namespace Http {
+
+namespace {
+constexpr size_t CHUNK_SIZE = 16384;
+}  // namespace
+
+struct Decompressor::Impl {
+    z_stream zlib{};
+    bool     zlib_ready  = false;
+    bool     stream_done = false;
+    // "deflate" is specified as zlib-wrapped, but many servers send raw deflate; the
+    // wrapper is detected from the first two bytes.
+    std::string deflate_probe;
+#ifdef MOJO_HAVE_BROTLI
+    BrotliDecoderState* brotli = nullptr;
+#endif
+#ifdef MOJO_HAVE_ZSTD
+    ZSTD_DStream* zstd = nullptr;
+#endif
+
+    ~Impl() {
+        if (zlib_ready)
+            inflateEnd(&zlib);
+#ifdef MOJO_HAVE_BROTLI
+        if (brotli)
+            BrotliDecoderDestroyInstance(brotli);
+#endif
+#ifdef MOJO_HAVE_ZSTD
+        if (zstd)
+            ZSTD_freeDStream(zstd);
+#endif
+    }
+
+    bool init_zlib(int window_bits) {
+        zlib_ready = inflateInit2(&zlib, window_bits) == Z_OK;
+        return zlib_ready;
+    }
+};
+
+Decompressor::Decompressor(ContentEncoding encoding, size_t max_output)
+    : encoding_(encoding), max_output_(max_output), impl_(std::make_unique<Impl>()) {
+    switch (encoding_) {
+        case ContentEncoding::Gzip:
+            // 15 + 32: accept both gzip and zlib headers.
+            if (!impl_->init_zlib(15 + 32))
+                fail("inflateInit2 failed");
+            break;
+#ifdef MOJO_HAVE_BROTLI
+        case ContentEncoding::Brotli:
+            impl_->brotli = BrotliDecoderCreateInstance(nullptr, nullptr, nullptr);
+            if (!impl_->brotli)
+                fail("BrotliDecoderCreateInstance failed");
+            break;
+#else
+        case ContentEncoding::Brotli:
+            unsupported_ = true;
+            fail("brotli support not compiled in");
+            break;
+#endif
+#ifdef MOJO_HAVE_ZSTD
+        case ContentEncoding::Zstd:
+            impl_->zstd = ZSTD_createDStream();
+            if (!impl_->zstd || ZSTD_isError(ZSTD_initDStream(impl_->zstd)))
+                fail("ZSTD_initDStream failed");
+            break;
+#else
+        case ContentEncoding::Zstd:
+            unsupported_ = true;
+            fail("zstd support not compiled in");
+            break;
+#endif
+        case ContentEncoding::Unsupported:
+            unsupported_ = true;
+            fail("Unsupported Content-Encoding");
+            break;
+        default:
+            break;
+    }
+}
+
+Decompressor::~Decompressor() = default;
+
+ContentEncoding Decompressor::parse(std::string_view header) {
+    std::string value;
+    for (char c : header) {
+        if (!std::isspace(static_cast<unsigned char>(c)))
+            value += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+
+    if (value.empty() || value == "identity")
+        return ContentEncoding::Identity;
+    if (value == "gzip" || value == "x-gzip")
+        return ContentEncoding::Gzip;
+    if (value == "deflate")
+        return ContentEncoding::Deflate;
+#ifdef MOJO_HAVE_BROTLI
+    if (value == "br")
+        return ContentEncoding::Brotli;
+#endif
+#ifdef MOJO_HAVE_ZSTD
+    if (value == "zstd")
+        return ContentEncoding::Zstd;
+#endif
+    return ContentEncoding::Unsupported;
+}
+
+const std::string& Decompressor::accept_encoding() {
+    static const std::string value = [] {
+        std::string v;
+#ifdef MOJO_HAVE_ZSTD
+        v += "zstd, ";
+#endif
+#ifdef MOJO_HAVE_BROTLI
+        v += "br, ";
+#endif
+        v += "gzip, deflate";
+        return v;
+    }();
+    return value;
+}
+
+bool Decompressor::append(std::string& out, const char* data, size_t len) {
+    if (produced_ + len > max_output_) {
+        limit_exceeded_ = true;
+        return fail("Decoded body exceeds " + std::to_string(max_output_) + " bytes");
+    }
+    out.append(data, len);
+    produced_ += len;
+    return true;
+}
+
+bool Decompressor::fail(const std::string& message) {
+    failed_ = true;
+    if (error_.empty())
+        error_ = message;
+    return false;
+}
+
+bool Decompressor::feed(std::string_view input, std::string& out) {
+    if (failed_)
+        return false;
+    if (input.empty())
+        return true;
+
+    char chunk[CHUNK_SIZE];
+
+    switch (encoding_) {
+        case ContentEncoding::Identity:
+            return append(out, input.data(), input.size());
+
+        case ContentEncoding::Deflate:
+            if (!impl_->zlib_ready) {
+                impl_->deflate_probe.append(input);
+                if (impl_->deflate_probe.size() < 2)
+                    return true;
+                auto b0          = static_cast<unsigned char>(impl_->deflate_probe[0]);
+                auto b1          = static_cast<unsigned char>(impl_->deflate_probe[1]);
+                bool zlib_header = (b0 & 0x0F) == 8 && ((b0 << 8) | b1) % 31 == 0;
+                if (!impl_->init_zlib(zlib_header ? 15 : -15))
+                    return fail("inflateInit2 failed");
+                std::string probe = std::move(impl_->deflate_probe);
+                return feed(probe, out);
+            }
+            [[fallthrough]];
+
+        case ContentEncoding::Gzip: {
+            auto& zs    = impl_->zlib;
+            zs.next_in  = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+            zs.avail_in = static_cast<uInt>(input.size());
+            while (zs.avail_in > 0 && !impl_->stream_done) {
+                zs.next_out  = reinterpret_cast<Bytef*>(chunk);
+                zs.avail_out = sizeof(chunk);
+                int rc       = inflate(&zs, Z_NO_FLUSH);
+                if (rc != Z_OK && rc != Z_STREAM_END && rc != Z_BUF_ERROR)
+                    return fail(std::string("inflate failed: ") + (zs.msg ? zs.msg : "corrupt"));
+                if (!append(out, chunk, sizeof(chunk) - zs.avail_out))
+                    return false;
+                if (rc == Z_STREAM_END)
+                    impl_->stream_done = true;
+                else if (rc == Z_BUF_ERROR)
+                    break;
+            }
+            return true;
+        }
+
+#ifdef MOJO_HAVE_BROTLI
+        case ContentEncoding::Brotli: {
+            size_t         avail_in = input.size();
+            const uint8_t* next_in  = reinterpret_cast<const uint8_t*>(input.data());
+            while (true) {
+                size_t   avail_out = sizeof(chunk);
+                uint8_t* next_out  = reinterpret_cast<uint8_t*>(chunk);
+                auto     rc        = BrotliDecoderDecompressStream(
+                    impl_->brotli, &avail_in, &next_in, &avail_out, &next_out, nullptr);
+                if (rc == BROTLI_DECODER_RESULT_ERROR) {
+                    auto code = BrotliDecoderGetErrorCode(impl_->brotli);
+                    return fail(std::string("brotli: ") + BrotliDecoderErrorString(code));
+                }
+                if (!append(out, chunk, sizeof(chunk) - avail_out))
+                    return false;
+                if (rc == BROTLI_DECODER_RESULT_SUCCESS)
+                    impl_->stream_done = true;
+                if (rc != BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT)
+                    return true;
+            }
+        }
+#endif
+
+#ifdef MOJO_HAVE_ZSTD
+        case ContentEncoding::Zstd: {
+            ZSTD_inBuffer in{input.data(), input.size(), 0};
+            while (true) {
+                ZSTD_outBuffer o{chunk, sizeof(chunk), 0};
+                size_t         rc = ZSTD_decompressStream(impl_->zstd, &o, &in);
+                if (ZSTD_isError(rc))
+                    return fail(std::string("zstd: ") + ZSTD_getErrorName(rc));
+                if (!append(out, chunk, o.pos))
+                    return false;
+                // rc == 0 marks the end of a frame; further frames may follow.
+                impl_->stream_done = (rc == 0);
+                if (in.pos == in.size && o.pos < o.size)
+                    break;
+            }
+            return true;
+        }
+#endif
+
+        default:
+            return append(out, input.data(), input.size());
+    }
+}
+
+bool Decompressor::finish() {
+    if (failed_)
+        return false;
+
+    switch (encoding_) {
+        case ContentEncoding::Gzip:
+        case ContentEncoding::Brotli:
+        case ContentEncoding::Zstd:
+            if (!impl_->stream_done)
+                return fail("Compressed body is truncated");
+            return true;
+        case ContentEncoding::Deflate:
+            // Bodies shorter than the probe never started the inflater.
+            if (!impl_->zlib_ready && !impl_->deflate_probe.empty())
+                return fail("Compressed body is truncated");
+            if (impl_->zlib_ready && !impl_->stream_done)
+                return fail("Compressed body is truncated");
+            return true;
+        default:
+            return true;
+    }
+}
+
+}  // namespace Http
+}  // namespace Network
+}  // namespace Mojo
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace Mojo {
+namespace Network {
+namespace Http {
+
+enum class ContentEncoding { Identity, Gzip, Deflate, Brotli, Zstd, Unsupported };
+
+/**
+ * @brief Streaming decoder for HTTP Content-Encoding.
+ *
+ * Body chunks are fed as they arrive from the socket and decoded output is appended to
+ * the caller's string, so compressed bodies are never buffered twice. Output is capped at
+ * `max_output` bytes to defuse decompression bombs; once the cap is hit `feed()` fails
+ * and `limit_exceeded()` reports why. A coding this build cannot decode fails the same way,
+ * with `unsupported()` set, instead of passing the encoded bytes through as the body.
+ */
+class Decompressor {
+public:
+    Decompressor(ContentEncoding encoding, size_t max_output);
+    ~Decompressor();
+
+    Decompressor(const Decompressor&)            = delete;
+    Decompressor& operator=(const Decompressor&) = delete;
+
+    /**
+     * @brief Parses a Content-Encoding header value. Empty and "identity" map to Identity.
+     */
+    static ContentEncoding parse(std::string_view header);
+
+    /**
+     * @brief Accept-Encoding value listing every encoding this build can decode.
+     */
+    static const std::string& accept_encoding();
+
+    /**
+     * @brief Decodes `input` and appends the result to `out`.
+     * @return false on corrupt input or when the output limit is exceeded.
+     */
+    bool feed(std::string_view input, std::string& out);
+
+    /**
+     * @brief Checks that the stream ended cleanly (no truncated compressed frame).
+     */
+    bool finish();
+
+    bool limit_exceeded() const {
+        return limit_exceeded_;
+    }
+
+    bool unsupported() const {
+        return unsupported_;
+    }
+
+    /// The body was refused rather than found corrupt, so the page is skipped.
+    bool skipped() const {
+        return limit_exceeded_ || unsupported_;
+    }
+
+    const std::string& error() const {
+        return error_;
+    }
+
+private:
+    struct Impl;
+
+    bool append(std::string& out, const char* data, size_t len);
+    bool fail(const std::string& message);
+
+    ContentEncoding       encoding_;
+    size_t                max_output_;
+    size_t                produced_       = 0;
+    bool                  limit_exceeded_ = false;
+    bool                  unsupported_    = false;
+    bool                  failed_         = false;
+    std::string           error_;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace Http
+}  // namespace Network
+}  // namespace Mojo
@@ -0,0 +1,80 @@
+#include "h2_client.hpp"
+#include "../../utils/url/url.hpp"
+
+namespace Mojo {
+namespace Network {
+namespace Http {
+
+namespace http = boost::beast::http;
+namespace net  = boost::asio;
+
+H2Client::H2Client(net::io_context& ioc)
+    : pool_(H2ConnectionPool::get(ioc)), fallback_(ioc) {
+}
+
+void H2Client::set_proxy(const std::string& proxy) {
+    proxy_ = proxy;
+    fallback_.set_proxy(proxy);
+}
+
+void H2Client::set_connect_timeout(std::chrono::milliseconds timeout) {
+    options_.connect_timeout = timeout;
+    fallback_.set_connect_timeout(timeout);
+}
+
+void H2Client::set_max_body_size(size_t bytes) {
+    options_.max_body_size = bytes;
+    fallback_.set_max_body_size(bytes);
+}
+
+void H2Client::set_max_decoded_size(size_t bytes) {
+    options_.max_decoded_size = bytes;
+    fallback_.set_max_decoded_size(bytes);
+}
+
+net::awaitable<Response> H2Client::get(const std::string& url) {
+    co_return co_await do_request(http::verb::get, url);
+}
+
+net::awaitable<Response> H2Client::head(const std::string& url) {
+    co_return co_await do_request(http::verb::head, url);
+}
+
+net::awaitable<Response> H2Client::do_request(http::verb method, const std::string& url) {
+    auto parsed = Mojo::Utils::Url::parse(url);
+    // HTTP/2 is only negotiated via TLS ALPN, and tunnelling it through the proxy
+    // gateway is not supported, so those requests keep using HTTP/1.1.
+    if (parsed.host.empty() || parsed.scheme != "https" || !proxy_.empty())
+        co_return co_await fallback(method, url);
+
+    std::string port   = parsed.port.empty() ? "443" : parsed.port;
+    std::string target = parsed.path.empty() ? "/" : parsed.path;
+    if (!parsed.query.empty())
+        target += "?" + parsed.query;
+
+    // A pooled connection may have been shut down by the server (GOAWAY, idle close) just
+    // as the request went out; retry once on a fresh one, as BeastClient does for stale
+    // keep-alive sockets. Connections that never came up are not retried.
+    for (int attempt = 0;; ++attempt) {
+        auto conn   = pool_.connection(parsed.host, port);
+        auto result = co_await conn->request(method, target, options_);
+        if (!result) {
+            pool_.record_fallback();
+            co_return co_await fallback(method, url);
+        }
+        if (attempt == 0 && result->status_code == 0 && conn->established() && !conn->usable()) {
+            continue;
+        }
+        co_return std::move(*result);
+    }
+}
+
+net::awaitable<Response> H2Client::fallback(http::verb method, const std::string& url) {
+    if (method == http::verb::head)
+        co_return co_await fallback_.head(url);
+    co_return co_await fallback_.get(url);
+}
+
+}  // namespace Http
+}  // namespace Network
+}  // namespace Mojo
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <boost/asio.hpp>
+#include <chrono>
+#include <string>
+#include "../../core/types/constants.hpp"
+#include "beast_client.hpp"
+#include "h2_connection.hpp"
+#include "http_client.hpp"
+
+namespace Mojo {
+namespace Network {
+namespace Http {
+
+/**
+ * @brief HttpClient that speaks HTTP/2 over TLS and falls back to HTTP/1.1.
+ *
+ * Requests to an https origin are multiplexed over the single connection that
+ * H2ConnectionPool keeps for it, so concurrent get() calls from many workers share one
+ * socket. Plain http URLs, requests through an upstream proxy and origins whose ALPN
+ * answer is not h2 are delegated to an internal BeastClient.
+ */
+class H2Client : public HttpClient {
+public:
+    explicit H2Client(boost::asio::io_context& ioc);
+    ~H2Client() override = default;
+
+    void set_proxy(const std::string& proxy) override;
+    void set_connect_timeout(std::chrono::milliseconds timeout) override;
+    void set_max_body_size(size_t bytes) override;
+    void set_max_decoded_size(size_t bytes);
+    boost::asio::awaitable<Response> get(const std::string& url) override;
+    boost::asio::awaitable<Response> head(const std::string& url) override;
+
+private:
+    H2ConnectionPool& pool_;
+    BeastClient       fallback_;
+    std::string       proxy_;
+    H2RequestOptions  options_;
+
+    boost::asio::awaitable<Response> do_request(boost::beast::http::verb method,
+                                                const std::string&       url);
+    boost::asio::awaitable<Response> fallback(boost::beast::http::verb method,
+                                              const std::string&       url);
+};
+
+}  // namespace Http
+}  // namespace Network
+}  // namespace Mojo
@@ -0,0 +1,532 @@
+#include "h2_connection.hpp"
+#include <openssl/ssl.h>
+#include <algorithm>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+#include "../../core/types/constants.hpp"
+#include "../dns/dns_cache.hpp"
+#include "tls_context.hpp"
+
+namespace Mojo {
+namespace Network {
+namespace Http {
+
+namespace beast = boost::beast;
+namespace http  = beast::http;
+namespace net   = boost::asio;
+namespace ssl   = net::ssl;
+
+namespace {
+constexpr size_t  READ_BUFFER_SIZE    = 16384;
+constexpr size_t  WRITE_BATCH_SIZE    = 65536;
+constexpr int32_t STREAM_WINDOW_SIZE  = 1 << 20;
+constexpr int32_t SESSION_WINDOW_SIZE = 16 << 20;
+
+// ALPN protocol list in wire format: length-prefixed names, most preferred first.
+constexpr unsigned char ALPN_PROTOCOLS[] = "\x02h2\x08http/1.1";
+
+nghttp2_nv make_nv(std::string_view name, std::string_view value) {
+    return nghttp2_nv{reinterpret_cast<uint8_t*>(const_cast<char*>(name.data())),
+                      reinterpret_cast<uint8_t*>(const_cast<char*>(value.data())),
+                      name.size(),
+                      value.size(),
+                      NGHTTP2_NV_FLAG_NONE};
+}
+}  // namespace
+
+H2Connection::H2Connection(net::io_context& ioc, std::string host, std::string port)
+    : strand_(net::make_strand(ioc)),
+      pool_(H2ConnectionPool::get(ioc)),
+      host_(std::move(host)),
+      port_(std::move(port)) {
+}
+
+H2Connection::~H2Connection() {
+    if (session_)
+        nghttp2_session_del(session_);
+}
+
+net::awaitable<std::optional<Response>>
+H2Connection::request(http::verb method, std::string target, H2RequestOptions options) {
+    // The session is only ever touched on the strand, whichever thread the caller runs on.
+    co_return co_await net::co_spawn(
+        strand_,
+        request_on_strand(shared_from_this(), method, std::move(target), options),
+        net::use_awaitable);
+}
+
+void H2Connection::close() {
+    closed_ = true;
+    net::post(strand_, [self = shared_from_this()]() { self->close_on_strand(); });
+}
+
+net::awaitable<std::optional<Response>>
+H2Connection::request_on_strand(std::shared_ptr<H2Connection> self,
+                                http::verb                    method,
+                                std::string                   target,
+                                H2RequestOptions              options) {
+    auto& conn = *self;
+    co_await conn.ensure_connected(options.connect_timeout);
+    if (conn.http1_)
+        co_return std::nullopt;
+
+    Response response;
+    response.effective_url = "https://" + conn.host_ + ":" + conn.port_ + target;
+    if (conn.state_ != State::Ready || conn.closed_) {
+        response.error =
+            conn.connect_error_.empty() ? "HTTP/2 connection closed" : conn.connect_error_;
+        response.error_type = ErrorType::Network;
+        co_return response;
+    }
+
+    std::string authority = conn.port_ == "443" ? conn.host_ : conn.host_ + ":" + conn.port_;
+    auto        verb      = http::to_string(method);
+    const nghttp2_nv headers[] = {
+        make_nv(":method", std::string_view(verb.data(), verb.size())),
+        make_nv(":scheme", "https"),
+        make_nv(":authority", authority),
+        make_nv(":path", target),
+        make_nv("user-agent", Mojo::Core::Constants::USER_AGENT),
+        make_nv("accept-encoding", Decompressor::accept_encoding()),
+    };
+
+    int32_t stream_id = nghttp2_submit_request(
+        conn.session_, nullptr, headers, std::size(headers), nullptr, nullptr);
+    if (stream_id < 0) {
+        response.error      = nghttp2_strerror(stream_id);
+        response.error_type = ErrorType::Network;
+        co_return response;
+    }
+
+    auto stream       = std::make_unique<Stream>();
+    stream->response  = std::move(response);
+    stream->options   = options;
+    stream->head_only = (method == http::verb::head);
+    stream->waiter    = std::make_unique<net::steady_timer>(conn.strand_);
+    Stream& s         = *stream;
+    conn.streams_.emplace(stream_id, std::move(stream));
+    conn.pool_.record_stream();
+    conn.flush();
+
+    if (!s.done) {
+        s.waiter->expires_after(
+            std::chrono::seconds(Mojo::Core::Constants::REQUEST_TIMEOUT_SECONDS));
+        boost::system::error_code ec;
+        co_await s.waiter->async_wait(net::redirect_error(net::use_awaitable, ec));
+    }
+    if (!s.done) {
+        s.response.success    = false;
+        s.response.error      = "HTTP/2 request timed out";
+        s.response.error_type = ErrorType::Timeout;
+        conn.abort_stream(stream_id, s);
+    }
+
+    Response result = std::move(s.response);
+    conn.streams_.erase(stream_id);
+    co_return result;
+}
+
+net::awaitable<void> H2Connection::ensure_connected(std::chrono::milliseconds timeout) {
+    if (state_ == State::Idle) {
+        state_ = State::Connecting;
+        try {
+            co_await connect(timeout);
+        } catch (const std::exception& e) {
+            connect_error_ = e.what();
+            state_         = State::Closed;
+            closed_        = true;
+        }
+        for (auto& waiter : connect_waiters_)
+            waiter->cancel();
+        connect_waiters_.clear();
+    }
+    else if (state_ == State::Connecting) {
+        auto waiter =
+            std::make_shared<net::steady_timer>(strand_, net::steady_timer::time_point::max());
+        connect_waiters_.push_back(waiter);
+        boost::system::error_code ec;
+        co_await waiter->async_wait(net::redirect_error(net::use_awaitable, ec));
+    }
+}
+
+net::awaitable<void> H2Connection::connect(std::chrono::milliseconds timeout) {
+    auto results = co_await Dns::DnsCache::instance().resolve(host_, port_);
+
+    auto& tls = pool_.tls_context();
+    stream_   = tls.make_stream<SslStream>(strand_);
+    SSL* ssl  = stream_->native_handle();
+    if (!tls.prepare(ssl, host_)
+        || SSL_set_alpn_protos(ssl, ALPN_PROTOCOLS, sizeof(ALPN_PROTOCOLS) - 1) != 0) {
+        throw beast::system_error(
+            beast::error_code(static_cast<int>(::ERR_get_error()), net::error::get_ssl_category()));
+    }
+
+    auto& lowest = beast::get_lowest_layer(*stream_);
+    lowest.expires_after(timeout);
+    co_await lowest.async_connect(results, net::use_awaitable);
+    lowest.expires_after(timeout);
+    co_await stream_->async_handshake(ssl::stream_base::client, net::use_awaitable);
+    tls.record_handshake(ssl);
+    // Streams carry their own deadlines; the connection itself stays open while idle.
+    lowest.expires_never();
+
+    const unsigned char* protocol = nullptr;
+    unsigned int         length   = 0;
+    SSL_get0_alpn_selected(ssl, &protocol, &length);
+    if (length != 2 || std::memcmp(protocol, "h2", 2) != 0) {
+        http1_  = true;
+        closed_ = true;
+        state_  = State::Closed;
+        beast::error_code ignored;
+        lowest.socket().close(ignored);
+        co_return;
+    }
+
+    start_session();
+    state_       = State::Ready;
+    established_ = true;
+    pool_.record_connection();
+    net::co_spawn(strand_, read_loop(shared_from_this()), net::detached);
+    flush();
+}
+
+void H2Connection::start_session() {
+    nghttp2_session_callbacks* callbacks = nullptr;
+    nghttp2_session_callbacks_new(&callbacks);
+    nghttp2_session_callbacks_set_on_header_callback(callbacks, &H2Connection::on_header);
+    nghttp2_session_callbacks_set_on_frame_recv_callback(callbacks, &H2Connection::on_frame_recv);
+    nghttp2_session_callbacks_set_on_data_chunk_recv_callback(callbacks,
+                                                              &H2Connection::on_data_chunk_recv);
+    nghttp2_session_callbacks_set_on_stream_close_callback(callbacks,
+                                                           &H2Connection::on_stream_close);
+    nghttp2_session_client_new(&session_, callbacks, this);
+    nghttp2_session_callbacks_del(callbacks);
+
+    // Larger windows than the 64KB default keep one slow consumer from stalling the rest.
+    const nghttp2_settings_entry settings[] = {
+        {NGHTTP2_SETTINGS_ENABLE_PUSH, 0},
+        {NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE, STREAM_WINDOW_SIZE},
+    };
+    nghttp2_submit_settings(session_, NGHTTP2_FLAG_NONE, settings, std::size(settings));
+    nghttp2_session_set_local_window_size(session_, NGHTTP2_FLAG_NONE, 0, SESSION_WINDOW_SIZE);
+}
+
+net::awaitable<void> H2Connection::read_loop(std::shared_ptr<H2Connection> self) {
+    std::vector<uint8_t> buffer(READ_BUFFER_SIZE);
+    while (self->state_ == State::Ready) {
+        boost::system::error_code ec;
+        size_t                    n = co_await self->stream_->async_read_some(
+            net::buffer(buffer), net::redirect_error(net::use_awaitable, ec));
+        if (self->state_ != State::Ready)
+            break;
+        if (ec) {
+            self->fail(ec == net::error::eof || ec == ssl::error::stream_truncated
+                           ? "HTTP/2 connection closed by peer"
+                           : ec.message());
+            break;
+        }
+
+        ssize_t rv = nghttp2_session_mem_recv(self->session_, buffer.data(), n);
+        if (rv < 0) {
+            self->fail(nghttp2_strerror(static_cast<int>(rv)));
+            break;
+        }
+        self->flush();
+        if (!nghttp2_session_want_read(self->session_)
+            && !nghttp2_session_want_write(self->session_)) {
+            self->fail("HTTP/2 session ended");
+            break;
+        }
+    }
+}
+
+void H2Connection::flush() {
+    // Only one write is in flight at a time; the running loop picks up anything queued
+    // in the session while it was suspended.
+    if (writing_ || state_ != State::Ready)
+        return;
+    writing_ = true;
+    net::co_spawn(strand_, write_loop(shared_from_this()), net::detached);
+}
+
+net::awaitable<void> H2Connection::write_loop(std::shared_ptr<H2Connection> self) {
+    std::vector<uint8_t> pending;
+    while (self->state_ == State::Ready) {
+        // Frames are copied out because the session may be torn down during the write.
+        pending.clear();
+        while (pending.size() < WRITE_BATCH_SIZE) {
+            const uint8_t* data = nullptr;
+            ssize_t        n    = nghttp2_session_mem_send(self->session_, &data);
+            if (n < 0) {
+                self->fail(nghttp2_strerror(static_cast<int>(n)));
+                break;
+            }
+            if (n == 0)
+                break;
+            pending.insert(pending.end(), data, data + n);
+        }
+        if (pending.empty() || self->state_ != State::Ready)
+            break;
+
+        boost::system::error_code ec;
+        co_await net::async_write(
+            *self->stream_, net::buffer(pending), net::redirect_error(net::use_awaitable, ec));
+        if (ec) {
+            self->fail(ec.message());
+            break;
+        }
+    }
+    self->writing_ = false;
+}
+
+void H2Connection::fail(const std::string& reason) {
+    if (state_ == State::Closed)
+        return;
+    state_         = State::Closed;
+    closed_        = true;
+    connect_error_ = reason;
+    for (auto& [id, stream] : streams_) {
+        if (stream->done)
+            continue;
+        stream->response.success    = false;
+        stream->response.error      = reason;
+        stream->response.error_type = ErrorType::Network;
+        complete(*stream);
+    }
+    if (stream_) {
+        beast::error_code ignored;
+        beast::get_lowest_layer(*stream_).socket().close(ignored);
+    }
+}
+
+void H2Connection::close_on_strand() {
+    if (state_ == State::Ready)
+        fail("HTTP/2 connection closed");
+}
+
+H2Connection::Stream* H2Connection::find_stream(int32_t stream_id) {
+    auto it = streams_.find(stream_id);
+    return it == streams_.end() ? nullptr : it->second.get();
+}
+
+void H2Connection::on_response_headers(int32_t stream_id, Stream& stream) {
+    auto& response = stream.response;
+    if (!Mojo::Core::is_fetchable_content_type(response.content_type)) {
+        response.skipped    = true;
+        response.error_type = ErrorType::Skipped;
+        response.error      = "Unwanted content type: " + response.content_type;
+        abort_stream(stream_id, stream);
+        return;
+    }
+    // A HEAD response advertises the size of a body that is never sent.
+    if (!stream.head_only && stream.content_length
+        && *stream.content_length > stream.options.max_body_size) {
+        response.skipped    = true;
+        response.error_type = ErrorType::Skipped;
+        response.error =
+            "Content-Length exceeds limit of " + std::to_string(stream.options.max_body_size);
+        abort_stream(stream_id, stream);
+        return;
+    }
+    stream.decoder = std::make_unique<Decompressor>(Decompressor::parse(stream.content_encoding),
+                                                    stream.options.max_decoded_size);
+}
+
+void H2Connection::abort_stream(int32_t stream_id, Stream& stream) {
+    // Resetting only this stream leaves the rest of the connection untouched, unlike
+    // HTTP/1.1 where an abandoned body costs the whole socket.
+    stream.aborted = true;
+    if (state_ == State::Ready) {
+        nghttp2_submit_rst_stream(session_, NGHTTP2_FLAG_NONE, stream_id, NGHTTP2_CANCEL);
+        flush();
+    }
+    complete(stream);
+}
+
+void H2Connection::complete(Stream& stream) {
+    stream.done = true;
+    stream.waiter->cancel();
+}
+
+int H2Connection::on_header(nghttp2_session* /*session*/,
+                            const nghttp2_frame* frame,
+                            const uint8_t*       name,
+                            size_t               namelen,
+                            const uint8_t*       value,
+                            size_t               valuelen,
+                            uint8_t /*flags*/,
+                            void* user_data) {
+    if (frame->hd.type != NGHTTP2_HEADERS)
+        return 0;
+    auto*   conn   = static_cast<H2Connection*>(user_data);
+    Stream* stream = conn->find_stream(frame->hd.stream_id);
+    if (!stream || stream->aborted || stream->decoder)
+        return 0;
+
+    std::string_view key(reinterpret_cast<const char*>(name), namelen);
+    std::string_view val(reinterpret_cast<const char*>(value), valuelen);
+    if (key == ":status") {
+        std::from_chars(val.data(), val.data() + val.size(), stream->response.status_code);
+    }
+    else if (key == "content-type") {
+        stream->response.content_type = std::string(val);
+    }
+    else if (key == "content-encoding") {
+        stream->content_encoding = std::string(val);
+    }
+    else if (key == "content-length") {
+        uint64_t length = 0;
+        auto [ptr, ec]  = std::from_chars(val.data(), val.data() + val.size(), length);
+        if (ec == std::errc())
+            stream->content_length = length;
+    }
+    return 0;
+}
+
+int H2Connection::on_frame_recv(nghttp2_session* /*session*/,
+                                const nghttp2_frame* frame,
+                                void*                user_data) {
+    auto* conn = static_cast<H2Connection*>(user_data);
+    if (frame->hd.type == NGHTTP2_GOAWAY) {
+        // Streams already accepted still complete, but new requests need a new connection.
+        conn->closed_ = true;
+        return 0;
+    }
+    if (frame->hd.type != NGHTTP2_HEADERS)
+        return 0;
+
+    Stream* stream = conn->find_stream(frame->hd.stream_id);
+    if (!stream || stream->aborted || stream->decoder)
+        return 0;
+    // Interim (1xx) responses are followed by the real header block.
+    if (stream->response.status_code >= 100 && stream->response.status_code < 200)
+        return 0;
+    conn->on_response_headers(frame->hd.stream_id, *stream);
+    return 0;
+}
+
+int H2Connection::on_data_chunk_recv(nghttp2_session* /*session*/,
+                                     uint8_t /*flags*/,
+                                     int32_t        stream_id,
+                                     const uint8_t* data,
+                                     size_t         len,
+                                     void*          user_data) {
+    auto*   conn   = static_cast<H2Connection*>(user_data);
+    Stream* stream = conn->find_stream(stream_id);
+    if (!stream || stream->aborted || !stream->decoder)
+        return 0;
+
+    auto&  response = stream->response;
+    size_t room     = stream->options.max_body_size - response.wire_bytes;
+    size_t take     = std::min(len, room);
+    response.wire_bytes += take;
+
+    if (!stream->decoder->feed(std::string_view(reinterpret_cast<const char*>(data), take),
+                               response.body)) {
+        response.success = false;
+        response.error   = stream->decoder->error();
+        if (stream->decoder->skipped()) {
+            response.skipped    = true;
+            response.error_type = ErrorType::Skipped;
+        }
+        else {
+            response.error_type = ErrorType::Other;
+        }
+        response.body.clear();
+        response.decoded_bytes = 0;
+        conn->abort_stream(stream_id, *stream);
+        return 0;
+    }
+    response.decoded_bytes = response.body.size();
+
+    if (take < len) {
+        response.truncated = true;
+        response.success   = (response.status_code >= 200 && response.status_code < 400);
+        conn->abort_stream(stream_id, *stream);
+    }
+    return 0;
+}
+
+int H2Connection::on_stream_close(nghttp2_session* /*session*/,
+                                  int32_t  stream_id,
+                                  uint32_t error_code,
+                                  void*    user_data) {
+    auto*   conn   = static_cast<H2Connection*>(user_data);
+    Stream* stream = conn->find_stream(stream_id);
+    if (!stream || stream->done)
+        return 0;
+
+    auto& response = stream->response;
+    if (error_code != NGHTTP2_NO_ERROR) {
+        response.success    = false;
+        response.error      = std::string("HTTP/2 stream reset: ")
+                         + nghttp2_http2_strerror(error_code);
+        response.error_type = ErrorType::Network;
+    }
+    // HEAD, 204 and 304 responses feed the decoder nothing, so there is no stream to end.
+    else if (stream->decoder && response.wire_bytes > 0 && !stream->decoder->finish()) {
+        response.success    = false;
+        response.skipped    = stream->decoder->skipped();
+        response.error      = stream->decoder->error();
+        response.error_type = response.skipped ? ErrorType::Skipped : ErrorType::Other;
+        response.body.clear();
+    }
+    else if (!stream->decoder) {
+        response.success    = false;
+        response.error      = "HTTP/2 stream closed without a response";
+        response.error_type = ErrorType::Network;
+    }
+    else {
+        response.decoded_bytes = response.body.size();
+        response.success       = (response.status_code >= 200 && response.status_code < 400);
+    }
+    conn->complete(*stream);
+    return 0;
+}
+
+net::execution_context::id H2ConnectionPool::id;
+
+H2ConnectionPool::H2ConnectionPool(net::execution_context& ctx)
+    : net::execution_context::service(ctx), ioc_(static_cast<net::io_context&>(ctx)) {
+}
+
+H2ConnectionPool& H2ConnectionPool::get(net::io_context& ioc) {
+    return net::use_service<H2ConnectionPool>(ioc);
+}
+
+std::shared_ptr<H2Connection> H2ConnectionPool::connection(const std::string& host,
+                                                           const std::string& port) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto&                       conn = connections_by_origin_[host + ":" + port];
+    if (!conn || (!conn->usable() && !conn->http1_only()))
+        conn = std::make_shared<H2Connection>(ioc_, host, port);
+    return conn;
+}
+
+H2Stats H2ConnectionPool::stats() const {
+    H2Stats s;
+    s.connections = connections_.load();
+    s.streams     = streams_.load();
+    s.fallbacks   = fallbacks_.load();
+    return s;
+}
+
+void H2ConnectionPool::close_all() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [origin, conn] : connections_by_origin_) {
+        if (conn->usable())
+            conn->close();
+    }
+}
+
+void H2ConnectionPool::shutdown() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    connections_by_origin_.clear();
+}
+
+}  // namespace Http
+}  // namespace Network
+}  // namespace Mojo
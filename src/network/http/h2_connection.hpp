@@ -0,0 +1,200 @@
+#pragma once
+
+#include <nghttp2/nghttp2.h>
+#include <atomic>
+#include <boost/asio.hpp>
+#include <boost/beast/http/verb.hpp>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "connection_pool.hpp"
+#include "decompressor.hpp"
+#include "http_client.hpp"
+
+namespace Mojo {
+namespace Network {
+namespace Http {
+
+class H2ConnectionPool;
+
+/**
+ * @brief Per-request limits, copied from the client that issued the request.
+ */
+struct H2RequestOptions {
+    size_t                    max_body_size    = Mojo::Core::Constants::DEFAULT_MAX_BODY_SIZE;
+    size_t                    max_decoded_size = Mojo::Core::Constants::MAX_DECODED_BODY_SIZE;
+    std::chrono::milliseconds connect_timeout{5000};
+};
+
+/**
+ * @brief One HTTP/2 connection to an origin, shared by every request to that origin.
+ *
+ * All session state lives on a strand: requests are co_spawned onto it, submitted to the
+ * nghttp2 session and then park on a per-stream timer until the read loop completes the
+ * stream. The first request connects; requests arriving meanwhile wait for the handshake.
+ * If ALPN does not select h2 the connection is marked HTTP/1.1-only and `request()`
+ * returns nullopt so the caller can fall back.
+ */
+class H2Connection : public std::enable_shared_from_this<H2Connection> {
+public:
+    H2Connection(boost::asio::io_context& ioc, std::string host, std::string port);
+    ~H2Connection();
+
+    boost::asio::awaitable<std::optional<Response>>
+    request(boost::beast::http::verb method, std::string target, H2RequestOptions options);
+
+    /// False once the connection has failed, was closed by the peer or is HTTP/1.1-only.
+    bool usable() const {
+        return !closed_.load();
+    }
+    /// True once the connection completed its handshake and started an HTTP/2 session.
+    bool established() const {
+        return established_.load();
+    }
+    bool http1_only() const {
+        return http1_.load();
+    }
+    void close();
+
+    H2Connection(const H2Connection&)            = delete;
+    H2Connection& operator=(const H2Connection&) = delete;
+
+private:
+    enum class State { Idle, Connecting, Ready, Closed };
+
+    struct Stream {
+        Response                                   response;
+        H2RequestOptions                           options;
+        std::unique_ptr<Decompressor>              decoder;
+        std::optional<uint64_t>                    content_length;
+        std::string                                content_encoding;
+        bool                                       head_only = false;
+        bool                                       aborted   = false;
+        bool                                       done      = false;
+        std::unique_ptr<boost::asio::steady_timer> waiter;
+    };
+
+    using Strand = boost::asio::strand<boost::asio::io_context::executor_type>;
+
+    static boost::asio::awaitable<std::optional<Response>>
+    request_on_strand(std::shared_ptr<H2Connection> self,
+                      boost::beast::http::verb      method,
+                      std::string                   target,
+                      H2RequestOptions              options);
+    static boost::asio::awaitable<void> read_loop(std::shared_ptr<H2Connection> self);
+    static boost::asio::awaitable<void> write_loop(std::shared_ptr<H2Connection> self);
+
+    boost::asio::awaitable<void> ensure_connected(std::chrono::milliseconds timeout);
+    boost::asio::awaitable<void> connect(std::chrono::milliseconds timeout);
+    void                         start_session();
+    void                         flush();
+    void                         fail(const std::string& reason);
+    void                         close_on_strand();
+
+    Stream* find_stream(int32_t stream_id);
+    void    on_response_headers(int32_t stream_id, Stream& stream);
+    void    abort_stream(int32_t stream_id, Stream& stream);
+    void    complete(Stream& stream);
+
+    static int on_header(nghttp2_session*     session,
+                         const nghttp2_frame* frame,
+                         const uint8_t*       name,
+                         size_t               namelen,
+                         const uint8_t*       value,
+                         size_t               valuelen,
+                         uint8_t              flags,
+                         void*                user_data);
+    static int on_frame_recv(nghttp2_session* session, const nghttp2_frame* frame, void* user_data);
+    static int on_data_chunk_recv(nghttp2_session* session,
+                                  uint8_t          flags,
+                                  int32_t          stream_id,
+                                  const uint8_t*   data,
+                                  size_t           len,
+                                  void*            user_data);
+    static int on_stream_close(nghttp2_session* session,
+                               int32_t          stream_id,
+                               uint32_t         error_code,
+                               void*            user_data);
+
+    Strand                     strand_;
+    H2ConnectionPool&          pool_;
+    std::string                host_;
+    std::string                port_;
+    std::unique_ptr<SslStream> stream_;
+    nghttp2_session*           session_ = nullptr;
+    State                      state_   = State::Idle;
+    std::string                connect_error_;
+    bool                       writing_ = false;
+
+    std::map<int32_t, std::unique_ptr<Stream>>               streams_;
+    std::vector<std::shared_ptr<boost::asio::steady_timer>> connect_waiters_;
+
+    std::atomic<bool> closed_{false};
+    std::atomic<bool> http1_{false};
+    std::atomic<bool> established_{false};
+};
+
+struct H2Stats {
+    uint64_t connections = 0;  // HTTP/2 connections opened
+    uint64_t streams     = 0;  // Requests multiplexed over them
+    uint64_t fallbacks   = 0;  // Requests sent over HTTP/1.1 because the origin lacks h2
+};
+
+/**
+ * @brief Registry of HTTP/2 connections on an io_context, one per origin.
+ *
+ * Registered as an asio service like ConnectionPool, so every H2Client on the same
+ * io_context multiplexes onto the same connection. Connections that failed or were
+ * closed are replaced on the next lookup; origins that negotiated HTTP/1.1 keep their
+ * (closed) entry so the fallback decision is not renegotiated on every request.
+ */
+class H2ConnectionPool : public boost::asio::execution_context::service {
+public:
+    static boost::asio::execution_context::id id;
+
+    explicit H2ConnectionPool(boost::asio::execution_context& ctx);
+    ~H2ConnectionPool() override = default;
+
+    static H2ConnectionPool& get(boost::asio::io_context& ioc);
+
+    std::shared_ptr<H2Connection> connection(const std::string& host, const std::string& port);
+
+    /// The context of the io_context's ConnectionPool, so both protocols trust the same CAs.
+    TlsContext& tls_context() {
+        return ConnectionPool::get(ioc_).tls_context();
+    }
+
+    void record_connection() {
+        connections_++;
+    }
+    void record_stream() {
+        streams_++;
+    }
+    void record_fallback() {
+        fallbacks_++;
+    }
+
+    H2Stats stats() const;
+    /// Closes every open connection so that their read loops stop holding the io_context.
+    void close_all();
+
+private:
+    void shutdown() override;
+
+    boost::asio::io_context&                                       ioc_;
+    std::mutex                                                     mutex_;
+    std::unordered_map<std::string, std::shared_ptr<H2Connection>> connections_by_origin_;
+
+    std::atomic<uint64_t> connections_{0};
+    std::atomic<uint64_t> streams_{0};
+    std::atomic<uint64_t> fallbacks_{0};
+};
+
+}  // namespace Http
+}  // namespace Network
+}  // namespace Mojo
@@ -29,6 +29,9 @@ struct Response {
     bool                     success    = false;
     bool                     skipped    = false;
     Network::Http::ErrorType error_type = Network::Http::ErrorType::None;
+    size_t                   wire_bytes    = 0;  // Body bytes as received (still encoded)
+    size_t                   decoded_bytes = 0;  // Body bytes after Content-Encoding decoding
+    bool                     truncated     = false;  // Body cut off at the size limit
 };
 
 namespace Network {
@@ -40,6 +43,7 @@ public:
 
     virtual void set_proxy(const std::string& proxy) = 0;
     virtual void set_connect_timeout(std::chrono::milliseconds /*timeout*/){};
+    virtual void set_max_body_size(size_t /*bytes*/){};
     virtual boost::asio::awaitable<Response> get(const std::string& url)  = 0;
     virtual boost::asio::awaitable<Response> head(const std::string& url) = 0;
 };
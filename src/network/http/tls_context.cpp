@@ -0,0 +1,116 @@
+#include "tls_context.hpp"
+#include "../../core/types/constants.hpp"
+
+namespace Mojo {
+namespace Network {
+namespace Http {
+
+namespace ssl = boost::asio::ssl;
+
+namespace {
+
+// asio keeps its verify callback in the context's app data, so the owner gets its own slot.
+int owner_index() {
+    static const int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+
+}  // namespace
+
+TlsContext& TlsContext::instance() {
+    static TlsContext instance;
+    return instance;
+}
+
+TlsContext::TlsContext(const std::string& extra_ca_pem) {
+    ctx_.set_default_verify_paths();
+    if (!extra_ca_pem.empty())
+        ctx_.add_certificate_authority(boost::asio::buffer(extra_ca_pem));
+    ctx_.set_verify_mode(ssl::verify_peer);
+
+    // Client-side cache only; OpenSSL's internal store is keyed by session id, which is
+    // useless to a client, so sessions are kept in our own per-host map instead.
+    SSL_CTX* native = ctx_.native_handle();
+    SSL_CTX_set_session_cache_mode(native,
+                                   SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(native, &TlsContext::on_new_session);
+    SSL_CTX_set_ex_data(native, owner_index(), this);
+}
+
+TlsContext::~TlsContext() {
+    clear_sessions();
+}
+
+bool TlsContext::prepare(SSL* ssl, const std::string& host) {
+    if (!SSL_set_tlsext_host_name(ssl, host.c_str()))
+        return false;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto                        it = sessions_.find(host);
+    if (it != sessions_.end()) {
+        // SSL_set_session takes its own reference, so the cached entry stays valid.
+        SSL_set_session(ssl, it->second.session);
+        lru_.splice(lru_.begin(), lru_, it->second.position);
+    }
+    return true;
+}
+
+void TlsContext::record_handshake(SSL* ssl) {
+    if (SSL_session_reused(ssl))
+        resumed_++;
+    else
+        full_++;
+}
+
+int TlsContext::on_new_session(SSL* ssl, SSL_SESSION* session) {
+    const char* host = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+    if (!host)
+        return 0;
+    SSL_CTX* native = SSL_get_SSL_CTX(ssl);
+    auto*    self   = static_cast<TlsContext*>(SSL_CTX_get_ex_data(native, owner_index()));
+    self->store_session(host, session);
+    // Returning 1 transfers ownership of `session` to us.
+    return 1;
+}
+
+void TlsContext::store_session(const std::string& host, SSL_SESSION* session) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto                        it = sessions_.find(host);
+    if (it != sessions_.end()) {
+        SSL_SESSION_free(it->second.session);
+        it->second.session = session;
+        lru_.splice(lru_.begin(), lru_, it->second.position);
+        return;
+    }
+
+    if (sessions_.size() >= Mojo::Core::Constants::DEFAULT_TLS_SESSION_CACHE_SIZE) {
+        auto victim = sessions_.find(lru_.back());
+        SSL_SESSION_free(victim->second.session);
+        sessions_.erase(victim);
+        lru_.pop_back();
+    }
+    lru_.push_front(host);
+    sessions_.emplace(host, Entry{session, lru_.begin()});
+}
+
+TlsStats TlsContext::stats() const {
+    TlsStats s;
+    s.full_handshakes    = full_.load();
+    s.resumed_handshakes = resumed_.load();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    s.cached_sessions = sessions_.size();
+    return s;
+}
+
+void TlsContext::clear_sessions() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [host, entry] : sessions_)
+        SSL_SESSION_free(entry.session);
+    sessions_.clear();
+    lru_.clear();
+}
+
+}  // namespace Http
+}  // namespace Network
+}  // namespace Mojo
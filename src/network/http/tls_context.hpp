@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <boost/asio/ssl.hpp>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace Mojo {
+namespace Network {
+namespace Http {
+
+struct TlsStats {
+    uint64_t full_handshakes    = 0;
+    uint64_t resumed_handshakes = 0;
+    size_t   cached_sessions    = 0;
+};
+
+/**
+ * @brief Client TLS context with a session cache keyed by SNI host.
+ *
+ * The trust store is set up by the constructor and the context is not modified afterwards,
+ * so it is safe to create streams from any thread. Sessions handed out by servers are stored
+ * per host and offered on the next handshake to the same host, turning it into an
+ * abbreviated (resumed) handshake when the server accepts it. The least recently used host
+ * is evicted once the cache is full.
+ *
+ * The crawler shares instance(); a context of its own (trusting an extra CA, say) is handed
+ * to a connection pool with ConnectionPool::set_tls_context.
+ */
+class TlsContext {
+public:
+    static TlsContext& instance();
+
+    /// Trusts the system CA bundle, plus the PEM certificate `extra_ca_pem` if not empty.
+    explicit TlsContext(const std::string& extra_ca_pem = "");
+    ~TlsContext();
+
+    const boost::asio::ssl::context& context() const {
+        return ctx_;
+    }
+
+    /// Builds a stream on the context; asio wants a mutable context, but only reads it here.
+    template <typename Stream, typename Executor>
+    std::unique_ptr<Stream> make_stream(const Executor& executor) {
+        return std::make_unique<Stream>(executor, ctx_);
+    }
+
+    /**
+     * @brief Sets SNI on `ssl` and attaches the cached session for `host`, if any.
+     * @return false if SNI could not be set.
+     */
+    bool prepare(SSL* ssl, const std::string& host);
+
+    /**
+     * @brief Records whether the completed handshake on `ssl` was resumed.
+     */
+    void record_handshake(SSL* ssl);
+
+    TlsStats stats() const;
+    void     clear_sessions();
+
+    TlsContext(const TlsContext&)            = delete;
+    TlsContext& operator=(const TlsContext&) = delete;
+
+private:
+    struct Entry {
+        SSL_SESSION*                     session;
+        std::list<std::string>::iterator position;  // In lru_
+    };
+
+    static int on_new_session(SSL* ssl, SSL_SESSION* session);
+    void       store_session(const std::string& host, SSL_SESSION* session);
+
+    boost::asio::ssl::context ctx_{boost::asio::ssl::context::tlsv12_client};
+
+    mutable std::mutex                     mutex_;
+    std::unordered_map<std::string, Entry> sessions_;
+    std::list<std::string>                 lru_;  // Most recently used host first
+
+    std::atomic<uint64_t> full_{0};
+    std::atomic<uint64_t> resumed_{0};
+};
+
+}  // namespace Http
+}  // namespace Network
+}  // namespace Mojo
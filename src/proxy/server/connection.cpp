@@ -7,6 +7,7 @@
 #include "../../binary/reader.hpp"
 #include "../../binary/writer.hpp"
 #include "../../core/logger/logger.hpp"
+#include "../../network/dns/dns_cache.hpp"
 #include "../../network/proxy/socks_handshake.hpp"
 #include "../../utils/url/url.hpp"
 #include "proxy_server.hpp"
@@ -21,7 +22,6 @@ using Pool::Proxy;
 Connection::Connection(boost::asio::ip::tcp::socket socket, ProxyServer* server)
     : client_socket_(std::move(socket)),
       upstream_socket_(server->io_context()),
-      resolver_(server->io_context()),
       server_(server),
       tunnel_buffer_c2u_(kBufferSize),
       tunnel_buffer_u2c_(kBufferSize) {
@@ -81,8 +81,8 @@ boost::asio::awaitable<void> Connection::do_resolve() {
     std::string p_port     = url_parsed.port.empty() ? "80" : url_parsed.port;
 
     try {
-        auto results = co_await resolver_.async_resolve(p_host, p_port, boost::asio::use_awaitable);
-        co_await                do_connect_upstream(results);
+        auto results = co_await Mojo::Network::Dns::DnsCache::instance().resolve(p_host, p_port);
+        co_await do_connect_upstream(results);
     } catch (...) {
         server_->proxy_pool().report(*current_proxy_, false);
         throw;
@@ -43,10 +43,9 @@ private:
     };
     bool parse_target_request(const std::string& data);
 
-    boost::asio::ip::tcp::socket   client_socket_;
-    boost::asio::ip::tcp::socket   upstream_socket_;
-    boost::asio::ip::tcp::resolver resolver_;
-    ProxyServer*                   server_;
+    boost::asio::ip::tcp::socket client_socket_;
+    boost::asio::ip::tcp::socket upstream_socket_;
+    ProxyServer*                 server_;
 
     boost::asio::streambuf client_buffer_;
     boost::asio::streambuf upstream_buffer_;
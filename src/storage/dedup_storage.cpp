@@ -0,0 +1,132 @@
+#include "dedup_storage.hpp"
+#include "../utils/crypto/murmur3.h"
+
+namespace Mojo {
+namespace Storage {
+
+DedupStorage::DedupStorage(std::unique_ptr<Storage> inner, size_t max_entries)
+    : inner_(std::move(inner)), max_entries_(max_entries) {
+}
+
+void DedupStorage::save(const std::string& key, const std::string& content, bool is_binary) {
+    store(key, content, is_binary, nullptr);
+}
+
+void DedupStorage::save_page(const std::string& key,
+                             const std::string& content,
+                             bool               is_binary,
+                             const FetchRecord& fetch) {
+    store(key, content, is_binary, &fetch);
+}
+
+void DedupStorage::store(const std::string& key,
+                         const std::string& content,
+                         bool               is_binary,
+                         const FetchRecord* fetch) {
+    uint64_t out[2];
+    MurmurHash3_x64_128(content.data(), static_cast<int>(content.size()), 0, out);
+    ContentHash hash{out[0], out[1]};
+
+    // A key saved again with another body no longer holds the old one; it must not be
+    // offered as that body's original any more.
+    forget_original(key, hash);
+
+    // The high half picks the shard, so the low half still spreads keys within it.
+    Shard&      shard = shards_[hash.high % SHARDS];
+    std::string original;
+    bool        claimed = false;  // This key is the hash's first, and publishes it once saved
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto                        it = shard.keys.find(hash);
+        if (it != shard.keys.end()) {
+            if (it->second.written && it->second.key != key)
+                original = it->second.key;
+        }
+        else if (entries_.load(std::memory_order_relaxed) < max_entries_) {
+            shard.keys.emplace(hash, Original{key});
+            entries_.fetch_add(1, std::memory_order_relaxed);
+            claimed = true;
+        }
+    }
+
+    if (original.empty()) {
+        save_full(key, content, is_binary, fetch);
+        if (claimed) {
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                auto                        it = shard.keys.find(hash);
+                if (it != shard.keys.end() && it->second.key == key)
+                    it->second.written = true;
+            }
+            Shard&                      owner = key_shard(key);
+            std::lock_guard<std::mutex> lock(owner.mutex);
+            owner.originals[key] = hash;
+        }
+        return;
+    }
+    if (inner_->save_duplicate(key, original, content, is_binary, fetch)) {
+        duplicates_.fetch_add(1, std::memory_order_relaxed);
+        bytes_saved_.fetch_add(content.size(), std::memory_order_relaxed);
+    }
+    else {
+        saved_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+DedupStorage::Shard& DedupStorage::key_shard(const std::string& key) {
+    return shards_[std::hash<std::string>{}(key) % SHARDS];
+}
+
+void DedupStorage::forget_original(const std::string& key, const ContentHash& hash) {
+    ContentHash stale{};
+    {
+        Shard&                      owner = key_shard(key);
+        std::lock_guard<std::mutex> lock(owner.mutex);
+        auto                        it = owner.originals.find(key);
+        if (it == owner.originals.end() || it->second == hash)
+            return;
+        stale = it->second;
+        owner.originals.erase(it);
+    }
+    Shard&                      shard = shards_[stale.high % SHARDS];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto                        it = shard.keys.find(stale);
+    if (it != shard.keys.end() && it->second.key == key) {
+        shard.keys.erase(it);
+        entries_.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void DedupStorage::save_full(const std::string& key,
+                             const std::string& content,
+                             bool               is_binary,
+                             const FetchRecord* fetch) {
+    saved_.fetch_add(1, std::memory_order_relaxed);
+    if (fetch)
+        inner_->save_page(key, content, is_binary, *fetch);
+    else
+        inner_->save(key, content, is_binary);
+}
+
+bool DedupStorage::save_duplicate(const std::string& key,
+                                  const std::string& original,
+                                  const std::string& content,
+                                  bool               is_binary,
+                                  const FetchRecord* fetch) {
+    return inner_->save_duplicate(key, original, content, is_binary, fetch);
+}
+
+void DedupStorage::flush() {
+    inner_->flush();
+}
+
+DedupStats DedupStorage::stats() const {
+    // Duplicates the backend linked after returning were counted as saved in full.
+    DeferredLinks later = inner_->deferred_links();
+    return {saved_.load(std::memory_order_relaxed) - later.count,
+            duplicates_.load(std::memory_order_relaxed) + later.count,
+            bytes_saved_.load(std::memory_order_relaxed) + later.bytes};
+}
+
+}  // namespace Storage
+}  // namespace Mojo
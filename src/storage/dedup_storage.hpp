@@ -0,0 +1,116 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "../core/types/constants.hpp"
+#include "storage.hpp"
+
+namespace Mojo {
+namespace Storage {
+
+struct DedupStats {
+    uint64_t saved       = 0;  // Bodies written in full
+    uint64_t duplicates  = 0;  // Bodies stored as references to an earlier key
+    uint64_t bytes_saved = 0;  // Content bytes not written again
+};
+
+/**
+ * @brief Exact content deduplication in front of another backend.
+ *
+ * Every body is hashed with 128-bit MurmurHash3. The first key saved with a given hash is
+ * written through `save()`; later keys with the same hash go to `save_duplicate()` naming
+ * that first key, which a backend can turn into a hard link or a manifest entry instead of
+ * another copy. Soft 404s, print views and localized aliases of one page are stored once.
+ *
+ * A hash is offered as an original only once its body has been written: a duplicate that
+ * arrives while the first copy is still being saved is written in full, so no link can name a
+ * file that is not there yet. Duplicates the backend could not link count as saved, and
+ * links a backend makes after returning (a write-behind queue) count once reported. An
+ * original saved again with a different body stops standing for the old one, so later
+ * copies of the old body are not linked to a file that now holds the new.
+ *
+ * At 128 bits two different bodies share a hash with probability about n^2 / 2^129, far
+ * below disk error rates for any crawl. Hashes sit in mutex-guarded shards; past
+ * `max_entries` new bodies are written without being remembered.
+ */
+class DedupStorage : public Storage {
+public:
+    explicit DedupStorage(std::unique_ptr<Storage> inner,
+                          size_t max_entries = Mojo::Core::Constants::DEDUP_MAX_ENTRIES);
+
+    void save(const std::string& key, const std::string& content, bool is_binary = false) override;
+    void save_page(const std::string& key,
+                   const std::string& content,
+                   bool               is_binary,
+                   const FetchRecord& fetch) override;
+    bool save_duplicate(const std::string& key,
+                        const std::string& original,
+                        const std::string& content,
+                        bool               is_binary = false,
+                        const FetchRecord* fetch     = nullptr) override;
+    bool wants_title() const override {
+        return inner_->wants_title();
+    }
+    DeferredLinks deferred_links() const override {
+        return inner_->deferred_links();
+    }
+    void flush() override;
+
+    /// Counts links the inner backend reports having made since, so call it after flush().
+    DedupStats stats() const;
+
+private:
+    static constexpr size_t SHARDS = 16;
+
+    struct ContentHash {
+        uint64_t low;
+        uint64_t high;
+
+        bool operator==(const ContentHash&) const = default;
+    };
+
+    struct ContentHashHasher {
+        size_t operator()(const ContentHash& hash) const {
+            return hash.low;
+        }
+    };
+
+    struct Original {
+        std::string key;
+        bool        written = false;  // Saved by the inner backend, so it can be linked to
+    };
+
+    struct alignas(64) Shard {
+        std::mutex                                                   mutex;
+        std::unordered_map<ContentHash, Original, ContentHashHasher> keys;
+        std::unordered_map<std::string, ContentHash>                 originals;  // Their hashes
+    };
+
+    /// The shard whose `originals` hold `key`; `keys` are sharded by hash instead.
+    Shard& key_shard(const std::string& key);
+    void   forget_original(const std::string& key, const ContentHash& hash);
+
+    void store(const std::string& key,
+               const std::string& content,
+               bool               is_binary,
+               const FetchRecord* fetch);
+    void save_full(const std::string& key,
+                   const std::string& content,
+                   bool               is_binary,
+                   const FetchRecord* fetch);
+
+    std::unique_ptr<Storage>  inner_;
+    size_t                    max_entries_;
+    std::array<Shard, SHARDS> shards_;
+    std::atomic<size_t>       entries_{0};
+    std::atomic<uint64_t>     saved_{0};
+    std::atomic<uint64_t>     duplicates_{0};
+    std::atomic<uint64_t>     bytes_saved_{0};
+};
+
+}  // namespace Storage
+}  // namespace Mojo
@@ -1,44 +1,459 @@
 #include "disk_storage.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <stdexcept>
 #include "../core/logger/logger.hpp"
+#include "../core/types/constants.hpp"
+#include "../utils/crypto/murmur3.h"
 
 namespace Mojo {
 namespace Storage {
 
-DiskStorage::DiskStorage(const std::string& base_path) : base_path_(base_path) {
+namespace {
+
+constexpr int FILE_FLAGS = O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC;
+
+bool write_all(int fd, const std::string& data) {
+    size_t done = 0;
+    while (done < data.size()) {
+        ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+std::string parent_of(const std::string& path) {
+    return std::filesystem::path(path).parent_path().string();
+}
+
+int open_directory(const std::string& dir) {
+    return ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+}
+
+}  // namespace
+
+DiskStorage::DiskStorage(const std::string& base_path, const DiskOptions& options)
+    : base_path_(base_path), options_(options) {
+    options_.hash_dirs = std::clamp(options_.hash_dirs, 0, 4);
     if (!base_path_.empty()) {
         try {
             std::filesystem::create_directories(base_path_);
+            directories_.insert(base_path_);
         } catch (...) {
             Mojo::Core::Logger::error("Failed to create storage directory: " + base_path_);
         }
     }
+    if (options_.write_behind) {
+        for (size_t i = 0; i < Mojo::Core::Constants::DISK_WRITERS; ++i)
+            writers_.push_back(std::make_unique<Writer>());
+        for (auto& writer : writers_)
+            writer->thread = std::thread([this, w = writer.get()] { run(*w); });
+    }
+}
+
+DiskStorage::~DiskStorage() {
+    for (auto& writer : writers_) {
+        {
+            std::lock_guard<std::mutex> lock(writer->mutex);
+            writer->stopping = true;
+        }
+        writer->work.notify_one();
+    }
+    for (auto& writer : writers_) {
+        writer->thread.join();
+        for (const auto& [dir, entry] : writer->directory_fds)
+            ::close(entry.fd);
+    }
+}
+
+FsyncPolicy DiskStorage::parse_fsync(const std::string& name) {
+    if (name == "none")
+        return FsyncPolicy::NONE;
+    if (name == "batch")
+        return FsyncPolicy::PER_BATCH;
+    if (name == "file")
+        return FsyncPolicy::PER_FILE;
+    throw std::invalid_argument("Unknown fsync policy: " + name);
+}
+
+int DiskStorage::create_file(int dir_fd, const char* name) {
+    int fd = ::openat(dir_fd, name, FILE_FLAGS, 0644);
+    if (fd < 0 && errno == EEXIST && ::unlinkat(dir_fd, name, 0) == 0)
+        fd = ::openat(dir_fd, name, FILE_FLAGS, 0644);
+    return fd;
+}
+
+std::string DiskStorage::path_for(const std::string& key) const {
+    std::filesystem::path path(base_path_);
+    if (options_.hash_dirs > 0) {
+        static constexpr char HEX[] = "0123456789abcdef";
+        uint64_t              hash[2];
+        MurmurHash3_x64_128(key.data(), static_cast<int>(key.size()), 42, hash);
+        for (int level = 0; level < options_.hash_dirs; ++level) {
+            auto byte = static_cast<uint8_t>(hash[0] >> (8 * level));
+            path /= std::string{HEX[byte >> 4], HEX[byte & 15]};
+        }
+    }
+    path /= key;
+    return path.string();
+}
+
+bool DiskStorage::ensure_directory(const std::string& dir) {
+    if (dir.empty())
+        return true;
+    std::lock_guard<std::mutex> lock(directories_mutex_);
+    if (directories_.count(dir))
+        return true;
+    std::error_code error;
+    std::filesystem::create_directories(dir, error);
+    if (error) {
+        Mojo::Core::Logger::error("FS Error: " + error.message() + " creating " + dir);
+        return false;
+    }
+    directories_.insert(dir);
+    return true;
+}
+
+void DiskStorage::forget_directory(const std::string& dir) {
+    std::lock_guard<std::mutex> lock(directories_mutex_);
+    directories_.erase(dir);
 }
 
-void DiskStorage::save(const std::string& key, const std::string& content, bool is_binary) {
+bool DiskStorage::sync(int fd) {
+    syncs_.fetch_add(1, std::memory_order_relaxed);
+    return ::fsync(fd) == 0;
+}
+
+void DiskStorage::save(const std::string& key, const std::string& content, bool /*is_binary*/) {
     try {
-        std::filesystem::path path(base_path_);
-        path /= key;
+        std::string path = path_for(key);
+        if (options_.write_behind)
+            enqueue({std::move(path), content, {}});
+        else
+            write_now(path, content);
+    } catch (const std::exception& e) {
+        Mojo::Core::Logger::error("FS Error: " + std::string(e.what()));
+    } catch (...) {
+        Mojo::Core::Logger::error("FS Error: Unknown exception working with " + key);
+    }
+}
 
-        if (path.has_parent_path()) {
-            std::filesystem::create_directories(path.parent_path());
+void DiskStorage::write_now(const std::string& path, const std::string& data) {
+    std::string dir = parent_of(path);
+    ensure_directory(dir);
+    int fd = create_file(AT_FDCWD, path.c_str());
+    if (fd < 0 && errno == ENOENT) {
+        // Removed since it was created
+        forget_directory(dir);
+        ensure_directory(dir);
+        fd = create_file(AT_FDCWD, path.c_str());
+    }
+    if (fd < 0) {
+        Mojo::Core::Logger::error("Write Error: " + path);
+        return;
+    }
+
+    bool ok = write_all(fd, data);
+    if (ok && options_.fsync != FsyncPolicy::NONE) {
+        // A save is a batch of one, so both policies sync the file and its directory.
+        ok         = sync(fd);
+        int dir_fd = open_directory(dir);
+        if (dir_fd >= 0) {
+            ok = sync(dir_fd) && ok;
+            ::close(dir_fd);
         }
+    }
+    ::close(fd);
+    batches_.fetch_add(1, std::memory_order_relaxed);
+
+    if (ok) {
+        files_.fetch_add(1, std::memory_order_relaxed);
+        bytes_.fetch_add(data.size(), std::memory_order_relaxed);
+        Mojo::Core::Logger::success("Saved: " + path);
+    }
+    else {
+        Mojo::Core::Logger::error("Write Error: " + path);
+    }
+}
+
+bool DiskStorage::save_duplicate(const std::string& key,
+                                 const std::string& original,
+                                 const std::string& content,
+                                 bool               is_binary,
+                                 const FetchRecord* /*fetch*/) {
+    bool linked = false;
+    try {
+        std::string path  = path_for(key);
+        std::string first = path_for(original);
 
-        std::ofstream file(path, is_binary ? std::ios::binary : std::ios::out);
-        if (file.is_open()) {
-            file.write(content.data(), content.size());
-            Mojo::Core::Logger::success("Saved: " + path.string());
+        if (options_.write_behind) {
+            enqueue({std::move(path), content, std::move(first)});
         }
         else {
-            Mojo::Core::Logger::error("Write Error: " + path.string());
+            ensure_directory(parent_of(path));
+            // A link cannot replace an existing file, so a page saved again is unlinked first.
+            std::error_code error;
+            std::filesystem::remove(path, error);
+            std::filesystem::create_hard_link(first, path, error);
+            if (error) {
+                save(key, content, is_binary);
+            }
+            else {
+                Mojo::Core::Logger::success("Linked: " + path + " -> " + original);
+                links_.fetch_add(1, std::memory_order_relaxed);
+                linked = true;
+            }
         }
+
+        std::lock_guard<std::mutex> lock(manifest_mutex_);
+        if (!manifest_.is_open()) {
+            std::filesystem::path manifest(base_path_);
+            manifest /= Mojo::Core::Constants::DEDUP_MANIFEST;
+            manifest_.open(manifest, std::ios::app);
+        }
+        manifest_ << key << '\t' << original << '\n' << std::flush;
     } catch (const std::exception& e) {
         Mojo::Core::Logger::error("FS Error: " + std::string(e.what()));
     } catch (...) {
         Mojo::Core::Logger::error("FS Error: Unknown exception working with " + key);
     }
+    return linked;
+}
+
+DiskStorage::Writer& DiskStorage::writer_for(const std::string& path) {
+    return *writers_[std::hash<std::string>{}(path) % writers_.size()];
+}
+
+void DiskStorage::enqueue(Job job) {
+    // Each writer gets an equal share of the cap on queued bytes.
+    const size_t limit  = Mojo::Core::Constants::DISK_MAX_PENDING / writers_.size();
+    Writer&      writer = writer_for(job.path);
+    if (!job.link.empty()) {
+        // The original may still be queued on another writer; the link waits until every
+        // job queued there so far is written, the original among them.
+        Writer& owner = writer_for(job.link);
+        if (&owner != &writer) {
+            std::lock_guard<std::mutex> lock(owner.mutex);
+            if (owner.written < owner.queued) {
+                job.original     = &owner;
+                job.queued_ahead = owner.queued;
+            }
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(writer.mutex);
+    writer.done.wait(lock,
+                     [&] { return writer.pending_bytes < limit || writer.pending_bytes == 0; });
+    writer.pending_bytes += job.data.size();
+    writer.queued++;
+    writer.pending.push_back(std::move(job));
+    lock.unlock();
+    writer.work.notify_one();
+}
+
+void DiskStorage::flush() {
+    for (auto& writer : writers_) {
+        std::unique_lock<std::mutex> lock(writer->mutex);
+        writer->done.wait(lock, [&] { return writer->pending.empty() && !writer->busy; });
+    }
+}
+
+DiskStats DiskStorage::stats() const {
+    return {files_.load(std::memory_order_relaxed),
+            bytes_.load(std::memory_order_relaxed),
+            batches_.load(std::memory_order_relaxed),
+            syncs_.load(std::memory_order_relaxed),
+            links_.load(std::memory_order_relaxed)};
+}
+
+DeferredLinks DiskStorage::deferred_links() const {
+    return {deferred_links_.load(std::memory_order_relaxed),
+            deferred_bytes_.load(std::memory_order_relaxed)};
+}
+
+void DiskStorage::run(Writer& writer) {
+    std::vector<Job> batch;
+    batch.reserve(Mojo::Core::Constants::DISK_BATCH_FILES);
+
+    std::unique_lock<std::mutex> lock(writer.mutex);
+    while (true) {
+        writer.work.wait(lock, [&] { return writer.stopping || !writer.pending.empty(); });
+        if (writer.pending.empty())
+            return;
+
+        size_t bytes = 0;
+        while (!writer.pending.empty()
+               && batch.size() < Mojo::Core::Constants::DISK_BATCH_FILES) {
+            bytes += writer.pending.front().data.size();
+            batch.push_back(std::move(writer.pending.front()));
+            writer.pending.pop_front();
+        }
+        uint64_t taken = writer.written + batch.size();
+        writer.busy = true;
+        lock.unlock();
+
+        try {
+            write_batch(writer, batch);
+        } catch (const std::exception& e) {
+            // Files written before the failure are counted; the rest of the batch is lost.
+            Mojo::Core::Logger::error("Write-behind batch failed: " + std::string(e.what()));
+        } catch (...) {
+            Mojo::Core::Logger::error("Write-behind batch failed: unknown exception");
+        }
+        batches_.fetch_add(1, std::memory_order_relaxed);
+
+        lock.lock();
+        writer.written = taken;  // Also past jobs a failed batch lost, so no link waits on them
+        writer.pending_bytes -= bytes;
+        writer.busy = false;
+        batch.clear();
+        writer.done.notify_all();
+    }
+}
+
+int DiskStorage::directory_fd(Writer& writer, const std::string& dir) {
+    auto it = writer.directory_fds.find(dir);
+    if (it != writer.directory_fds.end()) {
+        writer.directory_lru.splice(
+            writer.directory_lru.begin(), writer.directory_lru, it->second.position);
+        return it->second.fd;
+    }
+    if (!ensure_directory(dir))
+        return -1;
+    int fd = open_directory(dir);
+    if (fd < 0)
+        return -1;
+    if (writer.directory_fds.size() >= Mojo::Core::Constants::DISK_DIR_FDS)
+        close_directory_fd(writer, writer.directory_lru.back());
+    writer.directory_lru.push_front(dir);
+    writer.directory_fds.emplace(dir, DirectoryFd{fd, writer.directory_lru.begin()});
+    return fd;
+}
+
+void DiskStorage::close_directory_fd(Writer& writer, const std::string& dir) {
+    auto it = writer.directory_fds.find(dir);
+    if (it == writer.directory_fds.end())
+        return;
+    ::close(it->second.fd);
+    writer.directory_lru.erase(it->second.position);
+    writer.directory_fds.erase(it);
+}
+
+void DiskStorage::wait_written(Writer& writer, uint64_t count) {
+    std::unique_lock<std::mutex> lock(writer.mutex);
+    writer.done.wait(lock, [&] { return writer.written >= count; });
+}
+
+void DiskStorage::write_job(Writer&                                  writer,
+                            const Job&                               job,
+                            std::vector<std::pair<int, const Job*>>& unsynced,
+                            std::unordered_set<std::string>&         touched) {
+    std::filesystem::path path(job.path);
+    std::string           dir  = path.parent_path().string();
+    std::string           name = path.filename().string();
+    int                   dfd  = directory_fd(writer, dir);
+    int                   fd   = -1;
+    if (dfd >= 0 && !job.link.empty()) {
+        // A link cannot replace an existing file, so a page saved again is unlinked first.
+        ::unlinkat(dfd, name.c_str(), 0);
+        if (::linkat(AT_FDCWD, job.link.c_str(), dfd, name.c_str(), 0) == 0) {
+            Mojo::Core::Logger::success("Linked: " + job.path + " -> " + job.link);
+            links_.fetch_add(1, std::memory_order_relaxed);
+            deferred_links_.fetch_add(1, std::memory_order_relaxed);
+            deferred_bytes_.fetch_add(job.data.size(), std::memory_order_relaxed);
+            if (options_.fsync != FsyncPolicy::NONE)
+                touched.insert(dir);
+            return;
+        }
+    }
+    if (dfd >= 0)
+        fd = create_file(dfd, name.c_str());
+    if (fd < 0 && errno == ENOENT) {
+        // The directory was removed since its descriptor was opened
+        close_directory_fd(writer, dir);
+        forget_directory(dir);
+        dfd = directory_fd(writer, dir);
+        if (dfd >= 0)
+            fd = create_file(dfd, name.c_str());
+    }
+    if (fd < 0) {
+        Mojo::Core::Logger::error("Write Error: " + job.path);
+        return;
+    }
+
+    if (!write_all(fd, job.data)) {
+        ::close(fd);
+        Mojo::Core::Logger::error("Write Error: " + job.path);
+        return;
+    }
+    switch (options_.fsync) {
+        case FsyncPolicy::NONE:
+            ::close(fd);
+            break;
+        case FsyncPolicy::PER_BATCH:
+#ifdef __linux__
+            // Start writeback now, so the syncs at the end of the batch find it under way.
+            ::sync_file_range(fd, 0, 0, SYNC_FILE_RANGE_WRITE);
+#endif
+            unsynced.emplace_back(fd, &job);
+            touched.insert(dir);
+            return;
+        case FsyncPolicy::PER_FILE: {
+            bool ok = sync(fd);
+            ::close(fd);
+            if (!ok || !sync(dfd)) {
+                Mojo::Core::Logger::error("Sync Error: " + job.path);
+                return;
+            }
+            break;
+        }
+    }
+    files_.fetch_add(1, std::memory_order_relaxed);
+    bytes_.fetch_add(job.data.size(), std::memory_order_relaxed);
+    Mojo::Core::Logger::success("Saved: " + job.path);
+}
+
+void DiskStorage::write_batch(Writer& writer, std::vector<Job>& batch) {
+    std::vector<std::pair<int, const Job*>> unsynced;
+    std::unordered_set<std::string>         touched;
+
+    for (const auto& job : batch) {
+        if (job.original)
+            wait_written(*job.original, job.queued_ahead);
+        write_job(writer, job, unsynced, touched);
+        {
+            std::lock_guard<std::mutex> lock(writer.mutex);
+            ++writer.written;
+        }
+        writer.done.notify_all();
+    }
+
+    // Group commit: one pass of syncs covers every file written above
+    for (const auto& [fd, job] : unsynced) {
+        bool ok = sync(fd);
+        ::close(fd);
+        if (!ok) {
+            Mojo::Core::Logger::error("Sync Error: " + job->path);
+            continue;
+        }
+        files_.fetch_add(1, std::memory_order_relaxed);
+        bytes_.fetch_add(job->data.size(), std::memory_order_relaxed);
+        Mojo::Core::Logger::success("Saved: " + job->path);
+    }
+    for (const auto& dir : touched) {
+        int dfd = directory_fd(writer, dir);
+        if (dfd < 0 || !sync(dfd))
+            Mojo::Core::Logger::error("Sync Error: " + dir);
+    }
 }
 
 }  // namespace Storage
@@ -1,19 +1,175 @@
 #pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include "storage.hpp"
 
 namespace Mojo {
 namespace Storage {
 
+enum class FsyncPolicy {
+    NONE,       // Leave writeback to the kernel
+    PER_BATCH,  // Group commit: sync every file of a batch, then their directories, once
+    PER_FILE,   // Sync each file and its directory before the next one is written
+};
+
+struct DiskOptions {
+    bool        write_behind = false;  // Queue saves for writer threads instead of blocking
+    int         hash_dirs    = 0;      // Levels of 256 hash-named directories above each file
+    FsyncPolicy fsync        = FsyncPolicy::NONE;
+};
+
+struct DiskStats {
+    uint64_t files   = 0;
+    uint64_t bytes   = 0;
+    uint64_t batches = 0;  // Write-behind rounds; every synchronous save counts as one
+    uint64_t syncs   = 0;  // fsync/fdatasync calls, files and directories
+    uint64_t links   = 0;  // Duplicates stored as hard links
+};
+
+/**
+ * @brief Writes each key as a file under the base path.
+ *
+ * Directories are created once and remembered, so a crawl does not stat its way down the
+ * same path for every page. `hash_dirs` spreads files over 256^n directories named by the
+ * key's hash (`3f/a1/key`), keeping a flat crawl's directory small enough to stay fast.
+ *
+ * With write-behind, save() queues the file and returns, and DISK_WRITERS writer threads
+ * drain the queues in batches; a file's path picks its writer. Measured with four callers
+ * saving 4 KiB files to ext4, the writers keep pace with direct writes when nothing is synced,
+ * and with batch fsync, one group commit per batch, they save one and a half to two times as
+ * many files per second as callers syncing each file themselves. Each writer keeps
+ * descriptors of recently used directories open (closing the least recently used past
+ * DISK_DIR_FDS) and creates files with openat() relative to them, so a path is resolved once
+ * per directory rather than once per file. Queued bytes are capped; past the cap save()
+ * waits. A duplicate's link is made when its writer reaches it, after whatever writer holds
+ * the original has written every job queued ahead of the link: an original queued before it
+ * is on disk by then, and one that is not (never queued, or its write failed) gets a full
+ * copy instead.
+ */
 class DiskStorage : public Storage {
 public:
-    explicit DiskStorage(const std::string& base_path);
-    ~DiskStorage() override = default;
+    explicit DiskStorage(const std::string& base_path, const DiskOptions& options = {});
+    ~DiskStorage() override;
+
+    DiskStorage(const DiskStorage&)            = delete;
+    DiskStorage& operator=(const DiskStorage&) = delete;
 
     void save(const std::string& key, const std::string& content, bool is_binary = false) override;
 
+    /**
+     * @brief Hard-links `key` to the file of `original` and appends "key<TAB>original" to the
+     * manifest at the root of the output, so readers can skip known copies. Falls back to a
+     * full write when the link cannot be made (original missing, filesystem without links).
+     * @return Whether the link was made. With write-behind, false: the writer makes the link
+     * or the copy later and reports links it made through deferred_links().
+     */
+    bool save_duplicate(const std::string& key,
+                        const std::string& original,
+                        const std::string& content,
+                        bool               is_binary = false,
+                        const FetchRecord* fetch     = nullptr) override;
+
+    /// With write-behind, returns once every queued save is written (and synced, per policy).
+    void flush() override;
+
+    DeferredLinks deferred_links() const override;
+
+    DiskStats stats() const;
+
+    /// Where `key` is stored: under the base path, behind its hash directories if any.
+    std::string path_for(const std::string& key) const;
+
+    /// "none", "batch" or "file"; throws std::invalid_argument otherwise.
+    static FsyncPolicy parse_fsync(const std::string& name);
+
+    /**
+     * @brief Creates `name` under `dir_fd` (or AT_FDCWD) for writing. A file already there is
+     * unlinked and created anew rather than truncated: duplicates may be hard links to it,
+     * and they must keep the body they were linked to.
+     * @return The descriptor, or -1 with errno set.
+     */
+    static int create_file(int dir_fd, const char* name);
+
 private:
+    struct Writer;
+
+    struct Job {
+        std::string path;
+        std::string data;
+        std::string link;                    // Path of the original, for a duplicate
+        Writer*     original     = nullptr;  // Another writer that may still hold the original
+        uint64_t    queued_ahead = 0;        // Jobs it had queued; the link waits for them
+    };
+
+    struct DirectoryFd {
+        int                              fd;
+        std::list<std::string>::iterator position;  // In directory_lru
+    };
+
+    // One writer thread and its queue. A path always goes to the same writer, so saves of one
+    // file reach the disk in the order they were made.
+    struct Writer {
+        std::mutex              mutex;
+        std::condition_variable work;  // Jobs queued, or stopping
+        std::condition_variable done;  // A job or batch finished
+        std::deque<Job>         pending;
+        size_t                  pending_bytes = 0;
+        bool                    busy          = false;  // The thread holds a batch
+        bool                    stopping      = false;
+        uint64_t                queued        = 0;      // Jobs ever queued
+        uint64_t                written       = 0;      // Of those, jobs the thread is done with
+        std::thread             thread;
+
+        // Only touched by the thread; past DISK_DIR_FDS the least recently used is closed
+        std::list<std::string>                       directory_lru;  // Most recent first
+        std::unordered_map<std::string, DirectoryFd> directory_fds;
+    };
+
+    bool    ensure_directory(const std::string& dir);
+    void    forget_directory(const std::string& dir);
+    void    write_now(const std::string& path, const std::string& data);
+    Writer& writer_for(const std::string& path);
+    void    enqueue(Job job);
+    void    run(Writer& writer);
+    void    write_batch(Writer& writer, std::vector<Job>& batch);
+    void    write_job(Writer&                                  writer,
+                      const Job&                               job,
+                      std::vector<std::pair<int, const Job*>>& unsynced,
+                      std::unordered_set<std::string>&         touched);
+    void    wait_written(Writer& writer, uint64_t count);
+    int     directory_fd(Writer& writer, const std::string& dir);
+    void    close_directory_fd(Writer& writer, const std::string& dir);
+    bool    sync(int fd);
+
     std::string base_path_;
+    DiskOptions options_;
+
+    std::mutex    manifest_mutex_;
+    std::ofstream manifest_;  // Opened on the first duplicate
+
+    std::mutex                      directories_mutex_;
+    std::unordered_set<std::string> directories_;  // Known to exist
+
+    std::atomic<uint64_t> files_{0};
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<uint64_t> syncs_{0};
+    std::atomic<uint64_t> links_{0};
+    std::atomic<uint64_t> deferred_links_{0};  // Made by a writer
+    std::atomic<uint64_t> deferred_bytes_{0};
+
+    std::vector<std::unique_ptr<Writer>> writers_;  // DISK_WRITERS with write-behind, else none
 };
 
 }  // namespace Storage
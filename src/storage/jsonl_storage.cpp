@@ -0,0 +1,286 @@
+#include "jsonl_storage.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include "../core/logger/logger.hpp"
+#ifdef MOJO_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace Mojo {
+namespace Storage {
+
+namespace {
+
+using Clock = std::chrono::system_clock;
+
+std::string utc_date(Clock::time_point time, const char* format) {
+    std::time_t seconds = Clock::to_time_t(time);
+    std::tm     utc{};
+    gmtime_r(&seconds, &utc);
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), format, &utc);
+    return buffer;
+}
+
+std::string iso_date(Clock::time_point time) {
+    return utc_date(time, "%Y-%m-%dT%H:%M:%SZ");
+}
+
+/// Length of the UTF-8 sequence starting at `s[0]`, or 0 if it is not a valid one.
+size_t utf8_length(const unsigned char* s, size_t available) {
+    unsigned char c = s[0];
+    size_t        length;
+    uint32_t      min;
+    uint32_t      code;
+    if (c >= 0xC2 && c <= 0xDF) {
+        length = 2;
+        min    = 0x80;
+        code   = c & 0x1F;
+    }
+    else if (c >= 0xE0 && c <= 0xEF) {
+        length = 3;
+        min    = 0x800;
+        code   = c & 0x0F;
+    }
+    else if (c >= 0xF0 && c <= 0xF4) {
+        length = 4;
+        min    = 0x10000;
+        code   = c & 0x07;
+    }
+    else {
+        return 0;
+    }
+    if (available < length)
+        return 0;
+    for (size_t i = 1; i < length; ++i) {
+        if ((s[i] & 0xC0) != 0x80)
+            return 0;
+        code = (code << 6) | (s[i] & 0x3F);
+    }
+    // Overlong forms, UTF-16 surrogates and code points past U+10FFFF are all invalid
+    if (code < min || (code >= 0xD800 && code <= 0xDFFF) || code > 0x10FFFF)
+        return 0;
+    return length;
+}
+
+}  // namespace
+
+JsonlStorage::JsonlStorage(
+    const std::string& dir, size_t shards, uint64_t roll_size, bool zstd, size_t flush_size)
+    : dir_(dir), roll_size_(roll_size > 0 ? roll_size : Mojo::Core::Constants::WARC_ROLL_SIZE),
+      flush_size_(static_cast<size_t>(std::min<uint64_t>(flush_size, roll_size_))), zstd_(zstd),
+      run_(utc_date(Clock::now(), "%Y%m%d%H%M%S")) {
+    static std::atomic<uint64_t> next_id{1};
+    id_ = next_id.fetch_add(1, std::memory_order_relaxed);
+
+#ifndef MOJO_HAVE_ZSTD
+    if (zstd_) {
+        Mojo::Core::Logger::warn("Built without libzstd; JSONL output is written uncompressed");
+        zstd_ = false;
+    }
+#endif
+    for (size_t i = 0; i < std::max<size_t>(1, shards); ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+        shards_.back()->index = i;
+    }
+    try {
+        std::filesystem::create_directories(dir_);
+    } catch (...) {
+        Mojo::Core::Logger::error("Failed to create storage directory: " + dir_);
+    }
+}
+
+JsonlStorage::~JsonlStorage() {
+    flush();
+}
+
+void JsonlStorage::append_json_string(std::string& out, std::string_view value) {
+    static constexpr char HEX[] = "0123456789abcdef";
+    out += '"';
+    const auto* s     = reinterpret_cast<const unsigned char*>(value.data());
+    size_t      n     = value.size();
+    size_t      plain = 0;  // Start of the run copied as is
+    for (size_t i = 0; i < n;) {
+        unsigned char c = s[i];
+        if (c >= 0x20 && c != '"' && c != '\\' && c < 0x80) {
+            i++;
+            continue;
+        }
+        size_t length = c >= 0x80 ? utf8_length(s + i, n - i) : 0;
+        if (length > 0) {
+            i += length;
+            continue;
+        }
+
+        out.append(value.data() + plain, i - plain);
+        switch (c) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                if (c < 0x20) {
+                    out += "\\u00";
+                    out += HEX[c >> 4];
+                    out += HEX[c & 15];
+                }
+                else {
+                    out += "\xEF\xBF\xBD";  // U+FFFD for a byte that is not valid UTF-8
+                }
+        }
+        plain = ++i;
+    }
+    out.append(value.data() + plain, n - plain);
+    out += '"';
+}
+
+JsonlStorage::Shard& JsonlStorage::local_shard() {
+    struct Claim {
+        uint64_t owner = 0;
+        size_t   index = 0;
+    };
+    thread_local Claim claim;
+    if (claim.owner != id_)
+        claim = {id_, next_shard_.fetch_add(1, std::memory_order_relaxed) % shards_.size()};
+    return *shards_[claim.index];
+}
+
+void JsonlStorage::save(const std::string& key, const std::string& content, bool is_binary) {
+    append(key, {}, is_binary ? std::string_view() : content, iso_date(Clock::now()), 0);
+}
+
+void JsonlStorage::save_page(const std::string& key,
+                             const std::string& content,
+                             bool               is_binary,
+                             const FetchRecord& fetch) {
+    append(fetch.url.empty() ? std::string_view(key) : fetch.url,
+           fetch.title,
+           is_binary ? std::string_view() : content,
+           iso_date(fetch.fetched_at),
+           fetch.status);
+}
+
+void JsonlStorage::append(std::string_view url,
+                          std::string_view title,
+                          std::string_view markdown,
+                          std::string_view fetched_at,
+                          long             status) {
+    Shard&                      shard = local_shard();
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    std::string&                out = shard.buffer;
+    out += "{\"url\":";
+    append_json_string(out, url);
+    out += ",\"title\":";
+    append_json_string(out, title);
+    out += ",\"markdown\":";
+    append_json_string(out, markdown);
+    out += ",\"fetched_at\":\"";
+    out += fetched_at;
+    out += "\",\"status\":";
+    out += std::to_string(status);
+    out += "}\n";
+    shard.records++;
+
+    if (out.size() >= flush_size_)
+        write_out(shard);
+}
+
+void JsonlStorage::write_out(Shard& shard) {
+    if (shard.buffer.empty())
+        return;
+
+    if (!shard.file.is_open() || shard.file_bytes >= roll_size_) {
+        shard.file.close();
+        // A name already taken by another run started in the same second is skipped, never
+        // truncated.
+        std::filesystem::path path;
+        while (true) {
+            char name[96];
+            std::snprintf(name,
+                          sizeof(name),
+                          "%s-%s-%03zu-%05llu.jsonl%s",
+                          Mojo::Core::Constants::JSONL_PREFIX,
+                          run_.c_str(),
+                          shard.index,
+                          static_cast<unsigned long long>(shard.serial++),
+                          zstd_ ? ".zst" : "");
+            path   = std::filesystem::path(dir_) / name;
+            int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+            if (fd >= 0) {
+                ::close(fd);
+                shard.file.open(path, std::ios::binary | std::ios::app);
+                break;
+            }
+            if (errno != EEXIST)
+                break;
+        }
+        shard.file_bytes = 0;
+        shard.files++;
+        if (!shard.file.is_open()) {
+            Mojo::Core::Logger::error("Write Error: " + path.string());
+            shard.buffer.clear();
+            return;
+        }
+    }
+
+    std::string_view block = shard.buffer;
+#ifdef MOJO_HAVE_ZSTD
+    std::string frame;
+    if (zstd_) {
+        frame.resize(ZSTD_compressBound(block.size()));
+        size_t size = ZSTD_compress(frame.data(), frame.size(), block.data(), block.size(), 3);
+        if (ZSTD_isError(size)) {
+            Mojo::Core::Logger::error(std::string("zstd: ") + ZSTD_getErrorName(size));
+            shard.buffer.clear();
+            return;
+        }
+        frame.resize(size);
+        block = frame;
+    }
+#endif
+    shard.file.write(block.data(), static_cast<std::streamsize>(block.size()));
+    if (!shard.file)
+        Mojo::Core::Logger::error("Write Error: JSONL shard " + std::to_string(shard.index));
+    shard.file_bytes += block.size();
+    shard.bytes += block.size();
+    shard.buffer.clear();
+}
+
+void JsonlStorage::flush() {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        write_out(*shard);
+        if (shard->file.is_open())
+            shard->file.flush();
+    }
+}
+
+JsonlStats JsonlStorage::stats() const {
+    JsonlStats stats;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        stats.records += shard->records;
+        stats.files += shard->files;
+        stats.bytes += shard->bytes;
+    }
+    return stats;
+}
+
+}  // namespace Storage
+}  // namespace Mojo
@@ -0,0 +1,101 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../core/types/constants.hpp"
+#include "storage.hpp"
+
+namespace Mojo {
+namespace Storage {
+
+struct JsonlStats {
+    uint64_t records = 0;
+    uint64_t files   = 0;  // Across all shards
+    uint64_t bytes   = 0;  // Written to disk, after compression
+};
+
+/**
+ * @brief Writes each page as one JSON line, `{"url", "title", "markdown", "fetched_at",
+ * "status"}`, for ingestion pipelines that want records rather than a directory tree.
+ *
+ * Output is split over `shards` files, `pages-<start time>-<shard>-<serial>.jsonl`, created
+ * exclusively so a run never overwrites another's output. Every calling thread claims a shard
+ * of its own the first time it saves, so with one shard per worker thread no two threads
+ * share a buffer or a file; each shard still has a mutex, which is only contended when more
+ * threads than shards write. Records collect in the shard's buffer and
+ * go to disk in blocks of `flush_size` bytes (at most `roll_size`). Once a file passes
+ * `roll_size` bytes the shard moves on to the next serial.
+ *
+ * With `zstd` (when built with libzstd) each block is written as a separate zstd frame and
+ * files end in `.jsonl.zst`. A frame always holds whole lines, so `zstd -dc` over a file or
+ * any run of frames yields valid JSONL.
+ *
+ * Strings are escaped as JSON requires; bytes that are not valid UTF-8 become U+FFFD, since
+ * pages in legacy encodings would otherwise produce lines no JSON parser accepts. Documents
+ * (binary content) carry no Markdown and are recorded with an empty one.
+ */
+class JsonlStorage : public Storage {
+public:
+    JsonlStorage(const std::string& dir,
+                 size_t             shards,
+                 uint64_t           roll_size  = 0,
+                 bool               zstd       = false,
+                 size_t             flush_size = Mojo::Core::Constants::JSONL_FLUSH_SIZE);
+    ~JsonlStorage() override;
+
+    JsonlStorage(const JsonlStorage&)            = delete;
+    JsonlStorage& operator=(const JsonlStorage&) = delete;
+
+    void save(const std::string& key, const std::string& content, bool is_binary = false) override;
+    void save_page(const std::string& key,
+                   const std::string& content,
+                   bool               is_binary,
+                   const FetchRecord& fetch) override;
+    bool wants_title() const override {
+        return true;
+    }
+    void flush() override;
+
+    JsonlStats stats() const;
+
+    /// Appends `value` as a quoted JSON string.
+    static void append_json_string(std::string& out, std::string_view value);
+
+private:
+    struct alignas(64) Shard {
+        size_t        index = 0;
+        std::mutex    mutex;
+        std::string   buffer;
+        std::ofstream file;
+        uint64_t      file_bytes = 0;
+        uint64_t      serial     = 0;
+        uint64_t      records    = 0;
+        uint64_t      files      = 0;
+        uint64_t      bytes      = 0;
+    };
+
+    Shard& local_shard();
+    void   append(std::string_view url,
+                  std::string_view title,
+                  std::string_view markdown,
+                  std::string_view fetched_at,
+                  long             status);
+    void   write_out(Shard& shard);
+
+    std::string                         dir_;
+    uint64_t                            roll_size_;
+    size_t                              flush_size_;
+    bool                                zstd_;
+    std::string                         run_;  // Start time shared by this run's file names
+    uint64_t                            id_;  // Tells instances apart in the thread cache
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<size_t>                 next_shard_{0};
+};
+
+}  // namespace Storage
+}  // namespace Mojo
@@ -0,0 +1,38 @@
+#include "storage.hpp"
+#include <stdexcept>
+#include "disk_storage.hpp"
+#include "jsonl_storage.hpp"
+#ifdef MOJO_HAVE_IO_URING
+#include "uring_storage.hpp"
+#endif
+#include "warc_storage.hpp"
+
+namespace Mojo {
+namespace Storage {
+
+std::unique_ptr<Storage> Storage::create(const std::string& name, const StorageOptions& options) {
+    if (name == "disk") {
+        DiskOptions disk;
+        disk.write_behind = options.write_behind;
+        disk.hash_dirs    = options.hash_dirs;
+        disk.fsync        = DiskStorage::parse_fsync(options.fsync);
+        return std::make_unique<DiskStorage>(options.output_dir, disk);
+    }
+    if (name == "warc")
+        return std::make_unique<WarcStorage>(options.output_dir, options.roll_size);
+    if (name == "jsonl") {
+        return std::make_unique<JsonlStorage>(
+            options.output_dir, options.shards, options.roll_size, options.zstd);
+    }
+#ifdef MOJO_HAVE_IO_URING
+    if (name == "uring")
+        return std::make_unique<UringStorage>(options.output_dir);
+#else
+    if (name == "uring")
+        throw std::invalid_argument("Storage backend uring requires io_uring (Linux)");
+#endif
+    throw std::invalid_argument("Unknown storage backend: " + name);
+}
+
+}  // namespace Storage
+}  // namespace Mojo
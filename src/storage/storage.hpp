@@ -1,16 +1,101 @@
 #pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <string>
-#include <vector>
+#include <string_view>
 
 namespace Mojo {
 namespace Storage {
 
+/// The response a saved page came from, for backends that archive more than the content.
+struct FetchRecord {
+    std::string_view                      url;  // After redirects
+    long                                  status = 0;
+    std::string_view                      content_type;
+    std::chrono::system_clock::time_point fetched_at;
+    std::string_view                      body;   // Content-decoded response body
+    std::string_view                      title;  // Of an HTML page, if wants_title()
+};
+
+/// Duplicates a backend stored as references after save_duplicate() returned false for them.
+struct DeferredLinks {
+    uint64_t count = 0;
+    uint64_t bytes = 0;  // Content bytes those references kept from being written
+};
+
+struct StorageOptions {
+    std::string output_dir;
+    uint64_t    roll_size = 0;      // Bytes per output file for archive backends (0 = default)
+    size_t      shards    = 1;      // JSONL: files written in parallel, one per worker thread
+    bool        zstd      = false;  // JSONL: compress each flushed block as a zstd frame
+
+    bool        write_behind = false;   // Disk: queue saves for writer threads
+    int         hash_dirs    = 0;       // Disk: levels of hash-named directories above files
+    std::string fsync        = "none";  // Disk: none, batch or file
+};
+
 class Storage {
 public:
     virtual ~Storage() = default;
 
+    /**
+     * @brief Creates a backend by name: "disk" (a file per URL), "uring" (the same files,
+     * written through io_uring off the caller's thread), "warc" (rolling gzipped WARC files
+     * with a CDX index) or "jsonl" (sharded newline-delimited JSON records).
+     * @throws std::invalid_argument for any other name, or "uring" when built without it.
+     * @throws std::runtime_error when the kernel refuses to set up the ring.
+     */
+    static std::unique_ptr<Storage> create(const std::string& name, const StorageOptions& options);
+
     virtual void
     save(const std::string& key, const std::string& content, bool is_binary = false) = 0;
+
+    /**
+     * @brief Stores `content` as `save()` does, along with the response it was made from.
+     * Backends that keep only the content ignore `fetch`.
+     */
+    virtual void save_page(const std::string& key,
+                           const std::string& content,
+                           bool               is_binary,
+                           const FetchRecord& fetch) {
+        (void)fetch;
+        save(key, content, is_binary);
+    }
+
+    /**
+     * @brief Stores `key` as a copy of `original`, saved earlier with the same `content`.
+     * Backends with a cheap way to reference the first copy override this; the rest write
+     * the content again.
+     * @return true when `key` was stored as a reference, false when the content was written
+     * or the backend decides later; references made later are reported by deferred_links().
+     */
+    virtual bool save_duplicate(const std::string& key,
+                                const std::string& original,
+                                const std::string& content,
+                                bool               is_binary = false,
+                                const FetchRecord* fetch     = nullptr) {
+        (void)original;
+        if (fetch)
+            save_page(key, content, is_binary, *fetch);
+        else
+            save(key, content, is_binary);
+        return false;
+    }
+
+    /// Duplicates stored as references after save_duplicate() had already returned false.
+    virtual DeferredLinks deferred_links() const {
+        return {};
+    }
+
+    /// Whether `FetchRecord::title` is stored, so callers can skip extracting it otherwise.
+    virtual bool wants_title() const {
+        return false;
+    }
+
+    /// Writes out anything buffered. Called once no more saves are coming.
+    virtual void flush() {
+    }
 };
 
 }  // namespace Storage
@@ -0,0 +1,401 @@
+#include "uring_storage.hpp"
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+#include "../core/logger/logger.hpp"
+#include "disk_storage.hpp"
+
+namespace Mojo {
+namespace Storage {
+
+/**
+ * @brief A bare io_uring: the submission and completion rings mapped from the kernel, driven
+ * through the raw syscalls. Only the ring thread uses it, so the one producer and consumer
+ * on our side need no lock; the acquire/release pairs order us against the kernel.
+ */
+class UringStorage::Ring {
+public:
+    explicit Ring(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd_ < 0)
+            throw std::runtime_error("io_uring_setup failed: " + std::string(strerror(errno)));
+
+        sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        single_  = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_)
+            sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+
+        sq_ring_ = map(sq_size_, IORING_OFF_SQ_RING);
+        cq_ring_ = single_ || sq_ring_ == MAP_FAILED ? sq_ring_ : map(cq_size_, IORING_OFF_CQ_RING);
+        sqes_    = map(params.sq_entries * sizeof(io_uring_sqe), IORING_OFF_SQES);
+        if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+            std::string error = strerror(errno);
+            release();
+            throw std::runtime_error("io_uring mmap failed: " + error);
+        }
+
+        auto* sq   = static_cast<char*>(sq_ring_);
+        sq_head_   = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail_   = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask_   = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array_  = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        auto* cq   = static_cast<char*>(cq_ring_);
+        cq_head_   = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_   = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask_   = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_      = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        entries_   = params.sq_entries;
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    }
+
+    ~Ring() {
+        release();
+    }
+
+    unsigned entries() const {
+        return entries_;
+    }
+
+    /// A zeroed entry at the tail of the submission ring; the caller keeps at most entries()
+    /// operations in flight, so the ring cannot be full.
+    io_uring_sqe* next() {
+        unsigned      tail = *sq_tail_;
+        unsigned      slot = tail & sq_mask_;
+        io_uring_sqe* sqe  = &static_cast<io_uring_sqe*>(sqes_)[slot];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sq_array_[slot] = slot;
+        std::atomic_ref<unsigned>(*sq_tail_).store(tail + 1, std::memory_order_release);
+        unsubmitted_++;
+        return sqe;
+    }
+
+    /// Submits what next() prepared and hands `count` completions to `handle` as they arrive.
+    template <typename Handle>
+    void complete(unsigned count, Handle&& handle) {
+        while (count > 0) {
+            int submitted = static_cast<int>(syscall(
+                __NR_io_uring_enter, fd_, unsubmitted_, 1u, IORING_ENTER_GETEVENTS, nullptr, 0));
+            if (submitted < 0) {
+                // Transient; anything else means a malformed entry, which is a bug here.
+                if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+                    continue;
+                throw std::system_error(errno, std::generic_category(), "io_uring_enter");
+            }
+            unsubmitted_ -= static_cast<unsigned>(submitted);
+            in_flight_ += static_cast<unsigned>(submitted);
+            count -= reap(count, handle);
+        }
+    }
+
+    /**
+     * @brief Waits for every operation the kernel accepted to complete, handing each to
+     * `handle`, and submits nothing more.
+     * @return false when the kernel stops reporting completions; the operations left may
+     * still be reading and writing the memory and descriptors they were given.
+     */
+    template <typename Handle>
+    bool drain(Handle&& handle) {
+        while (in_flight_ > 0) {
+            int ret = static_cast<int>(syscall(
+                __NR_io_uring_enter, fd_, 0u, in_flight_, IORING_ENTER_GETEVENTS, nullptr, 0));
+            if (ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                return false;
+            reap(in_flight_, handle);
+        }
+        return true;
+    }
+
+private:
+    /// Hands up to `count` waiting completions to `handle`; returns how many.
+    template <typename Handle>
+    unsigned reap(unsigned count, Handle& handle) {
+        unsigned head = *cq_head_;
+        unsigned tail = std::atomic_ref<unsigned>(*cq_tail_).load(std::memory_order_acquire);
+        unsigned seen = 0;
+        for (; head != tail && seen < count; ++head, ++seen) {
+            const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+            handle(cqe.user_data, cqe.res);
+        }
+        std::atomic_ref<unsigned>(*cq_head_).store(head, std::memory_order_release);
+        in_flight_ -= seen;
+        return seen;
+    }
+
+    void* map(size_t size, off_t offset) {
+        return mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+    }
+
+    void release() {
+        if (sqes_ != MAP_FAILED)
+            munmap(sqes_, sqes_size_);
+        if (!single_ && cq_ring_ != MAP_FAILED)
+            munmap(cq_ring_, cq_size_);
+        if (sq_ring_ != MAP_FAILED)
+            munmap(sq_ring_, sq_size_);
+        close(fd_);
+    }
+
+    int           fd_          = -1;
+    bool          single_      = false;
+    void*         sq_ring_     = MAP_FAILED;
+    void*         cq_ring_     = MAP_FAILED;
+    void*         sqes_        = MAP_FAILED;
+    size_t        sq_size_     = 0;
+    size_t        cq_size_     = 0;
+    size_t        sqes_size_   = 0;
+    unsigned*     sq_head_     = nullptr;
+    unsigned*     sq_tail_     = nullptr;
+    unsigned*     sq_array_    = nullptr;
+    unsigned      sq_mask_     = 0;
+    unsigned*     cq_head_     = nullptr;
+    unsigned*     cq_tail_     = nullptr;
+    unsigned      cq_mask_     = 0;
+    io_uring_cqe* cqes_        = nullptr;
+    unsigned      entries_     = 0;
+    unsigned      unsubmitted_ = 0;
+    unsigned      in_flight_   = 0;  // Submitted, not yet reaped
+};
+
+UringStorage::UringStorage(const std::string& base_path, unsigned queue_depth, size_t max_pending)
+    : base_path_(base_path),
+      max_pending_(max_pending),
+      ring_(std::make_unique<Ring>(std::max(2u, queue_depth))) {
+    if (!base_path_.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(base_path_, error);
+        if (error)
+            Mojo::Core::Logger::error("Failed to create storage directory: " + base_path_);
+        else
+            directories_.insert(base_path_);
+    }
+    thread_ = std::thread([this] { run(); });
+}
+
+UringStorage::~UringStorage() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_.notify_one();
+    thread_.join();
+}
+
+void UringStorage::save(const std::string& key, const std::string& content, bool /*is_binary*/) {
+    std::filesystem::path path(base_path_);
+    path /= key;
+    Job job;
+    job.path = path.string();
+    job.data = content;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [&] { return pending_bytes_ < max_pending_ || pending_bytes_ == 0; });
+    pending_bytes_ += job.data.size();
+    pending_.push_back(std::move(job));
+    lock.unlock();
+    work_.notify_one();
+}
+
+void UringStorage::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [&] { return pending_.empty() && !busy_; });
+}
+
+UringStats UringStorage::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void UringStorage::run() {
+    // Each file takes a WRITE and a CLOSE entry in the second round.
+    const size_t     limit = ring_->entries() / 2;
+    std::vector<Job> batch;
+    batch.reserve(limit);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        work_.wait(lock, [&] { return stopping_ || !pending_.empty(); });
+        if (pending_.empty())
+            return;
+
+        // A path saved twice goes in a later batch, so the two writes cannot interleave.
+        size_t                          bytes = 0;
+        std::unordered_set<std::string> paths;
+        while (!pending_.empty() && batch.size() < limit
+               && paths.insert(pending_.front().path).second) {
+            bytes += pending_.front().data.size();
+            batch.push_back(std::move(pending_.front()));
+            pending_.pop_front();
+        }
+        busy_ = true;
+        lock.unlock();
+
+        bool abandoned = false;
+        try {
+            write_batch(batch);
+        } catch (const std::exception& e) {
+            Mojo::Core::Logger::error("io_uring failed, writing without it: "
+                                      + std::string(e.what()));
+            ring_failed_ = true;
+            abandoned    = !recover(batch);
+        }
+
+        lock.lock();
+        for (const auto& job : batch) {
+            if (job.failed || job.fd < 0
+                || job.written != static_cast<long long>(job.data.size())) {
+                stats_.errors++;
+                continue;
+            }
+            stats_.files++;
+            stats_.bytes += job.data.size();
+        }
+        stats_.batches++;
+        pending_bytes_ -= bytes;
+        busy_ = false;
+        if (abandoned)
+            abandoned_.push_back(std::move(batch));
+        batch.clear();
+        done_.notify_all();
+    }
+}
+
+void UringStorage::write_batch(std::vector<Job>& batch) {
+    if (ring_failed_) {
+        for (auto& job : batch) {
+            ensure_parent(job.path);
+            job.fd = DiskStorage::create_file(AT_FDCWD, job.path.c_str());
+            finish(job);
+        }
+        return;
+    }
+
+    unsigned opens = 0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        ensure_parent(batch[i].path);
+        io_uring_sqe* sqe = ring_->next();
+        sqe->opcode       = IORING_OP_OPENAT;
+        sqe->fd           = AT_FDCWD;
+        sqe->addr         = reinterpret_cast<uintptr_t>(batch[i].path.c_str());
+        sqe->len          = 0644;
+        sqe->open_flags   = O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC;
+        sqe->user_data    = OPEN_TAG | i;
+        opens++;
+    }
+    ring_->complete(opens, [&](uint64_t data, int res) { record(batch, data, res); });
+
+    unsigned ops = 0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        Job& job = batch[i];
+        // A file already there (EEXIST) is replaced rather than truncated, as DiskStorage
+        // does; kernels before 5.6 have no OPENAT on the ring at all.
+        if (job.fd < 0)
+            job.fd = DiskStorage::create_file(AT_FDCWD, job.path.c_str());
+        if (job.fd < 0)
+            continue;
+
+        // Whatever a single write cannot take is left to finish() as a short write.
+        io_uring_sqe* write = ring_->next();
+        write->opcode       = IORING_OP_WRITE;
+        write->fd           = job.fd;
+        write->addr         = reinterpret_cast<uintptr_t>(job.data.data());
+        write->len          = static_cast<uint32_t>(std::min<size_t>(job.data.size(), 1u << 30));
+        write->off          = 0;
+        write->flags        = IOSQE_IO_LINK;
+        write->user_data    = i * 2;
+
+        // A failed or short write cancels the close, leaving the descriptor to finish().
+        io_uring_sqe* close = ring_->next();
+        close->opcode       = IORING_OP_CLOSE;
+        close->fd           = job.fd;
+        close->user_data    = i * 2 + 1;
+        ops += 2;
+    }
+    ring_->complete(ops, [&](uint64_t data, int res) { record(batch, data, res); });
+
+    for (auto& job : batch)
+        finish(job);
+}
+
+void UringStorage::record(std::vector<Job>& batch, uint64_t data, int res) {
+    if (data & OPEN_TAG) {
+        batch[data & ~OPEN_TAG].fd = res;
+        return;
+    }
+    Job& job = batch[data / 2];
+    if (data % 2 == 0)
+        job.written = res;
+    else
+        job.closed = res != -ECANCELED;
+}
+
+bool UringStorage::recover(std::vector<Job>& batch) {
+    // Until the kernel is done with the batch, its paths, bodies and descriptors are not ours.
+    if (!ring_->drain([&](uint64_t data, int res) { record(batch, data, res); })) {
+        // Whatever is left running keeps the batch: it is parked, and its descriptors stay
+        // open, since a CLOSE still in flight could otherwise close a reused number.
+        for (auto& job : batch) {
+            Mojo::Core::Logger::error("Write Error: " + job.path);
+            job.failed = true;
+        }
+        return false;
+    }
+    // Every operation has completed, so the batch is finished by hand from where it stopped.
+    for (auto& job : batch) {
+        if (job.fd < 0) {
+            ensure_parent(job.path);
+            job.fd = DiskStorage::create_file(AT_FDCWD, job.path.c_str());
+        }
+        finish(job);
+    }
+    return true;
+}
+
+void UringStorage::ensure_parent(const std::string& path) {
+    std::string parent = std::filesystem::path(path).parent_path().string();
+    if (parent.empty() || directories_.count(parent))
+        return;
+    std::error_code error;
+    std::filesystem::create_directories(parent, error);
+    if (error)
+        Mojo::Core::Logger::error("FS Error: " + error.message() + " creating " + parent);
+    else
+        directories_.insert(std::move(parent));
+}
+
+void UringStorage::finish(Job& job) {
+    if (job.fd < 0) {
+        Mojo::Core::Logger::error("Write Error: " + job.path);
+        return;
+    }
+    while (job.written >= 0 && job.written < static_cast<long long>(job.data.size())) {
+        ssize_t n = ::pwrite(job.fd,
+                             job.data.data() + job.written,
+                             job.data.size() - static_cast<size_t>(job.written),
+                             job.written);
+        if (n < 0 && errno == EINTR)
+            continue;
+        job.written = n <= 0 ? -1 : job.written + n;
+    }
+    if (!job.closed)
+        ::close(job.fd);
+
+    if (job.written == static_cast<long long>(job.data.size()))
+        Mojo::Core::Logger::success("Saved: " + job.path);
+    else
+        Mojo::Core::Logger::error("Write Error: " + job.path);
+}
+
+}  // namespace Storage
+}  // namespace Mojo
@@ -0,0 +1,103 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "../core/types/constants.hpp"
+#include "storage.hpp"
+
+namespace Mojo {
+namespace Storage {
+
+struct UringStats {
+    uint64_t files   = 0;  // Written and closed
+    uint64_t bytes   = 0;
+    uint64_t batches = 0;  // Rounds of submissions to the ring
+    uint64_t errors  = 0;
+};
+
+/**
+ * @brief Writes the same tree as DiskStorage, but through io_uring on a thread of its own.
+ *
+ * save() copies the key and content onto a queue and returns, so worker threads go back to
+ * converting pages instead of waiting on open/write/close. The ring thread takes whatever has
+ * queued up as one batch: it creates missing directories (remembering the ones it made), then
+ * submits an OPENAT per file, and once those complete a WRITE linked to a CLOSE per file, so a
+ * batch costs two io_uring_enter calls however many files it holds. Writes the ring leaves
+ * short, and opens the kernel refuses, are finished with plain syscalls. The ring opens with
+ * O_EXCL; a file already there is unlinked and created anew, never truncated in place, so
+ * hard links to it keep their body. Should the ring itself fail, the thread waits for the
+ * operations it had in flight, finishes their batch with plain syscalls and carries on with
+ * open/pwrite/close. If the kernel will not even report those operations, the batch is
+ * reported as failed and kept, descriptors and all, for as long as the storage lives.
+ *
+ * Once `max_pending` bytes are queued, save() blocks until the ring catches up. flush()
+ * returns when every queued file is on disk (written and closed, not fsynced).
+ *
+ * The constructor throws std::runtime_error when the kernel has no io_uring (or it is
+ * disabled), so callers can fall back to DiskStorage.
+ */
+class UringStorage : public Storage {
+public:
+    explicit UringStorage(
+        const std::string& base_path,
+        unsigned           queue_depth = Mojo::Core::Constants::URING_QUEUE_DEPTH,
+        size_t             max_pending = Mojo::Core::Constants::URING_MAX_PENDING);
+    ~UringStorage() override;
+
+    UringStorage(const UringStorage&)            = delete;
+    UringStorage& operator=(const UringStorage&) = delete;
+
+    void save(const std::string& key, const std::string& content, bool is_binary = false) override;
+    void flush() override;
+
+    UringStats stats() const;
+
+private:
+    class Ring;
+
+    struct Job {
+        std::string path;
+        std::string data;
+        int         fd      = -1;
+        long long   written = 0;
+        bool        closed  = false;
+        bool        failed  = false;  // Left to a ring that stopped reporting
+    };
+
+    static constexpr uint64_t OPEN_TAG = 1ULL << 63;  // user_data of an OPENAT entry
+
+    void run();
+    void write_batch(std::vector<Job>& batch);
+    void record(std::vector<Job>& batch, uint64_t data, int res);
+    bool recover(std::vector<Job>& batch);
+    void ensure_parent(const std::string& path);
+    void finish(Job& job);
+
+    std::string           base_path_;
+    size_t                max_pending_;
+    std::unique_ptr<Ring> ring_;
+
+    mutable std::mutex      mutex_;
+    std::condition_variable work_;  // Jobs queued, or stopping
+    std::condition_variable done_;  // A batch finished
+    std::deque<Job>         pending_;
+    size_t                  pending_bytes_ = 0;
+    bool                    busy_          = false;  // The ring thread holds a batch
+    bool                    stopping_      = false;
+    UringStats              stats_;
+
+    // Only touched by the ring thread
+    std::unordered_set<std::string> directories_;
+    bool                            ring_failed_ = false;  // Batches bypass the ring
+    std::vector<std::vector<Job>>   abandoned_;  // Batches a failed ring may still be using
+    std::thread                     thread_;
+};
+
+}  // namespace Storage
+}  // namespace Mojo
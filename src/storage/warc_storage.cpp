@@ -0,0 +1,331 @@
+#include "warc_storage.hpp"
+#include <openssl/sha.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <random>
+#include "../core/logger/logger.hpp"
+#include "../utils/url/url.hpp"
+
+namespace Mojo {
+namespace Storage {
+
+namespace {
+
+using Clock = std::chrono::system_clock;
+
+std::tm to_utc(Clock::time_point time) {
+    std::time_t seconds = Clock::to_time_t(time);
+    std::tm     utc{};
+    gmtime_r(&seconds, &utc);
+    return utc;
+}
+
+/// ISO 8601 as WARC-Date wants it: 2024-05-01T12:00:00Z
+std::string warc_date(Clock::time_point time) {
+    std::tm utc = to_utc(time);
+    char    buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+    return buffer;
+}
+
+/// The 14-digit form used by CDX lines and file names: 20240501120000
+std::string compact_date(Clock::time_point time) {
+    std::tm utc = to_utc(time);
+    char    buffer[16];
+    std::strftime(buffer, sizeof(buffer), "%Y%m%d%H%M%S", &utc);
+    return buffer;
+}
+
+std::string record_id() {
+    thread_local std::mt19937_64 rng(std::random_device{}());
+    uint64_t                     high = rng(), low = rng();
+    high = (high & ~0xF000ULL) | 0x4000ULL;                // Version 4
+    low  = (low & ~(0xC000ULL << 48)) | (0x8000ULL << 48);  // RFC 4122 variant
+    char buffer[64];
+    std::snprintf(buffer,
+                  sizeof(buffer),
+                  "<urn:uuid:%08x-%04x-%04x-%04x-%012llx>",
+                  static_cast<unsigned>(high >> 32),
+                  static_cast<unsigned>((high >> 16) & 0xFFFF),
+                  static_cast<unsigned>(high & 0xFFFF),
+                  static_cast<unsigned>(low >> 48),
+                  static_cast<unsigned long long>(low & 0xFFFFFFFFFFFFULL));
+    return buffer;
+}
+
+/// "sha1:" and the RFC 4648 base32 digest, the form WARC and CDX tools expect.
+std::string sha1_digest(std::string_view data) {
+    static constexpr char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
+    unsigned char         hash[SHA_DIGEST_LENGTH];
+    SHA1(reinterpret_cast<const unsigned char*>(data.data()), data.size(), hash);
+
+    std::string out  = "sha1:";
+    uint32_t    bits = 0;
+    int         held = 0;
+    for (unsigned char byte : hash) {
+        bits = (bits << 8) | byte;
+        held += 8;
+        while (held >= 5) {
+            out += ALPHABET[(bits >> (held - 5)) & 31];
+            held -= 5;
+        }
+    }
+    return out;  // 160 bits is exactly 32 digits, no padding
+}
+
+std::string gzip_member(std::string_view data) {
+    z_stream stream{};
+    if (deflateInit2(&stream, Z_BEST_SPEED, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        throw std::runtime_error("deflateInit2 failed");
+
+    std::string out(deflateBound(&stream, static_cast<uLong>(data.size())), '\0');
+    stream.next_in   = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in  = static_cast<uInt>(data.size());
+    stream.next_out  = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = static_cast<uInt>(out.size());
+    int status       = deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    if (status != Z_STREAM_END)
+        throw std::runtime_error("deflate failed");
+    return out;
+}
+
+/// CDX fields are space separated; a URL or type with spaces would shift every column.
+std::string cdx_field(std::string_view value) {
+    if (value.empty())
+        return "-";
+    std::string out(value);
+    std::replace(out.begin(), out.end(), ' ', '+');
+    return out;
+}
+
+struct RecordHeader {
+    const char*       type;
+    std::string       id;
+    Clock::time_point date;
+    std::string_view  target_uri;
+    std::string_view  content_type;
+    std::string       extra;  // Further "Name: value\r\n" lines
+};
+
+/// One complete WARC record: headers, block and the two CRLFs that end it.
+std::string build_record(const RecordHeader& header, std::string_view block) {
+    std::string record;
+    record.reserve(block.size() + 512);
+    record += "WARC/1.1\r\nWARC-Type: ";
+    record += header.type;
+    record += "\r\nWARC-Record-ID: " + header.id;
+    record += "\r\nWARC-Date: " + warc_date(header.date) + "\r\n";
+    if (!header.target_uri.empty()) {
+        record += "WARC-Target-URI: ";
+        record += header.target_uri;
+        record += "\r\n";
+    }
+    record += header.extra;
+    record += "WARC-Block-Digest: " + sha1_digest(block) + "\r\n";
+    record += "Content-Type: ";
+    record += header.content_type;
+    record += "\r\nContent-Length: " + std::to_string(block.size()) + "\r\n\r\n";
+    record += block;
+    record += "\r\n\r\n";
+    return record;
+}
+
+}  // namespace
+
+WarcStorage::WarcStorage(const std::string& dir, uint64_t roll_size)
+    : dir_(dir), roll_size_(roll_size > 0 ? roll_size : Mojo::Core::Constants::WARC_ROLL_SIZE),
+      run_(compact_date(Clock::now())) {
+    try {
+        std::filesystem::create_directories(dir_);
+    } catch (...) {
+        Mojo::Core::Logger::error("Failed to create storage directory: " + dir_);
+    }
+}
+
+WarcStorage::~WarcStorage() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    warc_.close();
+    cdx_.close();
+}
+
+std::string WarcStorage::surt(const std::string& url) {
+    auto        parsed = Mojo::Utils::Url::parse(url);
+    std::string host   = parsed.host;
+    std::transform(host.begin(), host.end(), host.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    if (host.rfind("www.", 0) == 0)
+        host.erase(0, 4);
+
+    std::string key;
+    size_t      end = host.size();
+    while (end > 0) {
+        size_t dot   = host.rfind('.', end - 1);
+        size_t begin = dot == std::string::npos ? 0 : dot + 1;
+        if (!key.empty())
+            key += ',';
+        key.append(host, begin, end - begin);
+        if (dot == std::string::npos)
+            break;
+        end = dot;
+    }
+    if (!parsed.port.empty() && parsed.port != "80" && parsed.port != "443")
+        key += ":" + parsed.port;
+    key += ')';
+    key += parsed.path;
+    if (!parsed.query.empty())
+        key += "?" + parsed.query;
+    return key;
+}
+
+void WarcStorage::save(const std::string& key, const std::string& content, bool is_binary) {
+    try {
+        auto             now    = Clock::now();
+        std::string_view type   = is_binary ? "application/octet-stream" : "text/markdown";
+        std::string      record = build_record({"resource", record_id(), now, key, type, {}},
+                                          content);
+        append({{gzip_member(record),
+                 cdx_field(key) + " " + compact_date(now) + " " + cdx_field(key) + " "
+                     + std::string(type) + " - " + sha1_digest(content) + " - -"}});
+    } catch (const std::exception& e) {
+        Mojo::Core::Logger::error("WARC Error: " + std::string(e.what()));
+    }
+}
+
+void WarcStorage::save_page(const std::string& key,
+                            const std::string& content,
+                            bool               is_binary,
+                            const FetchRecord& fetch) {
+    try {
+        std::string url       = fetch.url.empty() ? key : std::string(fetch.url);
+        std::string key_field = cdx_field(surt(url)) + " " + compact_date(fetch.fetched_at) + " "
+                                + cdx_field(url) + " ";
+
+        // Only the decoded body and a few headers survive the fetch, which is not the
+        // response as it came off the wire, so it is archived as the resource it carried.
+        std::string resource_id = record_id();
+        std::string digest      = sha1_digest(fetch.body);
+        std::string mime = cdx_field(fetch.content_type.substr(0, fetch.content_type.find(';')));
+        std::string_view type =
+            fetch.content_type.empty() ? "application/octet-stream" : fetch.content_type;
+
+        std::vector<Record> records;
+        records.push_back(
+            {gzip_member(build_record({"resource", resource_id, fetch.fetched_at, url, type, {}},
+                                      fetch.body)),
+             key_field + mime + " " + std::to_string(fetch.status) + " " + digest + " - -"});
+
+        // A document is the resource itself; only text pages have a conversion to keep.
+        if (!is_binary) {
+            records.push_back({gzip_member(build_record(
+                                   {"conversion",
+                                    record_id(),
+                                    fetch.fetched_at,
+                                    url,
+                                    "text/markdown",
+                                    "WARC-Refers-To: " + resource_id + "\r\n"},
+                                   content)),
+                               key_field + "text/markdown - " + sha1_digest(content) + " - -"});
+        }
+        append(records);
+    } catch (const std::exception& e) {
+        Mojo::Core::Logger::error("WARC Error: " + std::string(e.what()));
+    }
+}
+
+void WarcStorage::append(const std::vector<Record>& records) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // A page's records stay together, so a file may run over by one page.
+    if (!warc_.is_open() || offset_ >= roll_size_)
+        open_next();
+    if (!warc_.is_open())
+        return;
+
+    for (const auto& record : records) {
+        warc_.write(record.member.data(), static_cast<std::streamsize>(record.member.size()));
+        cdx_ << record.cdx << ' ' << record.member.size() << ' ' << offset_ << ' ' << filename_
+             << '\n';
+        offset_ += record.member.size();
+        stats_.records++;
+        stats_.bytes += record.member.size();
+    }
+    if (!warc_)
+        Mojo::Core::Logger::error("Write Error: " + filename_);
+}
+
+void WarcStorage::open_next() {
+    warc_.close();
+
+    // Another run started in the same second may own a name already; it is skipped, never
+    // truncated, and the serial moves on.
+    std::filesystem::path path;
+    while (true) {
+        char serial[16];
+        std::snprintf(serial, sizeof(serial), "%05llu", static_cast<unsigned long long>(serial_++));
+        filename_ = std::string(Mojo::Core::Constants::WARC_PREFIX) + "-" + run_ + "-" + serial
+                    + ".warc.gz";
+        path = std::filesystem::path(dir_) / filename_;
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (fd >= 0) {
+            ::close(fd);
+            break;
+        }
+        if (errno != EEXIST) {
+            Mojo::Core::Logger::error("Write Error: " + path.string());
+            return;
+        }
+    }
+    warc_.open(path, std::ios::binary | std::ios::app);
+    if (!warc_.is_open()) {
+        Mojo::Core::Logger::error("Write Error: " + path.string());
+        return;
+    }
+    if (!cdx_.is_open()) {
+        std::filesystem::path index(dir_);
+        index /= Mojo::Core::Constants::WARC_CDX;
+        bool fresh = !std::filesystem::exists(index);
+        cdx_.open(index, std::ios::app);
+        if (fresh)
+            cdx_ << " CDX N b a m s k r M S V g\n";
+    }
+    stats_.files++;
+    offset_ = 0;
+
+    std::string fields = "software: mojo/" + std::string(Mojo::Core::Constants::VERSION)
+                         + "\r\nformat: WARC File Format 1.1\r\n"
+                           "conformsTo: http://iipc.github.io/warc-specifications/"
+                           "specifications/warc-format/warc-1.1/\r\n";
+    std::string info = gzip_member(build_record({"warcinfo",
+                                                 record_id(),
+                                                 Clock::now(),
+                                                 {},
+                                                 "application/warc-fields",
+                                                 "WARC-Filename: " + filename_ + "\r\n"},
+                                                fields));
+    warc_.write(info.data(), static_cast<std::streamsize>(info.size()));
+    offset_ += info.size();
+    stats_.bytes += info.size();
+    Mojo::Core::Logger::info("WARC: writing " + path.string());
+}
+
+void WarcStorage::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    warc_.flush();
+    cdx_.flush();
+}
+
+WarcStats WarcStorage::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+}  // namespace Storage
+}  // namespace Mojo
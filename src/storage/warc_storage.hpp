@@ -0,0 +1,83 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "../core/types/constants.hpp"
+#include "storage.hpp"
+
+namespace Mojo {
+namespace Storage {
+
+struct WarcStats {
+    uint64_t files   = 0;  // WARC files opened
+    uint64_t records = 0;
+    uint64_t bytes   = 0;  // Compressed bytes written
+};
+
+/**
+ * @brief Appends pages to rolling WARC 1.1 files instead of a file per URL.
+ *
+ * A fetched page becomes a `resource` record holding the decoded body under its URL and
+ * Content-Type (the wire response, with its headers and transfer encodings, is not kept, so
+ * it is not passed off as a `response`), followed by a `conversion` record with its
+ * Markdown, linked by WARC-Refers-To. Content saved without a response becomes a
+ * `resource` record under its key. Each record is its own gzip member, so any record can be
+ * read on its own from its offset, and the file as a whole is still a valid .warc.gz.
+ *
+ * Files are named `mojo-<start time>-<serial>.warc.gz`, created exclusively: a name another
+ * run already holds is skipped, never overwritten. Each starts with a `warcinfo` record;
+ * once one passes `roll_size` bytes, the next page opens a new file. Every record also gets
+ * a line in `index.cdx` ("CDX N b a m s k r M S V g": SURT key, timestamp, URL, MIME,
+ * status, SHA-1 payload digest, length, offset, file). Lines are in write order; a byte-wise
+ * sort makes the index searchable.
+ *
+ * Hashing and compression run on the calling thread; only the appends are serialized.
+ */
+class WarcStorage : public Storage {
+public:
+    explicit WarcStorage(const std::string& dir,
+                         uint64_t           roll_size = Mojo::Core::Constants::WARC_ROLL_SIZE);
+    ~WarcStorage() override;
+
+    WarcStorage(const WarcStorage&)            = delete;
+    WarcStorage& operator=(const WarcStorage&) = delete;
+
+    void save(const std::string& key, const std::string& content, bool is_binary = false) override;
+    void save_page(const std::string& key,
+                   const std::string& content,
+                   bool               is_binary,
+                   const FetchRecord& fetch) override;
+    void flush() override;
+
+    WarcStats stats() const;
+
+    /// SURT form of `url` used as the CDX key: "com,example)/path?query".
+    static std::string surt(const std::string& url);
+
+private:
+    /// A gzipped record, with what its CDX line needs besides the position.
+    struct Record {
+        std::string member;
+        std::string cdx;  // The line up to the length field
+    };
+
+    void append(const std::vector<Record>& records);
+    void open_next();
+
+    std::string dir_;
+    uint64_t    roll_size_;
+    std::string run_;  // Start time shared by this run's file names
+
+    mutable std::mutex mutex_;
+    std::ofstream      warc_;
+    std::ofstream      cdx_;
+    std::string        filename_;
+    uint64_t           serial_ = 0;  // Of the next file name to try
+    uint64_t           offset_ = 0;
+    WarcStats          stats_;
+};
+
+}  // namespace Storage
+}  // namespace Mojo
@@ -0,0 +1,94 @@
+#include "fingerprint_set.hpp"
+#include <algorithm>
+#include <bit>
+#include "murmur3.h"
+
+namespace Mojo {
+
+namespace {
+
+constexpr size_t MIN_SLOTS         = 64;
+constexpr size_t MAX_LOAD_NUM      = 7;  // Grow past 7/10 occupancy
+constexpr size_t MAX_LOAD_DENOM    = 10;
+constexpr double FINGERPRINT_SPACE = 18446744073709551616.0;  // 2^64
+
+}  // namespace
+
+FingerprintSet::FingerprintSet(size_t initial_capacity) {
+    size_t per_shard = initial_capacity / SHARDS * MAX_LOAD_DENOM / MAX_LOAD_NUM + 1;
+    size_t slots     = std::bit_ceil(std::max(per_shard, MIN_SLOTS));
+    for (auto& shard : shards_)
+        shard.slots.assign(slots, 0);
+}
+
+uint64_t FingerprintSet::fingerprint(const std::string& key, size_t& shard) {
+    uint64_t hash[2];
+    MurmurHash3_x64_128(key.data(), static_cast<int>(key.size()), 42, hash);
+    shard = static_cast<size_t>(hash[1] % SHARDS);
+    return hash[0] != 0 ? hash[0] : 1;
+}
+
+bool FingerprintSet::insert(std::vector<uint64_t>& slots, uint64_t fp) {
+    size_t mask = slots.size() - 1;
+    for (size_t i = fp & mask;; i = (i + 1) & mask) {
+        if (slots[i] == fp)
+            return false;
+        if (slots[i] == 0) {
+            slots[i] = fp;
+            return true;
+        }
+    }
+}
+
+void FingerprintSet::grow(Shard& shard) {
+    std::vector<uint64_t> slots(shard.slots.size() * 2, 0);
+    for (uint64_t fp : shard.slots) {
+        if (fp != 0)
+            insert(slots, fp);
+    }
+    shard.slots.swap(slots);
+}
+
+bool FingerprintSet::test_and_add(const std::string& key) {
+    size_t   index = 0;
+    uint64_t fp    = fingerprint(key, index);
+    Shard&   shard = shards_[index];
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (!insert(shard.slots, fp))
+        return false;
+    if (++shard.size * MAX_LOAD_DENOM > shard.slots.size() * MAX_LOAD_NUM)
+        grow(shard);
+    return true;
+}
+
+bool FingerprintSet::contains(const std::string& key) const {
+    size_t       index = 0;
+    uint64_t     fp    = fingerprint(key, index);
+    const Shard& shard = shards_[index];
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    size_t                      mask = shard.slots.size() - 1;
+    for (size_t i = fp & mask;; i = (i + 1) & mask) {
+        if (shard.slots[i] == fp)
+            return true;
+        if (shard.slots[i] == 0)
+            return false;
+    }
+}
+
+VisitedSetStats FingerprintSet::stats() const {
+    VisitedSetStats s;
+    size_t          slots = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        s.items += shard.size;
+        slots += shard.slots.size();
+    }
+    s.memory_bytes        = slots * sizeof(uint64_t);
+    s.fill_ratio          = slots > 0 ? static_cast<double>(s.items) / slots : 0.0;
+    s.false_positive_rate = static_cast<double>(s.items) / FINGERPRINT_SPACE;
+    return s;
+}
+
+}  // namespace Mojo
@@ -0,0 +1,43 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "visited_set.hpp"
+
+namespace Mojo {
+
+/**
+ * @brief Exact visited set storing a 64-bit fingerprint per key.
+ *
+ * Fingerprints live in open-addressing tables (linear probing, grown at 70% load) split
+ * over cache-line-aligned shards with one mutex each, so threads rarely contend. Eight
+ * bytes per slot instead of the full URL; two distinct URLs collide with probability
+ * about n / 2^64, which stays below one in a billion for the first 10^10 URLs.
+ */
+class FingerprintSet : public VisitedSet {
+public:
+    explicit FingerprintSet(size_t initial_capacity);
+
+    bool            test_and_add(const std::string& key) override;
+    bool            contains(const std::string& key) const override;
+    VisitedSetStats stats() const override;
+
+private:
+    static constexpr size_t SHARDS = 64;
+
+    struct alignas(64) Shard {
+        mutable std::mutex    mutex;
+        std::vector<uint64_t> slots;  // 0 marks an empty slot
+        size_t                size = 0;
+    };
+
+    static uint64_t fingerprint(const std::string& key, size_t& shard);
+    static bool     insert(std::vector<uint64_t>& slots, uint64_t fp);
+    static void     grow(Shard& shard);
+
+    std::array<Shard, SHARDS> shards_;
+};
+
+}  // namespace Mojo
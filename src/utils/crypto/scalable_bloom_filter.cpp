@@ -0,0 +1,101 @@
+#include "scalable_bloom_filter.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace Mojo {
+
+namespace {
+
+// Blocking skews bit load across blocks; extra bits keep each stage at its target.
+constexpr double BLOCKING_OVERHEAD = 1.2;
+
+size_t bits_for(size_t capacity, double fp_rate) {
+    double ln2 = std::log(2.0);
+    double m   = -static_cast<double>(capacity) * std::log(fp_rate) / (ln2 * ln2);
+    return static_cast<size_t>(std::ceil(m * BLOCKING_OVERHEAD));
+}
+
+int hashes_for(double fp_rate) {
+    return std::max(1, static_cast<int>(std::lround(-std::log2(fp_rate))));
+}
+
+}  // namespace
+
+ScalableBloomFilter::Stage::Stage(size_t capacity, double fp_rate)
+    : filter(bits_for(capacity, fp_rate), hashes_for(fp_rate)),
+      capacity(capacity),
+      fp_rate(fp_rate) {
+}
+
+ScalableBloomFilter::ScalableBloomFilter(size_t initial_capacity, double fp_rate)
+    : fp_rate_(std::clamp(fp_rate, 1e-12, 0.5)) {
+    owned_.push_back(std::make_unique<Stage>(std::max<size_t>(initial_capacity, 1),
+                                             fp_rate_ * (1.0 - TIGHTENING)));
+    stages_[0].store(owned_.back().get(), std::memory_order_release);
+    num_stages_.store(1, std::memory_order_release);
+}
+
+bool ScalableBloomFilter::test_and_add(const std::string& key) {
+    size_t n = num_stages_.load(std::memory_order_acquire);
+    for (size_t i = 0; i + 1 < n; ++i) {
+        if (stages_[i].load(std::memory_order_acquire)->filter.contains(key))
+            return false;
+    }
+
+    Stage* last = stages_[n - 1].load(std::memory_order_acquire);
+    if (!last->filter.test_and_add(key))
+        return false;
+    if (last->filter.items_added() >= last->capacity)
+        grow(n);
+    return true;
+}
+
+bool ScalableBloomFilter::contains(const std::string& key) const {
+    size_t n = num_stages_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < n; ++i) {
+        if (stages_[i].load(std::memory_order_acquire)->filter.contains(key))
+            return true;
+    }
+    return false;
+}
+
+VisitedSetStats ScalableBloomFilter::stats() const {
+    VisitedSetStats s;
+    size_t          n        = num_stages_.load(std::memory_order_acquire);
+    size_t          set_bits = 0;
+    size_t          bits     = 0;
+    double          miss     = 1.0;
+    for (size_t i = 0; i < n; ++i) {
+        const Stage* stage = stages_[i].load(std::memory_order_acquire);
+        s.items += stage->filter.items_added();
+        set_bits += stage->filter.set_bits();
+        bits += stage->filter.bit_count();
+        // A new key is a false positive if any stage matches it.
+        miss *= 1.0 - stage->filter.estimated_blocked_false_positive_rate();
+    }
+    s.stages              = n;
+    s.memory_bytes        = bits / 8;
+    s.fill_ratio          = bits > 0 ? static_cast<double>(set_bits) / bits : 0.0;
+    s.false_positive_rate = 1.0 - miss;
+    return s;
+}
+
+size_t ScalableBloomFilter::stages() const {
+    return num_stages_.load(std::memory_order_acquire);
+}
+
+void ScalableBloomFilter::grow(size_t seen_stages) {
+    std::lock_guard<std::mutex> lock(grow_mutex_);
+    // Another thread may already have appended the stage this caller saw fill up.
+    if (num_stages_.load(std::memory_order_acquire) != seen_stages || seen_stages >= MAX_STAGES)
+        return;
+
+    const Stage* last = owned_.back().get();
+    owned_.push_back(std::make_unique<Stage>(
+        static_cast<size_t>(static_cast<double>(last->capacity) * GROWTH),
+        last->fp_rate * TIGHTENING));
+    stages_[seen_stages].store(owned_.back().get(), std::memory_order_release);
+    num_stages_.store(seen_stages + 1, std::memory_order_release);
+}
+
+}  // namespace Mojo
@@ -0,0 +1,57 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "blocked_bloom_filter.hpp"
+#include "visited_set.hpp"
+
+namespace Mojo {
+
+/**
+ * @brief Scalable Bloom filter (Almeida et al.): a chain of BlockedBloomFilters.
+ *
+ * Each stage is sized for its capacity at its own false positive target. When the newest
+ * stage reaches capacity a stage twice as large is appended with half the target, so the
+ * compound rate stays below `fp_rate` however many keys arrive: the stage targets are
+ * fp_rate/2, fp_rate/4, ... and sum to at most fp_rate.
+ *
+ * Lookups and inserts are lock-free: older stages are only probed, the newest one takes
+ * the insert. Appending a stage is the only step that takes a lock.
+ */
+class ScalableBloomFilter : public VisitedSet {
+public:
+    static constexpr double GROWTH     = 2.0;
+    static constexpr double TIGHTENING = 0.5;
+
+    ScalableBloomFilter(size_t initial_capacity, double fp_rate);
+
+    bool            test_and_add(const std::string& key) override;
+    bool            contains(const std::string& key) const override;
+    VisitedSetStats stats() const override;
+
+    size_t stages() const;
+
+private:
+    struct Stage {
+        Stage(size_t capacity, double fp_rate);
+
+        BlockedBloomFilter filter;
+        size_t             capacity;
+        double             fp_rate;
+    };
+
+    static constexpr size_t MAX_STAGES = 32;
+
+    void grow(size_t seen_stages);
+
+    double                                      fp_rate_;
+    std::array<std::atomic<Stage*>, MAX_STAGES> stages_{};
+    std::atomic<size_t>                         num_stages_{0};
+    std::mutex                                  grow_mutex_;
+    std::vector<std::unique_ptr<Stage>>         owned_;
+};
+
+}  // namespace Mojo
@@ -0,0 +1,17 @@
+#include "visited_set.hpp"
+#include <stdexcept>
+#include "fingerprint_set.hpp"
+#include "scalable_bloom_filter.hpp"
+
+namespace Mojo {
+
+std::unique_ptr<VisitedSet>
+VisitedSet::create(const std::string& mode, size_t initial_capacity, double fp_rate) {
+    if (mode.empty() || mode == "bloom")
+        return std::make_unique<ScalableBloomFilter>(initial_capacity, fp_rate);
+    if (mode == "exact")
+        return std::make_unique<FingerprintSet>(initial_capacity);
+    throw std::invalid_argument("Unknown visited set mode: " + mode);
+}
+
+}  // namespace Mojo
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace Mojo {
+
+struct VisitedSetStats {
+    size_t items               = 0;    // Keys recorded as new
+    size_t memory_bytes        = 0;
+    size_t stages              = 1;    // Filters in the chain (scalable mode)
+    double fill_ratio          = 0.0;  // Set bits / bits, or used slots / slots
+    double false_positive_rate = 0.0;  // Chance the next new key is wrongly reported as seen
+};
+
+/**
+ * @brief Thread-safe "seen before?" set for crawl deduplication.
+ *
+ * `test_and_add()` is the only mutating call: it records the key and reports whether it
+ * was new, so callers never need their own lock around a contains/add pair.
+ */
+class VisitedSet {
+public:
+    virtual ~VisitedSet() = default;
+
+    virtual bool            test_and_add(const std::string& key) = 0;
+    virtual bool            contains(const std::string& key) const = 0;
+    virtual VisitedSetStats stats() const = 0;
+
+    /**
+     * @brief "bloom": ScalableBloomFilter held to `fp_rate` overall. "exact": FingerprintSet.
+     * @throws std::invalid_argument on an unknown mode.
+     */
+    static std::unique_ptr<VisitedSet>
+    create(const std::string& mode, size_t initial_capacity, double fp_rate);
+};
+
+}  // namespace Mojo
@@ -0,0 +1,177 @@
+#include "boilerplate.hpp"
+#include <algorithm>
+#include <functional>
+#include <string_view>
+#include <vector>
+#include "../crypto/murmur3.h"
+
+namespace Mojo {
+namespace Utils {
+namespace Text {
+
+namespace {
+
+struct Block {
+    size_t   begin       = 0;
+    size_t   end         = 0;  // Past the block's last character, before its newline
+    uint64_t fingerprint = 0;
+    bool     heading     = false;
+};
+
+bool is_blank(std::string_view line) {
+    return std::all_of(line.begin(), line.end(), [](char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    });
+}
+
+bool is_fence(std::string_view line) {
+    size_t start = line.find_first_not_of(' ');
+    return start != std::string_view::npos && line.compare(start, 3, "```") == 0;
+}
+
+/// Splits on blank lines outside fenced code.
+std::vector<Block> split_blocks(std::string_view md) {
+    std::vector<Block> blocks;
+    bool               in_block = false;
+    bool               in_fence = false;
+    size_t             pos      = 0;
+    while (pos < md.size()) {
+        size_t eol = md.find('\n', pos);
+        if (eol == std::string_view::npos)
+            eol = md.size();
+        auto line = md.substr(pos, eol - pos);
+
+        if (!in_fence && is_blank(line)) {
+            in_block = false;
+        }
+        else {
+            if (!in_block) {
+                blocks.push_back({pos, eol, 0, line.front() == '#'});
+                in_block = true;
+            }
+            blocks.back().end = eol;
+            if (is_fence(line))
+                in_fence = !in_fence;
+        }
+        pos = eol + 1;
+    }
+    return blocks;
+}
+
+uint64_t fingerprint(std::string_view text, std::string& scratch) {
+    scratch.clear();
+    for (char c : text) {
+        bool space = c == ' ' || c == '\n' || c == '\t' || c == '\r';
+        if (!space)
+            scratch += c;
+        else if (!scratch.empty() && scratch.back() != ' ')
+            scratch += ' ';
+    }
+    if (!scratch.empty() && scratch.back() == ' ')
+        scratch.pop_back();
+
+    uint64_t hash[2];
+    MurmurHash3_x64_128(scratch.data(), static_cast<int>(scratch.size()), 42, hash);
+    return hash[0];
+}
+
+}  // namespace
+
+BoilerplateFilter::BoilerplateFilter(double threshold,
+                                     size_t min_pages,
+                                     size_t max_blocks,
+                                     size_t max_hosts)
+    : threshold_(threshold),
+      min_pages_(std::max<size_t>(1, min_pages)),
+      max_blocks_(max_blocks),
+      max_hosts_(max_hosts) {
+}
+
+std::string BoilerplateFilter::filter(const std::string& host, const std::string& markdown) {
+    std::vector<Block> blocks = split_blocks(markdown);
+    if (blocks.empty())
+        return markdown;
+
+    std::string scratch;
+    for (auto& block : blocks)
+        block.fingerprint = fingerprint(
+            std::string_view(markdown).substr(block.begin, block.end - block.begin), scratch);
+
+    // Counted once per page, however often the block repeats on it
+    std::vector<uint64_t> unique;
+    unique.reserve(blocks.size());
+    for (const auto& block : blocks)
+        unique.push_back(block.fingerprint);
+    std::sort(unique.begin(), unique.end());
+    unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+
+    pages_.fetch_add(1, std::memory_order_relaxed);
+    std::vector<bool> drop(blocks.size(), false);
+    size_t            dropped = 0;
+    {
+        Shard&                      shard = shards_[std::hash<std::string>{}(host) % SHARDS];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto                        found = shard.sites.find(host);
+        if (found == shard.sites.end()) {
+            // Shards check the cap without a shared lock, so it can be passed by a few hosts.
+            if (hosts_.load(std::memory_order_relaxed) >= max_hosts_)
+                return markdown;
+            found = shard.sites.emplace(host, Site{}).first;
+            hosts_.fetch_add(1, std::memory_order_relaxed);
+        }
+        Site& site = found->second;
+        site.pages++;
+        for (uint64_t fp : unique) {
+            auto it = site.blocks.find(fp);
+            if (it != site.blocks.end())
+                it->second++;
+            else if (site.blocks.size() < max_blocks_)
+                site.blocks.emplace(fp, 1);
+        }
+
+        if (site.pages >= min_pages_) {
+            double limit = threshold_ * static_cast<double>(site.pages);
+            for (size_t i = 0; i < blocks.size(); ++i) {
+                if (blocks[i].heading)
+                    continue;
+                auto it = site.blocks.find(blocks[i].fingerprint);
+                if (it != site.blocks.end() && static_cast<double>(it->second) > limit) {
+                    drop[i] = true;
+                    dropped++;
+                }
+            }
+        }
+    }
+    if (dropped == 0)
+        return markdown;
+
+    std::string out;
+    out.reserve(markdown.size());
+    size_t removed = 0;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        if (drop[i]) {
+            removed += blocks[i].end - blocks[i].begin;
+            continue;
+        }
+        if (!out.empty())
+            out += "\n\n";
+        out.append(markdown, blocks[i].begin, blocks[i].end - blocks[i].begin);
+    }
+    if (!out.empty() && markdown.back() == '\n')
+        out += '\n';
+
+    blocks_removed_.fetch_add(dropped, std::memory_order_relaxed);
+    bytes_removed_.fetch_add(removed, std::memory_order_relaxed);
+    return out;
+}
+
+BoilerplateStats BoilerplateFilter::stats() const {
+    return {pages_.load(std::memory_order_relaxed),
+            blocks_removed_.load(std::memory_order_relaxed),
+            bytes_removed_.load(std::memory_order_relaxed),
+            hosts_.load(std::memory_order_relaxed)};
+}
+
+}  // namespace Text
+}  // namespace Utils
+}  // namespace Mojo
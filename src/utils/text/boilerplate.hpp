@@ -0,0 +1,75 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "../../core/types/constants.hpp"
+
+namespace Mojo {
+namespace Utils {
+namespace Text {
+
+struct BoilerplateStats {
+    uint64_t pages          = 0;  // Pages that went through the filter
+    uint64_t blocks_removed = 0;
+    uint64_t bytes_removed  = 0;
+    uint64_t hosts          = 0;  // Hosts whose blocks are tracked
+};
+
+/**
+ * @brief Drops Markdown blocks that repeat across the pages of one host.
+ *
+ * A block is a run of lines between blank lines; a fenced code block is one block however
+ * many blank lines it holds. Each block's text, whitespace collapsed, is hashed to 64 bits
+ * and counted once per page under the page's host. Once a host has `min_pages` pages, a
+ * block found on more than `threshold` (a fraction) of them is cut from that page and every
+ * later one, so menus, legal footers and "related articles" lists stop being stored. The
+ * first pages of a host are kept whole, since nothing is known to repeat yet. Headings are
+ * always kept: documentation repeats "## Examples" on purpose.
+ *
+ * Memory is bounded: past `max_blocks` fingerprints of a host, its new blocks are not tracked
+ * and so never removed, and past `max_hosts` hosts, pages of a new host pass through whole,
+ * so at most max_hosts * max_blocks fingerprints are held. Hosts are spread over
+ * mutex-guarded shards, so worker threads calling `filter()` concurrently rarely contend.
+ */
+class BoilerplateFilter {
+public:
+    explicit BoilerplateFilter(double threshold,
+                               size_t min_pages  = Mojo::Core::Constants::BOILERPLATE_MIN_PAGES,
+                               size_t max_blocks = Mojo::Core::Constants::BOILERPLATE_MAX_BLOCKS,
+                               size_t max_hosts  = Mojo::Core::Constants::BOILERPLATE_MAX_HOSTS);
+
+    /// Records the blocks of `markdown` for `host` and returns it without the repeated ones.
+    std::string filter(const std::string& host, const std::string& markdown);
+
+    BoilerplateStats stats() const;
+
+private:
+    static constexpr size_t SHARDS = 16;
+
+    struct Site {
+        uint64_t                               pages = 0;
+        std::unordered_map<uint64_t, uint32_t> blocks;  // Fingerprint -> pages it was on
+    };
+
+    struct alignas(64) Shard {
+        std::mutex                            mutex;
+        std::unordered_map<std::string, Site> sites;
+    };
+
+    double                    threshold_;
+    size_t                    min_pages_;
+    size_t                    max_blocks_;
+    size_t                    max_hosts_;
+    std::array<Shard, SHARDS> shards_;
+    std::atomic<uint64_t>     hosts_{0};
+    std::atomic<uint64_t>     pages_{0};
+    std::atomic<uint64_t>     blocks_removed_{0};
+    std::atomic<uint64_t>     bytes_removed_{0};
+};
+
+}  // namespace Text
+}  // namespace Utils
+}  // namespace Mojo
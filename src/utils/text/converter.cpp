@@ -1,49 +1,125 @@
 #include "converter.hpp"
-#include <gumbo.h>
-#include <sstream>
+#include <cctype>
 #include <string>
 #include <vector>
 #include "html2md.h"
+#include "html_parser.hpp"
+#include "readability.hpp"
 
 namespace Mojo {
 namespace Utils {
 namespace Text {
 
-namespace {
-
-void collect_links(GumboNode* node, std::vector<std::string>& links) {
-    if (node->type != GUMBO_NODE_ELEMENT)
-        return;
-
-    if (node->v.element.tag == GUMBO_TAG_A) {
-        GumboAttribute* href = gumbo_get_attribute(&node->v.element.attributes, "href");
-        if (href) {
-            links.emplace_back(href->value);
-        }
+ProcessedPage Converter::process(const std::string& html,
+                                 bool               with_links,
+                                 const HtmlParser*  parser,
+                                 const Readability* readability) {
+    if (readability != nullptr) {
+        ProcessedPage page;
+        bool          scan_links = with_links && parser == nullptr;
+        MainContent   content    = readability->find(html, scan_links ? &page.links : nullptr);
+        // No block holds enough text on index and landing pages; those are kept whole
+        page.markdown = content.found()
+                            ? to_markdown(html.substr(content.begin, content.end - content.begin))
+                            : to_markdown(html);
+        if (with_links && parser != nullptr)
+            page.links = parser->anchors(html);
+        return page;
     }
 
-    const GumboVector* children = &node->v.element.children;
-    for (unsigned int i = 0; i < children->length; ++i) {
-        collect_links(static_cast<GumboNode*>(children->data[i]), links);
+    if (parser != nullptr) {
+        ProcessedPage page;
+        page.markdown = to_markdown(html);
+        if (with_links)
+            page.links = parser->anchors(html);
+        return page;
     }
-}
 
-}  // namespace
+    html2md::Options options;
+    options.collectAnchors = with_links;
+    html2md::Converter converter(html, &options);
+
+    ProcessedPage page;
+    page.markdown = converter.convert();
+    page.links.reserve(converter.anchors().size());
+    for (const auto& anchor : converter.anchors())
+        page.links.push_back({anchor.href, anchor.text});
+    return page;
+}
 
 std::string Converter::to_markdown(const std::string& html) {
     return html2md::Convert(html);
 }
 
+std::string Converter::extract_title(std::string_view html) {
+    auto starts_with_tag = [&](size_t pos, std::string_view tag) {
+        if (html.size() - pos <= tag.size())
+            return false;
+        for (size_t i = 0; i < tag.size(); ++i) {
+            if (std::tolower(static_cast<unsigned char>(html[pos + i])) != tag[i])
+                return false;
+        }
+        char next = html[pos + tag.size()];
+        return next == '>' || next == '/' || std::isspace(static_cast<unsigned char>(next));
+    };
+    auto find_tag = [&](size_t from, std::string_view tag) {
+        for (size_t pos = html.find('<', from); pos != std::string_view::npos;
+             pos       = html.find('<', pos + 1)) {
+            if (starts_with_tag(pos, tag))
+                return pos;
+        }
+        return std::string_view::npos;
+    };
+
+    // Only the head is searched: a <title> in the body belongs to inline SVG, not the page.
+    size_t open = std::string_view::npos;
+    for (size_t pos = html.find('<'); pos != std::string_view::npos;
+         pos       = html.find('<', pos + 1)) {
+        if (starts_with_tag(pos, "<title")) {
+            open = pos;
+            break;
+        }
+        if (starts_with_tag(pos, "</head") || starts_with_tag(pos, "<body"))
+            break;
+    }
+    if (open == std::string_view::npos)
+        return {};
+    size_t begin = html.find('>', open);
+    if (begin == std::string_view::npos)
+        return {};
+    begin++;
+    size_t end = find_tag(begin, "</title");
+    if (end == std::string_view::npos)
+        end = html.size();
+
+    std::string title;
+    for (char c : html.substr(begin, end - begin)) {
+        if (!std::isspace(static_cast<unsigned char>(c)))
+            title += c;
+        else if (!title.empty() && title.back() != ' ')
+            title += ' ';
+    }
+    if (!title.empty() && title.back() == ' ')
+        title.pop_back();
+    html2md::Converter::DecodeDefaultHtmlSymbols(&title);
+    return title;
+}
+
 std::vector<std::string> Converter::extract_links(const std::string& html) {
-    std::vector<std::string> links;
-    if (html.empty())
-        return links;
+    return HtmlParser::reference().links(html);
+}
+
+std::vector<std::string> Converter::extract_links(const std::string& html,
+                                                  const HtmlParser&  parser) {
+    return parser.links(html);
+}
 
-    GumboOutput* output = gumbo_parse(html.c_str());
-    collect_links(output->root, links);
-    gumbo_destroy_output(&kGumboDefaultOptions, output);
+std::vector<Link> Converter::extract_anchors(const std::string& html) {
+    return HtmlParser::reference().anchors(html);
+}
 
-    return links;
+std::vector<Link> Converter::extract_anchors(const std::string& html, const HtmlParser& parser) {
+    return parser.anchors(html);
 }
 
 }  // namespace Text
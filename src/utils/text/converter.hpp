@@ -1,15 +1,56 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace Mojo {
 namespace Utils {
 namespace Text {
 
+struct Link {
+    std::string href;
+    std::string text;  // Anchor text, whitespace-collapsed
+};
+
+struct ProcessedPage {
+    std::string       markdown;
+    std::vector<Link> links;
+};
+
+class HtmlParser;
+class Readability;
+
 class Converter {
 public:
-    static std::string              to_markdown(const std::string& html);
+    /**
+     * @brief Markdown and outgoing links from a single pass over the HTML.
+     *
+     * By default the links come from the same html2md walk that writes the Markdown, so the
+     * page is not parsed a second time. Passing a `parser` takes them from that backend's DOM
+     * instead. With `with_links` off this is just `to_markdown()`.
+     *
+     * With `readability`, only the page's main content block is converted; links still come
+     * from the whole page, from the scan that found the block unless a `parser` is given.
+     */
+    static ProcessedPage process(const std::string& html,
+                                 bool               with_links  = true,
+                                 const HtmlParser*  parser      = nullptr,
+                                 const Readability* readability = nullptr);
+    static std::string   to_markdown(const std::string& html);
+
+    /**
+     * @brief Text of the page's `<title>`, entities decoded and whitespace collapsed; "" if
+     * there is none before `</head>` or `<body>`.
+     */
+    static std::string extract_title(std::string_view html);
+
+    /// Links from the reference (Gumbo) backend, or from `parser` when given.
     static std::vector<std::string> extract_links(const std::string& html);
+    static std::vector<std::string> extract_links(const std::string& html,
+                                                  const HtmlParser&  parser);
+    static std::vector<Link>        extract_anchors(const std::string& html);
+    static std::vector<Link>        extract_anchors(const std::string& html,
+                                                    const HtmlParser&  parser);
 };
 
 }  // namespace Text
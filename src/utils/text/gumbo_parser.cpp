@@ -0,0 +1,110 @@
+#include <gumbo.h>
+#include "html_parser.hpp"
+
+namespace Mojo {
+namespace Utils {
+namespace Text {
+
+namespace {
+
+void collect_links(GumboNode* node, std::vector<std::string>& links) {
+    if (node->type != GUMBO_NODE_ELEMENT)
+        return;
+
+    if (node->v.element.tag == GUMBO_TAG_A) {
+        GumboAttribute* href = gumbo_get_attribute(&node->v.element.attributes, "href");
+        if (href) {
+            links.emplace_back(href->value);
+        }
+    }
+
+    const GumboVector* children = &node->v.element.children;
+    for (unsigned int i = 0; i < children->length; ++i) {
+        collect_links(static_cast<GumboNode*>(children->data[i]), links);
+    }
+}
+
+void append_text(const GumboNode* node, std::string& out) {
+    if (out.size() >= HtmlParser::MAX_ANCHOR_TEXT)
+        return;
+    if (node->type == GUMBO_NODE_TEXT || node->type == GUMBO_NODE_WHITESPACE) {
+        append_anchor_text(out, node->v.text.text);
+        return;
+    }
+    if (node->type != GUMBO_NODE_ELEMENT)
+        return;
+    const GumboVector* children = &node->v.element.children;
+    for (unsigned int i = 0; i < children->length; ++i) {
+        append_text(static_cast<const GumboNode*>(children->data[i]), out);
+    }
+}
+
+void collect_anchors(GumboNode* node, std::vector<Link>& links) {
+    if (node->type != GUMBO_NODE_ELEMENT)
+        return;
+
+    if (node->v.element.tag == GUMBO_TAG_A) {
+        GumboAttribute* href = gumbo_get_attribute(&node->v.element.attributes, "href");
+        if (href) {
+            Link link{href->value, {}};
+            append_text(node, link.text);
+            finish_anchor_text(link.text);
+            links.push_back(std::move(link));
+        }
+    }
+
+    const GumboVector* children = &node->v.element.children;
+    for (unsigned int i = 0; i < children->length; ++i) {
+        collect_anchors(static_cast<GumboNode*>(children->data[i]), links);
+    }
+}
+
+/// Owns one parse, so an exception while walking the tree cannot leak it.
+class GumboDocument {
+public:
+    explicit GumboDocument(const std::string& html) : output_(gumbo_parse(html.c_str())) {
+    }
+    ~GumboDocument() {
+        gumbo_destroy_output(&kGumboDefaultOptions, output_);
+    }
+
+    GumboDocument(const GumboDocument&)            = delete;
+    GumboDocument& operator=(const GumboDocument&) = delete;
+
+    GumboNode* root() const {
+        return output_->root;
+    }
+
+private:
+    GumboOutput* output_;
+};
+
+}  // namespace
+
+std::string_view GumboParser::name() const {
+    return "gumbo";
+}
+
+std::vector<std::string> GumboParser::links(const std::string& html) const {
+    std::vector<std::string> links;
+    if (html.empty())
+        return links;
+
+    GumboDocument document(html);
+    collect_links(document.root(), links);
+    return links;
+}
+
+std::vector<Link> GumboParser::anchors(const std::string& html) const {
+    std::vector<Link> links;
+    if (html.empty())
+        return links;
+
+    GumboDocument document(html);
+    collect_anchors(document.root(), links);
+    return links;
+}
+
+}  // namespace Text
+}  // namespace Utils
+}  // namespace Mojo
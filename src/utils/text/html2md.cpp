@@ -3,13 +3,16 @@
 #include "table.h"
 
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cctype>
 #include <cstring>
-#include <memory>
-#include <sstream>
 #include <vector>
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define HTML2MD_X86_SIMD 1
+#include <immintrin.h>
+#endif
 
-using std::make_shared;
 using std::string;
 using std::vector;
 
@@ -39,33 +42,123 @@ size_t ReplaceAll(string* haystack, const string& needle, const string& replacem
     return amount_replaced;
 }
 
-string Repeat(const string& str, size_t amount) {
-    if (amount == 0)
-        return "";
-    else if (amount == 1)
-        return str;
-
-    if (str.size() == 1)
-        return string(amount, str[0]);
-
-    string out;
-    out.reserve(str.size() * amount);
-    for (size_t i = 0; i < amount; ++i)
-        out.append(str);
-
-    return out;
+// Position of `lower_needle` in `haystack`, ignoring ASCII case in the haystack
+size_t FindIgnoringCase(std::string_view haystack, std::string_view lower_needle) {
+    if (lower_needle.size() > haystack.size())
+        return string::npos;
+    for (size_t i = 0; i + lower_needle.size() <= haystack.size(); ++i) {
+        size_t j = 0;
+        while (j < lower_needle.size()) {
+            char ch = haystack[i + j];
+            if (ch >= 'A' && ch <= 'Z')
+                ch = static_cast<char>(ch + ('a' - 'A'));
+            if (ch != lower_needle[j])
+                break;
+            ++j;
+        }
+        if (j == lower_needle.size())
+            return i;
+    }
+    return string::npos;
 }
 
-string toLower(const string& str) {
-    string lower;
-    lower.reserve(str.size());
-    for (char ch : str) {
-        if (ch >= 'A' && ch <= 'Z')
-            lower += (char)(ch + ('a' - 'A'));
-        else
-            lower += ch;
+template <char... Needles>
+size_t ScanScalar(const char* data, size_t size, size_t from = 0) {
+    for (size_t i = from; i < size; ++i) {
+        if (((data[i] == Needles) || ...))
+            return i;
+    }
+    return size;
+}
+
+#ifdef HTML2MD_X86_SIMD
+template <char... Needles>
+__attribute__((target("avx2"))) size_t ScanAvx2(const char* data, size_t size) {
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i hits  = _mm256_setzero_si256();
+        ((hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(Needles)))), ...);
+        auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+        if (mask != 0)
+            return i + static_cast<size_t>(std::countr_zero(mask));
+    }
+    return ScanScalar<Needles...>(data, size, i);
+}
+
+// SSE2 is part of the x86-64 baseline, so this needs no dispatch
+template <char... Needles>
+size_t ScanSse2(const char* data, size_t size) {
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i hits  = _mm_setzero_si128();
+        ((hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(Needles)))), ...);
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(hits));
+        if (mask != 0)
+            return i + static_cast<size_t>(std::countr_zero(mask));
+    }
+    return ScanScalar<Needles...>(data, size, i);
+}
+
+const bool kHasAvx2 = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+}();
+#endif
+
+// Index of the first byte in `data` equal to one of `Needles`, or `size`
+template <char... Needles>
+size_t Scan(const char* data, size_t size) {
+#ifdef HTML2MD_X86_SIMD
+    return kHasAvx2 ? ScanAvx2<Needles...>(data, size) : ScanSse2<Needles...>(data, size);
+#else
+    return ScanScalar<Needles...>(data, size);
+#endif
+}
+
+template <typename T>
+struct TagEntry {
+    std::string_view name;
+    const T*         tag;
+};
+
+constexpr size_t kTagSlots = 256;
+
+// FNV-1a, salted with a seed chosen at compile time so the known tags do not collide
+constexpr uint32_t TagHash(std::string_view name, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ seed;
+    for (char ch : name) {
+        hash ^= static_cast<unsigned char>(ch);
+        hash *= 16777619u;
+    }
+    return hash % kTagSlots;
+}
+
+template <typename T, size_t N>
+constexpr uint32_t FindPerfectSeed(const std::array<TagEntry<T>, N>& entries) {
+    for (uint32_t seed = 0;; ++seed) {
+        bool used[kTagSlots] = {};
+        bool collision       = false;
+        for (const auto& entry : entries) {
+            uint32_t slot = TagHash(entry.name, seed);
+            collision     = collision || used[slot];
+            used[slot]    = true;
+        }
+        if (!collision)
+            return seed;
     }
-    return lower;
+}
+
+// Slot -> 1 + index into entries, 0 for empty
+template <typename T, size_t N>
+constexpr std::array<uint8_t, kTagSlots> BuildSlots(const std::array<TagEntry<T>, N>& entries,
+                                                    uint32_t                           seed) {
+    static_assert(N < 255);
+    std::array<uint8_t, kTagSlots> slots{};
+    for (size_t i = 0; i < N; ++i)
+        slots[TagHash(entries[i].name, seed)] = static_cast<uint8_t>(i + 1);
+    return slots;
 }
 
 }  // namespace
@@ -76,94 +169,104 @@ Converter::Converter(const string* html, const Options* options) : html_(*html)
     if (options)
         option = *options;
 
-    md_.reserve(static_cast<size_t>(html->size() * 1.2));
-    tags_.reserve(41);
-
-    auto tagIgnored     = make_shared<Converter::TagIgnored>();
-    tags_[kTagHead]     = tagIgnored;
-    tags_[kTagMeta]     = tagIgnored;
-    tags_[kTagNav]      = tagIgnored;
-    tags_[kTagNoScript] = tagIgnored;
-    tags_[kTagScript]   = tagIgnored;
-    tags_[kTagStyle]    = tagIgnored;
-    tags_[kTagTemplate] = tagIgnored;
-
-    tags_[kTagAnchor]        = make_shared<Converter::TagAnchor>();
-    tags_[kTagBreak]         = make_shared<Converter::TagBreak>();
-    tags_[kTagDiv]           = make_shared<Converter::TagDiv>();
-    tags_[kTagHeader1]       = make_shared<Converter::TagHeader1>();
-    tags_[kTagHeader2]       = make_shared<Converter::TagHeader2>();
-    tags_[kTagHeader3]       = make_shared<Converter::TagHeader3>();
-    tags_[kTagHeader4]       = make_shared<Converter::TagHeader4>();
-    tags_[kTagHeader5]       = make_shared<Converter::TagHeader5>();
-    tags_[kTagHeader6]       = make_shared<Converter::TagHeader6>();
-    tags_[kTagListItem]      = make_shared<Converter::TagListItem>();
-    tags_[kTagOption]        = make_shared<Converter::TagOption>();
-    tags_[kTagOrderedList]   = make_shared<Converter::TagOrderedList>();
-    tags_[kTagPre]           = make_shared<Converter::TagPre>();
-    tags_[kTagCode]          = make_shared<Converter::TagCode>();
-    tags_[kTagParagraph]     = make_shared<Converter::TagParagraph>();
-    tags_[kTagSpan]          = make_shared<Converter::TagSpan>();
-    tags_[kTagUnorderedList] = make_shared<Converter::TagUnorderedList>();
-    tags_[kTagTitle]         = make_shared<Converter::TagTitle>();
-    tags_[kTagImg]           = make_shared<Converter::TagImage>();
-    tags_[kTagSeperator]     = make_shared<Converter::TagSeperator>();
-
-    auto tagBold      = make_shared<Converter::TagBold>();
-    tags_[kTagBold]   = tagBold;
-    tags_[kTagStrong] = tagBold;
-
-    auto tagItalic        = make_shared<Converter::TagItalic>();
-    tags_[kTagItalic]     = tagItalic;
-    tags_[kTagItalic2]    = tagItalic;
-    tags_[kTagDefinition] = tagItalic;
-    tags_[kTagCitation]   = tagItalic;
-
-    tags_[kTagUnderline] = make_shared<Converter::TagUnderline>();
-
-    auto tagStrighthrought     = make_shared<Converter::TagStrikethrought>();
-    tags_[kTagStrighthrought]  = tagStrighthrought;
-    tags_[kTagStrighthrought2] = tagStrighthrought;
-
-    tags_[kTagBlockquote] = make_shared<Converter::TagBlockquote>();
-
-    tags_[kTagTable]       = make_shared<Converter::TagTable>();
-    tags_[kTagTableRow]    = make_shared<Converter::TagTableRow>();
-    tags_[kTagTableHeader] = make_shared<Converter::TagTableHeader>();
-    tags_[kTagTableData]   = make_shared<Converter::TagTableData>();
+    md_.reserve(static_cast<size_t>(static_cast<double>(html->size()) * 1.2));
+}
+
+const Converter::SymbolMap& Converter::DefaultHtmlSymbols() {
+    static const SymbolMap symbols = {{"&quot;", "\""},
+                                      {"&lt;", "<"},
+                                      {"&gt;", ">"},
+                                      {"&amp;", "&"},
+                                      {"&nbsp;", " "},
+                                      {"&rarr;", "→"}};
+    return symbols;
+}
+
+const Converter::Tag* Converter::FindTag(std::string_view name) {
+    static const TagIgnored        ignored;
+    static const TagAnchor         anchor;
+    static const TagBreak          line_break;
+    static const TagDiv            div;
+    static const TagHeader1        header1;
+    static const TagHeader2        header2;
+    static const TagHeader3        header3;
+    static const TagHeader4        header4;
+    static const TagHeader5        header5;
+    static const TagHeader6        header6;
+    static const TagListItem       list_item;
+    static const TagOption         option;
+    static const TagOrderedList    ordered_list;
+    static const TagPre            pre;
+    static const TagCode           code;
+    static const TagParagraph      paragraph;
+    static const TagSpan           span;
+    static const TagUnorderedList  unordered_list;
+    static const TagTitle          title;
+    static const TagImage          image;
+    static const TagSeperator      seperator;
+    static const TagBold           bold;
+    static const TagItalic         italic;
+    static const TagUnderline      underline;
+    static const TagStrikethrought strikethrough;
+    static const TagBlockquote     blockquote;
+    static const TagTable          table;
+    static const TagTableRow       table_row;
+    static const TagTableHeader    table_header;
+    static const TagTableData      table_data;
+
+    static constexpr std::array<TagEntry<Tag>, 41> entries = {{{kTagHead, &ignored},
+                                                          {kTagMeta, &ignored},
+                                                          {kTagNav, &ignored},
+                                                          {kTagNoScript, &ignored},
+                                                          {kTagScript, &ignored},
+                                                          {kTagStyle, &ignored},
+                                                          {kTagTemplate, &ignored},
+                                                          {kTagAnchor, &anchor},
+                                                          {kTagBreak, &line_break},
+                                                          {kTagDiv, &div},
+                                                          {kTagHeader1, &header1},
+                                                          {kTagHeader2, &header2},
+                                                          {kTagHeader3, &header3},
+                                                          {kTagHeader4, &header4},
+                                                          {kTagHeader5, &header5},
+                                                          {kTagHeader6, &header6},
+                                                          {kTagListItem, &list_item},
+                                                          {kTagOption, &option},
+                                                          {kTagOrderedList, &ordered_list},
+                                                          {kTagPre, &pre},
+                                                          {kTagCode, &code},
+                                                          {kTagParagraph, &paragraph},
+                                                          {kTagSpan, &span},
+                                                          {kTagUnorderedList, &unordered_list},
+                                                          {kTagTitle, &title},
+                                                          {kTagImg, &image},
+                                                          {kTagSeperator, &seperator},
+                                                          {kTagBold, &bold},
+                                                          {kTagStrong, &bold},
+                                                          {kTagItalic, &italic},
+                                                          {kTagItalic2, &italic},
+                                                          {kTagDefinition, &italic},
+                                                          {kTagCitation, &italic},
+                                                          {kTagUnderline, &underline},
+                                                          {kTagStrighthrought, &strikethrough},
+                                                          {kTagStrighthrought2, &strikethrough},
+                                                          {kTagBlockquote, &blockquote},
+                                                          {kTagTable, &table},
+                                                          {kTagTableRow, &table_row},
+                                                          {kTagTableHeader, &table_header},
+                                                          {kTagTableData, &table_data}}};
+    static constexpr uint32_t seed  = FindPerfectSeed(entries);
+    static constexpr auto     slots = BuildSlots(entries, seed);
+
+    uint8_t slot = slots[TagHash(name, seed)];
+    if (slot == 0 || entries[slot - 1].name != name)
+        return nullptr;
+    return entries[slot - 1].tag;
 }
 
 void Converter::CleanUpMarkdown() {
     TidyAllLines(&md_);
-    std::string buffer;
-    buffer.reserve(md_.size());
-
-    if (!option.keepHtmlEntities) {
-        for (size_t i = 0; i < md_.size();) {
-            bool replaced = false;
-
-            for (const auto& symbol_replacement : htmlSymbolConversions_) {
-                const std::string& symbol      = symbol_replacement.first;
-                const std::string& replacement = symbol_replacement.second;
-
-                if (md_.compare(i, symbol.size(), symbol) == 0) {
-                    buffer.append(replacement);
-                    i += symbol.size();
-                    replaced = true;
-                    break;
-                }
-            }
-
-            if (!replaced) {
-                buffer.push_back(md_[i++]);
-            }
-        }
-    }
-    else {
-        buffer.append(md_);
-    }
-
-    md_.swap(buffer);
+    DecodeHtmlSymbols(&md_);
 
     const char* replacements[][2] = {
         {" , ", ", "},
@@ -179,6 +282,93 @@ void Converter::CleanUpMarkdown() {
     }
 }
 
+void Converter::DecodeHtmlSymbols(string* s) const {
+    if (!option.keepHtmlEntities)
+        DecodeHtmlSymbols(s, HtmlSymbols());
+}
+
+void Converter::DecodeDefaultHtmlSymbols(string* s) {
+    DecodeHtmlSymbols(s, DefaultHtmlSymbols());
+}
+
+void Converter::DecodeHtmlSymbols(string* s, const SymbolMap& symbols) {
+    bool starts_symbol[256] = {};
+    bool in_place           = true;
+    for (const auto& [symbol, replacement] : symbols) {
+        if (symbol.empty())
+            continue;
+        starts_symbol[static_cast<unsigned char>(symbol[0])] = true;
+        in_place &= replacement.size() <= symbol.size();
+    }
+
+    // The default replacements are all shorter than their entities, so the
+    // text is rewritten in place; a longer custom one needs a second buffer.
+    string buffer;
+    if (!in_place)
+        buffer.reserve(s->size());
+    size_t write = 0;
+    auto   emit  = [&](std::string_view piece) {
+        if (in_place) {
+            std::copy(piece.begin(), piece.end(), s->begin() + static_cast<ptrdiff_t>(write));
+            write += piece.size();
+        }
+        else {
+            buffer.append(piece);
+        }
+    };
+
+    for (size_t i = 0; i < s->size();) {
+        if (starts_symbol[static_cast<unsigned char>((*s)[i])]) {
+            auto match = std::find_if(symbols.begin(), symbols.end(), [&](const auto& entry) {
+                return !entry.first.empty() && s->compare(i, entry.first.size(), entry.first) == 0;
+            });
+            if (match != symbols.end()) {
+                i += match->first.size();
+                emit(match->second);
+                continue;
+            }
+        }
+        char ch = (*s)[i++];
+        emit(std::string_view(&ch, 1));
+    }
+
+    if (in_place)
+        s->resize(write);
+    else
+        s->swap(buffer);
+}
+
+void Converter::OpenAnchor(std::string_view href) {
+    if (is_in_anchor_)
+        CloseAnchor();  // <a> does not nest; an unclosed one ends at the next
+    // The tokenizer does not know raw-text elements, so markup inside a script is not a link
+    if (href.empty() || prev_tag_ == kTagScript || prev_tag_ == kTagStyle
+        || prev_tag_ == kTagTemplate)
+        return;
+
+    anchors_.push_back({string(href), {}});
+    DecodeHtmlSymbols(&anchors_.back().href);
+    is_in_anchor_ = true;
+}
+
+void Converter::CloseAnchor() {
+    is_in_anchor_ = false;
+    string& text  = anchors_.back().text;
+    if (!text.empty() && text.back() == ' ')
+        text.pop_back();
+    DecodeHtmlSymbols(&text);
+}
+
+void Converter::AppendAnchorText(char ch) {
+    string& text = anchors_.back().text;
+    if (text.size() >= kMaxAnchorText)
+        return;
+    if (ch != ' ' && ch != '\n' && ch != '\t' && ch != '\r')
+        text += ch;
+    else if (!text.empty() && text.back() != ' ')
+        text += ' ';
+}
+
 Converter* Converter::appendToMd(char ch) {
     if (IsInIgnoredTag())
         return this;
@@ -187,7 +377,7 @@ Converter* Converter::appendToMd(char ch) {
         if (is_in_pre_) {
             md_ += ch;
             chars_in_curr_line_ = 0;
-            appendToMd(Repeat("> ", index_blockquote));
+            appendRepeatedToMd("> ", index_blockquote);
         }
 
         return this;
@@ -204,20 +394,27 @@ Converter* Converter::appendToMd(char ch) {
 }
 
 Converter* Converter::appendToMd(const char* str) {
+    return appendToMd(std::string_view(str));
+}
+
+Converter* Converter::appendToMd(std::string_view str) {
     if (IsInIgnoredTag())
         return this;
 
     md_ += str;
 
-    auto str_len = strlen(str);
+    auto newline = str.rfind('\n');
+    if (newline == std::string_view::npos)
+        chars_in_curr_line_ += str.size();
+    else
+        chars_in_curr_line_ = str.size() - newline - 1;
 
-    for (size_t i = 0; i < str_len; ++i) {
-        if (str[i] == '\n')
-            chars_in_curr_line_ = 0;
-        else
-            ++chars_in_curr_line_;
-    }
+    return this;
+}
 
+Converter* Converter::appendRepeatedToMd(std::string_view str, size_t amount) {
+    for (size_t i = 0; i < amount; ++i)
+        appendToMd(str);
     return this;
 }
 
@@ -360,11 +557,10 @@ void Converter::TidyAllLines(string* str) {
     str->resize(write);
 }
 
-string Converter::ExtractAttributeFromTagLeftOf(const string& attr) {
-    auto   tag      = html_.substr(offset_lt_, index_ch_in_html_ - offset_lt_);
-    string lowerTag = toLower(tag);  // Convert tag to lowercase for comparison
+std::string_view Converter::ExtractAttributeFromTagLeftOf(std::string_view attr) const {
+    auto tag = html_.substr(offset_lt_, index_ch_in_html_ - offset_lt_);
 
-    auto offset_attr = lowerTag.find(attr);
+    auto offset_attr = FindIgnoringCase(tag, attr);
 
     if (offset_attr == string::npos)
         return "";
@@ -421,13 +617,15 @@ string Converter::ExtractAttributeFromTagLeftOf(const string& attr) {
 }
 
 void Converter::TurnLineIntoHeader1() {
-    appendToMd('\n' + Repeat("=", chars_in_curr_line_) + "\n\n");
+    size_t width = chars_in_curr_line_;
+    appendToMd("\n")->appendRepeatedToMd("=", width)->appendToMd("\n\n");
 
     chars_in_curr_line_ = 0;
 }
 
 void Converter::TurnLineIntoHeader2() {
-    appendToMd('\n' + Repeat("-", chars_in_curr_line_) + "\n\n");
+    size_t width = chars_in_curr_line_;
+    appendToMd("\n")->appendRepeatedToMd("-", width)->appendToMd("\n\n");
 
     chars_in_curr_line_ = 0;
 }
@@ -438,7 +636,17 @@ string Converter::convert() {
 
     reset();
 
-    for (char ch : html_) {
+    while (index_ch_in_html_ < html_.size()) {
+        char ch = html_[index_ch_in_html_];
+
+        if (!is_in_tag_ && ch != '<') {
+            size_t run = AppendTextRun(html_.substr(index_ch_in_html_));
+            if (run > 0) {
+                index_ch_in_html_ += run;
+                continue;
+            }
+        }
+
         ++index_ch_in_html_;
 
         if (!is_in_tag_ && ch == '<') {
@@ -453,6 +661,9 @@ string Converter::convert() {
             ParseCharInTagContent(ch);
     }
 
+    if (is_in_anchor_)
+        CloseAnchor();
+
     CleanUpMarkdown();
 
     if (md_.size() >= 2 && md_[md_.size() - 1] == '\n' && md_[md_.size() - 2] == '\n') {
@@ -463,7 +674,7 @@ string Converter::convert() {
 }
 
 void Converter::OnHasEnteredTag() {
-    offset_lt_      = static_cast<uint16_t>(index_ch_in_html_);
+    offset_lt_      = index_ch_in_html_;
     is_in_tag_      = true;
     is_closing_tag_ = false;
     prev_tag_       = current_tag_;
@@ -486,12 +697,10 @@ Converter* Converter::UpdatePrevChFromMd() {
 }
 
 bool Converter::ParseCharInTag(char ch) {
-    static bool skipping_leading_whitespace = true;
-
     if (ch == '/' && !is_in_attribute_value_) {
         is_closing_tag_             = current_tag_.empty();
         is_self_closing_tag_        = !is_closing_tag_;
-        skipping_leading_whitespace = true;  // Reset for next tag
+        skipping_leading_whitespace_ = true;  // Reset for next tag
         return true;
     }
 
@@ -499,7 +708,7 @@ bool Converter::ParseCharInTag(char ch) {
         while (!current_tag_.empty() && std::isspace(current_tag_.back())) {
             current_tag_.pop_back();
         }
-        skipping_leading_whitespace = true;  // Reset for next tag
+        skipping_leading_whitespace_ = true;  // Reset for next tag
         if (!is_self_closing_tag_)
             return OnHasLeftTag();
         else {
@@ -510,9 +719,11 @@ bool Converter::ParseCharInTag(char ch) {
         }
     }
 
-    if (ch == '"') {
+    if (ch == '"' || ch == '\'') {
         if (is_in_attribute_value_) {
-            is_in_attribute_value_ = false;
+            // The other quote is part of the value: href="it's" or href='say "hi"'
+            if (ch == attribute_quote_)
+                is_in_attribute_value_ = false;
         }
         else {
             size_t pos = current_tag_.length();
@@ -521,17 +732,18 @@ bool Converter::ParseCharInTag(char ch) {
             }
             if (pos > 0 && current_tag_[pos - 1] == '=') {
                 is_in_attribute_value_ = true;
+                attribute_quote_       = ch;
             }
         }
-        skipping_leading_whitespace = false;  // Stop skipping after attribute
+        skipping_leading_whitespace_ = false;  // Stop skipping after attribute
         return true;
     }
 
-    if (isspace(ch) && skipping_leading_whitespace) {
+    if (isspace(ch) && skipping_leading_whitespace_) {
         return true;  // Ignore leading whitespace
     }
 
-    skipping_leading_whitespace = false;
+    skipping_leading_whitespace_ = false;
     if (ch >= 'A' && ch <= 'Z')
         current_tag_ += (char)(ch + ('a' - 'A'));
     else
@@ -556,7 +768,7 @@ bool Converter::OnHasLeftTag() {
     if (current_tag_.empty())
         return true;
 
-    auto tag = tags_[current_tag_];
+    const Tag* tag = FindTag(current_tag_);
 
     if (!tag)
         return true;
@@ -585,11 +797,14 @@ Converter* Converter::ShortenMarkdown(size_t chars) {
 }
 
 bool Converter::ParseCharInTagContent(char ch) {
+    if (is_in_anchor_ && !IsInIgnoredTag())
+        AppendAnchorText(ch);
+
     if (is_in_code_) {
         md_ += ch;
 
         if (index_blockquote != 0 && ch == '\n')
-            appendToMd(Repeat("> ", index_blockquote));
+            appendRepeatedToMd("> ", index_blockquote);
 
         return true;
     }
@@ -615,7 +830,7 @@ bool Converter::ParseCharInTagContent(char ch) {
         if (index_blockquote != 0) {
             md_ += '\n';
             chars_in_curr_line_ = 0;
-            appendToMd(Repeat("> ", index_blockquote));
+            appendRepeatedToMd("> ", index_blockquote);
         }
 
         return true;
@@ -678,6 +893,43 @@ bool Converter::ParseCharInTagContent(char ch) {
     return false;
 }
 
+size_t Converter::AppendTextRun(std::string_view text) {
+    if (option.compressWhitespace)
+        return 0;
+
+    bool   ignored = IsInIgnoredTag();
+    size_t run     = 0;
+    if (is_in_code_) {
+        // Newlines may need a blockquote prefix
+        run = Scan<'<', '\n'>(text.data(), text.size());
+        md_.append(text.data(), run);
+    }
+    else if (ignored || current_tag_ == kTagLink) {
+        run = Scan<'<'>(text.data(), text.size());
+        if (run > 0)
+            prev_ch_in_html_ = text[run - 1];
+    }
+    else {
+        // Stop where ParseCharInTagContent would start checking for a line break
+        size_t limit = text.size();
+        if (option.splitLines && !is_in_table_ && !is_in_list_ && current_tag_ != kTagImg
+            && current_tag_ != kTagAnchor) {
+            if (chars_in_curr_line_ >= option.softBreak)
+                return 0;
+            limit = std::min(limit, option.softBreak - chars_in_curr_line_);
+        }
+        run = Scan<'<', '\n', '*', '`', '\\', '.'>(text.data(), limit);
+        md_.append(text.data(), run);
+        chars_in_curr_line_ += run;
+    }
+
+    if (is_in_anchor_ && !ignored) {
+        for (size_t i = 0; i < run; ++i)
+            AppendAnchorText(text[i]);
+    }
+    return run;
+}
+
 bool Converter::ReplacePreviousSpaceInLineByNewline() {
     if (current_tag_ == kTagParagraph
         || (is_in_table_ && (prev_tag_ != kTagCode && prev_tag_ != kTagPre)))
@@ -705,23 +957,29 @@ bool Converter::ReplacePreviousSpaceInLineByNewline() {
     return false;
 }
 
-void Converter::TagAnchor::OnHasLeftOpeningTag(Converter* c) {
+void Converter::TagAnchor::OnHasLeftOpeningTag(Converter* c) const {
     if (c->prev_tag_ == kTagImg)
         c->appendToMd('\n');
 
-    current_title_ = c->ExtractAttributeFromTagLeftOf(kAttributeTitle);
+    c->anchor_title_ = c->ExtractAttributeFromTagLeftOf(kAttributeTitle);
 
     c->appendToMd('[');
-    current_href_ = c->ExtractAttributeFromTagLeftOf(kAttributeHref);
+    c->anchor_href_ = c->ExtractAttributeFromTagLeftOf(kAttributeHref);
+
+    if (c->option.collectAnchors)
+        c->OpenAnchor(c->anchor_href_);
 }
 
-void Converter::TagAnchor::OnHasLeftClosingTag(Converter* c) {
+void Converter::TagAnchor::OnHasLeftClosingTag(Converter* c) const {
+    if (c->is_in_anchor_)
+        c->CloseAnchor();
+
     if (!c->shortIfPrevCh('[')) {
-        c->appendToMd("](")->appendToMd(current_href_);
+        c->appendToMd("](")->appendToMd(c->anchor_href_);
 
-        if (!current_title_.empty()) {
-            c->appendToMd(" \"")->appendToMd(current_title_)->appendToMd('"');
-            current_title_.clear();
+        if (!c->anchor_title_.empty()) {
+            c->appendToMd(" \"")->appendToMd(c->anchor_title_)->appendToMd('"');
+            c->anchor_title_.clear();
         }
 
         c->appendToMd(')');
@@ -731,42 +989,42 @@ void Converter::TagAnchor::OnHasLeftClosingTag(Converter* c) {
     }
 }
 
-void Converter::TagBold::OnHasLeftOpeningTag(Converter* c) {
+void Converter::TagBold::OnHasLeftOpeningTag(Converter* c) const {
     c->appendToMd("**");
 }
 
-void Converter::TagBold::OnHasLeftClosingTag(Converter* c) {
+void Converter::TagBold::OnHasLeftClosingTag(Converter* c) const {
     c->appendToMd("**");
 }
 
-void Converter::TagItalic::OnHasLeftOpeningTag(Converter* c) {
+void Converter::TagItalic::OnHasLeftOpeningTag(Converter* c) const {
     c->appendToMd('*');
 }
 
-void Converter::TagItalic::OnHasLeftClosingTag(Converter* c) {
+void Converter::TagItalic::OnHasLeftClosingTag(Converter* c) const {
     c->appendToMd('*');
 }
 
-void Converter::TagUnderline::OnHasLeftOpeningTag(Converter* c) {
+void Converter::TagUnderline::OnHasLeftOpeningTag(Converter* c) const {
     c->appendToMd("<u>");
 }
 
-void Converter::TagUnderline::OnHasLeftClosingTag(Converter* c) {
+void Converter::TagUnderline::OnHasLeftClosingTag(Converter* c) const {
     c->appendToMd("</u>");
 }
 
-void Converter::TagStrikethrought::OnHasLeftOpeningTag(Converter* c) {
+void Converter::TagStrikethrought::OnHasLeftOpeningTag(Converter* c) const {
     c->appendToMd('~');
 }
 
-void Converter::TagStrikethrought::OnHasLeftClosingTag(Converter* c) {
+void Converter::TagStrikethrought::OnHasLeftClosingTag(Converter* c) const {
     c->appendToMd('~');
 }
 
-void Converter::TagBreak::OnHasLeftOpeningTag(Converter* c) {
+void Converter::TagBreak::OnHasLeftOpeningTag(Converter* c) const {
     if (c->is_in_list_) {  // When it's in a list, it's not in a paragraph
         c->appendToMd("  \n");
-        c->appendToMd(Repeat("  ", c->index_li));
+        c->appendRepeatedToMd("  ", c->index_li);
     }
     else if (c->is_in_table_) {
         c->appendToMd("<br>");
@@ -775,10 +1033,10 @@ void Converter::TagBreak::OnHasLeftOpeningTag(Converter* c) {
         c->appendToMd("  \n");
 }
 
-void Converter::TagBreak::OnHasLeftClosingTag(Converter* /*c*/) {
+void Converter::TagBreak::OnHasLeftClosingTag(Converter* /*c*/) const {
 }
 
-void Converter::TagDiv::OnHasLeftOpeningTag(Converter* c) {
+void Converter::TagDiv::OnHasLeftOpeningTag(Converter* c) const {
     if (c->prev_ch_in_md_ != '\n')
         c->appendToMd('\n');
 
@@ -786,64 +1044,64 @@ void Converter::TagDiv::OnHasLeftOpeningTag(Converter* c) {
         c->appendToMd('\n');
 }
 
-void Converter::TagDiv::OnHasLeftClosingTag(Converter* /*c*/) {
+void Converter::TagDiv::OnHasLeftClosingTag(Converter* /*c*/) const {
 }
 
-void Converter::TagHeader1::OnHasLeftOpeningTag(Converter* c) {
+void Converter::TagHeader1::OnHasLeftOpeningTag(Converter* c) const {
     c->appendToMd("\n# ");
 }
 
-void Converter::TagHeader1::OnHasLeftClosingTag(Converter* c) {
+void Converter::TagHeader1::OnHasLeftClosingTag(Converter* c) const {
     if (c->prev_prev_ch_in_md_ != ' ')
         c->appendToMd('\n');
 }
 
-void Converter::TagHeader2::OnHasLeftOpeningTag(Converter* c) {
+void Converter::TagHeader2::OnHasLeftOpeningTag(Converter* c) const {
     c->appendToMd("\n## ");
 }
 
-void Converter::TagHeader2::OnHasLeftClosingTag(Converter* c) {
+void Converter::TagHeader2::OnHasLeftClosingTag(Converter* c) const {
     if (c->prev_prev_ch_in_md_ != ' ')
         c->appendToMd('\n');
 }
 
-void Converter::TagHeader3::OnHasLeftOpeningTag(Converter* c) {
+void Converter::TagHeader3::OnHasLeftOpeningTag(Converter* c) const {
     c->appendToMd("\n### ");
 }
 
-void Converter::TagHeader3::OnHasLeftClosingTag(Converter* c) {
+void Converter::TagHeader3::OnHasLeftClosingTag(Converter* c) const {
     if (c->prev_prev_ch_in_md_ != ' ')
         c->appendToMd('\n');
 }
 
-void Converter::TagHeader4::OnHasLeftOpeningTag(Converter* c) {
+void Converter::TagHeader4::OnHasLeftOpeningTag(Converter* c) const {
     c->appendToMd("\n#### ");
 }
 
-void Converter::TagHeader4::OnHasLeftClosingTag(Converter* c) {
+void Converter::TagHeader4::OnHasLeftClosingTag(Converter* c) const {
     if (c->prev_prev_ch_in_md_ != ' ')
         c->appendToMd('\n');
 }
 
-void Converter::TagHeader5::OnHasLeftOpeningTag(Converter* c) {
+void Converter::TagHeader5::OnHasLeftOpeningTag(Converter* c) const {
     c->appendToMd("\n##### ");
 }
 
-void Converter::TagHeader5::OnHasLeftClosingTag(Converter* c) {
+void Converter::TagHeader5::OnHasLeftClosingTag(Converter* c) const {
     if (c->prev_prev_ch_in_md_ != ' ')
         c->appendToMd('\n');
 }
 
-void Converter::TagHeader6::OnHasLeftOpeningTag(Converter* c) {
+void Converter::TagHeader6::OnHasLeftOpeningTag(Converter* c) const {
     c->appendToMd("\n###### ");
 }
 
-void Converter::TagHeader6::OnHasLeftClosingTag(Converter* c) {
+void Converter::TagHeader6::OnHasLeftClosingTag(Converter* c) const {
     if (c->prev_prev_ch_in_md_ != ' ')
         c->appendToMd('\n');
 }
 
-void Converter::TagListItem::OnHasLeftOpeningTag(Converter* c) {
+void Converter::TagListItem::OnHasLeftOpeningTag(Converter* c) const {
     if (c->is_in_table_)
         return;
 
@@ -859,7 +1117,7 @@ void Converter::TagListItem::OnHasLeftOpeningTag(Converter* c) {
     c->appendToMd(num);
 }
 
-void Converter::TagListItem::OnHasLeftClosingTag(Converter* c) {
+void Converter::TagListItem::OnHasLeftClosingTag(Converter* c) const {
     if (c->is_in_table_)
         return;
 
@@ -867,15 +1125,15 @@ void Converter::TagListItem::OnHasLeftClosingTag(Converter* c) {
         c->appendToMd('\n');
 }
 
-void Converter::TagOption::OnHasLeftOpeningTag(Converter* /*c*/) {
+void Converter::TagOption::OnHasLeftOpeningTag(Converter* /*c*/) const {
 }
 
-void Converter::TagOption::OnHasLeftClosingTag(Converter* c) {
+void Converter::TagOption::OnHasLeftClosingTag(Converter* c) const {
     if (c->md_.length() > 0)
         c->appendToMd("  \n");
 }
 
-void Converter::TagOrderedList::OnHasLeftOpeningTag(Converter* c) {
+void Converter::TagOrderedList::OnHasLeftOpeningTag(Converter* c) const {
     if (c->is_in_table_)
         return;
 
@@ -890,7 +1148,7 @@ void Converter::TagOrderedList::OnHasLeftOpeningTag(Converter* c) {
     c->appendToMd('\n');
 }
 
-void Converter::TagOrderedList::OnHasLeftClosingTag(Converter* c) {
+void Converter::TagOrderedList::OnHasLeftClosingTag(Converter* c) const {
     if (c->is_in_table_)
         return;
 
@@ -904,7 +1162,7 @@ void Converter::TagOrderedList::OnHasLeftClosingTag(Converter* c) {
     c->appendToMd('\n');
 }
 
-void Converter::TagParagraph::OnHasLeftOpeningTag(Converter* c) {
+void Converter::TagParagraph::OnHasLeftOpeningTag(Converter* c) const {
     c->is_in_p_ = true;
 
     if (c->is_in_list_ && c->prev_tag_ == kTagParagraph)
@@ -913,17 +1171,17 @@ void Converter::TagParagraph::OnHasLeftOpeningTag(Converter* c) {
         c->appendToMd('\n');
 }
 
-void Converter::TagParagraph::OnHasLeftClosingTag(Converter* c) {
+void Converter::TagParagraph::OnHasLeftClosingTag(Converter* c) const {
     c->is_in_p_ = false;
 
     if (!c->md_.empty())
         c->appendToMd("\n");  // Workaround \n restriction for blockquotes
 
     if (c->index_blockquote != 0)
-        c->appendToMd(Repeat("> ", c->index_blockquote));
+        c->appendRepeatedToMd("> ", c->index_blockquote);
 }
 
-void Converter::TagPre::OnHasLeftOpeningTag(Converter* c) {
+void Converter::TagPre::OnHasLeftOpeningTag(Converter* c) const {
     c->is_in_pre_ = true;
 
     if (c->prev_ch_in_md_ != '\n')
@@ -941,7 +1199,7 @@ void Converter::TagPre::OnHasLeftOpeningTag(Converter* c) {
         c->appendToMd("```");
 }
 
-void Converter::TagPre::OnHasLeftClosingTag(Converter* c) {
+void Converter::TagPre::OnHasLeftClosingTag(Converter* c) const {
     c->is_in_pre_ = false;
 
     if (c->is_in_list_)
@@ -951,7 +1209,7 @@ void Converter::TagPre::OnHasLeftClosingTag(Converter* c) {
     c->appendToMd('\n');  // Don't combine because of blockquote
 }
 
-void Converter::TagCode::OnHasLeftOpeningTag(Converter* c) {
+void Converter::TagCode::OnHasLeftOpeningTag(Converter* c) const {
     c->is_in_code_ = true;
 
     if (c->is_in_pre_) {
@@ -960,8 +1218,8 @@ void Converter::TagCode::OnHasLeftOpeningTag(Converter* c) {
 
         auto code = c->ExtractAttributeFromTagLeftOf(kAttributeClass);
         if (!code.empty()) {
-            if (startsWith(code, "language-"))
-                code.erase(0, 9);  // remove language-
+            if (code.substr(0, 9) == "language-")
+                code.remove_prefix(9);  // remove language-
             c->appendToMd(code);
         }
         c->appendToMd('\n');
@@ -970,7 +1228,7 @@ void Converter::TagCode::OnHasLeftOpeningTag(Converter* c) {
         c->appendToMd('`');
 }
 
-void Converter::TagCode::OnHasLeftClosingTag(Converter* c) {
+void Converter::TagCode::OnHasLeftClosingTag(Converter* c) const {
     c->is_in_code_ = false;
 
     if (c->is_in_pre_)
@@ -979,20 +1237,20 @@ void Converter::TagCode::OnHasLeftClosingTag(Converter* c) {
     c->appendToMd('`');
 }
 
-void Converter::TagSpan::OnHasLeftOpeningTag(Converter* /*c*/) {
+void Converter::TagSpan::OnHasLeftOpeningTag(Converter* /*c*/) const {
 }
 
-void Converter::TagSpan::OnHasLeftClosingTag(Converter* /*c*/) {
+void Converter::TagSpan::OnHasLeftClosingTag(Converter* /*c*/) const {
 }
 
-void Converter::TagTitle::OnHasLeftOpeningTag(Converter* /*c*/) {
+void Converter::TagTitle::OnHasLeftOpeningTag(Converter* /*c*/) const {
 }
 
-void Converter::TagTitle::OnHasLeftClosingTag(Converter* c) {
+void Converter::TagTitle::OnHasLeftClosingTag(Converter* c) const {
     c->TurnLineIntoHeader1();
 }
 
-void Converter::TagUnorderedList::OnHasLeftOpeningTag(Converter* c) {
+void Converter::TagUnorderedList::OnHasLeftOpeningTag(Converter* c) const {
     if (c->is_in_list_ || c->is_in_table_)
         return;
 
@@ -1003,7 +1261,7 @@ void Converter::TagUnorderedList::OnHasLeftOpeningTag(Converter* c) {
     c->appendToMd('\n');
 }
 
-void Converter::TagUnorderedList::OnHasLeftClosingTag(Converter* c) {
+void Converter::TagUnorderedList::OnHasLeftClosingTag(Converter* c) const {
     if (c->is_in_table_)
         return;
 
@@ -1018,7 +1276,7 @@ void Converter::TagUnorderedList::OnHasLeftClosingTag(Converter* c) {
         c->appendToMd('\n');
 }
 
-void Converter::TagImage::OnHasLeftOpeningTag(Converter* c) {
+void Converter::TagImage::OnHasLeftOpeningTag(Converter* c) const {
     if (c->prev_tag_ != kTagAnchor && c->prev_ch_in_md_ != '\n')
         c->appendToMd('\n');
 
@@ -1035,25 +1293,25 @@ void Converter::TagImage::OnHasLeftOpeningTag(Converter* c) {
     c->appendToMd(")");
 }
 
-void Converter::TagImage::OnHasLeftClosingTag(Converter* c) {
+void Converter::TagImage::OnHasLeftClosingTag(Converter* c) const {
     if (c->prev_tag_ == kTagAnchor)
         c->appendToMd('\n');
 }
 
-void Converter::TagSeperator::OnHasLeftOpeningTag(Converter* c) {
+void Converter::TagSeperator::OnHasLeftOpeningTag(Converter* c) const {
     c->appendToMd("\n---\n");  // NOTE: We can make this an option
 }
 
-void Converter::TagSeperator::OnHasLeftClosingTag(Converter* /*c*/) {
+void Converter::TagSeperator::OnHasLeftClosingTag(Converter* /*c*/) const {
 }
 
-void Converter::TagTable::OnHasLeftOpeningTag(Converter* c) {
+void Converter::TagTable::OnHasLeftOpeningTag(Converter* c) const {
     c->is_in_table_ = true;
     c->appendToMd('\n');
     c->table_start = c->md_.length();  // Set start AFTER the newline
 }
 
-void Converter::TagTable::OnHasLeftClosingTag(Converter* c) {
+void Converter::TagTable::OnHasLeftClosingTag(Converter* c) const {
     c->is_in_table_ = false;
     c->appendToMd('\n');
 
@@ -1066,10 +1324,10 @@ void Converter::TagTable::OnHasLeftClosingTag(Converter* c) {
     c->appendToMd(table);
 }
 
-void Converter::TagTableRow::OnHasLeftOpeningTag(Converter* /*c*/) {
+void Converter::TagTableRow::OnHasLeftOpeningTag(Converter* /*c*/) const {
 }
 
-void Converter::TagTableRow::OnHasLeftClosingTag(Converter* c) {
+void Converter::TagTableRow::OnHasLeftClosingTag(Converter* c) const {
     c->UpdatePrevChFromMd();
 
     if (c->prev_ch_in_md_ != '|') {
@@ -1084,7 +1342,7 @@ void Converter::TagTableRow::OnHasLeftClosingTag(Converter* c) {
     }
 }
 
-void Converter::TagTableHeader::OnHasLeftOpeningTag(Converter* c) {
+void Converter::TagTableHeader::OnHasLeftOpeningTag(Converter* c) const {
     auto align = c->ExtractAttributeFromTagLeftOf(kAttrinuteAlign);
 
     string line = "| ";
@@ -1104,25 +1362,25 @@ void Converter::TagTableHeader::OnHasLeftOpeningTag(Converter* c) {
     c->appendToMd("| ");
 }
 
-void Converter::TagTableHeader::OnHasLeftClosingTag(Converter* c) {
+void Converter::TagTableHeader::OnHasLeftClosingTag(Converter* c) const {
     c->appendToMd(" ");
 }
 
-void Converter::TagTableData::OnHasLeftOpeningTag(Converter* c) {
+void Converter::TagTableData::OnHasLeftOpeningTag(Converter* c) const {
     c->appendToMd("| ");
 }
 
-void Converter::TagTableData::OnHasLeftClosingTag(Converter* c) {
+void Converter::TagTableData::OnHasLeftClosingTag(Converter* c) const {
     c->appendToMd(" ");
 }
 
-void Converter::TagBlockquote::OnHasLeftOpeningTag(Converter* c) {
+void Converter::TagBlockquote::OnHasLeftOpeningTag(Converter* c) const {
     ++c->index_blockquote;
     c->appendToMd("\n");
-    c->appendToMd(Repeat("> ", c->index_blockquote));
+    c->appendRepeatedToMd("> ", c->index_blockquote);
 }
 
-void Converter::TagBlockquote::OnHasLeftClosingTag(Converter* c) {
+void Converter::TagBlockquote::OnHasLeftClosingTag(Converter* c) const {
     --c->index_blockquote;
     if (!c->md_.empty() && c->md_.length() >= 2 && c->md_.substr(c->md_.length() - 2) == "> ") {
         c->ShortenMarkdown(2);  // Remove the '> ' only if it exists
@@ -1134,6 +1392,10 @@ void Converter::reset() {
     prev_ch_in_md_      = 0;
     prev_prev_ch_in_md_ = 0;
     index_ch_in_html_   = 0;
+    is_in_anchor_       = false;
+    anchors_.clear();
+
+    skipping_leading_whitespace_ = true;
 }
 
 bool Converter::IsInIgnoredTag() const {
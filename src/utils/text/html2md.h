@@ -5,9 +5,11 @@
 #define HTML2MD_H
 
 #include <cstdint>
-#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 /*!
  * \brief html2md namespace
@@ -21,6 +23,14 @@
  */
 namespace html2md {
 
+/*!
+ * \brief A link found while converting, see Options::collectAnchors
+ */
+struct Anchor {
+    std::string href;
+    std::string text;  // Whitespace-collapsed, entities decoded, capped in length
+};
+
 /*!
  * \brief Options for the conversion from HTML to Markdown
  * \warning Make sure to pass valid options; otherwise, the output will be
@@ -141,6 +151,16 @@ struct Options {
      */
     bool keepHtmlEntities = false;
 
+    /*!
+     * \brief Whether to record every `<a href>` and its text while converting
+     *
+     * Lets a caller get the Markdown and the outgoing links from one pass over
+     * the HTML instead of parsing the page a second time. Anchors with an
+     * empty href, or inside hidden elements, are skipped. See
+     * Converter::anchors(). Default is false.
+     */
+    bool collectAnchors = false;
+
     inline bool operator==(const html2md::Options& o) const {
         return splitLines == o.splitLines && unorderedList == o.unorderedList
                && orderedList == o.orderedList && includeTitle == o.includeTitle
@@ -148,7 +168,8 @@ struct Options {
                && formatTable == o.formatTable && forceLeftTrim == o.forceLeftTrim
                && compressWhitespace == o.compressWhitespace
                && escapeNumberedList == o.escapeNumberedList
-               && keepHtmlEntities == o.keepHtmlEntities;
+               && keepHtmlEntities == o.keepHtmlEntities
+               && collectAnchors == o.collectAnchors;
     };
 };
 
@@ -208,11 +229,17 @@ public:
      * This is the default initializer.<br>
      * You can use appendToMd() to append something to the beginning of the
      * generated output.
+     *
+     * \note The Converter keeps a view of `html`, so the string must outlive it.
+     * A converter does not share mutable state with any other, so separate
+     * instances can run on separate threads.
      */
-    explicit inline Converter(const std::string& html, const struct Options* options = nullptr) {
-        *this = Converter(&html, options);
+    explicit inline Converter(const std::string& html, const struct Options* options = nullptr)
+        : Converter(&html, options) {
     }
 
+    explicit Converter(std::string&& html, const struct Options* options = nullptr) = delete;
+
     /*!
      * \brief Convert HTML into Markdown.
      * \return Returns the converted Markdown.
@@ -242,9 +269,16 @@ public:
      * \return Returns a copy of the instance with the string appended.
      */
     inline Converter* appendToMd(const std::string& s) {
-        return appendToMd(s.c_str());
+        return appendToMd(std::string_view(s));
     }
 
+    /*!
+     * \brief Append a string_view to the Markdown.
+     * \param s The string_view to append.
+     * \return Returns a copy of the instance with the string_view appended.
+     */
+    Converter* appendToMd(std::string_view s);
+
     /*!
      * \brief Appends a ' ' in certain cases.
      * \return Copy of the instance with(maybe) the appended space.
@@ -268,7 +302,7 @@ public:
      * symbol that you want to convert to a specific Markdown representation.
      */
     void addHtmlSymbolConversion(const std::string& htmlSymbol, const std::string& replacement) {
-        htmlSymbolConversions_[htmlSymbol] = replacement;
+        MutableHtmlSymbols()[htmlSymbol] = replacement;
     }
 
     /*!
@@ -278,7 +312,7 @@ public:
      * previously.
      */
     void removeHtmlSymbolConversion(const std::string& htmlSymbol) {
-        htmlSymbolConversions_.erase(htmlSymbol);
+        MutableHtmlSymbols().erase(htmlSymbol);
     }
 
     /*!
@@ -286,9 +320,16 @@ public:
      * \note This is useful for clearing the conversion map (it's empty afterwards).
      */
     void clearHtmlSymbolConversions() {
-        htmlSymbolConversions_.clear();
+        MutableHtmlSymbols().clear();
     }
 
+    /*!
+     * \brief Decode the default HTML symbols in `s`, in place.
+     * \note For text taken from the HTML outside a conversion, so it reads the
+     * same as text a Converter decodes with no custom conversions.
+     */
+    static void DecodeDefaultHtmlSymbols(std::string* s);
+
     /*!
      * \brief Checks if everything was closed properly(in the HTML).
      * \return Returns false if there is a unclosed tag.
@@ -296,6 +337,14 @@ public:
      */
     [[nodiscard]] bool ok() const;
 
+    /*!
+     * \brief Links recorded by the last convert() when Options::collectAnchors
+     * is set, in document order.
+     */
+    [[nodiscard]] const std::vector<Anchor>& anchors() const {
+        return anchors_;
+    }
+
     /*!
      * \brief Reset the generated Markdown
      */
@@ -380,6 +429,8 @@ private:
     static constexpr const char* kTagTableHeader = "th";
     static constexpr const char* kTagTableData   = "td";
 
+    static constexpr size_t kMaxAnchorText = 256;
+
     size_t index_ch_in_html_ = 0;
 
     bool is_closing_tag_        = false;
@@ -391,6 +442,9 @@ private:
     bool is_in_table_           = false;
     bool is_in_tag_             = false;
     bool is_self_closing_tag_   = false;
+    bool is_in_anchor_          = false;  // Collecting text for anchors_.back()
+
+    bool skipping_leading_whitespace_ = true;  // Before the tag name inside <...>
 
     // relevant for <li> only, false = is in unordered list
     bool    is_in_ordered_list_ = false;
@@ -406,10 +460,11 @@ private:
 
     char prev_ch_in_md_ = 0, prev_prev_ch_in_md_ = 0;
     char prev_ch_in_html_ = 'x';
+    char attribute_quote_ = '"';
 
-    std::string html_;
+    std::string_view html_;
 
-    uint16_t    offset_lt_ = 0;
+    size_t      offset_lt_ = 0;
     std::string current_tag_;
     std::string prev_tag_;
 
@@ -420,184 +475,211 @@ private:
 
     std::string md_;
 
+    std::vector<Anchor> anchors_;
+
+    // Attributes of the open <a>, written out when it closes
+    std::string anchor_href_;
+    std::string anchor_title_;
+
     Options option;
 
-    std::unordered_map<std::string, std::string> htmlSymbolConversions_ = {{"&quot;", "\""},
-                                                                           {"&lt;", "<"},
-                                                                           {"&gt;", ">"},
-                                                                           {"&amp;", "&"},
-                                                                           {"&nbsp;", " "},
-                                                                           {"&rarr;", "→"}};
+    using SymbolMap = std::unordered_map<std::string, std::string>;
+
+    // Set only once a conversion is added or removed; until then the shared
+    // defaults are used and no map is built per converter.
+    std::optional<SymbolMap> customHtmlSymbols_;
+
+    static const SymbolMap& DefaultHtmlSymbols();
+
+    const SymbolMap& HtmlSymbols() const {
+        return customHtmlSymbols_ ? *customHtmlSymbols_ : DefaultHtmlSymbols();
+    }
+
+    SymbolMap& MutableHtmlSymbols() {
+        if (!customHtmlSymbols_)
+            customHtmlSymbols_ = DefaultHtmlSymbols();
+        return *customHtmlSymbols_;
+    }
 
-    // Tag: base class for tag types
+    // Tag: base class for tag types. Handlers are stateless and shared by all
+    // converters; per-document state lives in the Converter.
     struct Tag {
-        virtual ~Tag()                                 = default;
-        virtual void OnHasLeftOpeningTag(Converter* c) = 0;
-        virtual void OnHasLeftClosingTag(Converter* c) = 0;
+        virtual ~Tag()                                       = default;
+        virtual void OnHasLeftOpeningTag(Converter* c) const = 0;
+        virtual void OnHasLeftClosingTag(Converter* c) const = 0;
     };
 
     // Tag types
 
     // tags that are not printed (nav, script, noscript, ...)
     struct TagIgnored : Tag {
-        void OnHasLeftOpeningTag(Converter* /*c*/) override {};
-        void OnHasLeftClosingTag(Converter* /*c*/) override {};
+        void OnHasLeftOpeningTag(Converter* /*c*/) const override {};
+        void OnHasLeftClosingTag(Converter* /*c*/) const override {};
     };
 
     struct TagAnchor : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
-
-        std::string current_href_;
-        std::string current_title_;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagBold : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagItalic : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagUnderline : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagStrikethrought : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagBreak : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagDiv : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagHeader1 : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagHeader2 : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagHeader3 : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagHeader4 : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagHeader5 : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagHeader6 : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagListItem : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagOption : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagOrderedList : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagParagraph : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagPre : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagCode : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagSpan : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagTitle : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagUnorderedList : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagImage : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagSeperator : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagTable : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagTableRow : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagTableHeader : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagTableData : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
     struct TagBlockquote : Tag {
-        void OnHasLeftOpeningTag(Converter* c) override;
-        void OnHasLeftClosingTag(Converter* c) override;
+        void OnHasLeftOpeningTag(Converter* c) const override;
+        void OnHasLeftClosingTag(Converter* c) const override;
     };
 
-    std::unordered_map<std::string, std::shared_ptr<Tag>> tags_;
+    // Perfect-hash lookup over a table built at compile time; nullptr for tags
+    // without a handler.
+    static const Tag* FindTag(std::string_view name);
 
     explicit Converter(const std::string* html, const struct Options* options);
 
     void CleanUpMarkdown();
 
+    void DecodeHtmlSymbols(std::string* s) const;
+
+    static void DecodeHtmlSymbols(std::string* s, const SymbolMap& symbols);
+
+    void OpenAnchor(std::string_view href);
+
+    void CloseAnchor();
+
+    void AppendAnchorText(char ch);
+
     // Trim from start (in place)
     static void LTrim(std::string* s);
 
@@ -611,7 +693,8 @@ private:
     // 2. reduce consecutive newlines to maximum 3
     void TidyAllLines(std::string* str);
 
-    std::string ExtractAttributeFromTagLeftOf(const std::string& attr);
+    // A view into the HTML, valid as long as the converter
+    std::string_view ExtractAttributeFromTagLeftOf(std::string_view attr) const;
 
     void TurnLineIntoHeader1();
 
@@ -644,6 +727,7 @@ private:
     }
 
     Converter*  ShortenMarkdown(size_t chars = 1);
+    Converter*  appendRepeatedToMd(std::string_view s, size_t amount);
     inline bool shortIfPrevCh(char prev) {
         if (prev_ch_in_md_ == prev) {
             ShortenMarkdown();
@@ -658,6 +742,14 @@ private:
      */
     bool ParseCharInTagContent(char ch);
 
+    /**
+     * Bulk-append the plain text at the start of `text`, up to the next byte
+     * ParseCharInTagContent treats specially. Found with SIMD where available.
+     *
+     * @return bytes consumed; 0 means the next char needs the per-char path
+     */
+    size_t AppendTextRun(std::string_view text);
+
     // Replace previous space (if any) in current markdown line by newline
     bool ReplacePreviousSpaceInLineByNewline();
 
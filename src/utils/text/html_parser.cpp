@@ -0,0 +1,55 @@
+#include "html_parser.hpp"
+#include <stdexcept>
+
+namespace Mojo {
+namespace Utils {
+namespace Text {
+
+std::unique_ptr<HtmlParser> HtmlParser::create(const std::string& name) {
+    if (name == "html2md")
+        return nullptr;
+    if (name == "gumbo")
+        return std::make_unique<GumboParser>();
+#ifdef MOJO_HAVE_LEXBOR
+    if (name == "lexbor")
+        return std::make_unique<LexborParser>();
+#else
+    if (name == "lexbor")
+        throw std::invalid_argument("HTML parser 'lexbor' is not built in");
+#endif
+    throw std::invalid_argument("Unknown HTML parser: " + name);
+}
+
+std::vector<std::string> HtmlParser::available() {
+#ifdef MOJO_HAVE_LEXBOR
+    return {"gumbo", "lexbor"};
+#else
+    return {"gumbo"};
+#endif
+}
+
+const HtmlParser& HtmlParser::reference() {
+    static const GumboParser parser;
+    return parser;
+}
+
+void append_anchor_text(std::string& out, std::string_view text) {
+    for (char c : text) {
+        if (out.size() >= HtmlParser::MAX_ANCHOR_TEXT)
+            return;
+        bool space = c == ' ' || c == '\n' || c == '\t' || c == '\r';
+        if (!space)
+            out.push_back(c);
+        else if (!out.empty() && out.back() != ' ')
+            out.push_back(' ');
+    }
+}
+
+void finish_anchor_text(std::string& out) {
+    if (!out.empty() && out.back() == ' ')
+        out.pop_back();
+}
+
+}  // namespace Text
+}  // namespace Utils
+}  // namespace Mojo
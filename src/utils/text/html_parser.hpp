@@ -0,0 +1,71 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "converter.hpp"
+
+namespace Mojo {
+namespace Utils {
+namespace Text {
+
+/**
+ * @brief A full HTML5 parser used to pull links out of a page.
+ *
+ * Every backend builds a DOM and reports the `<a href>` elements in document order, with
+ * anchor text collected the same way: text descendants, whitespace collapsed, capped at
+ * MAX_ANCHOR_TEXT bytes. Gumbo is the reference; others must match it on the parity tests.
+ * Backends hold no per-document state, so one instance can be shared across threads.
+ */
+class HtmlParser {
+public:
+    static constexpr size_t MAX_ANCHOR_TEXT = 256;
+
+    virtual ~HtmlParser() = default;
+
+    virtual std::string_view name() const = 0;
+
+    /// `href` of every anchor, without collecting text.
+    virtual std::vector<std::string> links(const std::string& html) const = 0;
+    virtual std::vector<Link>        anchors(const std::string& html) const = 0;
+
+    /**
+     * @brief Backend by name: "gumbo", or "lexbor" when built with it.
+     * @return nullptr for "html2md" (links come from the Markdown pass), throws on an unknown
+     * or unavailable name.
+     */
+    static std::unique_ptr<HtmlParser> create(const std::string& name);
+
+    /// Names `create()` accepts in this build, reference backend first.
+    static std::vector<std::string> available();
+
+    /// Shared Gumbo instance behind `Converter::extract_links()` and `extract_anchors()`.
+    static const HtmlParser& reference();
+};
+
+/// Appends a text node to `out`, collapsing whitespace runs, up to MAX_ANCHOR_TEXT bytes.
+void append_anchor_text(std::string& out, std::string_view text);
+
+/// Drops the space a trailing whitespace run left behind.
+void finish_anchor_text(std::string& out);
+
+class GumboParser : public HtmlParser {
+public:
+    std::string_view         name() const override;
+    std::vector<std::string> links(const std::string& html) const override;
+    std::vector<Link>        anchors(const std::string& html) const override;
+};
+
+#ifdef MOJO_HAVE_LEXBOR
+/// lexbor's HTML5 parser: same tree construction rules as Gumbo, with arena allocation.
+class LexborParser : public HtmlParser {
+public:
+    std::string_view         name() const override;
+    std::vector<std::string> links(const std::string& html) const override;
+    std::vector<Link>        anchors(const std::string& html) const override;
+};
+#endif
+
+}  // namespace Text
+}  // namespace Utils
+}  // namespace Mojo
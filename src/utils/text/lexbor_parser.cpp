@@ -0,0 +1,138 @@
+#include <lexbor/html/html.h>
+#include <new>
+#include <stdexcept>
+#include "html_parser.hpp"
+
+namespace Mojo {
+namespace Utils {
+namespace Text {
+
+namespace {
+
+/// Owns one parsed document; lexbor frees the whole tree from its arenas at once.
+class LexborDocument {
+public:
+    explicit LexborDocument(const std::string& html) : document_(lxb_html_document_create()) {
+        if (document_ == nullptr)
+            throw std::bad_alloc();
+        lxb_status_t status = lxb_html_document_parse(
+            document_, reinterpret_cast<const lxb_char_t*>(html.data()), html.size());
+        if (status != LXB_STATUS_OK) {
+            lxb_html_document_destroy(document_);
+            throw std::runtime_error("lexbor: parse failed with status " + std::to_string(status));
+        }
+    }
+    ~LexborDocument() {
+        lxb_html_document_destroy(document_);
+    }
+
+    LexborDocument(const LexborDocument&)            = delete;
+    LexborDocument& operator=(const LexborDocument&) = delete;
+
+    lxb_dom_node_t* root() const {
+        return lxb_dom_interface_node(document_);
+    }
+
+private:
+    lxb_html_document_t* document_;
+};
+
+/**
+ * @brief Pre-order walk of `root`'s subtree without recursion, so deep DOMs cannot overflow
+ * the stack. `visit` returns false to skip a node's children.
+ */
+template <typename Visit>
+void walk(lxb_dom_node_t* root, Visit&& visit) {
+    lxb_dom_node_t* node = root;
+    while (node != nullptr) {
+        if (visit(node) && node->first_child != nullptr) {
+            node = node->first_child;
+            continue;
+        }
+        while (node != root && node->next == nullptr)
+            node = node->parent;
+        if (node == root)
+            return;
+        node = node->next;
+    }
+}
+
+bool is_anchor(const lxb_dom_node_t* node) {
+    return node->type == LXB_DOM_NODE_TYPE_ELEMENT && node->local_name == LXB_TAG_A;
+}
+
+/// Unlike lxb_dom_element_get_attribute(), tells a bare `href` ("") from a missing one.
+const lexbor_str_t* href_of(lxb_dom_node_t* node) {
+    static constexpr char HREF[] = "href";
+    lxb_dom_attr_t*       attr   = lxb_dom_element_attr_by_name(
+        lxb_dom_interface_element(node), reinterpret_cast<const lxb_char_t*>(HREF), 4);
+    if (attr == nullptr)
+        return nullptr;
+    static const lexbor_str_t EMPTY = {nullptr, 0};
+    return attr->value != nullptr ? attr->value : &EMPTY;
+}
+
+std::string to_string(const lexbor_str_t* str) {
+    return str->data != nullptr
+               ? std::string(reinterpret_cast<const char*>(str->data), str->length)
+               : std::string();
+}
+
+void append_text(lxb_dom_node_t* anchor, std::string& out) {
+    walk(anchor, [&](lxb_dom_node_t* node) {
+        if (out.size() >= HtmlParser::MAX_ANCHOR_TEXT)
+            return false;
+        if (node->type == LXB_DOM_NODE_TYPE_TEXT) {
+            const lexbor_str_t& data = lxb_dom_interface_text(node)->char_data.data;
+            append_anchor_text(
+                out, {reinterpret_cast<const char*>(data.data), data.data ? data.length : 0});
+        }
+        return node->type == LXB_DOM_NODE_TYPE_ELEMENT;
+    });
+}
+
+}  // namespace
+
+std::string_view LexborParser::name() const {
+    return "lexbor";
+}
+
+std::vector<std::string> LexborParser::links(const std::string& html) const {
+    std::vector<std::string> links;
+    if (html.empty())
+        return links;
+
+    LexborDocument document(html);
+    walk(document.root(), [&](lxb_dom_node_t* node) {
+        if (is_anchor(node)) {
+            if (const lexbor_str_t* href = href_of(node))
+                links.push_back(to_string(href));
+        }
+        return true;
+    });
+    return links;
+}
+
+std::vector<Link> LexborParser::anchors(const std::string& html) const {
+    std::vector<Link> links;
+    if (html.empty())
+        return links;
+
+    LexborDocument document(html);
+    walk(document.root(), [&](lxb_dom_node_t* node) {
+        if (is_anchor(node)) {
+            if (const lexbor_str_t* href = href_of(node)) {
+                Link link{to_string(href), {}};
+                append_text(node, link.text);
+                finish_anchor_text(link.text);
+                links.push_back(std::move(link));
+            }
+        }
+        return true;
+    });
+    return links;
+}
+
+}  // namespace Text
+}  // namespace Utils
+}  // namespace Mojo
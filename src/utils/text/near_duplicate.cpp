@@ -0,0 +1,120 @@
+#include "near_duplicate.hpp"
+#include <algorithm>
+#include <bit>
+#include "../crypto/murmur3.h"
+
+namespace Mojo {
+namespace Utils {
+namespace Text {
+
+namespace {
+
+constexpr int MAX_DISTANCE = 7;  // Eight bands of 8 bits; narrower bands make huge buckets
+
+bool is_word_char(unsigned char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c >= 0x80;
+}
+
+uint64_t hash64(const void* data, size_t size) {
+    uint64_t hash[2];
+    MurmurHash3_x64_128(data, static_cast<int>(size), 42, hash);
+    return hash[0];
+}
+
+}  // namespace
+
+NearDuplicateIndex::NearDuplicateIndex(int max_distance, int shingle, size_t max_pages)
+    : max_distance_(std::clamp(max_distance, 0, MAX_DISTANCE)),
+      shingle_(std::max(1, shingle)),
+      max_pages_(max_pages) {
+    // Widths differ by at most one bit so no band is much more selective than another
+    int count = max_distance_ + 1;
+    int shift = 0;
+    for (int i = 0; i < count; ++i) {
+        int width = 64 / count + (i < 64 % count ? 1 : 0);
+        bands_.push_back({shift, width == 64 ? ~0ULL : (1ULL << width) - 1, {}});
+        shift += width;
+    }
+}
+
+uint64_t NearDuplicateIndex::fingerprint(std::string_view markdown, int shingle) {
+    // Words are hashed once; a shingle hashes the hashes of its words.
+    std::vector<uint64_t> words;
+    char                  word[64];  // Longer words are hashed on their first 64 bytes
+    size_t                length = 0;
+    for (size_t i = 0; i <= markdown.size(); ++i) {
+        unsigned char c = i < markdown.size() ? static_cast<unsigned char>(markdown[i]) : ' ';
+        if (is_word_char(c)) {
+            if (length < sizeof(word))
+                word[length++] = static_cast<char>(c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c);
+        }
+        else if (length > 0) {
+            words.push_back(hash64(word, length));
+            length = 0;
+        }
+    }
+    if (words.empty())
+        return 0;
+
+    size_t width     = std::min<size_t>(std::max(1, shingle), words.size());
+    int    votes[64] = {};
+    for (size_t i = 0; i + width <= words.size(); ++i) {
+        uint64_t hash = hash64(&words[i], width * sizeof(uint64_t));
+        for (int bit = 0; bit < 64; ++bit)
+            votes[bit] += static_cast<int>((hash >> bit) & 1) * 2 - 1;
+    }
+
+    uint64_t simhash = 0;
+    for (int bit = 0; bit < 64; ++bit) {
+        if (votes[bit] > 0)
+            simhash |= 1ULL << bit;
+    }
+    return simhash != 0 ? simhash : 1;  // 0 is kept for "no words"
+}
+
+std::optional<NearDuplicate> NearDuplicateIndex::find_or_add(std::string_view   markdown,
+                                                             const std::string& url) {
+    uint64_t fp = fingerprint(markdown, shingle_);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    pages_++;
+    if (fp == 0)
+        return std::nullopt;
+
+    int      best_distance = max_distance_ + 1;
+    uint32_t best_id       = 0;
+    for (const auto& band : bands_) {
+        auto it = band.pages.find((fp >> band.shift) & band.mask);
+        if (it == band.pages.end())
+            continue;
+        for (uint32_t id : it->second) {
+            int distance = std::popcount(fp ^ fingerprints_[id]);
+            if (distance < best_distance) {
+                best_distance = distance;
+                best_id       = id;
+            }
+        }
+    }
+    if (best_distance <= max_distance_) {
+        duplicates_++;
+        return NearDuplicate{urls_[best_id], best_distance};
+    }
+
+    if (fingerprints_.size() < max_pages_) {
+        auto id = static_cast<uint32_t>(fingerprints_.size());
+        fingerprints_.push_back(fp);
+        urls_.push_back(url);
+        for (auto& band : bands_)
+            band.pages[(fp >> band.shift) & band.mask].push_back(id);
+    }
+    return std::nullopt;
+}
+
+NearDuplicateStats NearDuplicateIndex::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return {pages_, duplicates_, fingerprints_.size()};
+}
+
+}  // namespace Text
+}  // namespace Utils
+}  // namespace Mojo
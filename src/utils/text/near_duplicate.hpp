@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "../../core/types/constants.hpp"
+
+namespace Mojo {
+namespace Utils {
+namespace Text {
+
+struct NearDuplicateStats {
+    uint64_t pages      = 0;  // Pages checked
+    uint64_t duplicates = 0;  // Of which near-duplicates of an earlier page
+    uint64_t indexed    = 0;  // Fingerprints held by the index
+};
+
+struct NearDuplicate {
+    std::string url;       // The earlier page this one matches
+    int         distance;  // Differing fingerprint bits
+};
+
+/**
+ * @brief Spots pages whose Markdown is nearly the same as a page seen earlier in the crawl:
+ * mirrors, print views, session-ID variants of one URL, facets of one listing.
+ *
+ * Each page is reduced to a 64-bit SimHash. Its text is split into lowercase words, every
+ * run of `shingle` consecutive words is hashed with MurmurHash3, and each fingerprint bit is
+ * the majority vote of that bit over all shingles. Pages sharing most shingles end up a few
+ * bits apart; unrelated pages differ in about 32.
+ *
+ * Lookups use a banded LSH index. The 64 bits are cut into `max_distance + 1` bands, each
+ * with its own table from band value to pages. Two fingerprints at most `max_distance` bits
+ * apart must agree on at least one whole band, so only pages sharing a band are compared,
+ * which finds every match within the distance without scanning the crawl.
+ *
+ * Safe to call from several threads. Past `max_pages` entries new pages are still checked
+ * but no longer indexed, which bounds memory.
+ */
+class NearDuplicateIndex {
+public:
+    explicit NearDuplicateIndex(
+        int    max_distance = Mojo::Core::Constants::NEAR_DUPLICATE_DISTANCE,
+        int    shingle      = Mojo::Core::Constants::NEAR_DUPLICATE_SHINGLE,
+        size_t max_pages    = Mojo::Core::Constants::NEAR_DUPLICATE_MAX_PAGES);
+
+    /// SimHash of `markdown`'s word shingles; 0 when it holds no words.
+    static uint64_t fingerprint(std::string_view markdown, int shingle);
+
+    /**
+     * @brief Returns the closest indexed page within `max_distance` bits of `markdown`, or
+     * indexes `markdown` under `url` and returns nothing. Pages without words never match.
+     */
+    std::optional<NearDuplicate> find_or_add(std::string_view markdown, const std::string& url);
+
+    NearDuplicateStats stats() const;
+
+private:
+    struct Band {
+        int                                                 shift;
+        uint64_t                                            mask;
+        std::unordered_map<uint64_t, std::vector<uint32_t>> pages;  // Band value -> page ids
+    };
+
+    int    max_distance_;
+    int    shingle_;
+    size_t max_pages_;
+
+    mutable std::mutex       mutex_;
+    std::vector<Band>        bands_;
+    std::vector<uint64_t>    fingerprints_;  // By page id
+    std::vector<std::string> urls_;
+    uint64_t                 pages_      = 0;
+    uint64_t                 duplicates_ = 0;
+};
+
+}  // namespace Text
+}  // namespace Utils
+}  // namespace Mojo
@@ -0,0 +1,470 @@
+#include "readability.hpp"
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include "html2md.h"
+#include "html_parser.hpp"
+
+namespace Mojo {
+namespace Utils {
+namespace Text {
+
+namespace {
+
+constexpr size_t MIN_BLOCK_TEXT   = 25;  // Shorter text blocks do not score
+constexpr int    MAX_SCORE_LEVELS = 5;   // Ancestors credited by each text block
+constexpr double CLASS_WEIGHT     = 25.0;
+
+// Readability's class/id patterns, matched as substrings of the lower-cased "class id".
+constexpr std::string_view POSITIVE_NAMES[] = {
+    "article", "body", "content", "entry", "hentry", "h-entry", "main", "page", "pagination",
+    "post", "text", "blog", "story"};
+
+constexpr std::string_view NEGATIVE_NAMES[] = {
+    "-ad-", "hidden", "banner", "combx", "comment", "com-", "contact", "foot", "gdpr", "masthead",
+    "media", "meta", "outbrain", "promo", "related", "scroll", "share", "shoutbox", "sidebar",
+    "skyscraper", "sponsor", "shopping", "tags", "tool", "widget"};
+
+// Page chrome, left out of scoring unless the name also reads as content.
+constexpr std::string_view UNLIKELY_NAMES[] = {
+    "-ad-", "ad-break", "agegate", "banner", "breadcrumbs", "combx", "comment", "community",
+    "consent", "cookie", "cover-wrap", "disqus", "extra", "footer", "gdpr", "header", "legends",
+    "menu", "newsletter", "pager", "pagination", "popup", "related", "remark", "replies", "rss",
+    "shoutbox", "sidebar", "skyscraper", "social", "sponsor", "subscribe", "supplemental"};
+
+constexpr std::string_view MAYBE_NAMES[] = {
+    "and", "article", "body", "column", "content", "main", "shadow"};
+
+constexpr std::string_view EXCLUDED_ROLES[] = {
+    "navigation", "complementary", "menu", "menubar", "banner", "contentinfo", "dialog",
+    "alertdialog", "search"};
+
+constexpr std::string_view VOID_TAGS[] = {
+    "area", "base", "br", "col", "embed", "hr", "img", "input", "link", "meta", "param", "source",
+    "track", "wbr"};
+
+// Contents are not markup and never shown as text.
+constexpr std::string_view RAW_TEXT_TAGS[] = {
+    "script", "style", "template", "noscript", "textarea", "title", "iframe", "xmp"};
+
+// Block starts that close an open <p>; also what makes a div more than a text block.
+constexpr std::string_view BLOCK_TAGS[] = {
+    "address", "article", "aside", "blockquote", "details", "dialog", "div", "dl", "fieldset",
+    "figcaption", "figure", "footer", "form", "h1", "h2", "h3", "h4", "h5", "h6", "header",
+    "hgroup", "hr", "main", "menu", "nav", "ol", "p", "pre", "section", "table", "ul"};
+
+template <size_t N>
+bool is_one_of(std::string_view name, const std::string_view (&names)[N]) {
+    return std::find(std::begin(names), std::end(names), name) != std::end(names);
+}
+
+template <size_t N>
+bool contains_any(std::string_view text, const std::string_view (&needles)[N]) {
+    return std::any_of(std::begin(needles), std::end(needles), [&](std::string_view needle) {
+        return text.find(needle) != std::string_view::npos;
+    });
+}
+
+bool is_space(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\f';
+}
+
+bool is_alpha(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+char to_lower(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+std::string lowered(std::string_view s) {
+    std::string out(s);
+    std::transform(out.begin(), out.end(), out.begin(), to_lower);
+    return out;
+}
+
+bool iequals(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return to_lower(x) == to_lower(y);
+           });
+}
+
+double tag_bias(std::string_view tag) {
+    if (tag == "article" || tag == "main")
+        return 10.0;
+    if (tag == "div")
+        return 5.0;
+    if (is_one_of(tag, {"pre", "td", "blockquote"}))
+        return 3.0;
+    if (is_one_of(tag, {"address", "ol", "ul", "dl", "dd", "dt", "li", "form"}))
+        return -3.0;
+    if (is_one_of(tag, {"h1", "h2", "h3", "h4", "h5", "h6", "th"}))
+        return -5.0;
+    return 0.0;
+}
+
+struct Attributes {
+    std::string_view href;
+    std::string_view klass;
+    std::string_view id;
+    std::string_view role;
+    std::string_view style;
+    bool             has_href = false;
+    bool             hidden   = false;
+};
+
+struct Frame {
+    std::string name;
+    size_t      begin         = 0;
+    size_t      text          = 0;  // Non-space bytes in the subtree
+    size_t      link_text     = 0;  // The part of `text` inside anchors
+    size_t      commas        = 0;
+    double      content_score = 0.0;  // Credited by text blocks below
+    double      weight        = 0.0;  // Tag bias plus class/id weight
+    bool        excluded      = false;
+    bool        block_child   = false;
+    long        link          = -1;  // Index of the anchor this <a> opened
+};
+
+class Scanner {
+public:
+    Scanner(std::string_view html, const ReadabilityOptions& options, std::vector<Link>* links)
+        : html_(html), options_(options), links_(links) {
+        stack_.push_back({});  // The document: never a candidate, never popped
+    }
+
+    MainContent run() {
+        size_t pos = 0;
+        while (pos < html_.size()) {
+            size_t lt = html_.find('<', pos);
+            if (lt == std::string_view::npos) {
+                text(html_.substr(pos));
+                break;
+            }
+            if (lt > pos)
+                text(html_.substr(pos, lt - pos));
+            pos = markup(lt);
+        }
+        while (stack_.size() > 1)
+            pop(html_.size());
+        return best_;
+    }
+
+private:
+    /// Handles the markup starting at `lt`; returns where scanning resumes.
+    size_t markup(size_t lt) {
+        size_t n    = html_.size();
+        char   next = lt + 1 < n ? html_[lt + 1] : '\0';
+        if (html_.compare(lt, 4, "<!--") == 0) {
+            size_t end = html_.find("-->", lt + 4);
+            return end == std::string_view::npos ? n : end + 3;
+        }
+        bool end_tag = next == '/' && lt + 2 < n && is_alpha(html_[lt + 2]);
+        if (next == '!' || next == '?' || (next == '/' && !end_tag)) {
+            size_t end = html_.find('>', lt);
+            return end == std::string_view::npos ? n : end + 1;
+        }
+        if (end_tag) {
+            size_t name_end = lt + 2;
+            while (name_end < n && !is_space(html_[name_end]) && html_[name_end] != '>'
+                   && html_[name_end] != '/')
+                ++name_end;
+            size_t end = html_.find('>', name_end);
+            end        = end == std::string_view::npos ? n : end + 1;
+            close(lowered(html_.substr(lt + 2, name_end - lt - 2)), lt, end);
+            return end;
+        }
+        if (!is_alpha(next)) {
+            text(html_.substr(lt, 1));  // A stray '<' is text
+            return lt + 1;
+        }
+
+        size_t name_end = lt + 1;
+        while (name_end < n && !is_space(html_[name_end]) && html_[name_end] != '>'
+               && html_[name_end] != '/')
+            ++name_end;
+        std::string name = lowered(html_.substr(lt + 1, name_end - lt - 1));
+        Attributes  attrs;
+        bool        self_closing = false;
+        size_t      end          = attributes(name_end, attrs, self_closing);
+        if (end == std::string_view::npos)
+            return n;  // Unterminated tag at end of input is dropped
+
+        if (is_one_of(name, RAW_TEXT_TAGS))
+            return skip_raw_text(name, end);
+        open(std::move(name), attrs, lt, self_closing);
+        return end;
+    }
+
+    /// Reads attributes up to and including '>'; npos if the input ends first.
+    size_t attributes(size_t i, Attributes& attrs, bool& self_closing) const {
+        size_t n = html_.size();
+        for (;;) {
+            while (i < n && is_space(html_[i]))
+                ++i;
+            if (i >= n)
+                return std::string_view::npos;
+            if (html_[i] == '>')
+                return i + 1;
+            if (html_[i] == '/') {
+                if (i + 1 < n && html_[i + 1] == '>') {
+                    self_closing = true;
+                    return i + 2;
+                }
+                ++i;
+                continue;
+            }
+
+            size_t name_begin = i++;
+            while (i < n && !is_space(html_[i]) && html_[i] != '>' && html_[i] != '/'
+                   && html_[i] != '=')
+                ++i;
+            std::string_view name = html_.substr(name_begin, i - name_begin);
+            while (i < n && is_space(html_[i]))
+                ++i;
+
+            std::string_view value;
+            if (i < n && html_[i] == '=') {
+                ++i;
+                while (i < n && is_space(html_[i]))
+                    ++i;
+                if (i < n && (html_[i] == '"' || html_[i] == '\'')) {
+                    size_t close = html_.find(html_[i], i + 1);
+                    if (close == std::string_view::npos)
+                        return std::string_view::npos;
+                    value = html_.substr(i + 1, close - i - 1);
+                    i     = close + 1;
+                }
+                else {
+                    size_t value_begin = i;
+                    while (i < n && !is_space(html_[i]) && html_[i] != '>')
+                        ++i;
+                    value = html_.substr(value_begin, i - value_begin);
+                }
+            }
+
+            if (iequals(name, "href")) {
+                attrs.href     = value;
+                attrs.has_href = true;
+            }
+            else if (iequals(name, "class")) {
+                attrs.klass = value;
+            }
+            else if (iequals(name, "id")) {
+                attrs.id = value;
+            }
+            else if (iequals(name, "role")) {
+                attrs.role = value;
+            }
+            else if (iequals(name, "style")) {
+                attrs.style = value;
+            }
+            else if (iequals(name, "hidden")
+                     || (iequals(name, "aria-hidden") && iequals(value, "true"))) {
+                attrs.hidden = true;
+            }
+        }
+    }
+
+    size_t skip_raw_text(std::string_view name, size_t pos) const {
+        size_t n = html_.size();
+        while ((pos = html_.find("</", pos)) != std::string_view::npos) {
+            size_t after = pos + 2 + name.size();
+            if (after <= n && iequals(html_.substr(pos + 2, name.size()), name)
+                && (after == n || is_space(html_[after]) || html_[after] == '>'
+                    || html_[after] == '/')) {
+                size_t end = html_.find('>', after);
+                return end == std::string_view::npos ? n : end + 1;
+            }
+            pos += 2;
+        }
+        return n;
+    }
+
+    void open(std::string name, const Attributes& attrs, size_t begin, bool self_closing) {
+        implicit_close(name, begin);
+        if (name == "a")
+            close("a", begin, begin);  // <a> does not nest; an open one ends here
+
+        if (name == "a" && links_ != nullptr && attrs.has_href && !attrs.href.empty()) {
+            links_->push_back({std::string(attrs.href), {}});
+            html2md::Converter::DecodeDefaultHtmlSymbols(&links_->back().href);
+            open_link_ = static_cast<long>(links_->size()) - 1;
+        }
+        if (self_closing || is_one_of(name, VOID_TAGS)) {
+            if (name == "a")
+                finish_link();
+            return;
+        }
+
+        const Frame& parent = stack_.back();
+        Frame        frame;
+        frame.begin    = begin;
+        frame.excluded = parent.excluded || attrs.hidden
+                         || is_one_of(name, {"nav", "aside", "footer"})
+                         || is_one_of(lowered(attrs.role), EXCLUDED_ROLES);
+        if (!attrs.style.empty()) {
+            std::string style = lowered(attrs.style);
+            style.erase(std::remove(style.begin(), style.end(), ' '), style.end());
+            frame.excluded |= style.find("display:none") != std::string::npos;
+        }
+
+        frame.weight = tag_bias(name);
+        if (!attrs.klass.empty() || !attrs.id.empty()) {
+            for (auto value : {attrs.klass, attrs.id}) {
+                std::string names = lowered(value);
+                if (contains_any(names, NEGATIVE_NAMES))
+                    frame.weight -= CLASS_WEIGHT;
+                if (contains_any(names, POSITIVE_NAMES))
+                    frame.weight += CLASS_WEIGHT;
+            }
+            std::string names = lowered(attrs.klass) + ' ' + lowered(attrs.id);
+            if (contains_any(names, UNLIKELY_NAMES) && !contains_any(names, MAYBE_NAMES)
+                && name != "body" && name != "a" && name != "article" && name != "main")
+                frame.excluded = true;
+        }
+        if (iequals(attrs.role, "main"))
+            frame.weight += CLASS_WEIGHT;
+
+        if (name == "a") {
+            frame.link = open_link_;
+            ++open_anchors_;
+        }
+        frame.name = std::move(name);
+        stack_.push_back(std::move(frame));
+    }
+
+    /// End tags the HTML parser would imply before `name` opens.
+    void implicit_close(std::string_view name, size_t at) {
+        if (stack_.back().name == "p" && is_one_of(name, BLOCK_TAGS))
+            pop(at);
+        if (name == "li")
+            close_within({"li"}, {"ul", "ol", "menu"}, at);
+        else if (name == "dt" || name == "dd")
+            close_within({"dt", "dd"}, {"dl"}, at);
+        else if (name == "td" || name == "th")
+            close_within({"td", "th"}, {"tr", "table"}, at);
+        else if (name == "tr")
+            close_within({"tr", "td", "th"}, {"table", "tbody", "thead", "tfoot"}, at);
+        else if (name == "option" && stack_.back().name == "option")
+            pop(at);
+    }
+
+    /// Closes the innermost of `targets` unless one of `boundaries` is open inside it.
+    template <size_t N, size_t M>
+    void close_within(const std::string_view (&targets)[N],
+                      const std::string_view (&boundaries)[M],
+                      size_t at) {
+        for (size_t i = stack_.size() - 1; i > 0; --i) {
+            if (is_one_of(stack_[i].name, targets)) {
+                while (stack_.size() > i)
+                    pop(at);
+                return;
+            }
+            if (is_one_of(stack_[i].name, boundaries))
+                return;
+        }
+    }
+
+    /// An end tag from `lt` to `end`; ignored when nothing by that name is open.
+    void close(std::string_view name, size_t lt, size_t end) {
+        for (size_t i = stack_.size() - 1; i > 0; --i) {
+            if (stack_[i].name == name) {
+                while (stack_.size() > i + 1)
+                    pop(lt);
+                pop(end);
+                return;
+            }
+        }
+    }
+
+    void pop(size_t end) {
+        Frame  frame  = std::move(stack_.back());
+        Frame& parent = stack_[stack_.size() - 2];
+        stack_.pop_back();
+
+        if (frame.name == "a") {
+            --open_anchors_;
+            if (frame.link >= 0)
+                finish_link();
+        }
+        if (frame.excluded)
+            return;
+
+        parent.text += frame.text;
+        parent.link_text += frame.link_text;
+        parent.commas += frame.commas;
+        parent.block_child |= is_one_of(frame.name, BLOCK_TAGS);
+
+        bool text_block = is_one_of(frame.name, {"p", "pre", "td", "blockquote"})
+                          || (!frame.block_child && is_one_of(frame.name, {"div", "section"}));
+        if (text_block && frame.text >= MIN_BLOCK_TEXT) {
+            double score = 1.0 + static_cast<double>(frame.commas)
+                           + std::min(static_cast<double>(frame.text / 100), 3.0);
+            // The frame is already popped, so the parent is stack_.back()
+            for (int level = 0; level < MAX_SCORE_LEVELS; ++level) {
+                if (stack_.size() < static_cast<size_t>(level) + 2)
+                    break;
+                double divider = level == 0 ? 1.0 : level == 1 ? 2.0 : level * 3.0;
+                stack_[stack_.size() - 1 - level].content_score += score / divider;
+            }
+        }
+
+        if (frame.content_score <= 0.0 || frame.text == 0)
+            return;
+        double density = static_cast<double>(frame.link_text) / static_cast<double>(frame.text);
+        if (density > options_.max_link_density
+            || frame.text - frame.link_text < options_.min_text_length)
+            return;
+        double score = (frame.content_score + frame.weight) * (1.0 - density);
+        if (score > best_.score || !best_.found())
+            best_ = {frame.begin, end, score};
+    }
+
+    void text(std::string_view run) {
+        if (open_link_ >= 0)
+            append_anchor_text((*links_)[static_cast<size_t>(open_link_)].text, run);
+
+        Frame& top = stack_.back();
+        if (top.excluded)
+            return;
+        size_t chars = 0;
+        for (char c : run) {
+            chars += !is_space(c);
+            top.commas += c == ',';
+        }
+        top.text += chars;
+        if (open_anchors_ > 0)
+            top.link_text += chars;
+    }
+
+    void finish_link() {
+        if (open_link_ < 0)
+            return;
+        std::string& text = (*links_)[static_cast<size_t>(open_link_)].text;
+        finish_anchor_text(text);
+        html2md::Converter::DecodeDefaultHtmlSymbols(&text);
+        open_link_ = -1;
+    }
+
+    std::string_view          html_;
+    const ReadabilityOptions& options_;
+    std::vector<Link>*        links_;
+    std::vector<Frame>        stack_;
+    long                      open_link_    = -1;  // Anchor collecting text, if any
+    int                       open_anchors_ = 0;
+    MainContent               best_;
+};
+
+}  // namespace
+
+Readability::Readability(ReadabilityOptions options) : options_(options) {
+}
+
+MainContent Readability::find(std::string_view html, std::vector<Link>* links) const {
+    return Scanner(html, options_, links).run();
+}
+
+}  // namespace Text
+}  // namespace Utils
+}  // namespace Mojo
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <string_view>
+#include <vector>
+#include "converter.hpp"
+
+namespace Mojo {
+namespace Utils {
+namespace Text {
+
+struct ReadabilityOptions {
+    size_t min_text_length  = 250;  // Non-link text the chosen block must hold
+    double max_link_density = 0.5;  // Share of link text above which a block is navigation
+};
+
+struct MainContent {
+    size_t begin = 0;  // Byte range of the chosen element, start tag through end tag
+    size_t end   = 0;
+    double score = 0.0;
+
+    bool found() const {
+        return end > begin;
+    }
+};
+
+/**
+ * @brief Finds a page's main content block, readability style, in one pass over the tags.
+ *
+ * No DOM is built: a stack of open elements tracks each one's text and link text. When a
+ * text block closes (p, pre, td, blockquote, or a div without block children) with at least
+ * 25 characters, it scores 1 + its commas + one per 100 characters (at most 3). Its parent
+ * gets the full score, the grandparent half and up to three more ancestors a third of that
+ * per level. A candidate's final score adds a tag bias and a class/id weight, then scales by
+ * (1 - link density). nav, aside, footer, hidden elements and class, id or role names that
+ * read as page chrome (sidebar, cookie, comment, ...) count for nothing.
+ *
+ * The same pass can collect every `<a href>` on the page, so links still reach the frontier
+ * when the navigation around the content is left out of the Markdown.
+ */
+class Readability {
+public:
+    explicit Readability(ReadabilityOptions options = {});
+
+    /**
+     * @brief Locates the main content of `html`.
+     * @param links When given, receives the anchors of the whole page in document order.
+     * @return The best block, or an empty range when none holds enough text.
+     */
+    MainContent find(std::string_view html, std::vector<Link>* links = nullptr) const;
+
+    const ReadabilityOptions& options() const {
+        return options_;
+    }
+
+private:
+    ReadabilityOptions options_;
+};
+
+}  // namespace Text
+}  // namespace Utils
+}  // namespace Mojo
@@ -0,0 +1,248 @@
+#include "canonicalizer.hpp"
+#include <algorithm>
+#include <cctype>
+#include <utility>
+#include "url.hpp"
+
+namespace Mojo {
+namespace Utils {
+
+namespace {
+
+constexpr char HEX_DIGITS[] = "0123456789ABCDEF";
+
+enum class Component { Path, Query };
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+bool is_unreserved(unsigned char c) {
+    return std::isalnum(c) || c == '-' || c == '.' || c == '_' || c == '~';
+}
+
+// RFC 3986 pchar for paths, plus '?' in queries. Everything else is escaped.
+bool is_allowed(unsigned char c, Component component) {
+    if (c >= 0x80)
+        return false;
+    if (is_unreserved(c))
+        return true;
+    switch (c) {
+        case '!':
+        case '$':
+        case '&':
+        case '\'':
+        case '(':
+        case ')':
+        case '*':
+        case '+':
+        case ',':
+        case ';':
+        case '=':
+        case ':':
+        case '@':
+        case '/':
+            return true;
+        case '?':
+            return component == Component::Query;
+        default:
+            return false;
+    }
+}
+
+void append_escaped(std::string& out, unsigned char c) {
+    out += '%';
+    out += HEX_DIGITS[c >> 4];
+    out += HEX_DIGITS[c & 0x0F];
+}
+
+/// Decodes escaped unreserved characters, upper-cases the hex of the escapes that must stay,
+/// and escapes raw bytes that are not allowed in the component.
+std::string normalize_percent(std::string_view in, Component component) {
+    std::string out;
+    out.reserve(in.size());
+    for (size_t i = 0; i < in.size(); ++i) {
+        auto c = static_cast<unsigned char>(in[i]);
+        if (c == '%') {
+            int hi = i + 2 < in.size() ? hex_value(in[i + 1]) : -1;
+            int lo = i + 2 < in.size() ? hex_value(in[i + 2]) : -1;
+            if (hi < 0 || lo < 0) {
+                out += "%25";  // A stray '%' is itself data
+                continue;
+            }
+            auto decoded = static_cast<unsigned char>(hi * 16 + lo);
+            if (is_unreserved(decoded))
+                out += static_cast<char>(decoded);
+            else
+                append_escaped(out, decoded);
+            i += 2;
+        }
+        else if (is_allowed(c, component)) {
+            out += static_cast<char>(c);
+        }
+        else {
+            append_escaped(out, c);
+        }
+    }
+    return out;
+}
+
+/// RFC 3986 §5.2.4 for an absolute path: "." and ".." segments are resolved, and a path
+/// ending in one of them keeps its trailing slash.
+std::string remove_dot_segments(std::string_view path) {
+    std::vector<std::string_view> segments;
+    bool                          trailing_dot = false;
+    size_t                        start        = path.empty() || path[0] != '/' ? 0 : 1;
+    while (start <= path.size()) {
+        size_t end = path.find('/', start);
+        if (end == std::string_view::npos)
+            end = path.size();
+        auto segment = path.substr(start, end - start);
+        trailing_dot = segment == "." || segment == "..";
+        if (segment == "..") {
+            if (!segments.empty())
+                segments.pop_back();
+        }
+        else if (segment != ".") {
+            segments.push_back(segment);
+        }
+        start = end + 1;
+    }
+    if (trailing_dot)
+        segments.emplace_back();
+
+    std::string out;
+    out.reserve(path.size());
+    for (auto segment : segments) {
+        out += '/';
+        out += segment;
+    }
+    return out.empty() ? "/" : out;
+}
+
+bool iequals(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x))
+                      == std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+void to_lower(std::string& s) {
+    for (char& c : s)
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+}  // namespace
+
+UrlCanonicalizer::UrlCanonicalizer(CanonicalizerOptions options) : options_(std::move(options)) {
+}
+
+std::string UrlCanonicalizer::canonicalize(const std::string& url) const {
+    UrlParsed   parsed = Url::parse(url);
+    std::string scheme = parsed.scheme;
+    to_lower(scheme);
+    if ((scheme != "http" && scheme != "https") || parsed.host.empty())
+        return url;
+
+    std::string host = std::move(parsed.host);
+    if (options_.lowercase) {
+        to_lower(host);
+        if (host.size() > 1 && host.back() == '.')
+            host.pop_back();
+    }
+    else {
+        scheme = std::move(parsed.scheme);
+    }
+
+    std::string port = std::move(parsed.port);
+    if (options_.remove_default_port
+        && ((scheme == "http" && port == "80") || (scheme == "https" && port == "443")))
+        port.clear();
+
+    std::string path = std::move(parsed.path);
+    if (options_.normalize_percent)
+        path = normalize_percent(path, Component::Path);
+    if (options_.remove_dot_segments)
+        path = remove_dot_segments(path);
+
+    std::string query = options_.normalize_percent
+                            ? normalize_percent(parsed.query, Component::Query)
+                            : std::move(parsed.query);
+    query             = canonical_query(query);
+
+    std::string out;
+    out.reserve(url.size());
+    out += scheme;
+    out += "://";
+    out += host;
+    if (!port.empty()) {
+        out += ':';
+        out += port;
+    }
+    out += path;
+    if (!query.empty()) {
+        out += '?';
+        out += query;
+    }
+    if (!options_.strip_fragment && !parsed.fragment.empty()) {
+        out += '#';
+        out += parsed.fragment;
+    }
+    return out;
+}
+
+bool UrlCanonicalizer::is_tracking_param(std::string_view key) const {
+    for (const auto& pattern : options_.tracking_params) {
+        if (!pattern.empty() && pattern.back() == '*') {
+            size_t prefix = pattern.size() - 1;
+            if (key.size() >= prefix && iequals(key.substr(0, prefix), {pattern.data(), prefix}))
+                return true;
+        }
+        else if (iequals(key, pattern)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string UrlCanonicalizer::canonical_query(std::string_view query) const {
+    if (query.empty() || (!options_.sort_query && !options_.remove_tracking_params))
+        return std::string(query);
+
+    std::vector<std::pair<std::string_view, std::string_view>> params;  // key, whole param
+    size_t                                                     start = 0;
+    while (start <= query.size()) {
+        size_t end = query.find('&', start);
+        if (end == std::string_view::npos)
+            end = query.size();
+        auto param = query.substr(start, end - start);
+        auto key   = param.substr(0, param.find('='));
+        if (!param.empty() && !(options_.remove_tracking_params && is_tracking_param(key)))
+            params.emplace_back(key, param);
+        start = end + 1;
+    }
+
+    if (options_.sort_query) {
+        std::stable_sort(params.begin(), params.end(), [](const auto& a, const auto& b) {
+            return a.first < b.first;
+        });
+    }
+
+    std::string out;
+    out.reserve(query.size());
+    for (const auto& [key, param] : params) {
+        if (!out.empty())
+            out += '&';
+        out += param;
+    }
+    return out;
+}
+
+}  // namespace Utils
+}  // namespace Mojo
@@ -0,0 +1,63 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Mojo {
+namespace Utils {
+
+struct CanonicalizerOptions {
+    bool lowercase              = true;  // Scheme and host; trailing dot on the host dropped
+    bool remove_default_port    = true;  // :80 for http, :443 for https
+    bool strip_fragment         = true;
+    bool normalize_percent      = true;  // Decode unreserved, upper-case hex, escape the rest
+    bool remove_dot_segments    = true;
+    bool sort_query             = true;  // Stable by key, so repeated keys keep their order
+    bool remove_tracking_params = true;
+
+    // Exact keys, or "prefix*" to match by prefix. Compared case-insensitively.
+    std::vector<std::string> tracking_params = {"utm_*",
+                                                "gclid",
+                                                "dclid",
+                                                "gbraid",
+                                                "wbraid",
+                                                "fbclid",
+                                                "msclkid",
+                                                "yclid",
+                                                "mc_cid",
+                                                "mc_eid",
+                                                "_ga",
+                                                "_gl",
+                                                "igshid",
+                                                "mkt_tok",
+                                                "_hsenc",
+                                                "_hsmi",
+                                                "ref_src"};
+};
+
+/**
+ * @brief Rewrites a URL into one canonical spelling so equivalent links dedupe together.
+ *
+ * `HTTP://Example.com:80/a/./b?utm_source=x&b=2&a=1#top` becomes
+ * `http://example.com/a/b?a=1&b=2`. Only http and https URLs are rewritten; anything else,
+ * or a URL without a host, is returned unchanged. User info is dropped.
+ */
+class UrlCanonicalizer {
+public:
+    explicit UrlCanonicalizer(CanonicalizerOptions options = {});
+
+    std::string canonicalize(const std::string& url) const;
+
+    const CanonicalizerOptions& options() const {
+        return options_;
+    }
+
+private:
+    bool        is_tracking_param(std::string_view key) const;
+    std::string canonical_query(std::string_view query) const;
+
+    CanonicalizerOptions options_;
+};
+
+}  // namespace Utils
+}  // namespace Mojo
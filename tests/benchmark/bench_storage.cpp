@@ -0,0 +1,144 @@
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "../../src/core/logger/logger.hpp"
+#include "../../src/storage/disk_storage.hpp"
+#ifdef MOJO_HAVE_IO_URING
+#include "../../src/storage/uring_storage.hpp"
+#endif
+
+using namespace Mojo::Storage;
+namespace fs = std::filesystem;
+
+class StorageBenchmark : public ::testing::Test {
+protected:
+    void SetUp() override {
+        if (fs::exists("test_storage_out"))
+            fs::remove_all("test_storage_out");
+    }
+
+    void TearDown() override {
+        if (fs::exists("test_storage_out"))
+            fs::remove_all("test_storage_out");
+    }
+};
+
+TEST_F(StorageBenchmark, DiskWriteBehindThroughput) {
+    using Clock            = std::chrono::steady_clock;
+    constexpr int THREADS  = 4;
+    const std::string body(4096, 'x');
+
+    // Flat keys from a worker pool; returns {seconds per thread in save(), files/s to disk}
+    auto run = [&](const DiskOptions& options, int per_thread) {
+        fs::remove_all("test_storage_out");
+        DiskStorage              storage("test_storage_out", options);
+        std::atomic<long long>   blocked{0};
+        std::vector<std::thread> threads;
+        auto                     start = Clock::now();
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&, t] {
+                auto begin = Clock::now();
+                for (int i = 0; i < per_thread; ++i)
+                    storage.save("host_page" + std::to_string(t * per_thread + i) + ".md", body);
+                blocked += std::chrono::duration_cast<std::chrono::microseconds>(Clock::now()
+                                                                                 - begin)
+                               .count();
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        storage.flush();
+        std::chrono::duration<double> total = Clock::now() - start;
+        EXPECT_EQ(storage.stats().files, static_cast<uint64_t>(THREADS * per_thread));
+        return std::make_pair(blocked.load() / 1e3 / THREADS, THREADS * per_thread / total.count());
+    };
+
+    struct Case {
+        const char* name;
+        DiskOptions options;
+        int         per_thread;
+    };
+    const std::vector<Case> cases = {
+        {"sync, flat", {false, 0, FsyncPolicy::NONE}, 5000},
+        {"sync, hash-dirs 1", {false, 1, FsyncPolicy::NONE}, 5000},
+        {"write-behind, flat", {true, 0, FsyncPolicy::NONE}, 5000},
+        {"write-behind, hash-dirs 1", {true, 1, FsyncPolicy::NONE}, 5000},
+        {"sync, fsync file", {false, 1, FsyncPolicy::PER_FILE}, 100},
+        {"write-behind, fsync file", {true, 1, FsyncPolicy::PER_FILE}, 100},
+        {"write-behind, fsync batch", {true, 1, FsyncPolicy::PER_BATCH}, 100},
+    };
+    Mojo::Core::Logger::set_level(Mojo::Core::LOG_ERROR);
+    for (const auto& c : cases) {
+        auto [blocked_ms, files_per_second] = run(c.options, c.per_thread);
+        std::cout << "[ BENCH    ] " << THREADS * c.per_thread << " files of 4 KiB, " << c.name
+                  << ": " << blocked_ms << " ms per thread in save(), " << files_per_second
+                  << " files/s" << std::endl;
+    }
+    Mojo::Core::Logger::set_level(Mojo::Core::LOG_ALL);
+}
+
+#ifdef MOJO_HAVE_IO_URING
+TEST_F(StorageBenchmark, UringAgainstDisk) {
+    using Clock               = std::chrono::steady_clock;
+    constexpr int    THREADS  = 4;
+    constexpr int    PER      = 1000;
+    constexpr size_t BODY     = 4096;
+    const std::string body(BODY, 'x');
+
+    // Saves from a worker pool, as the crawler makes them; returns {in save(), until on disk}
+    auto run = [&](Storage& storage) {
+        std::atomic<long long>   blocked{0};
+        std::vector<std::thread> threads;
+        auto                     start = Clock::now();
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&, t] {
+                auto begin = Clock::now();
+                for (int i = 0; i < PER; ++i) {
+                    storage.save("host" + std::to_string(t) + "/section" + std::to_string(i % 20)
+                                     + "/page" + std::to_string(i) + ".md",
+                                 body);
+                }
+                blocked += std::chrono::duration_cast<std::chrono::microseconds>(Clock::now()
+                                                                                 - begin)
+                               .count();
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        storage.flush();
+        std::chrono::duration<double> total = Clock::now() - start;
+        return std::make_pair(blocked.load() / 1e6 / THREADS, total.count());
+    };
+
+    std::unique_ptr<UringStorage> uring;
+    try {
+        uring = std::make_unique<UringStorage>("test_storage_out");
+    } catch (const std::runtime_error&) {
+        GTEST_SKIP() << "io_uring unavailable";
+    }
+    Mojo::Core::Logger::set_level(Mojo::Core::LOG_ERROR);
+    auto [uring_blocked, uring_total] = run(*uring);
+    EXPECT_EQ(uring->stats().files, static_cast<uint64_t>(THREADS * PER));
+    uring.reset();
+    fs::remove_all("test_storage_out");
+
+    DiskStorage disk("test_storage_out");
+    auto [disk_blocked, disk_total] = run(disk);
+    Mojo::Core::Logger::set_level(Mojo::Core::LOG_ALL);
+
+    std::cout << "[ BENCH    ] " << THREADS * PER << " files of " << BODY / 1024
+              << " KiB from " << THREADS << " threads: disk " << disk_blocked * 1000
+              << " ms per thread in save(), " << THREADS * PER / disk_total
+              << " files/s; uring " << uring_blocked * 1000 << " ms per thread in save(), "
+              << THREADS * PER / uring_total << " files/s" << std::endl;
+    EXPECT_EQ(disk.stats().files, static_cast<uint64_t>(THREADS * PER));
+}
+#endif
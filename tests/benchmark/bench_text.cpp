@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/utils/text/converter.hpp"
+#include "../../src/utils/text/html_parser.hpp"
+#include "../../src/utils/text/near_duplicate.hpp"
+#include "../../src/utils/text/readability.hpp"
+#include "../unit/test_pages.hpp"
+
+using namespace Mojo::Utils::Text;
+using Mojo::Testing::article;
+using Mojo::Testing::chrome_page;
+using Mojo::Testing::sample_page;
+
+TEST(TextBenchmark, ProcessThroughput) {
+    using Clock          = std::chrono::steady_clock;
+    constexpr int ROUNDS = 5;
+    std::string   html   = sample_page(2000);
+
+    size_t two_pass_bytes = 0, two_pass_links = 0;
+    auto   start          = Clock::now();
+    for (int i = 0; i < ROUNDS; ++i) {
+        two_pass_bytes += Converter::to_markdown(html).size();
+        two_pass_links += Converter::extract_anchors(html).size();
+    }
+    std::chrono::duration<double, std::milli> two_pass = Clock::now() - start;
+
+    size_t one_pass_bytes = 0, one_pass_links = 0;
+    start                 = Clock::now();
+    for (int i = 0; i < ROUNDS; ++i) {
+        auto page = Converter::process(html);
+        one_pass_bytes += page.markdown.size();
+        one_pass_links += page.links.size();
+    }
+    std::chrono::duration<double, std::milli> one_pass = Clock::now() - start;
+
+    std::cout << "[ BENCH    ] " << html.size() / 1024 << " KiB page: markdown + gumbo links "
+              << two_pass.count() / ROUNDS << " ms, single pass " << one_pass.count() / ROUNDS
+              << " ms (" << 100.0 * (1.0 - one_pass.count() / two_pass.count()) << "% saved)"
+              << std::endl;
+    EXPECT_EQ(one_pass_bytes, two_pass_bytes);
+    EXPECT_EQ(one_pass_links, two_pass_links);
+}
+
+TEST(TextBenchmark, ParserBackendThroughput) {
+    using Clock          = std::chrono::steady_clock;
+    constexpr int ROUNDS = 5;
+    std::string   html   = sample_page(2000);
+
+    auto time_ms = [&](auto&& extract) {
+        size_t links = 0;
+        auto   start = Clock::now();
+        for (int i = 0; i < ROUNDS; ++i)
+            links += extract().size();
+        std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+        EXPECT_EQ(links, ROUNDS * (2u * 2000 + 3));
+        return elapsed.count() / ROUNDS;
+    };
+
+    std::cout << "[ BENCH    ] " << html.size() / 1024 << " KiB page, anchors:";
+    for (const auto& name : HtmlParser::available()) {
+        auto parser = HtmlParser::create(name);
+        std::cout << " " << name << " " << time_ms([&] { return parser->anchors(html); }) << " ms,";
+    }
+    std::cout << " html2md pass " << time_ms([&] { return Converter::process(html).links; })
+              << " ms" << std::endl;
+}
+
+TEST(TextBenchmark, MainContentThroughput) {
+    using Clock          = std::chrono::steady_clock;
+    constexpr int ROUNDS = 5;
+    std::string   html   = chrome_page(40);
+    for (int i = 0; i < 6; ++i)
+        html += html;  // 64 pages back to back: the first article still wins
+
+    Readability main;
+    size_t      full_bytes = 0, lean_bytes = 0;
+    auto        start      = Clock::now();
+    for (int i = 0; i < ROUNDS; ++i)
+        full_bytes += Converter::process(html).markdown.size();
+    std::chrono::duration<double, std::milli> full = Clock::now() - start;
+
+    start = Clock::now();
+    for (int i = 0; i < ROUNDS; ++i)
+        lean_bytes += Converter::process(html, true, nullptr, &main).markdown.size();
+    std::chrono::duration<double, std::milli> lean = Clock::now() - start;
+
+    std::cout << "[ BENCH    ] " << html.size() / 1024 << " KiB page: whole "
+              << full_bytes / ROUNDS / 1024 << " KiB Markdown in " << full.count() / ROUNDS
+              << " ms, main content " << lean_bytes / ROUNDS / 1024 << " KiB in "
+              << lean.count() / ROUNDS << " ms" << std::endl;
+    EXPECT_LT(lean_bytes, full_bytes);
+}
+
+TEST(TextBenchmark, NearDuplicateLookupThroughput) {
+    using Clock          = std::chrono::steady_clock;
+    constexpr unsigned N = 20000;
+    std::vector<std::string> pages;
+    for (unsigned seed = 0; seed < 500; ++seed)
+        pages.push_back(article(seed, 600));
+
+    NearDuplicateIndex index;
+    size_t             bytes = 0, duplicates = 0;
+    auto               start = Clock::now();
+    for (unsigned i = 0; i < N; ++i) {
+        // Every page comes back as a copy with one word changed
+        std::string page = pages[i % pages.size()];
+        if (i >= pages.size())
+            page += std::to_string(i);
+        bytes += page.size();
+        duplicates += index.find_or_add(page, std::to_string(i)).has_value();
+    }
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+
+    std::cout << "[ BENCH    ] " << N << " pages (" << bytes / N / 1024 << " KiB each): "
+              << N / elapsed.count() << " pages/s, " << bytes / elapsed.count() / (1 << 20)
+              << " MiB/s, " << duplicates << " near-duplicates" << std::endl;
+    // A single edit can tip a few close bit votes; rarely more than the distance allows
+    EXPECT_GE(duplicates, (N - pages.size()) * 99 / 100);
+}
@@ -0,0 +1,30 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/utils/url/canonicalizer.hpp"
+
+using Mojo::Utils::UrlCanonicalizer;
+
+TEST(UrlBenchmark, CanonicalizeThroughput) {
+    std::vector<std::string> urls = {
+        "https://www.example.com/2024/05/some-long-article-slug?utm_source=feed&ref=home#c",
+        "HTTP://Example.com:80/a/./b/../c/index.html?b=2&a=1&fbclid=xyz",
+        "https://docs.example.org/api/v2/reference/%7euser/search?q=caf%c3%a9&page=3",
+        "https://shop.example.net/cart?items=1,2,3&session=abc&gclid=123&sort=price"};
+    UrlCanonicalizer c;
+    constexpr int    ROUNDS = 20000;
+
+    size_t total_size = 0;
+    auto   start      = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; ++i) {
+        for (const auto& url : urls)
+            total_size += c.canonicalize(url).size();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "[ BENCH    ] canonicalize: "
+              << elapsed.count() / (ROUNDS * static_cast<double>(urls.size())) << " ns/URL"
+              << std::endl;
+    EXPECT_GT(total_size, 0u);
+}
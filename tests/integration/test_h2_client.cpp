@@ -0,0 +1,389 @@
+#include <nghttp2/nghttp2.h>
+#include <openssl/ssl.h>
+#include <atomic>
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast.hpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../../src/network/http/h2_client.hpp"
+#include "../../src/network/http/tls_context.hpp"
+#include "../unit/test_certs.hpp"
+#include "../unit/test_compress.hpp"
+
+using namespace Mojo::Network::Http;
+
+namespace {
+
+namespace net = boost::asio;
+namespace ssl = net::ssl;
+
+// Local TLS server that negotiates h2 through ALPN (or only http/1.1 when `offer_h2` is
+// false). HTTP/2 responses are held back until `batch` requests are open at the same
+// time, which only succeeds if the client really multiplexes them on one connection.
+// Paths under /gzip are served gzip-encoded, and HEAD requests get the headers alone.
+class H2TestServer {
+public:
+    H2TestServer(const Mojo::Testing::SelfSignedCert& cert, bool offer_h2, size_t batch = 1)
+        : ssl_ctx_(ssl::context::tls_server),
+          acceptor_(ioc_, {net::ip::make_address("127.0.0.1"), 0}),
+          offer_h2_(offer_h2),
+          batch_(batch) {
+        ssl_ctx_.use_certificate_chain(net::buffer(cert.cert_pem));
+        ssl_ctx_.use_private_key(net::buffer(cert.key_pem), ssl::context::pem);
+        SSL_CTX_set_alpn_select_cb(ssl_ctx_.native_handle(), &H2TestServer::select_alpn, this);
+        thread_ = std::thread([this]() { run(); });
+    }
+
+    ~H2TestServer() {
+        stopping_ = true;
+        boost::system::error_code ec;
+        net::ip::tcp::socket      wake(ioc_);
+        wake.connect(acceptor_.local_endpoint(), ec);
+        thread_.join();
+    }
+
+    std::string url(const std::string& path) const {
+        return "https://127.0.0.1:" + std::to_string(acceptor_.local_endpoint().port()) + path;
+    }
+
+    int connections() const {
+        return connections_.load();
+    }
+    int h2_connections() const {
+        return h2_connections_.load();
+    }
+    size_t peak_open_streams() const {
+        return peak_open_streams_.load();
+    }
+
+private:
+    using TlsSocket = ssl::stream<net::ip::tcp::socket>;
+
+    struct ServerStream {
+        std::string path;
+        std::string body;
+        size_t      offset = 0;
+        bool        head   = false;
+    };
+
+    struct Session {
+        H2TestServer*                   server = nullptr;
+        std::map<int32_t, ServerStream> streams;
+        std::vector<int32_t>            pending;
+    };
+
+    static int select_alpn(SSL* /*ssl*/,
+                           const unsigned char** out,
+                           unsigned char*        outlen,
+                           const unsigned char*  in,
+                           unsigned int          inlen,
+                           void*                 arg) {
+        auto*                self  = static_cast<H2TestServer*>(arg);
+        static const uint8_t both[] = "\x02h2\x08http/1.1";
+        static const uint8_t h1[]   = "\x08http/1.1";
+        const uint8_t*       list   = self->offer_h2_ ? both : h1;
+        unsigned int         len    = self->offer_h2_ ? sizeof(both) - 1 : sizeof(h1) - 1;
+        if (SSL_select_next_proto(const_cast<unsigned char**>(out), outlen, list, len, in, inlen)
+            != OPENSSL_NPN_NEGOTIATED)
+            return SSL_TLSEXT_ERR_NOACK;
+        return SSL_TLSEXT_ERR_OK;
+    }
+
+    void run() {
+        while (true) {
+            boost::system::error_code ec;
+            TlsSocket                 stream(ioc_, ssl_ctx_);
+            acceptor_.accept(stream.next_layer(), ec);
+            if (ec || stopping_)
+                return;
+            connections_++;
+            stream.handshake(ssl::stream_base::server, ec);
+            if (ec)
+                continue;
+
+            const unsigned char* proto = nullptr;
+            unsigned int         len   = 0;
+            SSL_get0_alpn_selected(stream.native_handle(), &proto, &len);
+            if (len == 2 && std::memcmp(proto, "h2", 2) == 0) {
+                h2_connections_++;
+                serve_h2(stream);
+            }
+            else {
+                serve_http1(stream);
+            }
+        }
+    }
+
+    void serve_http1(TlsSocket& stream) {
+        namespace http = boost::beast::http;
+        boost::system::error_code        ec;
+        boost::beast::flat_buffer        buffer;
+        http::request<http::string_body> req;
+        http::read(stream, buffer, req, ec);
+        if (ec)
+            return;
+        http::response<http::string_body> res{http::status::ok, 11};
+        res.set(http::field::content_type, "text/html");
+        res.keep_alive(false);
+        res.body() = "<html>http1 " + std::string(req.target()) + "</html>";
+        res.prepare_payload();
+        http::write(stream, res, ec);
+        stream.shutdown(ec);
+    }
+
+    void serve_h2(TlsSocket& stream) {
+        Session                    session{this, {}, {}};
+        nghttp2_session_callbacks* callbacks = nullptr;
+        nghttp2_session_callbacks_new(&callbacks);
+        nghttp2_session_callbacks_set_on_header_callback(callbacks, &H2TestServer::on_header);
+        nghttp2_session_callbacks_set_on_frame_recv_callback(callbacks,
+                                                             &H2TestServer::on_frame_recv);
+        nghttp2_session*   h2 = nullptr;
+        nghttp2_session_server_new(&h2, callbacks, &session);
+        nghttp2_session_callbacks_del(callbacks);
+        nghttp2_submit_settings(h2, NGHTTP2_FLAG_NONE, nullptr, 0);
+
+        std::vector<uint8_t> buffer(16384);
+        while (nghttp2_session_want_read(h2) || nghttp2_session_want_write(h2)) {
+            if (!send_pending(stream, h2))
+                break;
+            boost::system::error_code ec;
+            size_t                    n = stream.read_some(net::buffer(buffer), ec);
+            if (ec || nghttp2_session_mem_recv(h2, buffer.data(), n) < 0)
+                break;
+
+            peak_open_streams_ = std::max(peak_open_streams_.load(), session.pending.size());
+            if (session.pending.size() >= batch_) {
+                for (int32_t id : session.pending)
+                    respond(h2, session, id);
+                session.pending.clear();
+            }
+        }
+        nghttp2_session_del(h2);
+    }
+
+    static bool send_pending(TlsSocket& stream, nghttp2_session* h2) {
+        while (true) {
+            const uint8_t* data = nullptr;
+            ssize_t        n    = nghttp2_session_mem_send(h2, &data);
+            if (n <= 0)
+                return n == 0;
+            boost::system::error_code ec;
+            net::write(stream, net::buffer(data, static_cast<size_t>(n)), ec);
+            if (ec)
+                return false;
+        }
+    }
+
+    static void respond(nghttp2_session* h2, Session& session, int32_t id) {
+        auto&       s            = session.streams[id];
+        std::string content_type = "text/html";
+        if (s.path == "/video")
+            content_type = "video/mp4";
+        s.body       = "<html>h2 " + s.path + "</html>";
+        bool gzipped = s.path.rfind("/gzip", 0) == 0;
+        if (gzipped)
+            s.body = Mojo::Testing::gzip(s.body);
+
+        std::vector<nghttp2_nv> headers = {
+            {(uint8_t*)":status", (uint8_t*)"200", 7, 3, NGHTTP2_NV_FLAG_NONE},
+            {(uint8_t*)"content-type",
+             (uint8_t*)content_type.data(),
+             12,
+             content_type.size(),
+             NGHTTP2_NV_FLAG_NONE},
+        };
+        if (gzipped)
+            headers.push_back(
+                {(uint8_t*)"content-encoding", (uint8_t*)"gzip", 16, 4, NGHTTP2_NV_FLAG_NONE});
+        nghttp2_data_provider provider;
+        provider.source.ptr    = &s;
+        provider.read_callback = &H2TestServer::read_body;
+        // Without a data provider the HEADERS frame itself ends the stream.
+        nghttp2_submit_response(
+            h2, id, headers.data(), headers.size(), s.head ? nullptr : &provider);
+    }
+
+    static ssize_t read_body(nghttp2_session* /*session*/,
+                             int32_t /*stream_id*/,
+                             uint8_t*             buf,
+                             size_t               length,
+                             uint32_t*            data_flags,
+                             nghttp2_data_source* source,
+                             void* /*user_data*/) {
+        auto*  s = static_cast<ServerStream*>(source->ptr);
+        size_t n = std::min(length, s->body.size() - s->offset);
+        std::memcpy(buf, s->body.data() + s->offset, n);
+        s->offset += n;
+        if (s->offset == s->body.size())
+            *data_flags |= NGHTTP2_DATA_FLAG_EOF;
+        return static_cast<ssize_t>(n);
+    }
+
+    static int on_header(nghttp2_session* /*session*/,
+                         const nghttp2_frame* frame,
+                         const uint8_t*       name,
+                         size_t               namelen,
+                         const uint8_t*       value,
+                         size_t               valuelen,
+                         uint8_t /*flags*/,
+                         void* user_data) {
+        auto*            session = static_cast<Session*>(user_data);
+        std::string_view key(reinterpret_cast<const char*>(name), namelen);
+        std::string_view val(reinterpret_cast<const char*>(value), valuelen);
+        if (key == ":path")
+            session->streams[frame->hd.stream_id].path = std::string(val);
+        else if (key == ":method")
+            session->streams[frame->hd.stream_id].head = (val == "HEAD");
+        return 0;
+    }
+
+    static int on_frame_recv(nghttp2_session* /*session*/,
+                             const nghttp2_frame* frame,
+                             void*                user_data) {
+        auto* session = static_cast<Session*>(user_data);
+        if (frame->hd.type == NGHTTP2_HEADERS && (frame->hd.flags & NGHTTP2_FLAG_END_STREAM))
+            session->pending.push_back(frame->hd.stream_id);
+        return 0;
+    }
+
+    net::io_context         ioc_;
+    ssl::context            ssl_ctx_;
+    net::ip::tcp::acceptor  acceptor_;
+    bool                    offer_h2_;
+    size_t                  batch_;
+    std::thread             thread_;
+    std::atomic<bool>       stopping_{false};
+    std::atomic<int>        connections_{0};
+    std::atomic<int>        h2_connections_{0};
+    std::atomic<size_t>     peak_open_streams_{0};
+};
+
+const Mojo::Testing::SelfSignedCert& test_cert() {
+    static const auto cert = Mojo::Testing::make_self_signed_cert("localhost");
+    return cert;
+}
+
+// Trusts test_cert() without touching the process-wide TlsContext.
+TlsContext& test_tls() {
+    static TlsContext tls(test_cert().cert_pem);
+    return tls;
+}
+
+// Fetches every URL from its own client and coroutine, the way crawler workers do, and
+// closes the pooled HTTP/2 connections once the last one finishes.
+std::vector<Mojo::Response> fetch_all(const std::vector<std::string>& urls, int threads) {
+    net::io_context             ioc;
+    std::vector<Mojo::Response> results(urls.size());
+    std::atomic<size_t>         remaining{urls.size()};
+    ConnectionPool::get(ioc).set_tls_context(test_tls());
+
+    for (size_t i = 0; i < urls.size(); ++i) {
+        net::co_spawn(
+            ioc,
+            [&ioc, &results, &remaining, &urls, i]() -> net::awaitable<void> {
+                H2Client client(ioc);
+                results[i] = co_await client.get(urls[i]);
+                if (--remaining == 0)
+                    H2ConnectionPool::get(ioc).close_all();
+            },
+            net::detached);
+    }
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t)
+        pool.emplace_back([&ioc]() { ioc.run(); });
+    ioc.run();
+    for (auto& t : pool)
+        t.join();
+    return results;
+}
+
+}  // namespace
+
+TEST(H2ClientTest, ConcurrentRequestsShareOneConnection) {
+    constexpr size_t kRequests = 8;
+    H2TestServer     server(test_cert(), true, kRequests);
+
+    std::vector<std::string> urls;
+    for (size_t i = 0; i < kRequests; ++i)
+        urls.push_back(server.url("/page/" + std::to_string(i)));
+
+    auto results = fetch_all(urls, 4);
+    for (size_t i = 0; i < kRequests; ++i) {
+        EXPECT_TRUE(results[i].success) << results[i].error;
+        EXPECT_EQ(results[i].status_code, 200);
+        EXPECT_EQ(results[i].body, "<html>h2 /page/" + std::to_string(i) + "</html>");
+    }
+    EXPECT_EQ(server.connections(), 1);
+    EXPECT_EQ(server.h2_connections(), 1);
+    EXPECT_EQ(server.peak_open_streams(), kRequests);
+}
+
+TEST(H2ClientTest, RejectedStreamLeavesConnectionUsable) {
+    H2TestServer server(test_cert(), true);
+
+    net::io_context             ioc;
+    std::vector<Mojo::Response> results;
+    ConnectionPool::get(ioc).set_tls_context(test_tls());
+    net::co_spawn(
+        ioc,
+        [&]() -> net::awaitable<void> {
+            H2Client client(ioc);
+            results.push_back(co_await client.get(server.url("/video")));
+            results.push_back(co_await client.get(server.url("/after")));
+            H2ConnectionPool::get(ioc).close_all();
+        },
+        net::detached);
+    ioc.run();
+
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_TRUE(results[0].skipped);
+    EXPECT_EQ(results[0].error_type, ErrorType::Skipped);
+    EXPECT_TRUE(results[1].success) << results[1].error;
+    EXPECT_EQ(results[1].body, "<html>h2 /after</html>");
+    EXPECT_EQ(server.connections(), 1);
+}
+
+TEST(H2ClientTest, FallsBackToHttp11WithoutH2) {
+    H2TestServer server(test_cert(), false);
+
+    auto results = fetch_all({server.url("/one"), server.url("/two")}, 1);
+    for (const auto& r : results)
+        EXPECT_TRUE(r.success) << r.error;
+    EXPECT_EQ(results[0].body, "<html>http1 /one</html>");
+    EXPECT_EQ(results[1].body, "<html>http1 /two</html>");
+    EXPECT_EQ(server.h2_connections(), 0);
+}
+
+TEST(H2ClientTest, HeadOfGzipResourceSucceeds) {
+    H2TestServer server(test_cert(), true);
+
+    net::io_context             ioc;
+    std::vector<Mojo::Response> results;
+    ConnectionPool::get(ioc).set_tls_context(test_tls());
+    net::co_spawn(
+        ioc,
+        [&]() -> net::awaitable<void> {
+            H2Client client(ioc);
+            results.push_back(co_await client.head(server.url("/gzip/page")));
+            results.push_back(co_await client.get(server.url("/gzip/page")));
+            H2ConnectionPool::get(ioc).close_all();
+        },
+        net::detached);
+    ioc.run();
+
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_TRUE(results[0].success) << results[0].error;
+    EXPECT_EQ(results[0].status_code, 200);
+    EXPECT_TRUE(results[0].body.empty());
+    EXPECT_TRUE(results[1].success) << results[1].error;
+    EXPECT_EQ(results[1].body, "<html>h2 /gzip/page</html>");
+    EXPECT_EQ(server.connections(), 1);
+}
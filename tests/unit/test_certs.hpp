@@ -0,0 +1,68 @@
+#pragma once
+
+#include <memory>
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <string>
+
+namespace Mojo {
+namespace Testing {
+
+struct SelfSignedCert {
+    std::string cert_pem;
+    std::string key_pem;
+};
+
+/**
+ * @brief Generates a throwaway P-256 key and a self-signed certificate for `common_name`.
+ * Used by tests that need a local TLS server; never written to disk.
+ */
+inline SelfSignedCert make_self_signed_cert(const std::string& common_name) {
+    SelfSignedCert result;
+
+    std::unique_ptr<EVP_PKEY_CTX, decltype(&EVP_PKEY_CTX_free)> kctx(
+        EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr), EVP_PKEY_CTX_free);
+    EVP_PKEY* raw_key = nullptr;
+    if (!kctx || EVP_PKEY_keygen_init(kctx.get()) <= 0
+        || EVP_PKEY_CTX_set_ec_paramgen_curve_nid(kctx.get(), NID_X9_62_prime256v1) <= 0
+        || EVP_PKEY_keygen(kctx.get(), &raw_key) <= 0)
+        return result;
+    std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> key(raw_key, EVP_PKEY_free);
+
+    std::unique_ptr<X509, decltype(&X509_free)> cert(X509_new(), X509_free);
+    X509_set_version(cert.get(), 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert.get()), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert.get()), -60);
+    X509_gmtime_adj(X509_getm_notAfter(cert.get()), 24 * 60 * 60);
+    X509_set_pubkey(cert.get(), key.get());
+
+    X509_NAME* name = X509_get_subject_name(cert.get());
+    X509_NAME_add_entry_by_txt(name,
+                               "CN",
+                               MBSTRING_ASC,
+                               reinterpret_cast<const unsigned char*>(common_name.c_str()),
+                               -1,
+                               -1,
+                               0);
+    X509_set_issuer_name(cert.get(), name);
+    if (X509_sign(cert.get(), key.get(), EVP_sha256()) <= 0)
+        return result;
+
+    auto to_pem = [](auto write) {
+        std::unique_ptr<BIO, decltype(&BIO_free)> bio(BIO_new(BIO_s_mem()), BIO_free);
+        write(bio.get());
+        char* data = nullptr;
+        long  len  = BIO_get_mem_data(bio.get(), &data);
+        return std::string(data, static_cast<size_t>(len));
+    };
+    result.cert_pem = to_pem([&](BIO* bio) { PEM_write_bio_X509(bio, cert.get()); });
+    result.key_pem  = to_pem([&](BIO* bio) {
+        PEM_write_bio_PrivateKey(bio, key.get(), nullptr, nullptr, 0, nullptr, nullptr);
+    });
+    return result;
+}
+
+}  // namespace Testing
+}  // namespace Mojo
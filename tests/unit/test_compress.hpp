@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <zlib.h>
+
+namespace Mojo {
+namespace Testing {
+
+/**
+ * @brief Compresses `input` in one shot. `window_bits` selects the wrapper: 15 + 16 for
+ * gzip, 15 for zlib-wrapped deflate, -15 for raw deflate.
+ */
+inline std::string zlib_compress(const std::string& input, int window_bits) {
+    z_stream zs{};
+    deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY);
+    std::string out(deflateBound(&zs, input.size()) + 32, '\0');
+    zs.next_in   = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    zs.avail_in  = static_cast<uInt>(input.size());
+    zs.next_out  = reinterpret_cast<Bytef*>(out.data());
+    zs.avail_out = static_cast<uInt>(out.size());
+    deflate(&zs, Z_FINISH);
+    out.resize(zs.total_out);
+    deflateEnd(&zs);
+    return out;
+}
+
+inline std::string gzip(const std::string& input) {
+    return zlib_compress(input, 15 + 16);
+}
+
+}  // namespace Testing
+}  // namespace Mojo
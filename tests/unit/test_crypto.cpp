@@ -1,8 +1,13 @@
+#include <atomic>
 #include <gtest/gtest.h>
 #include <thread>
 #include <unordered_set>
+#include "../../src/utils/crypto/blocked_bloom_filter.hpp"
 #include "../../src/utils/crypto/bloom_filter.hpp"
+#include "../../src/utils/crypto/fingerprint_set.hpp"
 #include "../../src/utils/crypto/murmur3.h"
+#include "../../src/utils/crypto/scalable_bloom_filter.hpp"
+#include "../../src/utils/crypto/visited_set.hpp"
 
 using namespace Mojo;
 
@@ -125,6 +130,146 @@ TEST(BloomFilterTest, MonitoringMethods) {
     EXPECT_EQ(filter.set_bits(), 0);
 }
 
+TEST(BlockedBloomFilterTest, TestAndAddReportsNewKeys) {
+    BlockedBloomFilter filter(1000, 5);
+
+    EXPECT_EQ(filter.bit_count(), 1024u);  // Rounded up to whole 512-bit blocks
+    EXPECT_TRUE(filter.test_and_add("http://a/"));
+    EXPECT_FALSE(filter.test_and_add("http://a/"));
+    EXPECT_TRUE(filter.contains("http://a/"));
+    EXPECT_FALSE(filter.contains("http://b/"));
+    EXPECT_EQ(filter.items_added(), 1u);
+    EXPECT_GT(filter.set_bits(), 0u);
+    EXPECT_LE(filter.set_bits(), 5u);
+
+    filter.clear();
+    EXPECT_FALSE(filter.contains("http://a/"));
+    EXPECT_EQ(filter.items_added(), 0u);
+    EXPECT_EQ(filter.set_bits(), 0u);
+}
+
+TEST(BlockedBloomFilterTest, FalsePositiveRateMatchesEstimate) {
+    // Ten bits per key, k=7: the classic estimate is ~0.8%.
+    BlockedBloomFilter filter(100000, 7);
+    for (int i = 0; i < 10000; ++i)
+        filter.add("present_" + std::to_string(i));
+    for (int i = 0; i < 10000; ++i)
+        ASSERT_TRUE(filter.contains("present_" + std::to_string(i)));
+
+    int false_positives = 0;
+    int num_check       = 100000;
+    for (int i = 0; i < num_check; ++i) {
+        if (filter.contains("absent_" + std::to_string(i)))
+            false_positives++;
+    }
+
+    double measured = static_cast<double>(false_positives) / num_check;
+    double estimate = filter.estimated_false_positive_rate();
+    EXPECT_NEAR(estimate, 0.0082, 0.001);
+    // Blocking costs a little accuracy, but stays in the estimate's neighbourhood.
+    EXPECT_GT(measured, estimate * 0.5);
+    EXPECT_LT(measured, estimate * 2.0);
+    EXPECT_NEAR(measured, filter.estimated_blocked_false_positive_rate(), 0.002);
+}
+
+TEST(BlockedBloomFilterTest, ConcurrentInsertsOfDistinctKeys) {
+    BlockedBloomFilter       filter(1 << 20, 7);
+    std::atomic<int>         fresh{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&filter, &fresh, i]() {
+            for (int j = 0; j < 2000; ++j) {
+                if (filter.test_and_add("thread_" + std::to_string(i) + "_" + std::to_string(j)))
+                    fresh++;
+            }
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+
+    // Near-empty filter: essentially every distinct key is new, and all are present.
+    EXPECT_GE(fresh.load(), 15990);
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 2000; ++j)
+            EXPECT_TRUE(filter.contains("thread_" + std::to_string(i) + "_" + std::to_string(j)));
+    }
+}
+
+TEST(ScalableBloomFilterTest, GrowsAndHoldsFalsePositiveBudget) {
+    ScalableBloomFilter filter(1000, 0.01);
+    for (int i = 0; i < 50000; ++i)
+        filter.test_and_add("present_" + std::to_string(i));
+    for (int i = 0; i < 50000; ++i)
+        ASSERT_TRUE(filter.contains("present_" + std::to_string(i)));
+    EXPECT_FALSE(filter.test_and_add("present_0"));
+
+    // Keys a stage wrongly reports as seen are not counted, so growth lags slightly.
+    // 1000 + 2000 + ... : six stages are needed for 50k keys.
+    EXPECT_EQ(filter.stages(), 6u);
+
+    int false_positives = 0;
+    int num_check       = 100000;
+    for (int i = 0; i < num_check; ++i) {
+        if (filter.contains("absent_" + std::to_string(i)))
+            false_positives++;
+    }
+    double measured = static_cast<double>(false_positives) / num_check;
+    auto   stats    = filter.stats();
+    EXPECT_LT(measured, 0.01);
+    EXPECT_LT(stats.false_positive_rate, 0.01);
+    EXPECT_NEAR(stats.false_positive_rate, measured, 0.002);
+    EXPECT_EQ(stats.stages, 6u);
+    EXPECT_GT(stats.fill_ratio, 0.0);
+    EXPECT_LT(stats.fill_ratio, 1.0);
+    EXPECT_GE(stats.items, 49500u);
+}
+
+TEST(ScalableBloomFilterTest, ConcurrentInsertsAcrossGrowth) {
+    ScalableBloomFilter      filter(100, 0.001);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&filter, i]() {
+            for (int j = 0; j < 5000; ++j)
+                filter.test_and_add("thread_" + std::to_string(i) + "_" + std::to_string(j));
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+
+    EXPECT_GT(filter.stages(), 1u);
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 5000; ++j)
+            ASSERT_TRUE(filter.contains("thread_" + std::to_string(i) + "_" + std::to_string(j)));
+    }
+}
+
+TEST(FingerprintSetTest, ExactMembershipWithGrowth) {
+    FingerprintSet set(100);
+    for (int i = 0; i < 100000; ++i)
+        EXPECT_TRUE(set.test_and_add("present_" + std::to_string(i)));
+    for (int i = 0; i < 100000; ++i)
+        EXPECT_FALSE(set.test_and_add("present_" + std::to_string(i)));
+    for (int i = 0; i < 100000; ++i)
+        EXPECT_FALSE(set.contains("absent_" + std::to_string(i)));
+
+    auto stats = set.stats();
+    EXPECT_EQ(stats.items, 100000u);
+    EXPECT_GT(stats.fill_ratio, 0.3);
+    EXPECT_LE(stats.fill_ratio, 0.7);
+    EXPECT_LT(stats.false_positive_rate, 1e-12);
+    EXPECT_GE(stats.memory_bytes, 100000u * sizeof(uint64_t));
+}
+
+TEST(VisitedSetTest, CreateByMode) {
+    auto bloom = VisitedSet::create("bloom", 1000, 0.01);
+    auto exact = VisitedSet::create("exact", 1000, 0.01);
+    EXPECT_NE(dynamic_cast<ScalableBloomFilter*>(bloom.get()), nullptr);
+    EXPECT_NE(dynamic_cast<FingerprintSet*>(exact.get()), nullptr);
+    EXPECT_TRUE(exact->test_and_add("http://a/"));
+    EXPECT_FALSE(exact->test_and_add("http://a/"));
+    EXPECT_THROW(VisitedSet::create("cuckoo", 1000, 0.01), std::invalid_argument);
+}
+
 TEST(Murmur3Test, Consistency) {
     std::string data = "consistent data";
     uint64_t    h1[2], h2[2];
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "../../src/network/http/decompressor.hpp"
+#include "test_compress.hpp"
+#ifdef MOJO_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace Mojo::Network::Http;
+using Mojo::Testing::zlib_compress;
+
+namespace {
+
+std::string sample_html() {
+    std::string html = "<html><body>";
+    for (int i = 0; i < 2000; ++i)
+        html += "<p>Paragraph " + std::to_string(i) + " of repetitive text.</p>";
+    return html + "</body></html>";
+}
+
+// Feeds `input` in small pieces to exercise the streaming path.
+bool decode(Decompressor& decoder, const std::string& input, std::string& out, size_t step = 7) {
+    for (size_t i = 0; i < input.size(); i += step) {
+        if (!decoder.feed(std::string_view(input).substr(i, step), out))
+            return false;
+    }
+    return decoder.finish();
+}
+
+}  // namespace
+
+TEST(DecompressorTest, ParseHeader) {
+    EXPECT_EQ(Decompressor::parse(""), ContentEncoding::Identity);
+    EXPECT_EQ(Decompressor::parse("identity"), ContentEncoding::Identity);
+    EXPECT_EQ(Decompressor::parse("GZIP"), ContentEncoding::Gzip);
+    EXPECT_EQ(Decompressor::parse(" x-gzip "), ContentEncoding::Gzip);
+    EXPECT_EQ(Decompressor::parse("deflate"), ContentEncoding::Deflate);
+    EXPECT_EQ(Decompressor::parse("compress"), ContentEncoding::Unsupported);
+#ifdef MOJO_HAVE_BROTLI
+    EXPECT_EQ(Decompressor::parse("br"), ContentEncoding::Brotli);
+    EXPECT_NE(Decompressor::accept_encoding().find("br"), std::string::npos);
+#endif
+    EXPECT_NE(Decompressor::accept_encoding().find("gzip"), std::string::npos);
+}
+
+TEST(DecompressorTest, GzipRoundTrip) {
+    std::string html       = sample_html();
+    std::string compressed = zlib_compress(html, 15 + 16);
+    ASSERT_LT(compressed.size(), html.size() / 4);
+
+    Decompressor decoder(ContentEncoding::Gzip, 1 << 20);
+    std::string  out;
+    EXPECT_TRUE(decode(decoder, compressed, out));
+    EXPECT_EQ(out, html);
+}
+
+TEST(DecompressorTest, DeflateWithAndWithoutZlibWrapper) {
+    std::string html = sample_html();
+    for (int window_bits : {15, -15}) {
+        Decompressor decoder(ContentEncoding::Deflate, 1 << 20);
+        std::string  out;
+        EXPECT_TRUE(decode(decoder, zlib_compress(html, window_bits), out, 1)) << decoder.error();
+        EXPECT_EQ(out, html);
+    }
+}
+
+#ifdef MOJO_HAVE_ZSTD
+TEST(DecompressorTest, ZstdRoundTrip) {
+    std::string html = sample_html();
+    std::string compressed(ZSTD_compressBound(html.size()), '\0');
+    compressed.resize(
+        ZSTD_compress(compressed.data(), compressed.size(), html.data(), html.size(), 3));
+
+    Decompressor decoder(ContentEncoding::Zstd, 1 << 20);
+    std::string  out;
+    EXPECT_TRUE(decode(decoder, compressed, out, 64));
+    EXPECT_EQ(out, html);
+}
+#endif
+
+TEST(DecompressorTest, BombIsCutOff) {
+    std::string zeros(8 * 1024 * 1024, '\0');
+    std::string bomb = zlib_compress(zeros, 15 + 16);
+    ASSERT_LT(bomb.size(), 64u * 1024);
+
+    Decompressor decoder(ContentEncoding::Gzip, 1024 * 1024);
+    std::string  out;
+    EXPECT_FALSE(decoder.feed(bomb, out));
+    EXPECT_TRUE(decoder.limit_exceeded());
+    EXPECT_LE(out.size(), 1024u * 1024);
+}
+
+TEST(DecompressorTest, TruncatedAndCorruptInput) {
+    std::string compressed = zlib_compress(sample_html(), 15 + 16);
+
+    Decompressor truncated(ContentEncoding::Gzip, 1 << 20);
+    std::string  out;
+    EXPECT_TRUE(truncated.feed(compressed.substr(0, compressed.size() / 2), out));
+    EXPECT_FALSE(truncated.finish());
+    EXPECT_FALSE(truncated.limit_exceeded());
+
+    Decompressor corrupt(ContentEncoding::Gzip, 1 << 20);
+    out.clear();
+    EXPECT_FALSE(corrupt.feed("definitely not gzip", out));
+    EXPECT_FALSE(corrupt.error().empty());
+}
+
+TEST(DecompressorTest, UnsupportedEncodingIsRefused) {
+    Decompressor decoder(Decompressor::parse("compress"), 1 << 20);
+    std::string  out;
+    EXPECT_FALSE(decoder.feed("\x1f\x9d\x90", out));
+    EXPECT_FALSE(decoder.finish());
+    EXPECT_TRUE(decoder.unsupported());
+    EXPECT_TRUE(decoder.skipped());
+    EXPECT_FALSE(decoder.limit_exceeded());
+    EXPECT_TRUE(out.empty());
+}
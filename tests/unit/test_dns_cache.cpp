@@ -0,0 +1,153 @@
+#include <boost/asio.hpp>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../../src/network/dns/dns_cache.hpp"
+
+using namespace Mojo::Network::Dns;
+
+class DnsCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        cache().clear();
+        cache().configure(16, std::chrono::seconds(60), std::chrono::seconds(60));
+    }
+
+    void TearDown() override {
+        cache().clear();
+        cache().configure(Mojo::Core::Constants::DEFAULT_DNS_CACHE_SIZE,
+                          std::chrono::seconds(Mojo::Core::Constants::DEFAULT_DNS_TTL_SECONDS),
+                          std::chrono::seconds(
+                              Mojo::Core::Constants::DEFAULT_DNS_NEGATIVE_TTL_SECONDS));
+    }
+
+    static DnsCache& cache() {
+        return DnsCache::instance();
+    }
+
+    boost::asio::io_context ioc;
+};
+
+TEST_F(DnsCacheTest, RepeatLookupsHitCache) {
+    auto before = cache().stats();
+
+    std::vector<size_t> sizes;
+    boost::asio::co_spawn(
+        ioc,
+        [&]() -> boost::asio::awaitable<void> {
+            for (int i = 0; i < 3; ++i) {
+                auto results = co_await cache().resolve("127.0.0.1", "80");
+                sizes.push_back(results.size());
+            }
+        },
+        boost::asio::detached);
+    ioc.run();
+
+    ASSERT_EQ(sizes.size(), 3u);
+    EXPECT_GT(sizes[0], 0u);
+    EXPECT_EQ(sizes[1], sizes[0]);
+
+    auto after = cache().stats();
+    EXPECT_EQ(after.misses - before.misses, 1u);
+    EXPECT_EQ(after.hits - before.hits, 2u);
+}
+
+TEST_F(DnsCacheTest, ConcurrentLookupsAreCoalesced) {
+    auto before = cache().stats();
+
+    int completed = 0;
+    for (int i = 0; i < 8; ++i) {
+        boost::asio::co_spawn(
+            ioc,
+            [&]() -> boost::asio::awaitable<void> {
+                auto results = co_await cache().resolve("localhost", "443");
+                if (!results.empty())
+                    completed++;
+            },
+            boost::asio::detached);
+    }
+    ioc.run();
+
+    EXPECT_EQ(completed, 8);
+    auto after = cache().stats();
+    EXPECT_EQ(after.misses - before.misses, 1u);
+    EXPECT_EQ(after.coalesced - before.coalesced, 7u);
+}
+
+TEST_F(DnsCacheTest, FailuresAreCachedNegatively) {
+    auto before = cache().stats();
+
+    int failures = 0;
+    boost::asio::co_spawn(
+        ioc,
+        [&]() -> boost::asio::awaitable<void> {
+            for (int i = 0; i < 2; ++i) {
+                try {
+                    co_await cache().resolve("mojo-test.invalid", "80");
+                } catch (const boost::system::system_error&) {
+                    failures++;
+                }
+            }
+        },
+        boost::asio::detached);
+    ioc.run();
+
+    EXPECT_EQ(failures, 2);
+    auto after = cache().stats();
+    EXPECT_EQ(after.misses - before.misses, 1u);
+    EXPECT_EQ(after.negative_hits - before.negative_hits, 1u);
+}
+
+TEST_F(DnsCacheTest, SizeIsBounded) {
+    cache().configure(2, std::chrono::seconds(60), std::chrono::seconds(60));
+    auto before = cache().stats();
+
+    boost::asio::co_spawn(
+        ioc,
+        [&]() -> boost::asio::awaitable<void> {
+            co_await cache().resolve("127.0.0.1", "1");
+            co_await cache().resolve("127.0.0.1", "2");
+            co_await cache().resolve("127.0.0.1", "3");
+            // Least recently used ("1") was evicted, so this is a fresh lookup.
+            co_await cache().resolve("127.0.0.1", "1");
+        },
+        boost::asio::detached);
+    ioc.run();
+
+    auto after = cache().stats();
+    EXPECT_EQ(after.entries, 2u);
+    EXPECT_EQ(after.misses - before.misses, 4u);
+    EXPECT_EQ(after.evictions - before.evictions, 2u);
+}
+
+TEST_F(DnsCacheTest, WaitersSurviveTheLeadersIoContext) {
+    auto before = cache().stats();
+
+    // The leader starts the resolve on its own io_context, which is torn down before the
+    // answer is delivered there.
+    auto leader = std::make_unique<boost::asio::io_context>();
+    boost::asio::co_spawn(
+        *leader,
+        [&]() -> boost::asio::awaitable<void> { co_await cache().resolve("localhost", "8443"); },
+        boost::asio::detached);
+    // Step the leader only until its resolve is issued, so the answer is still pending.
+    while (cache().stats().misses == before.misses)
+        leader->run_one();
+
+    size_t results = 0;
+    boost::asio::co_spawn(
+        ioc,
+        [&]() -> boost::asio::awaitable<void> {
+            results = (co_await cache().resolve("localhost", "8443")).size();
+        },
+        boost::asio::detached);
+    while (cache().stats().coalesced == before.coalesced)
+        ioc.run_one();
+
+    leader.reset();
+    ioc.run();
+
+    EXPECT_GT(results, 0u);
+    EXPECT_EQ(cache().stats().entries, 1u);
+}
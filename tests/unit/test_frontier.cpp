@@ -0,0 +1,488 @@
+#include <boost/asio.hpp>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../../src/engine/frontier/frontier.hpp"
+#include "../../src/engine/frontier/url_scorer.hpp"
+
+using namespace Mojo::Engine;
+using Mojo::Utils::Text::Link;
+
+namespace {
+using boost::asio::awaitable;
+using boost::asio::use_awaitable;
+}  // namespace
+
+TEST(FrontierTest, PopsInFifoOrder) {
+    boost::asio::io_context  ioc;
+    Frontier                 frontier(ioc);
+    std::vector<std::string> urls;
+
+    frontier.push("http://a/1", 0);
+    frontier.push("http://a/2", 1);
+    EXPECT_EQ(frontier.size(), 2u);
+
+    boost::asio::co_spawn(
+        ioc,
+        [&]() -> awaitable<void> {
+            while (auto task = co_await frontier.pop()) {
+                urls.push_back(task->url);
+                frontier.task_done();
+            }
+        },
+        boost::asio::detached);
+    ioc.run();
+
+    EXPECT_EQ(urls, (std::vector<std::string>{"http://a/1", "http://a/2"}));
+    EXPECT_TRUE(frontier.closed());
+}
+
+TEST(FrontierTest, PushWakesExactlyOneParkedWorker) {
+    boost::asio::io_context ioc;
+    Frontier                frontier(ioc);
+    int                     received = 0;
+    int                     finished = 0;
+
+    // Keep the frontier from looking idle while the workers park.
+    frontier.hold();
+    for (int i = 0; i < 3; ++i) {
+        boost::asio::co_spawn(
+            ioc,
+            [&]() -> awaitable<void> {
+                auto task = co_await frontier.pop();
+                if (task) {
+                    received++;
+                    frontier.task_done();
+                }
+                finished++;
+            },
+            boost::asio::detached);
+    }
+    ioc.poll();
+    EXPECT_EQ(frontier.stats().waiting, 3u);
+
+    frontier.push("http://a/", 0);
+    ioc.poll();
+    EXPECT_EQ(received, 1);
+    EXPECT_EQ(finished, 1);
+    EXPECT_EQ(frontier.stats().waiting, 2u);
+    EXPECT_EQ(frontier.stats().handoffs, 1u);
+
+    // Dropping the last hold makes the crawl quiescent and releases everyone else.
+    frontier.release();
+    ioc.run();
+    EXPECT_EQ(received, 1);
+    EXPECT_EQ(finished, 3);
+    EXPECT_TRUE(frontier.closed());
+}
+
+TEST(FrontierTest, InFlightTaskDefersCompletion) {
+    boost::asio::io_context ioc;
+    Frontier                frontier(ioc);
+    std::vector<int>        depths;
+
+    frontier.push("http://a/", 0);
+    boost::asio::co_spawn(
+        ioc,
+        [&]() -> awaitable<void> {
+            while (auto task = co_await frontier.pop()) {
+                depths.push_back(task->depth);
+                // Links discovered by a task are pushed before it is marked done.
+                if (task->depth < 2)
+                    frontier.push("http://a/" + std::to_string(task->depth + 1), task->depth + 1);
+                frontier.task_done();
+            }
+        },
+        boost::asio::detached);
+    boost::asio::co_spawn(
+        ioc,
+        [&]() -> awaitable<void> {
+            while (auto task = co_await frontier.pop())
+                frontier.task_done();
+        },
+        boost::asio::detached);
+    ioc.run();
+
+    EXPECT_FALSE(depths.empty());
+    EXPECT_EQ(frontier.stats().dispatched, 3u);
+    EXPECT_EQ(frontier.size(), 0u);
+}
+
+TEST(FrontierTest, CloseReleasesWaitersAndDropsPushes) {
+    boost::asio::io_context ioc;
+    Frontier                frontier(ioc);
+    bool                    got_nullopt = false;
+
+    frontier.hold();
+    boost::asio::co_spawn(
+        ioc,
+        [&]() -> awaitable<void> { got_nullopt = !(co_await frontier.pop()).has_value(); },
+        boost::asio::detached);
+    ioc.poll();
+    frontier.close();
+    ioc.run();
+
+    EXPECT_TRUE(got_nullopt);
+    frontier.push("http://a/", 0);
+    EXPECT_EQ(frontier.size(), 0u);
+
+    frontier.reopen();
+    frontier.push("http://a/", 0);
+    EXPECT_EQ(frontier.size(), 1u);
+}
+
+TEST(FrontierTest, DelayedHostDoesNotBlockOthers) {
+    using namespace std::chrono;
+    boost::asio::io_context  ioc;
+    Frontier                 frontier(ioc);
+    std::vector<std::string> urls;
+    steady_clock::time_point slow_first;
+    steady_clock::time_point slow_second;
+
+    frontier.set_host_delay("slow.test", milliseconds(150));
+    frontier.push("http://slow.test/1", 0);
+    frontier.push("http://slow.test/2", 0);
+    frontier.push("http://fast.test/1", 0);
+    frontier.push("http://fast.test/2", 0);
+
+    boost::asio::co_spawn(
+        ioc,
+        [&]() -> awaitable<void> {
+            while (auto task = co_await frontier.pop()) {
+                urls.push_back(task->url);
+                if (task->url == "http://slow.test/1")
+                    slow_first = steady_clock::now();
+                if (task->url == "http://slow.test/2")
+                    slow_second = steady_clock::now();
+                frontier.task_done();
+            }
+        },
+        boost::asio::detached);
+    ioc.run();
+
+    // The fast host is drained while the slow one waits out its crawl delay.
+    ASSERT_EQ(urls.size(), 4u);
+    EXPECT_EQ(urls.back(), "http://slow.test/2");
+    EXPECT_GE(duration_cast<milliseconds>(slow_second - slow_first).count(), 140);
+    EXPECT_EQ(frontier.stats().hosts, 0u);
+}
+
+TEST(FrontierTest, HigherPriorityFirstWithinAndAcrossHosts) {
+    boost::asio::io_context  ioc;
+    Frontier                 frontier(ioc);
+    std::vector<std::string> urls;
+
+    frontier.push("http://a.test/tag/x", 1, -2.0);
+    frontier.push("http://a.test/article", 1, 3.0);
+    frontier.push("http://b.test/page/2", 1, -1.0);
+    frontier.push("http://b.test/guide", 1, 1.0);
+    frontier.push("http://a.test/other", 1, 0.0);
+
+    boost::asio::co_spawn(
+        ioc,
+        [&]() -> awaitable<void> {
+            while (auto task = co_await frontier.pop()) {
+                urls.push_back(task->url);
+                frontier.task_done();
+            }
+        },
+        boost::asio::detached);
+    ioc.run();
+
+    EXPECT_EQ(urls,
+              (std::vector<std::string>{"http://a.test/article",
+                                        "http://b.test/guide",
+                                        "http://a.test/other",
+                                        "http://b.test/page/2",
+                                        "http://a.test/tag/x"}));
+}
+
+TEST(FrontierTest, PriorityNeverOverridesCrawlDelay) {
+    boost::asio::io_context  ioc;
+    Frontier                 frontier(ioc);
+    std::vector<std::string> urls;
+
+    frontier.set_host_delay("slow.test", std::chrono::milliseconds(100));
+    frontier.push("http://slow.test/1", 0, 10.0);
+    frontier.push("http://slow.test/2", 0, 10.0);
+    frontier.push("http://fast.test/1", 0, -10.0);
+
+    boost::asio::co_spawn(
+        ioc,
+        [&]() -> awaitable<void> {
+            while (auto task = co_await frontier.pop()) {
+                urls.push_back(task->url);
+                frontier.task_done();
+            }
+        },
+        boost::asio::detached);
+    ioc.run();
+
+    EXPECT_EQ(urls,
+              (std::vector<std::string>{
+                  "http://slow.test/1", "http://fast.test/1", "http://slow.test/2"}));
+}
+
+TEST(UrlScorerTest, CreateByName) {
+    EXPECT_EQ(UrlScorer::create("fifo"), nullptr);
+    EXPECT_EQ(UrlScorer::create("depth")->name(), "depth");
+    EXPECT_EQ(UrlScorer::create("opic")->name(), "opic");
+    EXPECT_EQ(UrlScorer::create("heuristic")->name(), "heuristic");
+    EXPECT_THROW(UrlScorer::create("pagerank"), std::invalid_argument);
+}
+
+TEST(UrlScorerTest, DepthScorerPrefersShallowLinks) {
+    DepthScorer scorer;
+    std::vector<Link> links = {{"http://a/1", ""}, {"http://a/2", ""}};
+    std::vector<bool> queued(links.size(), true);
+    auto              shallow = scorer.score("http://a/", 0, links, queued);
+    auto              deep    = scorer.score("http://a/1", 3, links, queued);
+    ASSERT_EQ(shallow.size(), 2u);
+    EXPECT_GT(shallow[0], deep[0]);
+    EXPECT_EQ(shallow[0], shallow[1]);
+}
+
+TEST(UrlScorerTest, OpicDistributesCashAlongLinks) {
+    OpicScorer scorer;
+    EXPECT_DOUBLE_EQ(scorer.seed("http://a/"), 1.0);
+
+    auto home = scorer.score("http://a/",
+                             0,
+                             {{"http://a/x", ""}, {"http://a/y", ""}, {"http://a/z", ""},
+                              {"http://a/w", ""}},
+                             {true, true, true, true});
+    ASSERT_EQ(home.size(), 4u);
+    EXPECT_DOUBLE_EQ(home[0], 0.25);
+    EXPECT_DOUBLE_EQ(scorer.cash("http://a/"), 0.0);
+
+    // x passes its whole balance to y, which is already queued and now linked from two pages.
+    auto x = scorer.score("http://a/x", 1, {{"http://a/y", ""}}, {false});
+    EXPECT_DOUBLE_EQ(x[0], 0.5);
+    EXPECT_DOUBLE_EQ(scorer.cash("http://a/y"), 0.5);
+    EXPECT_LT(scorer.cash("http://a/z"), scorer.cash("http://a/y"));
+
+    // A page that was never credited has nothing to hand out.
+    auto orphan = scorer.score("http://a/unknown", 1, {{"http://a/q", ""}}, {true});
+    EXPECT_DOUBLE_EQ(orphan[0], 0.0);
+}
+
+TEST(UrlScorerTest, OpicDropsSharesOfLinksItWillNotFetch) {
+    OpicScorer scorer;
+    scorer.seed("http://a/");
+
+    // Off-site links and the already processed home page are not queued; only /new is.
+    auto home = scorer.score("http://a/",
+                             0,
+                             {{"http://b/", ""}, {"http://a/new", ""}, {"http://c/", ""}},
+                             {false, true, false});
+    EXPECT_DOUBLE_EQ(home[1], 1.0 / 3);
+    EXPECT_DOUBLE_EQ(scorer.cash("http://a/new"), 1.0 / 3);
+
+    auto back =
+        scorer.score("http://a/new", 1, {{"http://a/", ""}, {"http://b/", ""}}, {false, false});
+    EXPECT_DOUBLE_EQ(back[0], 0.0);
+    EXPECT_DOUBLE_EQ(scorer.cash("http://a/"), 0.0);
+    EXPECT_DOUBLE_EQ(scorer.cash("http://b/"), 0.0);
+    EXPECT_DOUBLE_EQ(scorer.cash("http://c/"), 0.0);
+}
+
+TEST(UrlScorerTest, HeuristicDemotesListingsAndNavigation) {
+    double article = HeuristicScorer::score_link(
+        "http://a/blog/how-we-cut-latency-in-half", "How we cut latency in half", 1);
+    double tag        = HeuristicScorer::score_link("http://a/tag/latency", "latency", 1);
+    double pagination = HeuristicScorer::score_link("http://a/blog/page/3", "3", 1);
+    double query      = HeuristicScorer::score_link("http://a/list?page=4&sort=new", "Next", 1);
+    double login      = HeuristicScorer::score_link("http://a/login", "Sign in", 1);
+
+    EXPECT_GT(article, tag);
+    EXPECT_GT(tag, pagination);
+    EXPECT_GT(article, query);
+    EXPECT_GT(article, login);
+    EXPECT_GT(HeuristicScorer::score_link("http://a/docs/intro", "Introduction", 1),
+              HeuristicScorer::score_link("http://a/docs/intro", "Introduction", 4));
+}
+
+TEST(FrontierTest, SpillsBeyondBudgetAndReadsBackInOrder) {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "mojo_frontier_spill_test";
+    fs::remove_all(dir);
+
+    boost::asio::io_context  ioc;
+    Frontier                 frontier(ioc);
+    std::vector<std::string> expected;
+    std::vector<std::string> urls;
+
+    frontier.enable_spill(dir, 4, 3);
+    for (int i = 0; i < 20; ++i) {
+        expected.push_back("http://a.test/" + std::to_string(i));
+        frontier.push(expected.back(), 1);
+    }
+
+    auto stats = frontier.stats();
+    EXPECT_EQ(frontier.size(), 20u);
+    EXPECT_EQ(stats.spilled, 16u);
+    EXPECT_EQ(stats.spill_segments, 5u);
+    EXPECT_GT(stats.spill_bytes, 0u);
+    EXPECT_EQ(std::distance(fs::directory_iterator(dir), fs::directory_iterator()), 5);
+
+    boost::asio::co_spawn(
+        ioc,
+        [&]() -> awaitable<void> {
+            while (auto task = co_await frontier.pop()) {
+                urls.push_back(task->url);
+                frontier.task_done();
+            }
+        },
+        boost::asio::detached);
+    ioc.run();
+
+    // Spilled URLs reach the head in push order, so a single FIFO host stays in order.
+    EXPECT_EQ(urls, expected);
+    EXPECT_EQ(frontier.stats().spilled, 0u);
+    EXPECT_TRUE(fs::is_empty(dir));
+    fs::remove_all(dir);
+}
+
+TEST(FrontierTest, ConcurrentPushesSpillWithoutLosingUrls) {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "mojo_frontier_spill_concurrent_test";
+    fs::remove_all(dir);
+
+    boost::asio::io_context ioc;
+    Frontier                frontier(ioc);
+    frontier.enable_spill(dir, 16, 8);
+
+    constexpr int            kThreads = 4;
+    constexpr int            kPerThread = 1000;
+    std::vector<std::thread> pushers;
+    for (int t = 0; t < kThreads; ++t) {
+        pushers.emplace_back([&frontier, t]() {
+            for (int i = 0; i < kPerThread; ++i)
+                frontier.push("http://h" + std::to_string(i % 7) + ".test/" + std::to_string(t)
+                                  + "/" + std::to_string(i),
+                              1);
+        });
+    }
+
+    // Pop while the pushers are still spilling, so segments are read back mid-write.
+    std::set<std::string> urls;
+    auto                  work = boost::asio::make_work_guard(ioc);
+    frontier.hold();
+    boost::asio::co_spawn(
+        ioc,
+        [&]() -> awaitable<void> {
+            while (auto task = co_await frontier.pop()) {
+                urls.insert(task->url);
+                frontier.task_done();
+            }
+            work.reset();
+        },
+        boost::asio::detached);
+    std::thread runner([&ioc]() { ioc.run(); });
+    for (auto& pusher : pushers)
+        pusher.join();
+    frontier.release();
+    runner.join();
+
+    EXPECT_EQ(urls.size(), static_cast<size_t>(kThreads * kPerThread));
+    EXPECT_EQ(frontier.size(), 0u);
+    EXPECT_EQ(frontier.stats().spilled, 0u);
+    EXPECT_GT(frontier.stats().spill_segments, 0u);
+    EXPECT_TRUE(!fs::exists(dir) || fs::is_empty(dir));
+    fs::remove_all(dir);
+}
+
+TEST(FrontierTest, RefillsRacingSpillingPushesStillQuiesce) {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "mojo_frontier_spill_refill_test";
+    fs::remove_all(dir);
+
+    boost::asio::io_context ioc;
+    Frontier                frontier(ioc);
+    // A tiny budget and segments make nearly every pop refill while pushes land in the tail.
+    frontier.enable_spill(dir, 2, 2);
+
+    constexpr int            kThreads   = 16;
+    constexpr int            kPerThread = 1000;
+    std::vector<std::thread> pushers;
+    for (int t = 0; t < kThreads; ++t) {
+        pushers.emplace_back([&frontier, t]() {
+            for (int i = 0; i < kPerThread; ++i)
+                frontier.push("http://h" + std::to_string(t) + ".test/" + std::to_string(i), 1);
+        });
+    }
+
+    size_t             popped = 0;
+    std::promise<void> drained;
+    auto               work = boost::asio::make_work_guard(ioc);
+    frontier.hold();
+    boost::asio::co_spawn(
+        ioc,
+        [&]() -> awaitable<void> {
+            while (auto task = co_await frontier.pop()) {
+                popped++;
+                frontier.task_done();
+            }
+            drained.set_value();
+            work.reset();
+        },
+        boost::asio::detached);
+    std::thread runner([&ioc]() { ioc.run(); });
+    for (auto& pusher : pushers)
+        pusher.join();
+    frontier.release();
+
+    // A miscounted queue never reaches zero, so the consumer would wait forever.
+    bool quiesced =
+        drained.get_future().wait_for(std::chrono::seconds(30)) == std::future_status::ready;
+    if (!quiesced)
+        frontier.close();
+    runner.join();
+
+    EXPECT_TRUE(quiesced);
+    EXPECT_EQ(popped, static_cast<size_t>(kThreads * kPerThread));
+    EXPECT_EQ(frontier.size(), 0u);
+    fs::remove_all(dir);
+}
+
+TEST(FrontierTest, UnreadableSegmentIsDroppedFromTheCount) {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "mojo_frontier_spill_corrupt_test";
+    fs::remove_all(dir);
+
+    boost::asio::io_context ioc;
+    Frontier                frontier(ioc);
+    frontier.enable_spill(dir, 4, 3);
+    for (int i = 0; i < 20; ++i)
+        frontier.push("http://a.test/" + std::to_string(i), 1);
+
+    // Overwrite the oldest segment, so its three URLs cannot be read back.
+    std::vector<fs::path> segments{fs::directory_iterator(dir), fs::directory_iterator()};
+    ASSERT_EQ(segments.size(), 5u);
+    std::sort(segments.begin(), segments.end());
+    std::ofstream(segments.front(), std::ios::binary | std::ios::trunc) << "garbage";
+
+    size_t popped = 0;
+    boost::asio::co_spawn(
+        ioc,
+        [&]() -> awaitable<void> {
+            while (auto task = co_await frontier.pop()) {
+                popped++;
+                frontier.task_done();
+            }
+        },
+        boost::asio::detached);
+    ioc.run();
+
+    EXPECT_EQ(popped, 17u);
+    EXPECT_EQ(frontier.size(), 0u);
+    fs::remove_all(dir);
+}
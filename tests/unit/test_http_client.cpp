@@ -1,9 +1,19 @@
+#include <algorithm>
+#include <atomic>
 #include <boost/asio.hpp>
+#include <boost/beast.hpp>
 #include <chrono>
 #include <gtest/gtest.h>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include "../../src/network/http/beast_client.hpp"
+#include "../../src/network/http/connection_pool.hpp"
+#include "test_compress.hpp"
 
 using namespace Mojo::Network::Http;
+using Mojo::Testing::gzip;
 
 class HttpClientTest : public ::testing::Test {
 protected:
@@ -22,3 +32,424 @@ TEST_F(HttpClientTest, ProxyParsing) {
     client.set_proxy("http://proxy.example.com:8080");
     client.set_proxy("");
 }
+
+namespace {
+
+// Minimal keep-alive HTTP/1.1 server: answers every request on a connection until the
+// client closes it, and counts how many TCP connections were accepted. The body is sent
+// as-is with the given Content-Encoding, if any.
+class KeepAliveServer {
+public:
+    explicit KeepAliveServer(std::string body = "<html>pooled</html>", std::string encoding = "")
+        : body_(std::move(body)),
+          encoding_(std::move(encoding)),
+          acceptor_(ioc_, {boost::asio::ip::make_address("127.0.0.1"), 0}) {
+        thread_ = std::thread([this]() { run(); });
+    }
+
+    ~KeepAliveServer() {
+        stopping_ = true;
+        // A blocking accept() is not interrupted by close(); wake it with a connection.
+        boost::system::error_code    ec;
+        boost::asio::ip::tcp::socket wake(ioc_);
+        wake.connect(acceptor_.local_endpoint(), ec);
+        thread_.join();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& socket : sockets_)
+                socket->shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+        }
+        for (auto& worker : workers_)
+            worker.join();
+    }
+
+    unsigned short port() const {
+        return acceptor_.local_endpoint().port();
+    }
+
+    int connections() const {
+        return connections_.load();
+    }
+
+    std::string accept_encoding() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return accept_encoding_;
+    }
+
+private:
+    void run() {
+        while (true) {
+            boost::system::error_code ec;
+            auto socket = std::make_shared<boost::asio::ip::tcp::socket>(ioc_);
+            acceptor_.accept(*socket, ec);
+            if (ec || stopping_)
+                return;
+            connections_++;
+            std::lock_guard<std::mutex> lock(mutex_);
+            sockets_.push_back(socket);
+            workers_.emplace_back([this, socket]() { serve(*socket); });
+        }
+    }
+
+    void serve(boost::asio::ip::tcp::socket& socket) {
+        namespace http = boost::beast::http;
+        boost::beast::flat_buffer buffer;
+        while (true) {
+            boost::system::error_code        ec;
+            http::request<http::string_body> req;
+            http::read(socket, buffer, req, ec);
+            if (ec)
+                return;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                accept_encoding_ = std::string(req[http::field::accept_encoding]);
+            }
+            http::response<http::string_body> res{http::status::ok, 11};
+            res.set(http::field::content_type, "text/html");
+            if (!encoding_.empty())
+                res.set(http::field::content_encoding, encoding_);
+            res.keep_alive(true);
+            res.body() = body_;
+            res.prepare_payload();
+            if (req.method() == http::verb::head)
+                res.body().clear();
+            http::write(socket, res, ec);
+            if (ec)
+                return;
+        }
+    }
+
+    std::string                                                body_;
+    std::string                                                encoding_;
+    std::string                                                accept_encoding_;
+    boost::asio::io_context                                    ioc_;
+    boost::asio::ip::tcp::acceptor                             acceptor_;
+    std::thread                                                thread_;
+    std::atomic<bool>                                          stopping_{false};
+    std::atomic<int>                                           connections_{0};
+    std::mutex                                                 mutex_;
+    std::vector<std::shared_ptr<boost::asio::ip::tcp::socket>> sockets_;
+    std::vector<std::thread>                                   workers_;
+};
+
+}  // namespace
+
+TEST_F(HttpClientTest, KeepAliveConnectionsAreReused) {
+    KeepAliveServer server;
+    std::string     url = "http://127.0.0.1:" + std::to_string(server.port()) + "/";
+
+    std::vector<Mojo::Response> responses;
+    boost::asio::co_spawn(
+        ioc,
+        [&]() -> boost::asio::awaitable<void> {
+            BeastClient first(ioc);
+            responses.push_back(co_await first.get(url));
+            // A different client on the same io_context shares the pool.
+            BeastClient second(ioc);
+            responses.push_back(co_await second.get(url));
+            responses.push_back(co_await second.head(url));
+        },
+        boost::asio::detached);
+    ioc.run();
+
+    ASSERT_EQ(responses.size(), 3u);
+    EXPECT_EQ(responses[0].body, "<html>pooled</html>");
+    EXPECT_EQ(responses[1].body, "<html>pooled</html>");
+    EXPECT_EQ(responses[2].status_code, 200);
+    EXPECT_TRUE(responses[2].body.empty());
+    EXPECT_EQ(server.connections(), 1);
+
+    auto stats = ConnectionPool::get(ioc).stats();
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_EQ(stats.idle, 1u);
+}
+
+TEST_F(HttpClientTest, SequentialRequestsAtLimitOneReuseTheConnection) {
+    KeepAliveServer server;
+    std::string     url  = "http://127.0.0.1:" + std::to_string(server.port()) + "/";
+    auto&           pool = ConnectionPool::get(ioc);
+    pool.configure(1, 1, std::chrono::milliseconds(30000));
+
+    std::vector<Mojo::Response> responses;
+    boost::asio::co_spawn(
+        ioc,
+        [&]() -> boost::asio::awaitable<void> {
+            BeastClient client(ioc);
+            for (int i = 0; i < 3; ++i)
+                responses.push_back(co_await client.get(url));
+        },
+        boost::asio::detached);
+    ioc.run();
+
+    ASSERT_EQ(responses.size(), 3u);
+    for (const auto& response : responses)
+        EXPECT_EQ(response.body, "<html>pooled</html>");
+    EXPECT_EQ(server.connections(), 1);
+    auto stats = pool.stats();
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_EQ(stats.evictions, 0u);
+}
+
+TEST_F(HttpClientTest, PoolDropsExpiredConnections) {
+    KeepAliveServer server;
+    std::string     url  = "http://127.0.0.1:" + std::to_string(server.port()) + "/";
+    auto&           pool = ConnectionPool::get(ioc);
+    pool.configure(4, 4, std::chrono::milliseconds(0));
+
+    boost::asio::co_spawn(
+        ioc,
+        [&]() -> boost::asio::awaitable<void> {
+            BeastClient client(ioc);
+            co_await    client.get(url);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            co_await client.get(url);
+        },
+        boost::asio::detached);
+    ioc.run();
+
+    EXPECT_EQ(server.connections(), 2);
+    EXPECT_EQ(pool.stats().hits, 0u);
+    EXPECT_EQ(pool.stats().evictions, 1u);
+}
+
+TEST_F(HttpClientTest, LeasesWaitAtPerHostLimit) {
+    auto& pool = ConnectionPool::get(ioc);
+    pool.configure(2, 2, std::chrono::milliseconds(30000));
+    PoolKey key{"http", "limited.example", "80", ""};
+
+    int active = 0, peak = 0, done = 0;
+    for (int i = 0; i < 6; ++i) {
+        boost::asio::co_spawn(
+            ioc,
+            [&]() -> boost::asio::awaitable<void> {
+                auto lease = co_await pool.lease(key);
+                peak       = std::max(peak, ++active);
+                boost::asio::steady_timer hold(ioc, std::chrono::milliseconds(5));
+                co_await hold.async_wait(boost::asio::use_awaitable);
+                --active;
+                ++done;
+            },
+            boost::asio::detached);
+    }
+    ioc.run();
+
+    EXPECT_EQ(done, 6);
+    EXPECT_EQ(peak, 2);
+    EXPECT_EQ(pool.stats().waits, 4u);
+    EXPECT_EQ(pool.stats().active, 0u);
+}
+
+TEST_F(HttpClientTest, ConcurrentRequestsShareLimitedConnections) {
+    KeepAliveServer server;
+    std::string     url = "http://127.0.0.1:" + std::to_string(server.port()) + "/";
+    ConnectionPool::get(ioc).configure(1, 1, std::chrono::milliseconds(30000));
+
+    std::vector<Mojo::Response> responses;
+    for (int i = 0; i < 4; ++i) {
+        boost::asio::co_spawn(
+            ioc,
+            [&]() -> boost::asio::awaitable<void> {
+                BeastClient client(ioc);
+                responses.push_back(co_await client.get(url));
+            },
+            boost::asio::detached);
+    }
+    ioc.run();
+
+    ASSERT_EQ(responses.size(), 4u);
+    for (const auto& response : responses)
+        EXPECT_EQ(response.body, "<html>pooled</html>");
+    EXPECT_EQ(server.connections(), 1);
+}
+
+TEST_F(HttpClientTest, CompressedBodyIsDecoded) {
+    std::string html(200000, 'x');
+    std::string compressed = gzip(html);
+
+    KeepAliveServer server(compressed, "gzip");
+    std::string     url = "http://127.0.0.1:" + std::to_string(server.port()) + "/";
+
+    Mojo::Response response;
+    boost::asio::co_spawn(
+        ioc,
+        [&]() -> boost::asio::awaitable<void> {
+            BeastClient client(ioc);
+            response = co_await client.get(url);
+        },
+        boost::asio::detached);
+    ioc.run();
+
+    EXPECT_NE(server.accept_encoding().find("gzip"), std::string::npos);
+    EXPECT_TRUE(response.success) << response.error;
+    EXPECT_EQ(response.body, html);
+    EXPECT_EQ(response.wire_bytes, compressed.size());
+    EXPECT_EQ(response.decoded_bytes, html.size());
+}
+
+TEST_F(HttpClientTest, HeadOfCompressedResourceKeepsTheConnection) {
+    std::string     html = "<html>" + std::string(1000, 'x') + "</html>";
+    KeepAliveServer server(gzip(html), "gzip");
+    std::string     url = "http://127.0.0.1:" + std::to_string(server.port()) + "/";
+
+    Mojo::Response head, get;
+    boost::asio::co_spawn(
+        ioc,
+        [&]() -> boost::asio::awaitable<void> {
+            BeastClient client(ioc);
+            head = co_await client.head(url);
+            get  = co_await client.get(url);
+        },
+        boost::asio::detached);
+    ioc.run();
+
+    // The HEAD response names gzip but has no body, which must not read as a truncated stream.
+    EXPECT_TRUE(head.success) << head.error;
+    EXPECT_EQ(head.status_code, 200);
+    EXPECT_TRUE(head.body.empty());
+    EXPECT_TRUE(get.success) << get.error;
+    EXPECT_EQ(get.body, html);
+    EXPECT_EQ(server.connections(), 1);
+    EXPECT_EQ(ConnectionPool::get(ioc).stats().hits, 1u);
+}
+
+TEST_F(HttpClientTest, DecompressionBombIsSkipped) {
+    KeepAliveServer server(gzip(std::string(4 * 1024 * 1024, '\0')), "gzip");
+    std::string     url = "http://127.0.0.1:" + std::to_string(server.port()) + "/";
+
+    Mojo::Response response;
+    boost::asio::co_spawn(
+        ioc,
+        [&]() -> boost::asio::awaitable<void> {
+            BeastClient client(ioc);
+            client.set_max_decoded_size(64 * 1024);
+            response = co_await client.get(url);
+        },
+        boost::asio::detached);
+    ioc.run();
+
+    EXPECT_FALSE(response.success);
+    EXPECT_TRUE(response.skipped);
+    EXPECT_EQ(response.error_type, ErrorType::Skipped);
+    EXPECT_TRUE(response.body.empty());
+    // The connection was abandoned mid-body, so it must not be pooled.
+    EXPECT_EQ(ConnectionPool::get(ioc).stats().idle, 0u);
+}
+
+TEST_F(HttpClientTest, UnsupportedEncodingIsSkipped) {
+    KeepAliveServer server("\x1f\x9d\x90<html>", "compress");
+    std::string     url = "http://127.0.0.1:" + std::to_string(server.port()) + "/";
+
+    Mojo::Response response;
+    boost::asio::co_spawn(
+        ioc,
+        [&]() -> boost::asio::awaitable<void> {
+            BeastClient client(ioc);
+            response = co_await client.get(url);
+        },
+        boost::asio::detached);
+    ioc.run();
+
+    EXPECT_FALSE(response.success);
+    EXPECT_TRUE(response.skipped);
+    EXPECT_EQ(response.error_type, ErrorType::Skipped);
+    EXPECT_TRUE(response.body.empty());
+}
+
+namespace {
+
+// Sends a fixed header block and then streams filler bytes until the client hangs up,
+// like a live video or a never-ending generated page.
+class EndlessServer {
+public:
+    explicit EndlessServer(std::string headers)
+        : headers_(std::move(headers)),
+          acceptor_(ioc_, {boost::asio::ip::make_address("127.0.0.1"), 0}) {
+        thread_ = std::thread([this]() { run(); });
+    }
+
+    ~EndlessServer() {
+        boost::system::error_code ec;
+        acceptor_.close(ec);
+        thread_.join();
+    }
+
+    unsigned short port() const {
+        return acceptor_.local_endpoint().port();
+    }
+
+private:
+    void run() {
+        boost::system::error_code    ec;
+        boost::asio::ip::tcp::socket socket(ioc_);
+        acceptor_.accept(socket, ec);
+        if (ec)
+            return;
+
+        boost::asio::streambuf request;
+        boost::asio::read_until(socket, request, "\r\n\r\n", ec);
+        boost::asio::write(socket, boost::asio::buffer(headers_), ec);
+        std::string filler(64 * 1024, 'a');
+        while (!ec)
+            boost::asio::write(socket, boost::asio::buffer(filler), ec);
+    }
+
+    std::string                    headers_;
+    boost::asio::io_context        ioc_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    std::thread                    thread_;
+};
+
+Mojo::Response fetch_with_limit(boost::asio::io_context& ioc, unsigned short port, size_t limit) {
+    std::string    url = "http://127.0.0.1:" + std::to_string(port) + "/";
+    Mojo::Response response;
+    boost::asio::co_spawn(
+        ioc,
+        [&]() -> boost::asio::awaitable<void> {
+            BeastClient client(ioc);
+            client.set_max_body_size(limit);
+            response = co_await client.get(url);
+        },
+        boost::asio::detached);
+    ioc.run();
+    return response;
+}
+
+}  // namespace
+
+TEST_F(HttpClientTest, EndlessBodyIsTruncatedAtLimit) {
+    EndlessServer server("HTTP/1.1 200 OK\r\nContent-Type: text/html\r\nConnection: close\r\n\r\n");
+
+    auto start    = std::chrono::steady_clock::now();
+    auto response = fetch_with_limit(ioc, server.port(), 256 * 1024);
+    auto elapsed  = std::chrono::steady_clock::now() - start;
+
+    EXPECT_TRUE(response.success) << response.error;
+    EXPECT_TRUE(response.truncated);
+    EXPECT_EQ(response.body.size(), 256u * 1024);
+    EXPECT_EQ(response.wire_bytes, 256u * 1024);
+    EXPECT_LT(elapsed, std::chrono::seconds(Mojo::Core::Constants::REQUEST_TIMEOUT_SECONDS / 2));
+}
+
+TEST_F(HttpClientTest, OversizedContentLengthIsRejectedOnHeaders) {
+    EndlessServer server(
+        "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\nContent-Length: 1073741824\r\n\r\n");
+
+    auto response = fetch_with_limit(ioc, server.port(), 1024 * 1024);
+
+    EXPECT_TRUE(response.skipped);
+    EXPECT_EQ(response.error_type, ErrorType::Skipped);
+    EXPECT_EQ(response.wire_bytes, 0u);
+    EXPECT_TRUE(response.body.empty());
+}
+
+TEST_F(HttpClientTest, UnwantedContentTypeIsRejectedOnHeaders) {
+    EndlessServer server("HTTP/1.1 200 OK\r\nContent-Type: video/mp4\r\n\r\n");
+
+    auto response = fetch_with_limit(ioc, server.port(), 1024 * 1024);
+
+    EXPECT_TRUE(response.skipped);
+    EXPECT_EQ(response.content_type, "video/mp4");
+    EXPECT_EQ(response.wire_bytes, 0u);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+
+namespace Mojo {
+namespace Testing {
+
+/// Docs-style HTML: a nav, then `articles` sections of two links each, then a footer link.
+inline std::string sample_page(int articles) {
+    std::string html = "<html><head><title>Docs</title><script>var s = '<a href=\"/js\">';"
+                       "</script></head><body><nav><a href='/'>Home</a> <a href='/about'>About"
+                       "</a></nav>";
+    for (int i = 0; i < articles; ++i) {
+        std::string n = std::to_string(i);
+        html += "<h2>Section " + n + "</h2><p>Some <b>bold</b> text and a <a href=\"/doc/" + n
+                + "?a=1&amp;b=2\" title=\"t\">link to <i>page</i> " + n
+                + "</a>.</p><ul><li><a href='/tag/" + n + "'>tag</a></li></ul>";
+    }
+    return html + "<footer><a href='#top'>Top</a></footer></body></html>";
+}
+
+/// A news-style page: header, nav, sidebar, cookie banner and footer around one article.
+inline std::string chrome_page(int paragraphs) {
+    std::string html = "<html><head><title>Story</title><style>.x{}</style></head><body>"
+                       "<header class='site-header'><a href='/'>Logo</a><nav><ul>"
+                       "<li><a href='/news'>News</a></li><li><a href='/sport'>Sport</a></li>"
+                       "</ul></nav></header>"
+                       "<div id='cookie-banner'><p>We use cookies to improve your experience, "
+                       "measure traffic and show ads. <a href='/privacy'>Accept cookies</a></p>"
+                       "</div><div class='layout'><div class='sidebar'><h3>Popular</h3><ul>";
+    for (int i = 0; i < 20; ++i) {
+        std::string n = std::to_string(i);
+        html += "<li><a href='/popular/" + n + "'>Popular story number " + n + "</a></li>";
+    }
+    html += "</ul></div><article class='post'><h1>The headline</h1>";
+    for (int i = 0; i < paragraphs; ++i) {
+        html += "<p>Paragraph " + std::to_string(i)
+                + " of the story, with enough words, commas, and detail to read as prose, "
+                  "including a <a href='/ref/"
+                + std::to_string(i) + "'>reference</a> now and then.</p>";
+    }
+    return html + "</article></div><footer><p>Copyright, terms, and all the small print "
+                  "nobody reads.</p><a href='/terms'>Terms</a></footer></body></html>";
+}
+
+/// A few hundred words of pseudo-prose; different seeds share the vocabulary, not the text.
+inline std::string article(unsigned seed, int words = 300) {
+    static const char* vocabulary[] = {"crawler", "page",   "index",  "storage", "link",
+                                       "host",    "queue",  "parser", "token",   "hash",
+                                       "worker",  "thread", "fetch",  "proxy",   "render",
+                                       "market",  "river",  "garden", "signal",  "winter"};
+    std::string text;
+    for (int i = 0; i < words; ++i) {
+        seed = seed * 1103515245 + 12345;
+        text += vocabulary[(seed >> 16) % 20];
+        text += (i % 12 == 11) ? ".\n\n" : " ";
+    }
+    return text;
+}
+
+}  // namespace Testing
+}  // namespace Mojo
@@ -1,7 +1,29 @@
+#include <zlib.h>
+#ifdef MOJO_HAVE_ZSTD
+#include <zstd.h>
+#endif
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <filesystem>
 #include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <gtest/gtest.h>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "../../src/core/types/constants.hpp"
+#include "../../src/storage/dedup_storage.hpp"
 #include "../../src/storage/disk_storage.hpp"
+#include "../../src/storage/jsonl_storage.hpp"
+#ifdef MOJO_HAVE_IO_URING
+#include "../../src/storage/uring_storage.hpp"
+#endif
+#include "../../src/storage/warc_storage.hpp"
 
 using namespace Mojo::Storage;
 namespace fs = std::filesystem;
@@ -48,3 +70,689 @@ TEST_F(StorageTest, BinaryStorage) {
     std::string   content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
     EXPECT_EQ(content, binary_data);
 }
+
+namespace {
+
+std::string read_file(const fs::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+}  // namespace
+
+TEST_F(StorageTest, DiskHashDirsSpreadFlatOutput) {
+    DiskOptions options;
+    options.hash_dirs = 2;
+    DiskStorage storage("test_storage_out", options);
+    storage.save("a.example_docs_page.md", "# Page");
+
+    fs::path path = storage.path_for("a.example_docs_page.md");
+    EXPECT_EQ(read_file(path), "# Page");
+    EXPECT_EQ(path.parent_path().filename().string().size(), 2u);
+    EXPECT_EQ(path.parent_path().parent_path().parent_path(), fs::path("test_storage_out"));
+    EXPECT_EQ(storage.path_for("a.example_docs_page.md"), path.string());  // Stable
+
+    std::set<std::string> directories;
+    for (int i = 0; i < 1000; ++i)
+        directories.insert(fs::path(storage.path_for(std::to_string(i))).parent_path().string());
+    EXPECT_GT(directories.size(), 900u);
+}
+
+TEST_F(StorageTest, DiskWriteBehindWritesAndLinks) {
+    DiskOptions options;
+    options.write_behind = true;
+    options.fsync        = FsyncPolicy::PER_BATCH;
+    {
+        DiskStorage storage("test_storage_out", options);
+        storage.save("a.example/index.md", "# Home");
+        storage.save("a.example/deep/path/page.md", "# Page");
+        // Queued behind its original, which is not on disk yet, so no link is claimed now
+        EXPECT_FALSE(
+            storage.save_duplicate("a.example/copy.md", "a.example/index.md", "# Home"));
+        // Its original was never saved, so the writer writes a full copy
+        storage.save_duplicate("a.example/lost.md", "a.example/never.md", "# Lost");
+        storage.save("a.example/index.md", "# Home");
+        storage.flush();
+
+        EXPECT_EQ(read_file("test_storage_out/a.example/deep/path/page.md"), "# Page");
+        EXPECT_EQ(read_file("test_storage_out/a.example/copy.md"), "# Home");
+        EXPECT_EQ(read_file("test_storage_out/a.example/lost.md"), "# Lost");
+        auto stats = storage.stats();
+        EXPECT_EQ(stats.files, 4u);
+        EXPECT_EQ(stats.links, 1u);
+        EXPECT_EQ(storage.deferred_links().count, 1u);
+        EXPECT_EQ(storage.deferred_links().bytes, 6u);
+        EXPECT_GT(stats.syncs, stats.batches);
+
+        // Later saves still reach the directory after it is removed behind the writer's back
+        fs::remove_all("test_storage_out/a.example/deep");
+        storage.save("a.example/deep/path/again.md", "# Again");
+    }
+    EXPECT_EQ(read_file("test_storage_out/a.example/deep/path/again.md"), "# Again");
+    EXPECT_EQ(read_file("test_storage_out/a.example/index.md"), "# Home");
+}
+
+TEST_F(StorageTest, DiskWriteBehindMoreDirectoriesThanDescriptors) {
+    DiskOptions options;
+    options.write_behind = true;
+    options.fsync        = FsyncPolicy::PER_BATCH;
+    const size_t dirs    = Mojo::Core::Constants::DISK_DIR_FDS + 44;
+    {
+        DiskStorage storage("test_storage_out", options);
+        // Every other save goes back to one hot directory while the rest cycle past the cap
+        for (size_t i = 0; i < dirs; ++i) {
+            storage.save("d" + std::to_string(i) + "/page.md", std::to_string(i));
+            storage.save("hot/" + std::to_string(i) + ".md", std::to_string(i));
+        }
+        storage.flush();
+        EXPECT_EQ(storage.stats().files, 2 * dirs);
+    }
+    for (size_t i = 0; i < dirs; ++i) {
+        EXPECT_EQ(read_file("test_storage_out/d" + std::to_string(i) + "/page.md"),
+                  std::to_string(i));
+        EXPECT_EQ(read_file("test_storage_out/hot/" + std::to_string(i) + ".md"),
+                  std::to_string(i));
+    }
+}
+
+TEST_F(StorageTest, DiskWriteBehindLinksToOriginalsOnOtherWriters) {
+    DiskOptions options;
+    options.write_behind = true;
+    constexpr int PAGES  = 64;
+    {
+        DiskStorage storage("test_storage_out", options);
+        // Most copies land on another writer than their original, queued just before them
+        for (int i = 0; i < PAGES; ++i) {
+            storage.save("orig" + std::to_string(i) + ".md", std::to_string(i));
+            storage.save_duplicate(
+                "copy" + std::to_string(i) + ".md", "orig" + std::to_string(i) + ".md",
+                std::to_string(i));
+        }
+    }
+    for (int i = 0; i < PAGES; ++i) {
+        EXPECT_TRUE(fs::equivalent("test_storage_out/orig" + std::to_string(i) + ".md",
+                                   "test_storage_out/copy" + std::to_string(i) + ".md"))
+            << i;
+    }
+}
+
+TEST_F(StorageTest, DiskFsyncPolicyNames) {
+    EXPECT_EQ(DiskStorage::parse_fsync("none"), FsyncPolicy::NONE);
+    EXPECT_EQ(DiskStorage::parse_fsync("batch"), FsyncPolicy::PER_BATCH);
+    EXPECT_EQ(DiskStorage::parse_fsync("file"), FsyncPolicy::PER_FILE);
+    EXPECT_THROW(DiskStorage::parse_fsync("sometimes"), std::invalid_argument);
+    EXPECT_THROW(Storage::create("disk", {"test_storage_out", 0, 1, false, false, 0, "always"}),
+                 std::invalid_argument);
+}
+
+TEST_F(StorageTest, DedupLinksIdenticalBodies) {
+    DedupStorage storage(std::make_unique<DiskStorage>("test_storage_out"));
+    storage.save("a.example/index.md", "# Not found");
+    storage.save("a.example/missing.md", "# Not found");
+    storage.save("b.example/fr/index.md", "# Not found");
+    storage.save("a.example/about.md", "# About");
+
+    EXPECT_EQ(read_file("test_storage_out/a.example/missing.md"), "# Not found");
+    EXPECT_EQ(read_file("test_storage_out/b.example/fr/index.md"), "# Not found");
+    EXPECT_TRUE(fs::equivalent("test_storage_out/a.example/index.md",
+                               "test_storage_out/b.example/fr/index.md"));
+    EXPECT_EQ(fs::hard_link_count("test_storage_out/a.example/index.md"), 3u);
+    EXPECT_EQ(fs::hard_link_count("test_storage_out/a.example/about.md"), 1u);
+
+    fs::path manifest = fs::path("test_storage_out") / Mojo::Core::Constants::DEDUP_MANIFEST;
+    EXPECT_EQ(read_file(manifest),
+              "a.example/missing.md\ta.example/index.md\n"
+              "b.example/fr/index.md\ta.example/index.md\n");
+
+    auto stats = storage.stats();
+    EXPECT_EQ(stats.saved, 2u);
+    EXPECT_EQ(stats.duplicates, 2u);
+    EXPECT_EQ(stats.bytes_saved, 22u);
+}
+
+TEST_F(StorageTest, DedupOriginalSavedAgainLeavesCopiesAlone) {
+    for (bool write_behind : {false, true}) {
+        SCOPED_TRACE(write_behind ? "write-behind" : "synchronous");
+        fs::remove_all("test_storage_out");
+        DiskOptions options;
+        options.write_behind = write_behind;
+        DedupStorage storage(std::make_unique<DiskStorage>("test_storage_out", options));
+        storage.save("a.md", "# Not found");
+        storage.save("b.md", "# Not found");
+        storage.flush();
+        ASSERT_TRUE(fs::equivalent("test_storage_out/a.md", "test_storage_out/b.md"));
+
+        auto stats = storage.stats();
+        EXPECT_EQ(stats.saved, 1u);
+        EXPECT_EQ(stats.duplicates, 1u);
+        EXPECT_EQ(stats.bytes_saved, 11u);
+
+        // The original gets a new inode; the link keeps the body it was made for.
+        storage.save("a.md", "# Real page now");
+        storage.flush();
+        EXPECT_EQ(read_file("test_storage_out/a.md"), "# Real page now");
+        EXPECT_EQ(read_file("test_storage_out/b.md"), "# Not found");
+    }
+}
+
+TEST_F(StorageTest, DedupOriginalSavedWithNewBodyIsNotLinkedToForOldOne) {
+    DedupStorage storage(std::make_unique<DiskStorage>("test_storage_out"));
+    storage.save("a.md", "x");
+    storage.save("a.md", "y");  // Say, a second URL redirected to the same page
+    storage.save("b.md", "x");
+
+    EXPECT_EQ(read_file("test_storage_out/a.md"), "y");
+    EXPECT_EQ(read_file("test_storage_out/b.md"), "x");
+    EXPECT_EQ(storage.stats().duplicates, 0u);
+
+    // "b.md" now stands for the old body
+    storage.save("c.md", "x");
+    EXPECT_TRUE(fs::equivalent("test_storage_out/b.md", "test_storage_out/c.md"));
+}
+
+TEST_F(StorageTest, DedupFallsBackToCopy) {
+    DedupStorage storage(std::make_unique<DiskStorage>("test_storage_out"));
+    storage.save("first.md", "same body");
+    fs::remove("test_storage_out/first.md");  // Nothing left to link to
+    storage.save("second.md", "same body");
+    EXPECT_EQ(read_file("test_storage_out/second.md"), "same body");
+
+    auto stats = storage.stats();
+    EXPECT_EQ(stats.saved, 2u);
+    EXPECT_EQ(stats.duplicates, 0u);
+    EXPECT_EQ(stats.bytes_saved, 0u);
+}
+
+TEST_F(StorageTest, DedupWithoutLinkSupportWritesCopies) {
+    class MemoryStorage : public Storage {
+    public:
+        void save(const std::string& key, const std::string& content, bool) override {
+            files[key] = content;
+        }
+        std::map<std::string, std::string> files;
+    };
+
+    auto         owned  = std::make_unique<MemoryStorage>();
+    auto*        memory = owned.get();
+    DedupStorage storage(std::move(owned));
+    storage.save("x", "body");
+    storage.save("y", "body");
+    EXPECT_EQ(memory->files.size(), 2u);
+    EXPECT_EQ(memory->files["y"], "body");
+    EXPECT_EQ(storage.stats().saved, 2u);
+    EXPECT_EQ(storage.stats().duplicates, 0u);
+}
+
+TEST_F(StorageTest, DedupDuplicateOfUnwrittenOriginalIsCopied) {
+    // Holds the first save until released, as a slow disk would.
+    class SlowStorage : public Storage {
+    public:
+        void save(const std::string& key, const std::string& content, bool) override {
+            std::unique_lock<std::mutex> lock(mutex);
+            files[key] = content;
+            if (started)
+                return;
+            started = true;
+            changed.notify_all();
+            changed.wait(lock, [&] { return released; });
+        }
+        bool save_duplicate(const std::string& key,
+                            const std::string& original,
+                            const std::string&,
+                            bool,
+                            const FetchRecord*) override {
+            std::lock_guard<std::mutex> lock(mutex);
+            links[key] = original;
+            return true;
+        }
+        std::mutex                         mutex;
+        std::condition_variable            changed;
+        bool                               started  = false;
+        bool                               released = false;
+        std::map<std::string, std::string> files;
+        std::map<std::string, std::string> links;
+    };
+
+    auto         owned = std::make_unique<SlowStorage>();
+    auto*        slow  = owned.get();
+    DedupStorage storage(std::move(owned));
+
+    std::thread first([&] { storage.save("a.md", "body"); });
+    {
+        std::unique_lock<std::mutex> lock(slow->mutex);
+        slow->changed.wait(lock, [&] { return slow->started; });
+    }
+    storage.save("b.md", "body");  // "a.md" is not written yet, so nothing to link to
+    {
+        std::lock_guard<std::mutex> lock(slow->mutex);
+        slow->released = true;
+    }
+    slow->changed.notify_all();
+    first.join();
+    storage.save("c.md", "body");
+
+    EXPECT_EQ(slow->files.count("b.md"), 1u);
+    ASSERT_EQ(slow->links.size(), 1u);
+    EXPECT_EQ(slow->links["c.md"], "a.md");
+    auto stats = storage.stats();
+    EXPECT_EQ(stats.saved, 2u);
+    EXPECT_EQ(stats.duplicates, 1u);
+    EXPECT_EQ(stats.bytes_saved, 4u);
+}
+
+TEST_F(StorageTest, DedupConcurrentSaves) {
+    DedupStorage             storage(std::make_unique<DiskStorage>("test_storage_out"));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&storage, t] {
+            for (int i = 0; i < 50; ++i)
+                storage.save("t" + std::to_string(t) + "/" + std::to_string(i) + ".md",
+                             "body " + std::to_string(i % 10));
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    // A body saved while its first copy is still being written is copied, not linked.
+    auto stats = storage.stats();
+    EXPECT_GE(stats.saved, 10u);
+    EXPECT_EQ(stats.saved + stats.duplicates, 400u);
+    for (int t = 0; t < 8; ++t)
+        for (int i = 0; i < 50; ++i)
+            EXPECT_EQ(read_file("test_storage_out/t" + std::to_string(t) + "/" +
+                                std::to_string(i) + ".md"),
+                      "body " + std::to_string(i % 10));
+}
+
+namespace {
+
+/// Inflates every gzip member in `data`; empty on a corrupt or cut-off stream.
+std::string gunzip(const std::string& data) {
+    z_stream stream{};
+    inflateInit2(&stream, 15 + 16);
+    std::string out;
+    char        buffer[16384];
+    stream.next_in  = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    int status      = Z_OK;
+    while (status == Z_OK) {
+        stream.next_out  = reinterpret_cast<Bytef*>(buffer);
+        stream.avail_out = sizeof(buffer);
+        status           = inflate(&stream, Z_NO_FLUSH);
+        out.append(buffer, sizeof(buffer) - stream.avail_out);
+        if (status == Z_STREAM_END && stream.avail_in > 0)
+            status = inflateReset(&stream);
+    }
+    inflateEnd(&stream);
+    return status == Z_STREAM_END ? out : "";
+}
+
+struct CdxLine {
+    std::string key, timestamp, url, mime, status, digest, redirect, meta, file;
+    size_t      length = 0, offset = 0;
+};
+
+std::vector<CdxLine> read_cdx(const fs::path& path) {
+    std::vector<CdxLine> lines;
+    std::ifstream        file(path);
+    std::string          line;
+    std::getline(file, line);
+    EXPECT_EQ(line, " CDX N b a m s k r M S V g");
+    while (std::getline(file, line)) {
+        std::istringstream in(line);
+        CdxLine            cdx;
+        in >> cdx.key >> cdx.timestamp >> cdx.url >> cdx.mime >> cdx.status >> cdx.digest
+            >> cdx.redirect >> cdx.meta >> cdx.length >> cdx.offset >> cdx.file;
+        lines.push_back(cdx);
+    }
+    return lines;
+}
+
+/// The record a CDX line points at, read back on its own.
+std::string read_record(const fs::path& dir, const CdxLine& cdx) {
+    std::ifstream file(dir / cdx.file, std::ios::binary);
+    file.seekg(static_cast<std::streamoff>(cdx.offset));
+    std::string member(cdx.length, '\0');
+    file.read(member.data(), static_cast<std::streamsize>(member.size()));
+    return gunzip(member);
+}
+
+}  // namespace
+
+TEST_F(StorageTest, WarcRecordsAreIndexed) {
+    std::string html = "<html><body><h1>Hi</h1></body></html>";
+    {
+        WarcStorage storage("test_storage_out");
+        FetchRecord fetch{"https://www.Example.com/a/b?x=1",
+                          200,
+                          "text/html; charset=utf-8",
+                          std::chrono::system_clock::now(),
+                          html,
+                          "Hi"};
+        storage.save_page("example.com/a/b.md", "# Hi\n", false, fetch);
+
+        std::string pdf = "%PDF-1.4 binary";
+        FetchRecord doc{
+            "https://example.com/doc.pdf", 200, "application/pdf", fetch.fetched_at, pdf, {}};
+        storage.save_page("example.com/doc.pdf", pdf, true, doc);
+
+        auto stats = storage.stats();
+        EXPECT_EQ(stats.files, 1u);
+        EXPECT_EQ(stats.records, 3u);
+    }
+
+    auto lines = read_cdx("test_storage_out/index.cdx");
+    ASSERT_EQ(lines.size(), 3u);
+    EXPECT_EQ(lines[0].key, "com,example)/a/b?x=1");
+    EXPECT_EQ(lines[0].url, "https://www.Example.com/a/b?x=1");
+    EXPECT_EQ(lines[0].mime, "text/html");
+    EXPECT_EQ(lines[0].status, "200");
+    EXPECT_EQ(lines[0].digest.size(), 37u);  // "sha1:" and 32 base32 digits
+    EXPECT_EQ(lines[0].timestamp.size(), 14u);
+    EXPECT_EQ(lines[1].mime, "text/markdown");
+    EXPECT_EQ(lines[2].mime, "application/pdf");
+    EXPECT_GT(lines[0].offset, 0u);  // After the warcinfo record
+    EXPECT_EQ(lines[1].offset, lines[0].offset + lines[0].length);
+
+    std::string resource = read_record("test_storage_out", lines[0]);
+    EXPECT_EQ(resource.rfind("WARC/1.1\r\nWARC-Type: resource\r\n", 0), 0u);
+    EXPECT_NE(resource.find("Content-Type: text/html; charset=utf-8\r\nContent-Length: "
+                            + std::to_string(html.size()) + "\r\n\r\n" + html + "\r\n\r\n"),
+              std::string::npos);
+    EXPECT_EQ(resource.find("HTTP/1.1"), std::string::npos);
+
+    std::string conversion = read_record("test_storage_out", lines[1]);
+    EXPECT_NE(conversion.find("WARC-Type: conversion"), std::string::npos);
+    auto id = resource.substr(resource.find("WARC-Record-ID: ") + 16, 47);
+    EXPECT_NE(conversion.find("WARC-Refers-To: " + id), std::string::npos);
+    EXPECT_NE(conversion.find("\r\n\r\n# Hi\n\r\n\r\n"), std::string::npos);
+
+    // The whole file is a valid multi-member gzip, warcinfo first
+    std::string whole = gunzip(read_file("test_storage_out/" + lines[0].file));
+    EXPECT_EQ(whole.rfind("WARC/1.1\r\nWARC-Type: warcinfo\r\n", 0), 0u);
+    EXPECT_NE(whole.find("WARC-Type: resource"), std::string::npos);
+}
+
+TEST_F(StorageTest, WarcFilesRoll) {
+    {
+        WarcStorage storage("test_storage_out", 1024);
+        std::string body;
+        for (unsigned seed = 1; body.size() < 2000;)  // Noise, so it does not compress away
+            body += static_cast<char>((seed = seed * 1103515245 + 12345) >> 16);
+        for (int i = 0; i < 4; ++i) {
+            std::string url = "https://example.com/" + std::to_string(i);
+            FetchRecord fetch{url, 200, "text/html", std::chrono::system_clock::now(), body, {}};
+            storage.save_page(std::to_string(i) + ".md", "page " + std::to_string(i), false, fetch);
+        }
+        EXPECT_EQ(storage.stats().files, 4u);
+    }
+
+    auto lines = read_cdx("test_storage_out/index.cdx");
+    ASSERT_EQ(lines.size(), 8u);
+    std::set<std::string> files;
+    for (const auto& line : lines) {
+        files.insert(line.file);
+        EXPECT_EQ(read_record("test_storage_out", line).rfind("WARC/1.1\r\n", 0), 0u);
+    }
+    EXPECT_EQ(files.size(), 4u);
+    EXPECT_EQ(lines[0].file, lines[1].file);  // A page's records share a file
+}
+
+TEST_F(StorageTest, WarcRunsInTheSameSecondKeepTheirFiles) {
+    for (int run = 0; run < 2; ++run) {
+        WarcStorage storage("test_storage_out");
+        storage.save("run.md", "run " + std::to_string(run));
+    }
+
+    auto lines = read_cdx("test_storage_out/index.cdx");
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_NE(lines[0].file, lines[1].file);
+    EXPECT_NE(read_record("test_storage_out", lines[0]).find("run 0"), std::string::npos);
+    EXPECT_NE(read_record("test_storage_out", lines[1]).find("run 1"), std::string::npos);
+}
+
+TEST_F(StorageTest, WarcResourceWithoutResponse) {
+    {
+        WarcStorage storage("test_storage_out");
+        storage.save("notes/readme.md", "plain save");
+    }
+    auto lines = read_cdx("test_storage_out/index.cdx");
+    ASSERT_EQ(lines.size(), 1u);
+    std::string record = read_record("test_storage_out", lines[0]);
+    EXPECT_NE(record.find("WARC-Type: resource"), std::string::npos);
+    EXPECT_NE(record.find("WARC-Target-URI: notes/readme.md"), std::string::npos);
+}
+
+TEST(WarcStorageTest, Surt) {
+    EXPECT_EQ(WarcStorage::surt("https://www.example.com/"), "com,example)/");
+    EXPECT_EQ(WarcStorage::surt("http://Docs.Example.co.uk/a?b=c"), "uk,co,example,docs)/a?b=c");
+    EXPECT_EQ(WarcStorage::surt("http://example.com:8080"), "com,example:8080)/");
+    EXPECT_EQ(WarcStorage::surt("https://127.0.0.1/x"), "1,0,0,127)/x");
+}
+
+namespace {
+
+std::vector<std::string> jsonl_lines(const fs::path& dir) {
+    std::vector<std::string> lines;
+    std::vector<fs::path>    files;
+    for (const auto& entry : fs::directory_iterator(dir))
+        files.push_back(entry.path());
+    std::sort(files.begin(), files.end());
+    for (const auto& file : files) {
+        std::ifstream in(file);
+        std::string   line;
+        while (std::getline(in, line))
+            lines.push_back(line);
+    }
+    return lines;
+}
+
+}  // namespace
+
+TEST_F(StorageTest, JsonlRecords) {
+    {
+        JsonlStorage storage("test_storage_out", 1);
+        auto         time = std::chrono::system_clock::from_time_t(1700000000);
+        std::string  html = "<title>T</title>";
+        FetchRecord  fetch{
+            "https://example.com/", 200, "text/html", time, html, "Caf\xC3\xA9 \"x\""};
+        storage.save_page("example.com/index.md", "# A\n\tb \\ c\x01", false, fetch);
+        storage.save_page("example.com/doc.pdf", "%PDF", true, fetch);
+    }
+    auto lines = jsonl_lines("test_storage_out");
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_EQ(lines[0],
+              "{\"url\":\"https://example.com/\",\"title\":\"Caf\xC3\xA9 \\\"x\\\"\","
+              "\"markdown\":\"# A\\n\\tb \\\\ c\\u0001\",\"fetched_at\":\"2023-11-14T22:13:20Z\","
+              "\"status\":200}");
+    EXPECT_NE(lines[1].find("\"markdown\":\"\""), std::string::npos);  // Documents: no text
+}
+
+TEST_F(StorageTest, JsonlEscapesInvalidUtf8) {
+    std::string out;
+    JsonlStorage::append_json_string(out, "ok \xE2\x82\xAC, latin-1 \xE9t\xE9, cut \xE2\x82");
+    EXPECT_EQ(out, "\"ok \xE2\x82\xAC, latin-1 \xEF\xBF\xBDt\xEF\xBF\xBD, cut "
+                   "\xEF\xBF\xBD\xEF\xBF\xBD\"");
+
+    out.clear();
+    JsonlStorage::append_json_string(out, "\xC0\xAF \xED\xA0\x80 \xF4\x90\x80\x80");  // Overlong,
+    EXPECT_EQ(out.find("\xC0"), std::string::npos);  // surrogate and past U+10FFFF
+    EXPECT_EQ(out.find("\xED"), std::string::npos);
+    EXPECT_EQ(out.find("\xF4"), std::string::npos);
+}
+
+TEST_F(StorageTest, JsonlShardsPerThreadAndRolls) {
+    constexpr int THREADS = 4, PER_THREAD = 500;
+    {
+        JsonlStorage             storage("test_storage_out", THREADS, 64 * 1024);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&storage, t] {
+                for (int i = 0; i < PER_THREAD; ++i) {
+                    std::string url = "https://example.com/" + std::to_string(t) + "/"
+                                      + std::to_string(i);
+                    FetchRecord fetch{
+                        url, 200, "text/html", std::chrono::system_clock::now(), {}, {}};
+                    storage.save_page(url, std::string(1000, 'a' + t), false, fetch);
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        storage.flush();
+
+        auto stats = storage.stats();
+        EXPECT_EQ(stats.records, THREADS * PER_THREAD);
+        EXPECT_GE(stats.files, THREADS * 7u);  // About 500 KiB per shard, rolled every 64 KiB
+    }
+
+    // Each thread had its own shard, so every file holds one thread's records
+    std::set<std::string> shard_names;
+    size_t                total = 0;
+    for (const auto& entry : fs::directory_iterator("test_storage_out")) {
+        std::string name = entry.path().filename().string();
+        shard_names.insert(name.substr(0, name.rfind('-')));
+        std::ifstream in(entry.path());
+        std::string   line;
+        std::set<char> letters;
+        while (std::getline(in, line)) {
+            letters.insert(line[line.find("\"markdown\":\"") + 12]);
+            total++;
+        }
+        EXPECT_EQ(letters.size(), 1u) << name;
+    }
+    EXPECT_EQ(shard_names.size(), static_cast<size_t>(THREADS));
+    EXPECT_EQ(total, static_cast<size_t>(THREADS * PER_THREAD));
+}
+
+TEST_F(StorageTest, JsonlRunsInTheSameSecondKeepTheirFiles) {
+    for (int run = 0; run < 2; ++run) {
+        JsonlStorage storage("test_storage_out", 1);
+        storage.save("https://example.com/" + std::to_string(run), "run " + std::to_string(run));
+    }
+
+    std::set<std::string> lines;
+    for (const auto& entry : fs::directory_iterator("test_storage_out")) {
+        std::ifstream in(entry.path());
+        for (std::string line; std::getline(in, line);)
+            lines.insert(line.substr(0, line.find(",\"title\"")));
+    }
+    EXPECT_EQ(lines,
+              (std::set<std::string>{"{\"url\":\"https://example.com/0\"",
+                                     "{\"url\":\"https://example.com/1\""}));
+}
+
+#ifdef MOJO_HAVE_ZSTD
+TEST_F(StorageTest, JsonlZstdFrames) {
+    {
+        JsonlStorage storage("test_storage_out", 1, 0, true, 4096);
+        for (int i = 0; i < 100; ++i)
+            storage.save("page" + std::to_string(i), std::string(200, 'z'));
+    }
+    auto files = std::vector<fs::directory_entry>(fs::directory_iterator("test_storage_out"),
+                                                  fs::directory_iterator());
+    ASSERT_EQ(files.size(), 1u);
+    EXPECT_EQ(files[0].path().extension(), ".zst");
+
+    // Several frames back to back, each holding whole lines
+    std::string   compressed = read_file(files[0].path());
+    std::string   plain;
+    ZSTD_DCtx*    context = ZSTD_createDCtx();
+    ZSTD_inBuffer in{compressed.data(), compressed.size(), 0};
+    char          buffer[8192];
+    while (in.pos < in.size) {
+        ZSTD_outBuffer out{buffer, sizeof(buffer), 0};
+        ASSERT_FALSE(ZSTD_isError(ZSTD_decompressStream(context, &out, &in)));
+        plain.append(buffer, out.pos);
+    }
+    ZSTD_freeDCtx(context);
+    EXPECT_EQ(std::count(plain.begin(), plain.end(), '\n'), 100);
+    EXPECT_LT(compressed.size(), plain.size() / 4);
+}
+#endif
+
+#ifdef MOJO_HAVE_IO_URING
+/// Containers may forbid io_uring (seccomp, kernel.io_uring_disabled).
+std::unique_ptr<UringStorage> make_uring(
+    unsigned depth   = Mojo::Core::Constants::URING_QUEUE_DEPTH,
+    size_t   pending = Mojo::Core::Constants::URING_MAX_PENDING) {
+    try {
+        return std::make_unique<UringStorage>("test_storage_out", depth, pending);
+    } catch (const std::runtime_error&) {
+        return nullptr;
+    }
+}
+
+TEST_F(StorageTest, UringWritesTree) {
+    auto storage = make_uring();
+    if (!storage)
+        GTEST_SKIP() << "io_uring unavailable";
+    std::string binary = {0x00, 0x01, (char)0xFF};
+    storage->save("a.example/index.md", "# Home");
+    storage->save("a.example/deep/path/page.md", "# Page");
+    storage->save("a.example/file.bin", binary, true);
+    storage->save("a.example/empty.md", "");
+    storage->flush();
+
+    EXPECT_EQ(read_file("test_storage_out/a.example/index.md"), "# Home");
+    EXPECT_EQ(read_file("test_storage_out/a.example/deep/path/page.md"), "# Page");
+    EXPECT_EQ(read_file("test_storage_out/a.example/file.bin"), binary);
+    EXPECT_TRUE(fs::exists("test_storage_out/a.example/empty.md"));
+
+    // A page saved again replaces the old body rather than writing over its start
+    storage->save("a.example/index.md", "#");
+    storage->flush();
+    EXPECT_EQ(read_file("test_storage_out/a.example/index.md"), "#");
+    EXPECT_EQ(storage->stats().files, 5u);
+    EXPECT_EQ(storage->stats().errors, 0u);
+}
+
+TEST_F(StorageTest, UringReplacesRatherThanTruncates) {
+    auto storage = make_uring();
+    if (!storage)
+        GTEST_SKIP() << "io_uring unavailable";
+    storage->save("a.md", "# Not found");
+    storage->flush();
+    fs::create_hard_link("test_storage_out/a.md", "test_storage_out/b.md");
+
+    storage->save("a.md", "# Real page now");
+    storage->flush();
+    EXPECT_EQ(read_file("test_storage_out/a.md"), "# Real page now");
+    EXPECT_EQ(read_file("test_storage_out/b.md"), "# Not found");
+    EXPECT_EQ(storage->stats().errors, 0u);
+}
+
+TEST_F(StorageTest, UringDrainsOnDestruction) {
+    UringStats stats;
+    {
+        // A queue of 8 entries and 1 KiB in flight: saves block and batches stay small
+        auto storage = make_uring(8, 1024);
+        if (!storage)
+            GTEST_SKIP() << "io_uring unavailable";
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&, t] {
+                for (int i = 0; i < 50; ++i) {
+                    storage->save("d" + std::to_string(i % 5) + "/" + std::to_string(t) + "-"
+                                      + std::to_string(i) + ".md",
+                                  std::string(300, static_cast<char>('a' + t)));
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        stats = storage->stats();
+    }
+    size_t files = 0;
+    for (const auto& entry : fs::recursive_directory_iterator("test_storage_out")) {
+        if (entry.is_regular_file()) {
+            files++;
+            EXPECT_EQ(entry.file_size(), 300u);
+        }
+    }
+    EXPECT_EQ(files, 200u);
+    // At most four files fit under the cap, queued or in the current batch, and a batch holds
+    // at most four; everything else was written before the destructor took over.
+    EXPECT_GE(stats.batches, (200u - 4) / 4);
+}
+#endif
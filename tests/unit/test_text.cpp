@@ -1,8 +1,20 @@
 #include <gtest/gtest.h>
+#include <atomic>
 #include <set>
+#include <stdexcept>
+#include <thread>
+#include "../../src/utils/text/boilerplate.hpp"
 #include "../../src/utils/text/converter.hpp"
+#include "../../src/utils/text/html2md.h"
+#include "../../src/utils/text/html_parser.hpp"
+#include "../../src/utils/text/near_duplicate.hpp"
+#include "../../src/utils/text/readability.hpp"
+#include "test_pages.hpp"
 
 using namespace Mojo::Utils::Text;
+using Mojo::Testing::article;
+using Mojo::Testing::chrome_page;
+using Mojo::Testing::sample_page;
 
 TEST(TextTest, LinkExtractionRealistic) {
     std::string html  = R"html(
@@ -165,3 +177,527 @@ TEST(TextTest, LargeAttributes) {
     ASSERT_EQ(links.size(), 1);
     EXPECT_EQ(links[0], large_href);
 }
+
+TEST(TextTest, ProcessMatchesSeparatePasses) {
+    std::string html = sample_page(20);
+    auto        page = Converter::process(html);
+
+    EXPECT_EQ(page.markdown, Converter::to_markdown(html));
+
+    auto expected = Converter::extract_anchors(html);
+    ASSERT_EQ(page.links.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(page.links[i].href, expected[i].href);
+        EXPECT_EQ(page.links[i].text, expected[i].text);
+    }
+}
+
+TEST(TextTest, ProcessAnchors) {
+    std::string html = "<script>x = '<a href=\"/no\">';</script>"
+                       "<p><a href='/a?x=1&amp;y=2'>  Fish\n &amp;   <b>Chips</b> </a>"
+                       "<a href=''>Empty</a><a name='x'>No href</a><A HREF='/upper'>Up</A></p>";
+    auto        page = Converter::process(html);
+    ASSERT_EQ(page.links.size(), 2);
+    EXPECT_EQ(page.links[0].href, "/a?x=1&y=2");
+    EXPECT_EQ(page.links[0].text, "Fish & Chips");
+    EXPECT_EQ(page.links[1].href, "/upper");
+    EXPECT_EQ(page.links[1].text, "Up");
+
+    EXPECT_TRUE(Converter::process(html, false).links.empty());
+}
+
+TEST(TextTest, ProcessLargePage) {
+    // Attribute offsets past 64 KiB used to wrap and return the wrong href
+    std::string html = "<p>" + std::string(70000, 'x') + "</p><a href='/far'>Far</a>";
+    auto        page = Converter::process(html);
+    ASSERT_EQ(page.links.size(), 1);
+    EXPECT_EQ(page.links[0].href, "/far");
+    EXPECT_NE(page.markdown.find("](/far)"), std::string::npos);
+}
+
+TEST(TextTest, ProcessMatchesSeparatePassesOnLargePage) {
+    std::string html = sample_page(2000);
+    auto        page = Converter::process(html);
+    EXPECT_EQ(page.markdown, Converter::to_markdown(html));
+    EXPECT_EQ(page.links.size(), Converter::extract_anchors(html).size());
+}
+
+TEST(TextTest, ConcurrentConversion) {
+    // Different shapes per thread, so shared state between converters would show up as a diff
+    std::vector<std::string> pages = {sample_page(50),
+                                      "<div><pre><code class='language-cpp'>int x;</code></pre>"
+                                      "<blockquote>Quoted <a href='/q'>link</a></blockquote></div>",
+                                      "<table><tr><th align='center'>H</th></tr><tr><td>D</td>"
+                                      "</tr></table><ol><li>One</li><li>Two</li></ol>",
+                                      "<h1>Title &amp; more</h1><p>Text with &lt;tags&gt;</p>"};
+    std::vector<ProcessedPage> expected;
+    for (const auto& html : pages)
+        expected.push_back(Converter::process(html));
+
+    constexpr int            THREADS = 8;
+    constexpr int            ROUNDS  = 50;
+    std::atomic<int>         mismatches{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int r = 0; r < ROUNDS; ++r) {
+                size_t i    = static_cast<size_t>(t + r) % pages.size();
+                auto   page = Converter::process(pages[i]);
+                if (page.markdown != expected[i].markdown
+                    || page.links.size() != expected[i].links.size())
+                    mismatches++;
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    EXPECT_EQ(mismatches.load(), 0);
+}
+
+TEST(TextTest, SymbolConversionsArePerConverter) {
+    std::string html = "<p>a &copy; b &amp; c</p>";
+
+    html2md::Converter custom(html);
+    custom.addHtmlSymbolConversion("&copy;", "(c)");
+    EXPECT_NE(custom.convert().find("a (c) b & c"), std::string::npos);
+
+    // The shared defaults are untouched
+    EXPECT_NE(html2md::Convert(html).find("a &copy; b & c"), std::string::npos);
+}
+
+TEST(TextTest, BulkTextMatchesPerCharOutput) {
+    // Expected output recorded from the per-char converter. The narrow line width puts the
+    // soft and hard break checks inside the bulk-copied runs.
+    html2md::Options narrow;
+    narrow.softBreak = 20;
+    narrow.hardBreak = 30;
+
+    std::vector<std::pair<std::string, std::string>> cases = {
+        {"<p>The quick brown fox jumps over the lazy dog. Pack my box with five dozen liquor "
+         "jugs.</p>",
+         "The quick brown fox jumps\nover the lazy dog. Pack\nmy box with five dozen\n"
+         "liquor jugs.\n"},
+        {"<p>Short then averyveryveryverylongwordwithoutanyspacesatall and more text after it.</p>",
+         "Short then averyveryveryverylongwordwithoutanyspacesatall\nand more text after it.\n"},
+        {"<h2>Escapes</h2><p>Use *stars*, `ticks` and back\\slashes. 1. Not a list</p>"
+         "<p>2. Also not</p>",
+         "## Escapes\n\nUse \\*stars\\*, \\`ticks\\`\nand back\\\\slashes. 1.\nNot a list\n\n"
+         "2\\. Also not\n"},
+        {"<blockquote><pre><code>int a = 1;\nif (a &lt; 2) {}\n</code></pre>Quoted text here "
+         "that wraps</blockquote>",
+         ">\n>\n> ```\n> int a = 1;\n> if (a < 2) {}\n> ```Quoted text\nhere that wraps\n"},
+        {"<script>var x = '*not* text';</script><style>p{}</style><p>Visible <a href='/x'>anchor "
+         "text that is long enough</a> tail.</p>",
+         "Visible [anchor text that is long enough](/x) tail.\n"},
+        {"<ul><li>List item with text long enough to pass the soft break</li></ul><table><tr><td>"
+         "Cell text long enough to pass</td></tr></table>",
+         "- List item with text long enough to pass the soft break\n\n"
+         "| Cell text long enough to pass |\n"}};
+
+    for (const auto& [html, expected] : cases) {
+        html2md::Converter converter(html, &narrow);
+        EXPECT_EQ(converter.convert(), expected) << html;
+    }
+}
+
+TEST(TextTest, ExtractTitle) {
+    EXPECT_EQ(Converter::extract_title("<html><head><TITLE lang=en>\n  Fish &amp; Chips\n"
+                                       "  </Title></head><body><svg><title>icon</title></svg>"),
+              "Fish & Chips");
+    EXPECT_EQ(Converter::extract_title("<titlebar>no</titlebar><title>Yes</title>"), "Yes");
+    EXPECT_EQ(Converter::extract_title("<title>Unclosed"), "Unclosed");
+    EXPECT_EQ(Converter::extract_title("<p>No title here</p>"), "");
+    EXPECT_EQ(Converter::extract_title("<title"), "");
+    // An icon's title in the body is not the page's
+    EXPECT_EQ(Converter::extract_title("<head></head><body><svg><title>icon</title></svg>"), "");
+    EXPECT_EQ(Converter::extract_title("<body><svg><title>icon</title></svg></body>"), "");
+}
+
+TEST(HtmlParserTest, CreateByName) {
+    EXPECT_EQ(HtmlParser::create("html2md"), nullptr);
+    EXPECT_EQ(HtmlParser::create("gumbo")->name(), "gumbo");
+    EXPECT_EQ(HtmlParser::reference().name(), "gumbo");
+    EXPECT_THROW(HtmlParser::create("expat"), std::invalid_argument);
+
+    auto names = HtmlParser::available();
+    ASSERT_FALSE(names.empty());
+    EXPECT_EQ(names.front(), "gumbo");
+#ifdef MOJO_HAVE_LEXBOR
+    EXPECT_EQ(HtmlParser::create("lexbor")->name(), "lexbor");
+#else
+    EXPECT_THROW(HtmlParser::create("lexbor"), std::invalid_argument);
+#endif
+}
+
+namespace {
+
+// Shapes where HTML5 tree construction matters: misnested and unclosed tags, foster
+// parenting, raw text elements, templates, entities and foreign content.
+std::vector<std::string> parity_corpus() {
+    std::vector<std::string> docs = {
+        "",
+        "<a href='/plain'>Plain</a>",
+        "<a href>Bare</a><a>None</a><A HREF='/UP'>Upper</A><a href=''>Empty</a>",
+        "<p><a href='/a'>one <b>two</a> three</b></p><a href='/b'>unclosed",
+        "<a href='/outer'>outer <a href='/inner'>inner</a> tail</a>",
+        "<table><a href='/fostered'>Fostered</a><tr><td><a href='/cell'>Cell</a></td></tr></table>",
+        "<script>document.write('<a href=\"/js\">')</script><style>a{}</style>"
+        "<textarea><a href='/ta'></textarea><title><a href='/title'></title>",
+        "<template><a href='/tpl'>Template</a></template><a href='/after'>After</a>",
+        "<a href='/e?a=1&amp;b=2&lt;'>Fish &amp; Chips &nbsp;&copy;&#x41;&#66;</a>",
+        "<svg><a href='/svg'><text>Vector</text></a></svg><math><mi>x</mi></math>",
+        "<a href='/ws'>\n\t  spaced   \r\n out  </a><a href='/cmt'>a<!-- c -->b</a>",
+        "<a href='/img'><img src='x.png' alt='Alt'></a><a href='/br'>line<br>break</a>",
+        "<head><link href='/css'><a href='/head'>Head</a></head><body><a href='/body'>Body</a>",
+        "<a href=\"/utf\">Caf\xC3\xA9 \xE2\x80\x94 \xF0\x9F\x9A\x80</a>",
+        "<<a href='/broken'>>Broken<</a>><a href='/unterminated",
+        "<a href='/long'>" + std::string(400, 'x') + " tail</a>",
+        sample_page(30),
+    };
+
+    std::string deep;
+    for (int i = 0; i < 2000; ++i)
+        deep += "<div>";
+    deep += "<a href='/deep'>Deep</a>";
+    docs.push_back(deep);
+    return docs;
+}
+
+class HtmlParserParity : public ::testing::TestWithParam<std::string> {
+protected:
+    std::unique_ptr<HtmlParser> parser = HtmlParser::create(GetParam());
+};
+
+}  // namespace
+
+TEST_P(HtmlParserParity, LinksMatchReference) {
+    for (const auto& html : parity_corpus())
+        EXPECT_EQ(parser->links(html), HtmlParser::reference().links(html)) << html;
+}
+
+TEST_P(HtmlParserParity, AnchorsMatchReference) {
+    for (const auto& html : parity_corpus()) {
+        auto got      = parser->anchors(html);
+        auto expected = HtmlParser::reference().anchors(html);
+        ASSERT_EQ(got.size(), expected.size()) << html;
+        for (size_t i = 0; i < expected.size(); ++i) {
+            EXPECT_EQ(got[i].href, expected[i].href) << html;
+            EXPECT_EQ(got[i].text, expected[i].text) << html;
+        }
+    }
+}
+
+TEST_P(HtmlParserParity, LinksAreAnchorHrefs) {
+    for (const auto& html : parity_corpus()) {
+        std::vector<std::string> hrefs;
+        for (const auto& anchor : parser->anchors(html))
+            hrefs.push_back(anchor.href);
+        EXPECT_EQ(parser->links(html), hrefs) << html;
+    }
+}
+
+TEST_P(HtmlParserParity, AnchorTextIsCapped) {
+    auto anchors = parser->anchors("<a href='/x'>" + std::string(1000, 'y') + "</a>");
+    ASSERT_EQ(anchors.size(), 1);
+    EXPECT_EQ(anchors[0].text.size(), HtmlParser::MAX_ANCHOR_TEXT);
+}
+
+TEST_P(HtmlParserParity, FindsEveryAnchorOnLargePage) {
+    std::string html = sample_page(2000);
+    EXPECT_EQ(parser->anchors(html).size(), 2u * 2000 + 3);
+}
+
+TEST_P(HtmlParserParity, ProcessTakesLinksFromParser) {
+    std::string html = sample_page(20);
+    auto        page = Converter::process(html, true, parser.get());
+    EXPECT_EQ(page.markdown, Converter::to_markdown(html));
+
+    auto expected = parser->anchors(html);
+    ASSERT_EQ(page.links.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+        EXPECT_EQ(page.links[i].href, expected[i].href);
+    EXPECT_TRUE(Converter::process(html, false, parser.get()).links.empty());
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends,
+                         HtmlParserParity,
+                         ::testing::ValuesIn(HtmlParser::available()),
+                         [](const auto& info) { return info.param; });
+
+TEST(ReadabilityTest, PicksArticle) {
+    std::string html    = chrome_page(8);
+    MainContent content = Readability().find(html);
+    ASSERT_TRUE(content.found());
+
+    auto block = std::string_view(html).substr(content.begin, content.end - content.begin);
+    EXPECT_EQ(block.substr(0, 21), "<article class='post'");
+    EXPECT_EQ(block.substr(block.size() - 10), "</article>");
+
+    auto page = Converter::process(html, true, nullptr, nullptr);
+    auto main = Readability();
+    auto lean = Converter::process(html, true, nullptr, &main);
+    EXPECT_NE(lean.markdown.find("The headline"), std::string::npos);
+    EXPECT_NE(lean.markdown.find("Paragraph 7 of the story"), std::string::npos);
+    EXPECT_EQ(lean.markdown.find("Popular story"), std::string::npos);
+    EXPECT_EQ(lean.markdown.find("cookies"), std::string::npos);
+    EXPECT_EQ(lean.markdown.find("Copyright"), std::string::npos);
+    EXPECT_LT(lean.markdown.size(), page.markdown.size());
+}
+
+TEST(ReadabilityTest, LinksCoverWholePage) {
+    for (const auto& html : {chrome_page(8), sample_page(20)}) {
+        std::vector<Link> links;
+        Readability().find(html, &links);
+        auto expected = Converter::process(html).links;
+        ASSERT_EQ(links.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+            EXPECT_EQ(links[i].href, expected[i].href);
+    }
+
+    std::vector<Link> links;
+    Readability().find("<p><a href='/a?x=1&amp;y=2'>  Fish\n &amp;   <b>Chips</b> </a>"
+                       "<a href='/b'>one<a href='/c'>two</a><a href=''>Empty</a></p>",
+                       &links);
+    ASSERT_EQ(links.size(), 3);
+    EXPECT_EQ(links[0].href, "/a?x=1&y=2");
+    EXPECT_EQ(links[0].text, "Fish & Chips");
+    EXPECT_EQ(links[1].text, "one");
+    EXPECT_EQ(links[2].text, "two");
+}
+
+TEST(ReadabilityTest, ShortPageKeptWhole) {
+    std::string html    = "<html><body><h1>Index</h1><ul><li><a href='/a'>A</a></li>"
+                          "<li><a href='/b'>B</a></li></ul><p>Short intro.</p></body></html>";
+    MainContent content = Readability().find(html);
+    EXPECT_FALSE(content.found());
+
+    Readability main;
+    auto        page = Converter::process(html, true, nullptr, &main);
+    EXPECT_EQ(page.markdown, Converter::to_markdown(html));
+    EXPECT_EQ(page.links.size(), 2);
+}
+
+TEST(ReadabilityTest, LinkHeavyBlockLoses) {
+    // A long list of links has plenty of text but is navigation
+    std::string html = "<div id='links'>";
+    for (int i = 0; i < 60; ++i)
+        html += "<p><a href='/l" + std::to_string(i) + "'>A rather long link title, number "
+                + std::to_string(i) + "</a></p>";
+    html += "</div><div id='story'>";
+    for (int i = 0; i < 4; ++i)
+        html += "<p>Real prose that carries the page, with commas, clauses, and some length to "
+                "it, paragraph "
+                + std::to_string(i) + ".</p>";
+    html += "</div>";
+
+    MainContent content = Readability().find(html);
+    ASSERT_TRUE(content.found());
+    EXPECT_EQ(html.compare(content.begin, 15, "<div id='story'"), 0);
+}
+
+TEST(ReadabilityTest, UnclosedAndHiddenMarkup) {
+    // Implied end tags, a hidden block, a comment and script text that looks like markup
+    std::string prose = "Plain words, many of them, running on long enough to count as a block";
+    std::string html  = "<div class='content'><!-- <div> --><script>var s = '</div><p>';</script>";
+    for (int i = 0; i < 6; ++i)
+        html += "<p>" + prose + " " + std::to_string(i);
+    html += "<div hidden><p>" + prose + prose + prose + prose + "</div>";
+
+    MainContent content = Readability().find(html);
+    ASSERT_TRUE(content.found());
+    EXPECT_EQ(content.begin, 0);
+    EXPECT_EQ(content.end, html.size());
+}
+
+TEST(ReadabilityTest, MainContentIsSmallerThanWholePage) {
+    std::string html = chrome_page(40);
+    for (int i = 0; i < 6; ++i)
+        html += html;  // 64 pages back to back: the first article still wins
+
+    Readability main;
+    EXPECT_LT(Converter::process(html, true, nullptr, &main).markdown.size(),
+              Converter::process(html).markdown.size());
+}
+
+namespace {
+
+std::string site_page(int n) {
+    return "[Home](/) [News](/news) [Sport](/sport)\n\n# Story " + std::to_string(n)
+           + "\n\nBody text that only page " + std::to_string(n)
+           + " has.\n\n## Related\n\n- [Other story](/other)\n- [More](/more)\n\n"
+             "Copyright 2024 Example Ltd. All rights reserved.\n";
+}
+
+}  // namespace
+
+TEST(BoilerplateTest, RepeatedBlocksRemovedAfterMinPages) {
+    BoilerplateFilter filter(0.5, 5);
+    for (int i = 0; i < 4; ++i)
+        EXPECT_EQ(filter.filter("example.com", site_page(i)), site_page(i));
+
+    std::string md = filter.filter("example.com", site_page(4));
+    EXPECT_EQ(md, "# Story 4\n\nBody text that only page 4 has.\n\n## Related\n");
+
+    auto stats = filter.stats();
+    EXPECT_EQ(stats.pages, 5);
+    EXPECT_EQ(stats.blocks_removed, 3);
+    EXPECT_GT(stats.bytes_removed, 0);
+}
+
+TEST(BoilerplateTest, HostsAreSeparate) {
+    BoilerplateFilter filter(0.5, 3);
+    for (int i = 0; i < 5; ++i)
+        filter.filter("a.example", site_page(i));
+    EXPECT_EQ(filter.filter("b.example", site_page(9)), site_page(9));
+    EXPECT_NE(filter.filter("a.example", site_page(9)), site_page(9));
+}
+
+TEST(BoilerplateTest, HostsPastTheCapPassThrough) {
+    BoilerplateFilter filter(0.5, 3, 100, 2);
+    for (const char* host : {"a.example", "b.example", "c.example"}) {
+        for (int i = 0; i < 5; ++i)
+            filter.filter(host, site_page(i));
+    }
+    EXPECT_EQ(filter.stats().hosts, 2);
+    EXPECT_EQ(filter.stats().pages, 15);
+    EXPECT_NE(filter.filter("b.example", site_page(9)), site_page(9));
+    EXPECT_EQ(filter.filter("c.example", site_page(9)), site_page(9));
+}
+
+TEST(BoilerplateTest, ThresholdIsAShareOfPages) {
+    BoilerplateFilter filter(0.5, 1);
+    std::string       banner = "Spring sale, everything half price.";
+    // On two of the first five pages: 40%, kept
+    for (int i = 0; i < 5; ++i) {
+        std::string md = "Unique " + std::to_string(i) + "\n";
+        if (i % 2 == 1)
+            md += "\n" + banner + "\n";
+        filter.filter("shop.example", md);
+    }
+    std::string md = "Unique 5\n\n" + banner + "\n";
+    EXPECT_EQ(filter.filter("shop.example", md), md);  // Now 3 of 6: still not more than half
+    EXPECT_EQ(filter.filter("shop.example", "Unique 6\n\n" + banner + "\n"), "Unique 6\n");
+}
+
+TEST(BoilerplateTest, CodeFencesStayWhole) {
+    BoilerplateFilter filter(0.5, 2);
+    std::string       shared = "```\nint main() {\n\n    return 0;\n}\n```";
+    filter.filter("docs.example", "Intro one\n\n" + shared + "\n");
+    std::string md = filter.filter("docs.example", "Intro two\n\n" + shared + "\n");
+    EXPECT_EQ(md, "Intro two\n");  // The whole fence went, not the lines around its blank
+
+    std::string heading = "## Examples\n\nFirst.\n";
+    filter.filter("docs.example", heading);
+    EXPECT_EQ(filter.filter("docs.example", "## Examples\n\nSecond.\n"),
+              "## Examples\n\nSecond.\n");
+}
+
+TEST(BoilerplateTest, ConcurrentHosts) {
+    BoilerplateFilter        filter(0.5, 5);
+    std::vector<std::thread> threads;
+    std::atomic<int>         failures{0};
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&, t] {
+            std::string host = "host" + std::to_string(t % 4) + ".example";
+            for (int i = 0; i < 200; ++i) {
+                std::string md = filter.filter(host, site_page(i));
+                if (md.find("Body text that only page " + std::to_string(i)) == std::string::npos)
+                    failures++;
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    EXPECT_EQ(failures.load(), 0);
+    EXPECT_EQ(filter.stats().pages, 8 * 200);
+}
+
+TEST(NearDuplicateTest, IdenticalAndVariantPagesMatch) {
+    NearDuplicateIndex index;
+    std::string        page = article(1) + "[Next](/list?page=2&sid=a81f3c)\n";
+    EXPECT_FALSE(index.find_or_add(page, "https://a.example/list"));
+
+    auto same = index.find_or_add(page, "https://mirror.example/list");
+    ASSERT_TRUE(same);
+    EXPECT_EQ(same->url, "https://a.example/list");
+    EXPECT_EQ(same->distance, 0);
+
+    // Another session ID and a print footer: a handful of shingles out of ~300
+    std::string variant = article(1) + "[Next](/list?page=2&sid=77e02b)\n\nPrinted: a.example\n";
+    auto        near    = index.find_or_add(variant, "https://a.example/list?sid=77e02b");
+    ASSERT_TRUE(near);
+    EXPECT_EQ(near->url, "https://a.example/list");
+    EXPECT_LE(near->distance, Mojo::Core::Constants::NEAR_DUPLICATE_DISTANCE);
+}
+
+TEST(NearDuplicateTest, DistinctPagesDoNot) {
+    NearDuplicateIndex index;
+    for (unsigned seed = 0; seed < 200; ++seed)
+        EXPECT_FALSE(index.find_or_add(article(seed), "https://a.example/" + std::to_string(seed)))
+            << seed;
+
+    auto stats = index.stats();
+    EXPECT_EQ(stats.pages, 200);
+    EXPECT_EQ(stats.duplicates, 0);
+    EXPECT_EQ(stats.indexed, 200);
+}
+
+TEST(NearDuplicateTest, FingerprintIgnoresCaseAndMarkup) {
+    std::string plain = "The quick brown fox jumps over the lazy dog near the river";
+    std::string md    = "# The Quick Brown Fox\n\n*jumps* over the **lazy** dog, near the river";
+    EXPECT_EQ(NearDuplicateIndex::fingerprint(plain, 4), NearDuplicateIndex::fingerprint(md, 4));
+    EXPECT_NE(NearDuplicateIndex::fingerprint(plain, 4),
+              NearDuplicateIndex::fingerprint(article(3), 4));
+    EXPECT_EQ(NearDuplicateIndex::fingerprint("", 4), 0);
+    EXPECT_EQ(NearDuplicateIndex::fingerprint("--- | *** |", 4), 0);
+}
+
+TEST(NearDuplicateTest, EmptyPagesAndDistanceZero) {
+    NearDuplicateIndex index(0);
+    EXPECT_FALSE(index.find_or_add("", "https://a.example/1"));
+    EXPECT_FALSE(index.find_or_add("", "https://a.example/2"));  // No words, nothing to match
+
+    std::string page = article(5);
+    EXPECT_FALSE(index.find_or_add(page, "https://a.example/3"));
+    auto exact = index.find_or_add(page, "https://a.example/4");
+    ASSERT_TRUE(exact);
+    EXPECT_EQ(exact->distance, 0);
+    EXPECT_EQ(exact->url, "https://a.example/3");
+
+    // At distance 0 only identical fingerprints match, so an edit makes a new page.
+    std::string edited  = page;
+    int         shingle = Mojo::Core::Constants::NEAR_DUPLICATE_SHINGLE;
+    edited.replace(0, 40, "An entirely different opening sentence here.");
+    ASSERT_NE(NearDuplicateIndex::fingerprint(edited, shingle),
+              NearDuplicateIndex::fingerprint(page, shingle));
+    EXPECT_FALSE(index.find_or_add(edited, "https://a.example/5"));
+    EXPECT_EQ(index.stats().indexed, 2);
+}
+
+TEST(NearDuplicateTest, IndexIsCapped) {
+    NearDuplicateIndex index(3, 4, 10);
+    for (unsigned seed = 0; seed < 20; ++seed)
+        index.find_or_add(article(seed), "https://a.example/" + std::to_string(seed));
+    EXPECT_EQ(index.stats().indexed, 10);
+    EXPECT_TRUE(index.find_or_add(article(2), "https://b.example/2"));    // Indexed
+    EXPECT_FALSE(index.find_or_add(article(15), "https://b.example/15"));  // Checked only
+}
+
+TEST(NearDuplicateTest, EditedCopiesAreFound) {
+    constexpr unsigned       N = 20000;
+    std::vector<std::string> pages;
+    for (unsigned seed = 0; seed < 500; ++seed)
+        pages.push_back(article(seed, 600));
+
+    NearDuplicateIndex index;
+    size_t             duplicates = 0;
+    for (unsigned i = 0; i < N; ++i) {
+        // Every page comes back as a copy with one word changed
+        std::string page = pages[i % pages.size()];
+        if (i >= pages.size())
+            page += std::to_string(i);
+        duplicates += index.find_or_add(page, std::to_string(i)).has_value();
+    }
+    // A single edit can tip a few close bit votes; rarely more than the distance allows
+    EXPECT_GE(duplicates, (N - pages.size()) * 99 / 100);
+}
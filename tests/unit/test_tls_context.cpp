@@ -0,0 +1,138 @@
+#include <atomic>
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast.hpp>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include "../../src/network/http/beast_client.hpp"
+#include "../../src/network/http/tls_context.hpp"
+#include "test_certs.hpp"
+
+using namespace Mojo::Network::Http;
+
+namespace {
+
+// TLS server that answers one request per connection and then closes it, so every
+// client request needs a new handshake.
+class ClosingTlsServer {
+public:
+    explicit ClosingTlsServer(const Mojo::Testing::SelfSignedCert& cert)
+        : ssl_ctx_(boost::asio::ssl::context::tls_server),
+          acceptor_(ioc_, {boost::asio::ip::make_address("127.0.0.1"), 0}) {
+        ssl_ctx_.use_certificate_chain(boost::asio::buffer(cert.cert_pem));
+        ssl_ctx_.use_private_key(boost::asio::buffer(cert.key_pem),
+                                 boost::asio::ssl::context::pem);
+        thread_ = std::thread([this]() { run(); });
+    }
+
+    ~ClosingTlsServer() {
+        stopping_ = true;
+        boost::system::error_code    ec;
+        boost::asio::ip::tcp::socket wake(ioc_);
+        wake.connect(acceptor_.local_endpoint(), ec);
+        thread_.join();
+    }
+
+    unsigned short port() const {
+        return acceptor_.local_endpoint().port();
+    }
+
+private:
+    void run() {
+        namespace http = boost::beast::http;
+        while (true) {
+            boost::system::error_code                              ec;
+            boost::asio::ssl::stream<boost::asio::ip::tcp::socket> stream(ioc_, ssl_ctx_);
+            acceptor_.accept(stream.next_layer(), ec);
+            if (ec || stopping_)
+                return;
+            stream.handshake(boost::asio::ssl::stream_base::server, ec);
+            if (ec)
+                continue;
+
+            boost::beast::flat_buffer        buffer;
+            http::request<http::string_body> req;
+            http::read(stream, buffer, req, ec);
+            if (ec)
+                continue;
+            http::response<http::string_body> res{http::status::ok, 11};
+            res.set(http::field::content_type, "text/html");
+            res.keep_alive(false);
+            res.body() = "<html>tls</html>";
+            res.prepare_payload();
+            http::write(stream, res, ec);
+            stream.shutdown(ec);
+        }
+    }
+
+    boost::asio::io_context        ioc_;
+    boost::asio::ssl::context      ssl_ctx_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    std::thread                    thread_;
+    std::atomic<bool>              stopping_{false};
+};
+
+}  // namespace
+
+TEST(TlsContextTest, SharedInstance) {
+    EXPECT_EQ(&TlsContext::instance(), &TlsContext::instance());
+    EXPECT_EQ(&TlsContext::instance().context(), &TlsContext::instance().context());
+}
+
+TEST(TlsContextTest, RepeatHandshakesAreResumed) {
+    auto cert = Mojo::Testing::make_self_signed_cert("127.0.0.1");
+    ASSERT_FALSE(cert.cert_pem.empty());
+
+    TlsContext       tls(cert.cert_pem);
+    ClosingTlsServer server(cert);
+    std::string      url = "https://127.0.0.1:" + std::to_string(server.port()) + "/";
+
+    boost::asio::io_context     ioc;
+    std::vector<Mojo::Response> responses;
+    ConnectionPool::get(ioc).set_tls_context(tls);
+    boost::asio::co_spawn(
+        ioc,
+        [&]() -> boost::asio::awaitable<void> {
+            BeastClient client(ioc);
+            responses.push_back(co_await client.get(url));
+            responses.push_back(co_await client.get(url));
+        },
+        boost::asio::detached);
+    ioc.run();
+
+    ASSERT_EQ(responses.size(), 2u);
+    EXPECT_TRUE(responses[0].success) << responses[0].error;
+    EXPECT_TRUE(responses[1].success) << responses[1].error;
+    EXPECT_EQ(responses[1].body, "<html>tls</html>");
+
+    auto stats = tls.stats();
+    EXPECT_EQ(stats.full_handshakes, 1u);
+    EXPECT_EQ(stats.resumed_handshakes, 1u);
+    EXPECT_EQ(stats.cached_sessions, 1u);
+    EXPECT_EQ(TlsContext::instance().stats().cached_sessions, 0u);
+}
+
+TEST(TlsContextTest, UntrustedCertificateFailsWithoutExtraCa) {
+    auto cert = Mojo::Testing::make_self_signed_cert("127.0.0.1");
+    ASSERT_FALSE(cert.cert_pem.empty());
+
+    TlsContext       tls;
+    ClosingTlsServer server(cert);
+    std::string      url = "https://127.0.0.1:" + std::to_string(server.port()) + "/";
+
+    boost::asio::io_context ioc;
+    Mojo::Response          response;
+    ConnectionPool::get(ioc).set_tls_context(tls);
+    boost::asio::co_spawn(
+        ioc,
+        [&]() -> boost::asio::awaitable<void> {
+            BeastClient client(ioc);
+            response = co_await client.get(url);
+        },
+        boost::asio::detached);
+    ioc.run();
+
+    EXPECT_FALSE(response.success);
+    EXPECT_EQ(tls.stats().cached_sessions, 0u);
+}
@@ -1,7 +1,10 @@
 #include <gtest/gtest.h>
+#include "../../src/utils/url/canonicalizer.hpp"
 #include "../../src/utils/url/url.hpp"
 
+using Mojo::Utils::CanonicalizerOptions;
 using Mojo::Utils::Url;
+using Mojo::Utils::UrlCanonicalizer;
 using namespace std::string_literals;
 
 TEST(UrlTest, BasicParsing) {
@@ -195,3 +198,110 @@ TEST(UrlTest, RecursePercent) {
     auto res = Url::resolve("http://example.com/", "%2525");
     EXPECT_EQ(res, "http://example.com/%2525");
 }
+
+TEST(CanonicalizerTest, CaseFolding) {
+    UrlCanonicalizer c;
+    EXPECT_EQ(c.canonicalize("HTTP://Example.COM/Path"), "http://example.com/Path");
+    EXPECT_EQ(c.canonicalize("https://example.com./a"), "https://example.com/a");
+}
+
+TEST(CanonicalizerTest, DefaultPort) {
+    UrlCanonicalizer c;
+    EXPECT_EQ(c.canonicalize("http://example.com:80/a"), "http://example.com/a");
+    EXPECT_EQ(c.canonicalize("https://example.com:443/a"), "https://example.com/a");
+    EXPECT_EQ(c.canonicalize("http://example.com:443/a"), "http://example.com:443/a");
+    EXPECT_EQ(c.canonicalize("https://example.com:8443/a"), "https://example.com:8443/a");
+}
+
+TEST(CanonicalizerTest, Fragment) {
+    UrlCanonicalizer c;
+    EXPECT_EQ(c.canonicalize("http://example.com/a#top"), "http://example.com/a");
+    EXPECT_EQ(c.canonicalize("http://example.com/a?b=1#top"), "http://example.com/a?b=1");
+
+    CanonicalizerOptions keep;
+    keep.strip_fragment = false;
+    EXPECT_EQ(UrlCanonicalizer(keep).canonicalize("http://example.com/a#top"),
+              "http://example.com/a#top");
+}
+
+TEST(CanonicalizerTest, PercentEncoding) {
+    UrlCanonicalizer c;
+    // Unreserved characters are decoded, reserved ones keep an upper-case escape
+    EXPECT_EQ(c.canonicalize("http://example.com/%7euser/%41%2f"), "http://example.com/~user/A%2F");
+    EXPECT_EQ(c.canonicalize("http://example.com/a b"), "http://example.com/a%20b");
+    EXPECT_EQ(c.canonicalize("http://example.com/100%"), "http://example.com/100%25");
+    EXPECT_EQ(c.canonicalize("http://example.com/caf\xc3\xa9"), "http://example.com/caf%C3%A9");
+    // An escaped '&' or '=' in the query is data, not a separator
+    EXPECT_EQ(c.canonicalize("http://example.com/?q=a%26b%3dc"), "http://example.com/?q=a%26b%3Dc");
+}
+
+TEST(CanonicalizerTest, DotSegments) {
+    UrlCanonicalizer c;
+    EXPECT_EQ(c.canonicalize("http://example.com/a/./b/../c"), "http://example.com/a/c");
+    EXPECT_EQ(c.canonicalize("http://example.com/a/b/.."), "http://example.com/a/");
+    EXPECT_EQ(c.canonicalize("http://example.com/../../a"), "http://example.com/a");
+    EXPECT_EQ(c.canonicalize("http://example.com/a/%2E%2E/b"), "http://example.com/b");
+    EXPECT_EQ(c.canonicalize("http://example.com"), "http://example.com/");
+}
+
+TEST(CanonicalizerTest, QuerySorting) {
+    UrlCanonicalizer c;
+    EXPECT_EQ(c.canonicalize("http://example.com/?b=2&a=1&c"), "http://example.com/?a=1&b=2&c");
+    // Repeated keys keep their relative order; empty params are dropped
+    EXPECT_EQ(c.canonicalize("http://example.com/?t=2&&a=1&t=1&"),
+              "http://example.com/?a=1&t=2&t=1");
+    EXPECT_EQ(c.canonicalize("http://example.com/a?"), "http://example.com/a");
+}
+
+TEST(CanonicalizerTest, TrackingParams) {
+    UrlCanonicalizer c;
+    EXPECT_EQ(c.canonicalize("http://example.com/a?utm_source=x&UTM_Medium=y&id=3&fbclid=z"),
+              "http://example.com/a?id=3");
+    EXPECT_EQ(c.canonicalize("http://example.com/a?gclid=1"), "http://example.com/a");
+
+    CanonicalizerOptions options;
+    options.tracking_params.push_back("sessionid");
+    EXPECT_EQ(UrlCanonicalizer(options).canonicalize("http://example.com/?sessionid=9&x=1"),
+              "http://example.com/?x=1");
+}
+
+TEST(CanonicalizerTest, DisabledRules) {
+    CanonicalizerOptions none;
+    none.lowercase              = false;
+    none.remove_default_port    = false;
+    none.normalize_percent      = false;
+    none.remove_dot_segments    = false;
+    none.sort_query             = false;
+    none.remove_tracking_params = false;
+    std::string url             = "http://Example.com:80/a/../%7e?b=1&utm_source=x&a=2";
+    EXPECT_EQ(UrlCanonicalizer(none).canonicalize(url + "#f"), url);
+}
+
+TEST(CanonicalizerTest, LeavesOtherUrlsAlone) {
+    UrlCanonicalizer c;
+    EXPECT_EQ(c.canonicalize("mailto:Someone@Example.com"), "mailto:Someone@Example.com");
+    EXPECT_EQ(c.canonicalize("ftp://Example.com/a/../b"), "ftp://Example.com/a/../b");
+    EXPECT_EQ(c.canonicalize("/relative/../path"), "/relative/../path");
+    EXPECT_EQ(c.canonicalize(""), "");
+}
+
+TEST(CanonicalizerTest, Equivalence) {
+    UrlCanonicalizer c;
+    std::string      expected = "https://example.com/a/b?a=1&b=2";
+    EXPECT_EQ(c.canonicalize("HTTPS://Example.com:443/a/./b?utm_source=x&b=2&a=1#top"), expected);
+    EXPECT_EQ(c.canonicalize("https://user@example.com/a/c/../b?a=1&b=2"), expected);
+    EXPECT_EQ(c.canonicalize("https://EXAMPLE.com/a/%62?b=2&a=%31"), expected);
+}
+
+TEST(CanonicalizerTest, OutputIsAFixedPoint) {
+    UrlCanonicalizer c;
+    for (const auto& url :
+         {"https://www.example.com/2024/05/some-long-article-slug?utm_source=feed&ref=home#c",
+          "HTTP://Example.com:80/a/./b/../c/index.html?b=2&a=1&fbclid=xyz",
+          "https://docs.example.org/api/v2/reference/%7euser/search?q=caf%c3%a9&page=3",
+          "https://shop.example.net/cart?items=1,2,3&session=abc&gclid=123&sort=price"}) {
+        std::string once = c.canonicalize(url);
+        EXPECT_FALSE(once.empty());
+        EXPECT_EQ(c.canonicalize(once), once);
+    }
+}